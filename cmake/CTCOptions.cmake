@@ -23,4 +23,15 @@ function(ct_apply_compiler_options target)
         endif()
     endif()
 
+    # Vector widths of the math kernels follow the target ISA; header-only kernels
+    # pick it up from the consumer, so it is a public requirement
+    if(CT_NATIVE_ARCH AND NOT MSVC)
+        get_target_property(target_type ${target} TYPE)
+        if(target_type STREQUAL "EXECUTABLE")
+            target_compile_options(${target} PRIVATE -march=native)
+        else()
+            target_compile_options(${target} PUBLIC -march=native)
+        endif()
+    endif()
+
 endfunction()
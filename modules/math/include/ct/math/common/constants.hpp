@@ -16,10 +16,10 @@ inline constexpr T two_pi = std::numbers::pi_v<T> * T{2};
 template<floating_point T>
 inline constexpr T half_pi = std::numbers::pi_v<T> / T{2};
 
-template<floating_point T>
+template<real T>
 inline constexpr T epsilon = std::numeric_limits<T>::epsilon();
 
-template<floating_point T>
+template<real T>
 inline constexpr T infinity = std::numeric_limits<T>::infinity();
 
 } // namespace cc
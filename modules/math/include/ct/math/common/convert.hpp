@@ -0,0 +1,159 @@
+#pragma once
+
+#include "./half.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../vec/base.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+//NOTE: MSVC has no __F16C__; every AVX2 target it builds for has the instructions
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+    #define CT_HALF_F16C 1
+#else
+    #define CT_HALF_F16C 0
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    #define CT_HALF_NEON 1
+#else
+    #define CT_HALF_NEON 0
+#endif
+
+namespace ct {
+
+namespace detail {
+
+//NOTE: Conversion is bound by memory bandwidth; below this many elements one thread keeps up
+inline constexpr std::size_t half_parallel_min = 256 * 1024;
+
+template<typename F>
+void half_batch_for(std::size_t n, F&& fn) {
+    if (n >= half_parallel_min) {
+        parallel_for(0, n, parallel_grain(n, 64 * 1024), fn);
+    } else {
+        fn(0, n);
+    }
+}
+
+// The vector loops cover whole registers with the hardware conversions (vcvtps2ph /
+// vcvtph2ps, fcvtn / fcvtl); the scalar tail, and targets without them, use the
+// branch-free bit conversions, which round identically
+inline void f16_encode(const float* CT_RESTRICT in, f16* CT_RESTRICT out, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) {
+        const __m256i h = _mm512_cvtps_ph(_mm512_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), h);
+    }
+#elif CT_HALF_F16C
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#elif CT_HALF_NEON
+    for (; i + 4 <= n; i += 4) {
+        const float16x4_t h = vcvt_f16_f32(vld1q_f32(in + i));
+        vst1_u16(reinterpret_cast<std::uint16_t*>(out + i), vreinterpret_u16_f16(h));
+    }
+#endif
+    CT_VECTORIZE
+    for (; i < n; ++i) out[i] = f16::from_bits(f16_from_f32(in[i]));
+}
+
+inline void f16_decode(const f16* CT_RESTRICT in, float* CT_RESTRICT out, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) {
+        const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm512_storeu_ps(out + i, _mm512_cvtph_ps(h));
+    }
+#elif CT_HALF_F16C
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#elif CT_HALF_NEON
+    for (; i + 4 <= n; i += 4) {
+        const uint16x4_t h = vld1_u16(reinterpret_cast<const std::uint16_t*>(in + i));
+        vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(h)));
+    }
+#endif
+    CT_VECTORIZE
+    for (; i < n; ++i) out[i] = f16_to_f32(in[i].bits());
+}
+
+//NOTE: No hardware path for bf16: the AVX512-BF16 instruction flushes subnormals, and the
+// integer rounding below vectorizes to a handful of shifts and adds anyway
+inline void bf16_encode(const float* CT_RESTRICT in, bf16* CT_RESTRICT out, std::size_t n) noexcept {
+    CT_VECTORIZE
+    for (std::size_t i = 0; i < n; ++i) out[i] = bf16::from_bits(bf16_from_f32(in[i]));
+}
+
+inline void bf16_decode(const bf16* CT_RESTRICT in, float* CT_RESTRICT out, std::size_t n) noexcept {
+    CT_VECTORIZE
+    for (std::size_t i = 0; i < n; ++i) out[i] = bf16_to_f32(in[i].bits());
+}
+
+} // namespace detail
+
+// Bulk conversion between float arrays and 16-bit storage; in and out must have the same
+// size and must not overlap. Large arrays are split over the thread pool.
+inline void convert(std::span<const float> in, std::span<f16> out) {
+    assert(in.size() == out.size());
+    detail::half_batch_for(in.size(), [&](std::size_t b, std::size_t e) {
+        detail::f16_encode(in.data() + b, out.data() + b, e - b);
+    });
+}
+
+inline void convert(std::span<const f16> in, std::span<float> out) {
+    assert(in.size() == out.size());
+    detail::half_batch_for(in.size(), [&](std::size_t b, std::size_t e) {
+        detail::f16_decode(in.data() + b, out.data() + b, e - b);
+    });
+}
+
+inline void convert(std::span<const float> in, std::span<bf16> out) {
+    assert(in.size() == out.size());
+    detail::half_batch_for(in.size(), [&](std::size_t b, std::size_t e) {
+        detail::bf16_encode(in.data() + b, out.data() + b, e - b);
+    });
+}
+
+inline void convert(std::span<const bf16> in, std::span<float> out) {
+    assert(in.size() == out.size());
+    detail::half_batch_for(in.size(), [&](std::size_t b, std::size_t e) {
+        detail::bf16_decode(in.data() + b, out.data() + b, e - b);
+    });
+}
+
+// Attribute buffers: vec<N, float> <-> vec<N, f16 / bf16>, converted as flat scalar arrays.
+// The element types are deduced from the half-precision side.
+template<std::size_t N, storage_float H>
+void convert(std::type_identity_t<std::span<const vec<N, float>>> in, std::span<vec<N, H>> out) {
+    static_assert(sizeof(vec<N, float>) == N * sizeof(float) && sizeof(vec<N, H>) == N * sizeof(H));
+    assert(in.size() == out.size());
+    convert(std::span<const float>(reinterpret_cast<const float*>(in.data()), in.size() * N),
+            std::span<H>(reinterpret_cast<H*>(out.data()), out.size() * N));
+}
+
+template<std::size_t N, storage_float H>
+void convert(std::span<const vec<N, H>> in, std::type_identity_t<std::span<vec<N, float>>> out) {
+    static_assert(sizeof(vec<N, float>) == N * sizeof(float) && sizeof(vec<N, H>) == N * sizeof(H));
+    assert(in.size() == out.size());
+    convert(std::span<const H>(reinterpret_cast<const H*>(in.data()), in.size() * N),
+            std::span<float>(reinterpret_cast<float*>(out.data()), out.size() * N));
+}
+
+} // namespace ct
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "./half.hpp"
+#include <format>
+
+// Printed as the float they hold, with the float format spec
+template<ct::storage_float H>
+struct std::formatter<H> : std::formatter<float> {
+    auto format(H value, std::format_context& ctx) const {
+        return std::formatter<float>::format(static_cast<float>(value), ctx);
+    }
+};
@@ -1,8 +1,25 @@
 #pragma once
 
 #include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
 #include "./constants.hpp"
+
+#include <bit>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
 
 namespace ct {
 
@@ -74,10 +91,377 @@ using std::acos;
 using std::atan;
 using std::atan2;
 using std::exp;
+using std::log;
 using std::pow;
 using std::ceil;
 using std::floor;
 using std::trunc;
 using std::round;
 
+
+// Approximations for call sites that do not need libm precision: ct::sin(x) stays exact,
+// ct::fast::sin(x) is the opt-in. Error bounds are measured over float inputs in the stated
+// ranges; double arguments run the same polynomials in double and land at about the same
+// absolute error. Each kernel is written once against a value type V, a scalar or a pack,
+// so the span overloads run it on whole SIMD registers without branches or libm calls.
+namespace detail {
+
+template<floating_point T>
+struct fast_bits;
+
+template<>
+struct fast_bits<float> {
+    using int_type = std::int32_t;
+    static constexpr int mantissa = 23;
+    static constexpr int_type bias = 127;
+    //NOTE: 1.5 * 2^23; adding it leaves round(t) in the low mantissa bits for |t| < 2^22
+    static constexpr float round_magic = 12582912.0f;
+    static constexpr float exp_lo = -104.0f;
+    static constexpr float exp_hi = 89.0f;
+};
+
+template<>
+struct fast_bits<double> {
+    using int_type = std::int64_t;
+    static constexpr int mantissa = 52;
+    static constexpr int_type bias = 1023;
+    static constexpr double round_magic = 6755399441055744.0;
+    static constexpr double exp_lo = -746.0;
+    static constexpr double exp_hi = 710.0;
+};
+
+template<floating_point T>
+inline constexpr std::size_t fast_width = simd_lanes<T>;
+
+// x = k pi/2 + r with |r| <= pi/4; the quadrant k comes back in the low bits of n.
+// Three-part Cody-Waite, so k * part is exact for |x| < 2^15.
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_reduce_half_pi(const V& x, rebind_lanes_t<V, typename fast_bits<T>::int_type>& n) noexcept {
+    using I = typename fast_bits<T>::int_type;
+    const V big = x * T(0.636619772367581343) + fast_bits<T>::round_magic;
+    n = lane_bit_cast<I>(big);
+    const V k = big - fast_bits<T>::round_magic;
+    return ((x - k * T(1.5703125)) - k * T(4.837512969970703125e-4)) - k * T(7.54978995489188216e-8);
+}
+
+// Minimax sin and cos on [-pi/4, pi/4] (Cephes sinf/cosf), z = r * r
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_sin_poly(const V& r, const V& z) noexcept {
+    return ((z * T(-1.9515295891e-4) + T(8.3321608736e-3)) * z - T(1.6666654611e-1)) * z * r + r;
+}
+
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_cos_poly(const V& z) noexcept {
+    return ((z * T(2.443315711809948e-5) - T(1.388731625493765e-3)) * z + T(4.166664568298827e-2)) * z * z
+           - z * T{0.5} + T{1};
+}
+
+// Flips the sign of v where bit 1 of the quadrant q is set
+template<floating_point T, typename V, typename N>
+[[nodiscard]] CT_FORCE_INLINE V fast_quadrant_sign(const V& v, const N& q) noexcept {
+    using I = typename fast_bits<T>::int_type;
+    return lane_bit_cast<T>(lane_bit_cast<I>(v) ^ ((q & I{2}) << static_cast<int>(sizeof(T) * 8 - 2)));
+}
+
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_sin(const V& x) noexcept {
+    using I = typename fast_bits<T>::int_type;
+    rebind_lanes_t<V, I> n;
+    const V r = fast_reduce_half_pi<T>(x, n);
+    const V z = r * r;
+    const V v = select((n & I{1}) != I{}, fast_cos_poly<T>(z), fast_sin_poly<T>(r, z));
+    return fast_quadrant_sign<T>(v, n);
+}
+
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_cos(const V& x) noexcept {
+    using I = typename fast_bits<T>::int_type;
+    rebind_lanes_t<V, I> n;
+    const V r = fast_reduce_half_pi<T>(x, n);
+    const V z = r * r;
+    const V v = select((n & I{1}) != I{}, fast_sin_poly<T>(r, z), fast_cos_poly<T>(z));
+    return fast_quadrant_sign<T>(v, n + I{1});
+}
+
+template<floating_point T, typename V>
+CT_FORCE_INLINE void fast_sincos(const V& x, V& s, V& c) noexcept {
+    using I = typename fast_bits<T>::int_type;
+    rebind_lanes_t<V, I> n;
+    const V r = fast_reduce_half_pi<T>(x, n);
+    const V z = r * r;
+    const V ps = fast_sin_poly<T>(r, z);
+    const V pc = fast_cos_poly<T>(z);
+    const auto odd = (n & I{1}) != I{};
+    s = fast_quadrant_sign<T>(select(odd, pc, ps), n);
+    c = fast_quadrant_sign<T>(select(odd, ps, pc), n + I{1});
+}
+
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_atan2(const V& y, const V& x) noexcept {
+    using I = typename fast_bits<T>::int_type;
+    const V ax = abs(x);
+    const V ay = abs(y);
+    const V hi = max(ax, ay);
+    const V lo = min(ax, ay);
+    const V a = select(hi > T{}, lo / hi, splat<V>(T{}));
+    const V s = a * a;
+    //NOTE: Minimax atan(a) / a on [0, 1] in a^2
+    V p = s * T(0.00282363896258175373) - T(0.0159569028764963150);
+    p = p * s + T(0.0425049886107444763);
+    p = p * s - T(0.0748900920152664184);
+    p = p * s + T(0.106347933411598206);
+    p = p * s - T(0.142027363181114197);
+    p = p * s + T(0.199926957488059998);
+    p = p * s - T(0.333331018686294556);
+    V r = p * s * a + a;
+    r = select(ay > ax, half_pi<T> - r, r);
+    r = select(lane_bit_cast<I>(x) < I{}, pi<T> - r, r);
+    //NOTE: r is in [0, pi], so copying y's sign bit in is copysign
+    return lane_bit_cast<T>(lane_bit_cast<I>(r) | (lane_bit_cast<I>(y) & std::numeric_limits<I>::min()));
+}
+
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_exp(const V& x) noexcept {
+    using bits = fast_bits<T>;
+    using I = typename bits::int_type;
+    constexpr I magic_bits = std::bit_cast<I>(bits::round_magic);
+
+    const V xc = min(max(x, splat<V>(bits::exp_lo)), splat<V>(bits::exp_hi));
+    const V big = xc * T(1.44269504088896341) + bits::round_magic;
+    const auto n = lane_bit_cast<I>(big) - magic_bits;
+    const V k = big - bits::round_magic;
+    const V r = (xc - k * T(0.693359375)) + k * T(2.12194440e-4);
+    //NOTE: Minimax e^r on [-ln2 / 2, ln2 / 2] (Cephes expf)
+    V p = r * T(1.9875691500e-4) + T(1.3981999507e-3);
+    p = p * r + T(8.3334519073e-3);
+    p = p * r + T(4.1665795894e-2);
+    p = p * r + T(1.6666665459e-1);
+    p = p * r + T(5.0000001201e-1);
+    //NOTE: 2^n as two factors so neither overflows the exponent field near the range ends
+    const auto h = n >> 1;
+    const V a = lane_bit_cast<T>((h + bits::bias) << bits::mantissa);
+    const V b = lane_bit_cast<T>((n - h + bits::bias) << bits::mantissa);
+    const V e = (p * (r * r) + r + T{1}) * a * b;
+    return select(x == x, e, x);
+}
+
+template<floating_point T, typename V>
+[[nodiscard]] CT_FORCE_INLINE V fast_log(const V& x) noexcept {
+    using bits = fast_bits<T>;
+    using I = typename bits::int_type;
+    using VI = rebind_lanes_t<V, I>;
+    constexpr I magic_bits = std::bit_cast<I>(bits::round_magic);
+    constexpr I mantissa_mask = (I{1} << bits::mantissa) - 1;
+
+    //NOTE: Subnormals are scaled by 2^25 into the normal range first
+    const auto sub = x < std::numeric_limits<T>::min();
+    const V xs = select(sub, x * T(33554432.0), x);
+    const VI b = lane_bit_cast<I>(xs);
+    //NOTE: Mantissa into [0.5, 1), exponent to match
+    VI e = ((b >> bits::mantissa) & (2 * bits::bias + 1)) - (bits::bias - 1) - select(sub, splat<VI>(I{25}), splat<VI>(I{}));
+    V m = lane_bit_cast<T>((b & mantissa_mask) | ((bits::bias - 1) << bits::mantissa));
+    const auto low = m < T(0.707106781186547524);
+    e = e - select(low, splat<VI>(I{1}), splat<VI>(I{}));
+    m = select(low, m + m - T{1}, m - T{1});
+
+    const V z = m * m;
+    //NOTE: Minimax log(1 + m) on [sqrt(1/2) - 1, sqrt(2) - 1] (Cephes logf)
+    V p = m * T(7.0376836292e-2) - T(1.1514610310e-1);
+    p = p * m + T(1.1676998740e-1);
+    p = p * m - T(1.2420140846e-1);
+    p = p * m + T(1.4249322787e-1);
+    p = p * m - T(1.6668057665e-1);
+    p = p * m + T(2.0000714765e-1);
+    p = p * m - T(2.4999993993e-1);
+    p = p * m + T(3.3333331174e-1);
+    const V k = lane_bit_cast<T>(e + magic_bits) - bits::round_magic;
+    const V y = p * m * z - k * T(2.12194440e-4) - z * T{0.5};
+    const V r = m + y + k * T(0.693359375);
+
+    const V special = select(x == T{}, splat<V>(-infinity<T>),
+                             select(x == infinity<T>, x, splat<V>(std::numeric_limits<T>::quiet_NaN())));
+    return select((x > T{}) && (x < infinity<T>), r, special);
+}
+
+// Runs a kernel over n values in packs of fast_width, the tail padded with ones
+template<floating_point T, typename Kernel>
+CT_FORCE_INLINE void fast_map(const T* x, T* out, std::size_t n, Kernel kernel) noexcept {
+    constexpr std::size_t W = fast_width<T>;
+    using V = pack<T, W>;
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) kernel(V::load(x + i)).store(out + i);
+    if (i == n) return;
+
+    T tail[W];
+    for (std::size_t l = 0; l < W; ++l) tail[l] = i + l < n ? x[i + l] : T{1};
+    kernel(V::load(tail)).store(tail);
+    for (std::size_t l = 0; i + l < n; ++l) out[i + l] = tail[l];
+}
+
+} // namespace detail
+
+namespace fast {
+
+// 1/sqrt(x) for x > 0: the hardware estimate (12 bits) refined by one Newton step,
+// relative error < 3e-7 for float. Double has no cheap estimate and divides exactly.
+template<floating_point T>
+[[nodiscard]] inline T rsqrt(T x) noexcept {
+    if constexpr (std::is_same_v<T, float>) {
+#if defined(__SSE2__) || defined(_M_X64)
+        const float e = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+        //NOTE: Bit-level estimate is only ~4 bits; two steps bring it to the SSE starting point
+        float e = std::bit_cast<float>(0x5f375a86 - (std::bit_cast<std::int32_t>(x) >> 1));
+        e = e * (1.5f - 0.5f * x * e * e);
+        e = e * (1.5f - 0.5f * x * e * e);
+#endif
+        return e * (1.5f - 0.5f * x * e * e);
+    } else {
+        return T{1} / std::sqrt(x);
+    }
+}
+
+// Absolute error < 1e-7 for |x| <= 8192; range reduction degrades beyond |x| ~ 3e4
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE T sin(T x) noexcept {
+    return detail::fast_sin<T>(x);
+}
+
+// Same bounds as sin()
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE T cos(T x) noexcept {
+    return detail::fast_cos<T>(x);
+}
+
+// {sin(x), cos(x)} sharing one range reduction
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE std::pair<T, T> sincos(T x) noexcept {
+    std::pair<T, T> r;
+    detail::fast_sincos<T>(x, r.first, r.second);
+    return r;
+}
+
+// Absolute error < 3.5e-7 rad over all finite inputs; atan2(0, 0) = 0, signed zeros as std::atan2
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE T atan2(T y, T x) noexcept {
+    return detail::fast_atan2<T>(y, x);
+}
+
+// Relative error < 1e-7 for x in [-87, 88]; saturates to 0 and +inf outside the float range.
+// NaN propagates.
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE T exp(T x) noexcept {
+    return detail::fast_exp<T>(x);
+}
+
+// Absolute error < 5e-8 for x in [0.5, 2], relative error < 1e-7 elsewhere; subnormals are
+// handled, log(0) = -inf, negative and NaN inputs give NaN
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE T log(T x) noexcept {
+    return detail::fast_log<T>(x);
+}
+
+// Element-wise over spans; out may alias x. Callers spell the type, e.g. fast::sin<float>(in, out).
+#define CT_FAST_UNARY_BATCH(fn)                                                                   \
+    template<floating_point T>                                                                    \
+    void fn(std::span<const T> x, std::span<T> out) noexcept {                                    \
+        assert(out.size() >= x.size());                                                           \
+        detail::fast_map(x.data(), out.data(), x.size(), [](const auto& v) noexcept {             \
+            return detail::fast_##fn<T>(v);                                                       \
+        });                                                                                       \
+    }
+
+CT_FAST_UNARY_BATCH(sin)
+CT_FAST_UNARY_BATCH(cos)
+CT_FAST_UNARY_BATCH(exp)
+CT_FAST_UNARY_BATCH(log)
+
+#undef CT_FAST_UNARY_BATCH
+
+template<floating_point T>
+void sincos(std::span<const T> x, std::span<T> s, std::span<T> c) noexcept {
+    assert(s.size() >= x.size() && c.size() >= x.size());
+    constexpr std::size_t W = detail::fast_width<T>;
+    using V = pack<T, W>;
+    const std::size_t n = x.size();
+    std::size_t i = 0;
+    V vs;
+    V vc;
+    for (; i + W <= n; i += W) {
+        detail::fast_sincos<T>(V::load(x.data() + i), vs, vc);
+        vs.store(s.data() + i);
+        vc.store(c.data() + i);
+    }
+    for (; i < n; ++i) detail::fast_sincos<T>(x[i], s[i], c[i]);
+}
+
+template<floating_point T>
+void atan2(std::span<const T> y, std::span<const T> x, std::span<T> out) noexcept {
+    assert(x.size() >= y.size() && out.size() >= y.size());
+    constexpr std::size_t W = detail::fast_width<T>;
+    using V = pack<T, W>;
+    const std::size_t n = y.size();
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) detail::fast_atan2<T>(V::load(y.data() + i), V::load(x.data() + i)).store(out.data() + i);
+    for (; i < n; ++i) out[i] = detail::fast_atan2<T>(y[i], x[i]);
+}
+
+// The scalar estimate is an intrinsic the vectorizer cannot widen, so the batch issues the
+// packed estimate directly
+template<floating_point T>
+void rsqrt(std::span<const T> x, std::span<T> out) noexcept {
+    assert(out.size() >= x.size());
+    const T* src = x.data();
+    T* dst = out.data();
+    const std::size_t n = x.size();
+    std::size_t i = 0;
+    if constexpr (std::is_same_v<T, float>) {
+#if defined(__AVX__)
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 three_halves = _mm256_set1_ps(1.5f);
+        for (; i + 8 <= n; i += 8) {
+            const __m256 v = _mm256_loadu_ps(src + i);
+            const __m256 e = _mm256_rsqrt_ps(v);
+            const __m256 t = _mm256_mul_ps(_mm256_mul_ps(half, v), _mm256_mul_ps(e, e));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(e, _mm256_sub_ps(three_halves, t)));
+        }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 half4 = _mm_set1_ps(0.5f);
+        const __m128 three_halves4 = _mm_set1_ps(1.5f);
+        for (; i + 4 <= n; i += 4) {
+            const __m128 v = _mm_loadu_ps(src + i);
+            const __m128 e = _mm_rsqrt_ps(v);
+            const __m128 t = _mm_mul_ps(_mm_mul_ps(half4, v), _mm_mul_ps(e, e));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(e, _mm_sub_ps(three_halves4, t)));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 4 <= n; i += 4) {
+            const float32x4_t v = vld1q_f32(src + i);
+            float32x4_t e = vrsqrteq_f32(v);
+            //NOTE: vrsqrts computes (3 - a b) / 2, i.e. the Newton factor
+            e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+            e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+            vst1q_f32(dst + i, e);
+        }
+#endif
+    } else {
+#if defined(__AVX__)
+        const __m256d one = _mm256_set1_pd(1.0);
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_loadu_pd(src + i))));
+        }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128d one2 = _mm_set1_pd(1.0);
+        for (; i + 2 <= n; i += 2) {
+            _mm_storeu_pd(dst + i, _mm_div_pd(one2, _mm_sqrt_pd(_mm_loadu_pd(src + i))));
+        }
+#endif
+    }
+    for (; i < n; ++i) dst[i] = rsqrt(src[i]);
+}
+
+} // namespace fast
+
 } // namespace cc
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace ct {
+
+// 16-bit storage scalars. f16 is IEEE binary16 (11-bit significand, range +-65504);
+// bf16 is the top half of a float (8-bit significand, full float range). Both round to
+// nearest even when built from a wider value and convert implicitly to float, so
+// comparisons and mixed expressions happen in float. Arithmetic between two halves
+// rounds once per operation, which is what makes vec<N, f16> usable as a container;
+// anything numerically interesting should convert to vec<N, float> first.
+//
+// Large arrays go through ct::convert (common/convert.hpp), which uses the hardware
+// conversions where the target has them.
+class f16;
+class bf16;
+
+template<>
+inline constexpr bool is_storage_float<f16> = true;
+template<>
+inline constexpr bool is_storage_float<bf16> = true;
+
+namespace detail {
+
+// float -> binary16, round to nearest even. Written without branches so loops over it
+// vectorize. Overflow saturates to infinity; NaNs come out quiet with the top payload
+// bits kept, as the F16C and NEON instructions do.
+[[nodiscard]] constexpr std::uint16_t f16_from_f32(float value) noexcept {
+    constexpr std::uint32_t f32_inf = 255u << 23;
+    constexpr std::uint32_t f16_overflow = (127u + 16u) << 23;
+    constexpr std::uint32_t f16_normal_min = 113u << 23;
+    //NOTE: 0.5f; adding it lines the f16 subnormal bits up with the float mantissa LSBs
+    constexpr std::uint32_t subnormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    std::uint32_t f = std::bit_cast<std::uint32_t>(value);
+    const std::uint32_t sign = f & 0x8000'0000u;
+    f ^= sign;
+
+    const std::uint32_t special = f > f32_inf ? 0x7e00u | ((f >> 13) & 0x3ffu) : 0x7c00u;
+    const std::uint32_t subnormal =
+        std::bit_cast<std::uint32_t>(std::bit_cast<float>(f) + std::bit_cast<float>(subnormal_magic)) -
+        subnormal_magic;
+    const std::uint32_t mant_odd = (f >> 13) & 1u;
+    const std::uint32_t normal = (f + ((15u - 127u) << 23) + 0xfffu + mant_odd) >> 13;
+
+    const std::uint32_t out = f >= f16_overflow ? special : f < f16_normal_min ? subnormal : normal;
+    return static_cast<std::uint16_t>(out | (sign >> 16));
+}
+
+[[nodiscard]] constexpr float f16_to_f32(std::uint16_t bits) noexcept {
+    constexpr std::uint32_t exp_mask = 0x7c00u << 13;
+    constexpr float subnormal_magic = std::bit_cast<float>(113u << 23);
+
+    const std::uint32_t h = bits;
+    const std::uint32_t shifted = (h & 0x7fffu) << 13;
+    const std::uint32_t exp = shifted & exp_mask;
+    const std::uint32_t rebiased = shifted + ((127u - 15u) << 23);
+
+    const std::uint32_t special = (rebiased + ((128u - 16u) << 23)) | ((h & 0x3ffu) != 0 ? 0x0040'0000u : 0u);
+    const std::uint32_t subnormal =
+        std::bit_cast<std::uint32_t>(std::bit_cast<float>(rebiased + (1u << 23)) - subnormal_magic);
+
+    const std::uint32_t out = exp == exp_mask ? special : exp == 0 ? subnormal : rebiased;
+    return std::bit_cast<float>(out | ((h & 0x8000u) << 16));
+}
+
+// float -> bfloat16, round to nearest even; NaNs are truncated with the quiet bit set so
+// a payload in the low half cannot round them into infinity
+[[nodiscard]] constexpr std::uint16_t bf16_from_f32(float value) noexcept {
+    const std::uint32_t f = std::bit_cast<std::uint32_t>(value);
+    const std::uint32_t rounded = (f + 0x7fffu + ((f >> 16) & 1u)) >> 16;
+    const std::uint32_t nan = (f >> 16) | 0x40u;
+    return static_cast<std::uint16_t>((f & 0x7fff'ffffu) > 0x7f80'0000u ? nan : rounded);
+}
+
+[[nodiscard]] constexpr float bf16_to_f32(std::uint16_t bits) noexcept {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+}
+
+} // namespace detail
+
+class f16 {
+public:
+    constexpr f16() noexcept = default;
+
+    template<arithmetic U>
+    explicit constexpr f16(U value) noexcept : bits_(detail::f16_from_f32(static_cast<float>(value))) {}
+
+    constexpr operator float() const noexcept { return detail::f16_to_f32(bits_); }
+
+    [[nodiscard]] static constexpr f16 from_bits(std::uint16_t bits) noexcept {
+        f16 h;
+        h.bits_ = bits;
+        return h;
+    }
+
+    [[nodiscard]] constexpr std::uint16_t bits() const noexcept { return bits_; }
+
+private:
+    std::uint16_t bits_;
+};
+
+class bf16 {
+public:
+    constexpr bf16() noexcept = default;
+
+    template<arithmetic U>
+    explicit constexpr bf16(U value) noexcept : bits_(detail::bf16_from_f32(static_cast<float>(value))) {}
+
+    constexpr operator float() const noexcept { return detail::bf16_to_f32(bits_); }
+
+    [[nodiscard]] static constexpr bf16 from_bits(std::uint16_t bits) noexcept {
+        bf16 h;
+        h.bits_ = bits;
+        return h;
+    }
+
+    [[nodiscard]] constexpr std::uint16_t bits() const noexcept { return bits_; }
+
+private:
+    std::uint16_t bits_;
+};
+
+static_assert(sizeof(f16) == 2 && alignof(f16) == 2);
+static_assert(sizeof(bf16) == 2 && alignof(bf16) == 2);
+
+//NOTE: Both operands must be the same half type; mixing with float promotes to float instead
+template<storage_float H>
+[[nodiscard]] constexpr H operator+(H a, H b) noexcept { return H(static_cast<float>(a) + static_cast<float>(b)); }
+
+template<storage_float H>
+[[nodiscard]] constexpr H operator-(H a, H b) noexcept { return H(static_cast<float>(a) - static_cast<float>(b)); }
+
+template<storage_float H>
+[[nodiscard]] constexpr H operator*(H a, H b) noexcept { return H(static_cast<float>(a) * static_cast<float>(b)); }
+
+template<storage_float H>
+[[nodiscard]] constexpr H operator/(H a, H b) noexcept { return H(static_cast<float>(a) / static_cast<float>(b)); }
+
+template<storage_float H>
+[[nodiscard]] constexpr H operator-(H a) noexcept { return H::from_bits(static_cast<std::uint16_t>(a.bits() ^ 0x8000u)); }
+
+template<storage_float H>
+constexpr H& operator+=(H& a, H b) noexcept { return a = a + b; }
+
+template<storage_float H>
+constexpr H& operator-=(H& a, H b) noexcept { return a = a - b; }
+
+template<storage_float H>
+constexpr H& operator*=(H& a, H b) noexcept { return a = a * b; }
+
+template<storage_float H>
+constexpr H& operator/=(H& a, H b) noexcept { return a = a / b; }
+
+} // namespace ct
+
+template<>
+class std::numeric_limits<ct::f16> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr bool has_signaling_NaN = true;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr float_round_style round_style = round_to_nearest;
+    static constexpr bool is_iec559 = true;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr int digits = 11;
+    static constexpr int digits10 = 3;
+    static constexpr int max_digits10 = 5;
+    static constexpr int radix = 2;
+    static constexpr int min_exponent = -13;
+    static constexpr int min_exponent10 = -4;
+    static constexpr int max_exponent = 16;
+    static constexpr int max_exponent10 = 4;
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+
+    static constexpr ct::f16 min() noexcept { return ct::f16::from_bits(0x0400); }
+    static constexpr ct::f16 lowest() noexcept { return ct::f16::from_bits(0xfbff); }
+    static constexpr ct::f16 max() noexcept { return ct::f16::from_bits(0x7bff); }
+    static constexpr ct::f16 epsilon() noexcept { return ct::f16::from_bits(0x1400); }
+    static constexpr ct::f16 round_error() noexcept { return ct::f16::from_bits(0x3800); }
+    static constexpr ct::f16 infinity() noexcept { return ct::f16::from_bits(0x7c00); }
+    static constexpr ct::f16 quiet_NaN() noexcept { return ct::f16::from_bits(0x7e00); }
+    static constexpr ct::f16 signaling_NaN() noexcept { return ct::f16::from_bits(0x7d00); }
+    static constexpr ct::f16 denorm_min() noexcept { return ct::f16::from_bits(0x0001); }
+};
+
+template<>
+class std::numeric_limits<ct::bf16> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr bool has_signaling_NaN = true;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr float_round_style round_style = round_to_nearest;
+    static constexpr bool is_iec559 = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr int digits = 8;
+    static constexpr int digits10 = 2;
+    static constexpr int max_digits10 = 4;
+    static constexpr int radix = 2;
+    static constexpr int min_exponent = -125;
+    static constexpr int min_exponent10 = -37;
+    static constexpr int max_exponent = 128;
+    static constexpr int max_exponent10 = 38;
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+
+    static constexpr ct::bf16 min() noexcept { return ct::bf16::from_bits(0x0080); }
+    static constexpr ct::bf16 lowest() noexcept { return ct::bf16::from_bits(0xff7f); }
+    static constexpr ct::bf16 max() noexcept { return ct::bf16::from_bits(0x7f7f); }
+    static constexpr ct::bf16 epsilon() noexcept { return ct::bf16::from_bits(0x3c00); }
+    static constexpr ct::bf16 round_error() noexcept { return ct::bf16::from_bits(0x3f00); }
+    static constexpr ct::bf16 infinity() noexcept { return ct::bf16::from_bits(0x7f80); }
+    static constexpr ct::bf16 quiet_NaN() noexcept { return ct::bf16::from_bits(0x7fc0); }
+    static constexpr ct::bf16 signaling_NaN() noexcept { return ct::bf16::from_bits(0x7fa0); }
+    static constexpr ct::bf16 denorm_min() noexcept { return ct::bf16::from_bits(0x0001); }
+};
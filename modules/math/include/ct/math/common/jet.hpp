@@ -0,0 +1,335 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "./functions.hpp"
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <limits>
+
+namespace ct {
+
+template<floating_point T, std::size_t N>
+requires (N > 0)
+class jet;
+
+template<floating_point T, std::size_t N>
+inline constexpr bool is_dual_number<jet<T, N>> = true;
+
+namespace detail {
+
+// The derivative part is held in whole SIMD registers: N rounded up to a power of two
+// while that is narrower than a register, whole registers beyond. Padding lanes stay
+// zero through every operation and are never read.
+template<floating_point T, std::size_t N>
+struct jet_lanes {
+    static constexpr std::size_t width = std::bit_ceil(N) < simd_lanes<T> ? std::bit_ceil(N) : simd_lanes<T>;
+    static constexpr std::size_t count = (N + width - 1) / width;
+    using chunk = pack<T, width>;
+};
+
+} // namespace detail
+
+// Forward-mode dual number: a value and its derivatives with respect to N variables.
+// Write a function once against a scalar type S, call it with S = jet<double, N> seeded
+// through variable(), and every result carries its exact gradient; one pass instead of
+// the N + 1 evaluations of finite differences. jets work as the element type of vec, mat
+// and quat; comparisons look at the value only.
+template<floating_point T, std::size_t N>
+requires (N > 0)
+class jet {
+    using lanes = detail::jet_lanes<T, N>;
+    using chunk = typename lanes::chunk;
+    static constexpr std::size_t W = lanes::width;
+    static constexpr std::size_t C = lanes::count;
+
+public:
+    using value_type = T;
+    static constexpr std::size_t size = N;
+
+    constexpr jet() noexcept = default;
+
+    // A constant: all derivatives zero
+    template<arithmetic U>
+    requires (!dual_number<U>)
+    explicit constexpr jet(U value) noexcept : a_(static_cast<T>(value)), d_{} {}
+
+    // The i-th variable at value: derivative 1 in slot i
+    [[nodiscard]] static jet variable(T value, std::size_t i) noexcept {
+        jet r(value);
+        r.set_derivative(i, T{1});
+        return r;
+    }
+
+    [[nodiscard]] constexpr T value() const noexcept { return a_; }
+
+    [[nodiscard]] T derivative(std::size_t i) const noexcept {
+        assert(i < N);
+        return d_[i / W][i % W];
+    }
+
+    void set_derivative(std::size_t i, T d) noexcept {
+        assert(i < N);
+        d_[i / W].set(i % W, d);
+    }
+
+    // f(x) from f and f' at value(), e.g. x.chain(std::erf(a), 2 / sqrt(pi) * exp(-a * a))
+    // for a function without an overload here
+    [[nodiscard]] CT_FORCE_INLINE jet chain(T f, T df) const noexcept {
+        jet r;
+        r.a_ = f;
+        for (std::size_t k = 0; k < C; ++k) r.d_[k] = d_[k] * df;
+        return r;
+    }
+
+    // f(x, y) from f and its partial derivatives at (value(), y.value())
+    [[nodiscard]] CT_FORCE_INLINE jet chain(T f, T dfx, const jet& y, T dfy) const noexcept {
+        jet r;
+        r.a_ = f;
+        for (std::size_t k = 0; k < C; ++k) r.d_[k] = d_[k] * dfx + y.d_[k] * dfy;
+        return r;
+    }
+
+    CT_FORCE_INLINE jet& operator+=(const jet& o) noexcept {
+        a_ += o.a_;
+        for (std::size_t k = 0; k < C; ++k) d_[k] += o.d_[k];
+        return *this;
+    }
+
+    CT_FORCE_INLINE jet& operator-=(const jet& o) noexcept {
+        a_ -= o.a_;
+        for (std::size_t k = 0; k < C; ++k) d_[k] -= o.d_[k];
+        return *this;
+    }
+
+    CT_FORCE_INLINE jet& operator*=(const jet& o) noexcept {
+        for (std::size_t k = 0; k < C; ++k) d_[k] = d_[k] * o.a_ + o.d_[k] * a_;
+        a_ *= o.a_;
+        return *this;
+    }
+
+    // (u / v)' = (u' - (u / v) v') / v
+    CT_FORCE_INLINE jet& operator/=(const jet& o) noexcept {
+        const T inv = T{1} / o.a_;
+        const T q = a_ * inv;
+        for (std::size_t k = 0; k < C; ++k) d_[k] = (d_[k] - o.d_[k] * q) * inv;
+        a_ = q;
+        return *this;
+    }
+
+    CT_FORCE_INLINE jet& operator+=(T s) noexcept {
+        a_ += s;
+        return *this;
+    }
+
+    CT_FORCE_INLINE jet& operator-=(T s) noexcept {
+        a_ -= s;
+        return *this;
+    }
+
+    CT_FORCE_INLINE jet& operator*=(T s) noexcept {
+        a_ *= s;
+        for (std::size_t k = 0; k < C; ++k) d_[k] *= s;
+        return *this;
+    }
+
+    CT_FORCE_INLINE jet& operator/=(T s) noexcept { return *this *= T{1} / s; }
+
+    [[nodiscard]] CT_FORCE_INLINE jet operator-() const noexcept {
+        jet r;
+        r.a_ = -a_;
+        for (std::size_t k = 0; k < C; ++k) r.d_[k] = -d_[k];
+        return r;
+    }
+
+    [[nodiscard]] CT_FORCE_INLINE jet operator+() const noexcept { return *this; }
+
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator+(jet a, const jet& b) noexcept { return a += b; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator-(jet a, const jet& b) noexcept { return a -= b; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator*(jet a, const jet& b) noexcept { return a *= b; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator/(jet a, const jet& b) noexcept { return a /= b; }
+
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator+(jet a, T s) noexcept { return a += s; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator-(jet a, T s) noexcept { return a -= s; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator*(jet a, T s) noexcept { return a *= s; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator/(jet a, T s) noexcept { return a /= s; }
+
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator+(T s, jet a) noexcept { return a += s; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator-(T s, const jet& a) noexcept { return -a + s; }
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator*(T s, jet a) noexcept { return a *= s; }
+
+    // (s / v)' = -(s / v) v' / v
+    [[nodiscard]] friend CT_FORCE_INLINE jet operator/(T s, const jet& a) noexcept {
+        const T q = s / a.a_;
+        return a.chain(q, -q / a.a_);
+    }
+
+    [[nodiscard]] friend constexpr bool operator==(const jet& a, const jet& b) noexcept { return a.a_ == b.a_; }
+    [[nodiscard]] friend constexpr bool operator==(const jet& a, T s) noexcept { return a.a_ == s; }
+
+    [[nodiscard]] friend constexpr std::partial_ordering operator<=>(const jet& a, const jet& b) noexcept {
+        return a.a_ <=> b.a_;
+    }
+
+    [[nodiscard]] friend constexpr std::partial_ordering operator<=>(const jet& a, T s) noexcept { return a.a_ <=> s; }
+
+private:
+    T a_;
+    std::array<chunk, C> d_;
+};
+
+// Math functions: the value through the scalar function, the derivatives by the chain rule
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> sqrt(const jet<T, N>& x) noexcept {
+    const T s = std::sqrt(x.value());
+    return x.chain(s, T{1} / (T{2} * s));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> cbrt(const jet<T, N>& x) noexcept {
+    const T s = std::cbrt(x.value());
+    return x.chain(s, T{1} / (T{3} * s * s));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> exp(const jet<T, N>& x) noexcept {
+    const T e = std::exp(x.value());
+    return x.chain(e, e);
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> expm1(const jet<T, N>& x) noexcept {
+    return x.chain(std::expm1(x.value()), std::exp(x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> log(const jet<T, N>& x) noexcept {
+    return x.chain(std::log(x.value()), T{1} / x.value());
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> log1p(const jet<T, N>& x) noexcept {
+    return x.chain(std::log1p(x.value()), T{1} / (T{1} + x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> sin(const jet<T, N>& x) noexcept {
+    return x.chain(std::sin(x.value()), std::cos(x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> cos(const jet<T, N>& x) noexcept {
+    return x.chain(std::cos(x.value()), -std::sin(x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> tan(const jet<T, N>& x) noexcept {
+    const T t = std::tan(x.value());
+    return x.chain(t, T{1} + t * t);
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> asin(const jet<T, N>& x) noexcept {
+    const T a = x.value();
+    return x.chain(std::asin(a), T{1} / std::sqrt(T{1} - a * a));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> acos(const jet<T, N>& x) noexcept {
+    const T a = x.value();
+    return x.chain(std::acos(a), T{-1} / std::sqrt(T{1} - a * a));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> atan(const jet<T, N>& x) noexcept {
+    const T a = x.value();
+    return x.chain(std::atan(a), T{1} / (T{1} + a * a));
+}
+
+// d atan2(y, x) = (x dy - y dx) / (x^2 + y^2)
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> atan2(const jet<T, N>& y, const jet<T, N>& x) noexcept {
+    const T r2 = x.value() * x.value() + y.value() * y.value();
+    return y.chain(std::atan2(y.value(), x.value()), x.value() / r2, x, -y.value() / r2);
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> sinh(const jet<T, N>& x) noexcept {
+    return x.chain(std::sinh(x.value()), std::cosh(x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> cosh(const jet<T, N>& x) noexcept {
+    return x.chain(std::cosh(x.value()), std::sinh(x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> tanh(const jet<T, N>& x) noexcept {
+    const T t = std::tanh(x.value());
+    return x.chain(t, T{1} - t * t);
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> pow(const jet<T, N>& x, T p) noexcept {
+    return x.chain(std::pow(x.value(), p), p * std::pow(x.value(), p - T{1}));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> pow(T b, const jet<T, N>& y) noexcept {
+    const T f = std::pow(b, y.value());
+    return y.chain(f, f * std::log(b));
+}
+
+//NOTE: x must be positive; the derivative in y goes through log(x)
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> pow(const jet<T, N>& x, const jet<T, N>& y) noexcept {
+    const T f = std::pow(x.value(), y.value());
+    return x.chain(f, y.value() * std::pow(x.value(), y.value() - T{1}), y, f * std::log(x.value()));
+}
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> hypot(const jet<T, N>& x, const jet<T, N>& y) noexcept {
+    const T h = std::hypot(x.value(), y.value());
+    return x.chain(h, x.value() / h, y, y.value() / h);
+}
+
+// Piecewise constant: zero derivatives
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> floor(const jet<T, N>& x) noexcept { return jet<T, N>(std::floor(x.value())); }
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline jet<T, N> ceil(const jet<T, N>& x) noexcept { return jet<T, N>(std::ceil(x.value())); }
+
+template<floating_point T, std::size_t N>
+[[nodiscard]] inline bool isfinite(const jet<T, N>& x) noexcept {
+    if (!std::isfinite(x.value())) return false;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (!std::isfinite(x.derivative(i))) return false;
+    }
+    return true;
+}
+
+} // namespace ct
+
+template<ct::floating_point T, std::size_t N>
+class std::numeric_limits<ct::jet<T, N>> : public std::numeric_limits<T> {
+    using base = std::numeric_limits<T>;
+
+public:
+    static constexpr ct::jet<T, N> min() noexcept { return ct::jet<T, N>(base::min()); }
+    static constexpr ct::jet<T, N> lowest() noexcept { return ct::jet<T, N>(base::lowest()); }
+    static constexpr ct::jet<T, N> max() noexcept { return ct::jet<T, N>(base::max()); }
+    static constexpr ct::jet<T, N> epsilon() noexcept { return ct::jet<T, N>(base::epsilon()); }
+    static constexpr ct::jet<T, N> round_error() noexcept { return ct::jet<T, N>(base::round_error()); }
+    static constexpr ct::jet<T, N> infinity() noexcept { return ct::jet<T, N>(base::infinity()); }
+    static constexpr ct::jet<T, N> quiet_NaN() noexcept { return ct::jet<T, N>(base::quiet_NaN()); }
+    static constexpr ct::jet<T, N> signaling_NaN() noexcept { return ct::jet<T, N>(base::signaling_NaN()); }
+    static constexpr ct::jet<T, N> denorm_min() noexcept { return ct::jet<T, N>(base::denorm_min()); }
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace ct {
+
+namespace detail {
+
+// Jacobi rotation (c, s) that zeroes the off-diagonal entry of [[app, apq], [apq, aqq]]
+template<floating_point T>
+[[nodiscard]] inline std::pair<T, T> jacobi_rotation(T app, T aqq, T apq) noexcept {
+    const T theta = (aqq - app) / (T{2} * apq);
+    //NOTE: For huge theta, theta^2 would overflow; t ~ 1 / (2 theta) is exact to rounding there
+    const T t = abs(theta) > T{1} / epsilon<T>
+        ? T{0.5} / theta
+        : (theta >= T{} ? T{1} : T{-1}) / (abs(theta) + sqrt(theta * theta + T{1}));
+    const T c = T{1} / sqrt(t * t + T{1});
+    return {c, t * c};
+}
+
+inline constexpr std::size_t jacobi_max_sweeps = 32;
+
+} // namespace detail
+
+// Eigen decomposition A = V diag(w) V^T of a fixed-size symmetric matrix by cyclic Jacobi
+// sweeps. Accurate to full precision even for tiny eigenvalues, and for the sizes mat
+// is used at (N <= 6 or so) quicker than tridiagonalization plus QL. Eigenvalues are sorted
+// ascending, eigenvectors are the matching columns of V.
+template<std::size_t N, floating_point T>
+class self_adjoint_eigen {
+public:
+    explicit self_adjoint_eigen(const mat<N, N, T>& m) noexcept : v_(mat<N, N, T>::identity()) {
+        mat<N, N, T> a{};
+        T norm{};
+        CT_UNROLL
+        for (std::size_t c = 0; c < N; ++c) {
+            CT_UNROLL
+            for (std::size_t r = 0; r < N; ++r) {
+                //NOTE: Symmetrize from the lower triangle so a slightly asymmetric input is harmless
+                a(r, c) = r >= c ? m(r, c) : m(c, r);
+                norm += a(r, c) * a(r, c);
+            }
+        }
+        const T tol = norm * epsilon<T> * epsilon<T>;
+
+        for (std::size_t sweep = 0; sweep < detail::jacobi_max_sweeps; ++sweep) {
+            T off{};
+            CT_UNROLL
+            for (std::size_t q = 1; q < N; ++q) {
+                CT_UNROLL
+                for (std::size_t p = 0; p < q; ++p) off += a(p, q) * a(p, q);
+            }
+            if (off <= tol) break;
+
+            CT_UNROLL
+            for (std::size_t p = 0; p + 1 < N; ++p) {
+                CT_UNROLL
+                for (std::size_t q = p + 1; q < N; ++q) {
+                    if (a(p, q) == T{}) continue;
+                    const auto [c, s] = detail::jacobi_rotation(a(p, p), a(q, q), a(p, q));
+
+                    CT_UNROLL
+                    for (std::size_t k = 0; k < N; ++k) {
+                        const T akp = a(k, p);
+                        const T akq = a(k, q);
+                        a(k, p) = c * akp - s * akq;
+                        a(k, q) = s * akp + c * akq;
+                    }
+                    CT_UNROLL
+                    for (std::size_t k = 0; k < N; ++k) {
+                        const T apk = a(p, k);
+                        const T aqk = a(q, k);
+                        a(p, k) = c * apk - s * aqk;
+                        a(q, k) = s * apk + c * aqk;
+                    }
+                    a(p, q) = T{};
+                    a(q, p) = T{};
+
+                    CT_UNROLL
+                    for (std::size_t k = 0; k < N; ++k) {
+                        const T vkp = v_(k, p);
+                        const T vkq = v_(k, q);
+                        v_(k, p) = c * vkp - s * vkq;
+                        v_(k, q) = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) w_[i] = a(i, i);
+
+        // Selection sort keeps the column swaps to at most N - 1
+        CT_UNROLL
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            std::size_t best = i;
+            CT_UNROLL
+            for (std::size_t j = i + 1; j < N; ++j) {
+                if (w_[j] < w_[best]) best = j;
+            }
+            if (best == i) continue;
+            std::swap(w_[i], w_[best]);
+            CT_UNROLL
+            for (std::size_t k = 0; k < N; ++k) std::swap(v_(k, i), v_(k, best));
+        }
+    }
+
+    [[nodiscard]] const vec<N, T>& eigenvalues() const noexcept { return w_; }
+    [[nodiscard]] const mat<N, N, T>& eigenvectors() const noexcept { return v_; }
+
+private:
+    vec<N, T> w_{};
+    mat<N, N, T> v_;
+};
+
+} // namespace ct
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace ct {
+
+// Square-root free Cholesky A = L D L^T of a fixed-size symmetric matrix, L unit lower
+// triangular. Only the lower triangle of A is read. Unlike llt it accepts semidefinite and
+// indefinite matrices as long as no leading minor vanishes; there is no pivoting.
+template<std::size_t N, floating_point T>
+class ldlt {
+public:
+    constexpr explicit ldlt(const mat<N, N, T>& m) noexcept : l_(mat<N, N, T>::identity()) {
+        T scale{};
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) scale = max(scale, abs(m(i, i)));
+        const T tol = scale * epsilon<T> * static_cast<T>(N);
+
+        CT_UNROLL
+        for (std::size_t j = 0; j < N; ++j) {
+            //NOTE: work[k] = L(j, k) * D(k), reused by every row below j
+            std::array<T, N> work{};
+            T d = m(j, j);
+            CT_UNROLL
+            for (std::size_t k = 0; k < j; ++k) {
+                work[k] = l_(j, k) * d_[k];
+                d -= l_(j, k) * work[k];
+            }
+            d_[j] = d;
+            if (abs(d) <= tol) {
+                ok_ = false;
+                continue;
+            }
+
+            const T inv = T{1} / d;
+            CT_UNROLL
+            for (std::size_t i = j + 1; i < N; ++i) {
+                T acc = m(i, j);
+                CT_UNROLL
+                for (std::size_t k = 0; k < j; ++k) acc -= l_(i, k) * work[k];
+                l_(i, j) = acc * inv;
+            }
+        }
+    }
+
+    // False when a pivot of D vanished; solve() is then meaningless
+    [[nodiscard]] constexpr bool ok() const noexcept { return ok_; }
+
+    [[nodiscard]] constexpr T det() const noexcept {
+        T r = T{1};
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) r *= d_[i];
+        return r;
+    }
+
+    [[nodiscard]] constexpr bool positive() const noexcept {
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) {
+            if (!(d_[i] > T{})) return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr vec<N, T> solve(const vec<N, T>& b) const noexcept {
+        vec<N, T> x(b);
+        substitute(x.data());
+        return x;
+    }
+
+    template<std::size_t K>
+    [[nodiscard]] constexpr mat<N, K, T> solve(const mat<N, K, T>& b) const noexcept {
+        mat<N, K, T> x(b);
+        CT_UNROLL
+        for (std::size_t k = 0; k < K; ++k) substitute(x.data() + k * N);
+        return x;
+    }
+
+    [[nodiscard]] constexpr const mat<N, N, T>& matrix_l() const noexcept { return l_; }
+
+    [[nodiscard]] constexpr vec<N, T> vector_d() const noexcept {
+        vec<N, T> r{};
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) r[i] = d_[i];
+        return r;
+    }
+
+private:
+    constexpr void substitute(T* x) const noexcept {
+        CT_UNROLL
+        for (std::size_t i = 1; i < N; ++i) {
+            T acc = x[i];
+            CT_UNROLL
+            for (std::size_t j = 0; j < i; ++j) acc -= l_(i, j) * x[j];
+            x[i] = acc;
+        }
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) x[i] /= d_[i];
+        CT_UNROLL
+        for (std::size_t ri = 0; ri < N; ++ri) {
+            const std::size_t i = N - 1 - ri;
+            T acc = x[i];
+            CT_UNROLL
+            for (std::size_t j = i + 1; j < N; ++j) acc -= l_(j, i) * x[j];
+            x[i] = acc;
+        }
+    }
+
+    mat<N, N, T> l_;
+    std::array<T, N> d_{};
+    bool ok_{true};
+};
+
+} // namespace ct
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../common/functions.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace ct {
+
+// Cholesky factorization A = L L^T of a fixed-size symmetric positive definite matrix.
+// Only the lower triangle of A is read. Roughly half the work of lu, and the natural
+// choice for normal equations and covariance matrices.
+template<std::size_t N, floating_point T>
+class llt {
+public:
+    explicit llt(const mat<N, N, T>& m) noexcept {
+        CT_UNROLL
+        for (std::size_t j = 0; j < N; ++j) {
+            T d = m(j, j);
+            CT_UNROLL
+            for (std::size_t k = 0; k < j; ++k) d -= l_(j, k) * l_(j, k);
+            if (!(d > T{})) {
+                ok_ = false;
+                return;
+            }
+            const T ljj = sqrt(d);
+            const T inv = T{1} / ljj;
+            l_(j, j) = ljj;
+
+            CT_UNROLL
+            for (std::size_t i = j + 1; i < N; ++i) {
+                T acc = m(i, j);
+                CT_UNROLL
+                for (std::size_t k = 0; k < j; ++k) acc -= l_(i, k) * l_(j, k);
+                l_(i, j) = acc * inv;
+            }
+        }
+    }
+
+    // False when A is not (numerically) positive definite
+    [[nodiscard]] bool ok() const noexcept { return ok_; }
+
+    [[nodiscard]] T det() const noexcept {
+        T d = T{1};
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) d *= l_(i, i);
+        return d * d;
+    }
+
+    [[nodiscard]] vec<N, T> solve(const vec<N, T>& b) const noexcept {
+        vec<N, T> x(b);
+        substitute(x.data());
+        return x;
+    }
+
+    template<std::size_t K>
+    [[nodiscard]] mat<N, K, T> solve(const mat<N, K, T>& b) const noexcept {
+        mat<N, K, T> x(b);
+        CT_UNROLL
+        for (std::size_t k = 0; k < K; ++k) substitute(x.data() + k * N);
+        return x;
+    }
+
+    [[nodiscard]] mat<N, N, T> inverse() const noexcept {
+        if (!ok_) return mat<N, N, T>::identity();
+        return solve(mat<N, N, T>::identity());
+    }
+
+    [[nodiscard]] const mat<N, N, T>& matrix_l() const noexcept { return l_; }
+
+private:
+    constexpr void substitute(T* x) const noexcept {
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) {
+            T acc = x[i];
+            CT_UNROLL
+            for (std::size_t j = 0; j < i; ++j) acc -= l_(i, j) * x[j];
+            x[i] = acc / l_(i, i);
+        }
+        CT_UNROLL
+        for (std::size_t ri = 0; ri < N; ++ri) {
+            const std::size_t i = N - 1 - ri;
+            T acc = x[i];
+            CT_UNROLL
+            for (std::size_t j = i + 1; j < N; ++j) acc -= l_(j, i) * x[j];
+            x[i] = acc / l_(i, i);
+        }
+    }
+
+    mat<N, N, T> l_{};
+    bool ok_{true};
+};
+
+} // namespace ct
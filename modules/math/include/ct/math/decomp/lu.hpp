@@ -0,0 +1,201 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace ct {
+
+// LU factorization with partial pivoting, P A = L U, of a fixed-size square matrix.
+// L (unit diagonal) and U share one matrix. Every loop has a compile-time trip count and
+// is unrolled, so factor once and reuse it for det(), solve() and inverse().
+template<std::size_t N, floating_point T>
+class lu {
+public:
+    constexpr explicit lu(const mat<N, N, T>& m) noexcept : lu_(m) {
+        T scale{};
+        CT_UNROLL
+        for (std::size_t c = 0; c < N; ++c) {
+            CT_UNROLL
+            for (std::size_t r = 0; r < N; ++r) scale = max(scale, abs(m(r, c)));
+        }
+        //NOTE: Pivots below this are treated as zero; relative so scaled matrices behave alike
+        const T tol = scale * epsilon<T> * static_cast<T>(N);
+
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) perm_[i] = i;
+
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t pivot = i;
+            T maxv = abs(lu_(i, i));
+            CT_UNROLL
+            for (std::size_t r = i + 1; r < N; ++r) {
+                const T v = abs(lu_(r, i));
+                if (v > maxv) {
+                    maxv = v;
+                    pivot = r;
+                }
+            }
+
+            if (maxv <= tol) invertible_ = false;
+            if (maxv == T{}) continue;
+
+            if (pivot != i) {
+                CT_UNROLL
+                for (std::size_t c = 0; c < N; ++c) std::swap(lu_(i, c), lu_(pivot, c));
+                std::swap(perm_[i], perm_[pivot]);
+                sign_ = -sign_;
+            }
+
+            const T inv_piv = T{1} / lu_(i, i);
+            CT_UNROLL
+            for (std::size_t r = i + 1; r < N; ++r) lu_(r, i) *= inv_piv;
+
+            CT_UNROLL
+            for (std::size_t c = i + 1; c < N; ++c) {
+                const T u = lu_(i, c);
+                CT_UNROLL
+                for (std::size_t r = i + 1; r < N; ++r) lu_(r, c) -= lu_(r, i) * u;
+            }
+        }
+    }
+
+    // False when a pivot vanished relative to the largest entry; solve() and inverse() are then meaningless
+    [[nodiscard]] constexpr bool ok() const noexcept { return invertible_; }
+
+    [[nodiscard]] constexpr T det() const noexcept {
+        T d = static_cast<T>(sign_);
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) d *= lu_(i, i);
+        return d;
+    }
+
+    [[nodiscard]] constexpr vec<N, T> solve(const vec<N, T>& b) const noexcept {
+        vec<N, T> x{};
+        CT_UNROLL
+        for (std::size_t i = 0; i < N; ++i) x[i] = b[perm_[i]];
+        substitute(x.data());
+        return x;
+    }
+
+    template<std::size_t K>
+    [[nodiscard]] constexpr mat<N, K, T> solve(const mat<N, K, T>& b) const noexcept {
+        mat<N, K, T> x{};
+        CT_UNROLL
+        for (std::size_t k = 0; k < K; ++k) {
+            std::array<T, N> col{};
+            CT_UNROLL
+            for (std::size_t i = 0; i < N; ++i) col[i] = b(perm_[i], k);
+            substitute(col.data());
+            CT_UNROLL
+            for (std::size_t i = 0; i < N; ++i) x(i, k) = col[i];
+        }
+        return x;
+    }
+
+    // Identity when the matrix is singular, matching mat3::inverse() and mat4::inverse()
+    [[nodiscard]] constexpr mat<N, N, T> inverse() const noexcept {
+        if (!invertible_) return mat<N, N, T>::identity();
+
+        mat<N, N, T> x{};
+        CT_UNROLL
+        for (std::size_t k = 0; k < N; ++k) {
+            std::array<T, N> col{};
+            CT_UNROLL
+            for (std::size_t i = 0; i < N; ++i) col[i] = perm_[i] == k ? T{1} : T{};
+            substitute(col.data());
+            CT_UNROLL
+            for (std::size_t i = 0; i < N; ++i) x(i, k) = col[i];
+        }
+        return x;
+    }
+
+    [[nodiscard]] constexpr const mat<N, N, T>& matrix_lu() const noexcept { return lu_; }
+    [[nodiscard]] constexpr const std::array<std::size_t, N>& permutation() const noexcept { return perm_; }
+
+private:
+    // Forward substitution with unit-diagonal L, then back substitution with U, in place
+    constexpr void substitute(T* x) const noexcept {
+        CT_UNROLL
+        for (std::size_t i = 1; i < N; ++i) {
+            T acc = x[i];
+            CT_UNROLL
+            for (std::size_t j = 0; j < i; ++j) acc -= lu_(i, j) * x[j];
+            x[i] = acc;
+        }
+        CT_UNROLL
+        for (std::size_t ri = 0; ri < N; ++ri) {
+            const std::size_t i = N - 1 - ri;
+            T acc = x[i];
+            CT_UNROLL
+            for (std::size_t j = i + 1; j < N; ++j) acc -= lu_(i, j) * x[j];
+            x[i] = acc / lu_(i, i);
+        }
+    }
+
+    mat<N, N, T> lu_;
+    std::array<std::size_t, N> perm_{};
+    int sign_{1};
+    bool invertible_{true};
+};
+
+namespace detail {
+
+// Fraction-free (Bareiss) elimination: every intermediate is an exact minor, so integer
+// determinants come out exact without a floating-point detour
+template<std::size_t N, integral T>
+[[nodiscard]] constexpr T bareiss_det(const mat<N, N, T>& m) noexcept {
+    mat<N, N, T> a(m);
+    T prev = T{1};
+    int sign = 1;
+
+    for (std::size_t i = 0; i + 1 < N; ++i) {
+        if (a(i, i) == T{}) {
+            std::size_t pivot = i + 1;
+            while (pivot < N && a(pivot, i) == T{}) ++pivot;
+            if (pivot == N) return T{};
+            for (std::size_t c = 0; c < N; ++c) std::swap(a(i, c), a(pivot, c));
+            sign = -sign;
+        }
+        for (std::size_t r = i + 1; r < N; ++r) {
+            for (std::size_t c = i + 1; c < N; ++c) {
+                a(r, c) = (a(r, c) * a(i, i) - a(r, i) * a(i, c)) / prev;
+            }
+        }
+        prev = a(i, i);
+    }
+
+    return sign == 1 ? a(N - 1, N - 1) : static_cast<T>(-a(N - 1, N - 1));
+}
+
+} // namespace detail
+
+template<std::size_t N, arithmetic T>
+[[nodiscard]] constexpr T det(const mat<N, N, T>& m) noexcept {
+    if constexpr (floating_point<T>) {
+        return lu<N, T>(m).det();
+    } else {
+        return detail::bareiss_det(m);
+    }
+}
+
+// Returns identity for a singular matrix; use lu<N, T>::ok() when the caller must know
+template<std::size_t N, floating_point T>
+[[nodiscard]] constexpr mat<N, N, T> inverse(const mat<N, N, T>& m) noexcept {
+    return lu<N, T>(m).inverse();
+}
+
+} // namespace ct
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace ct {
+
+// Householder QR, A = Q R, of a fixed-size Rows x Cols matrix with Rows >= Cols.
+// The reflectors are kept in compact form below the diagonal of R (LAPACK layout), so
+// solve() applies Q^T without ever forming Q. For Rows > Cols it is the least-squares solve.
+template<std::size_t Rows, std::size_t Cols, floating_point T>
+requires (Rows >= Cols)
+class qr {
+public:
+    explicit qr(const mat<Rows, Cols, T>& m) noexcept : qr_(m) {
+        T scale{};
+        CT_UNROLL
+        for (std::size_t c = 0; c < Cols; ++c) {
+            CT_UNROLL
+            for (std::size_t r = 0; r < Rows; ++r) scale = max(scale, abs(m(r, c)));
+        }
+        const T tol = scale * epsilon<T> * static_cast<T>(Rows);
+
+        CT_UNROLL
+        for (std::size_t k = 0; k < Cols; ++k) {
+            T tail{};
+            CT_UNROLL
+            for (std::size_t i = k + 1; i < Rows; ++i) tail += qr_(i, k) * qr_(i, k);
+
+            const T x0 = qr_(k, k);
+            if (tail == T{}) {
+                //NOTE: Column is already reduced; H = I
+                tau_[k] = T{};
+            } else {
+                const T norm = sqrt(x0 * x0 + tail);
+                const T beta = x0 >= T{} ? -norm : norm;
+                tau_[k] = (beta - x0) / beta;
+                const T inv = T{1} / (x0 - beta);
+                CT_UNROLL
+                for (std::size_t i = k + 1; i < Rows; ++i) qr_(i, k) *= inv;
+                qr_(k, k) = beta;
+
+                CT_UNROLL
+                for (std::size_t c = k + 1; c < Cols; ++c) {
+                    T w = qr_(k, c);
+                    CT_UNROLL
+                    for (std::size_t i = k + 1; i < Rows; ++i) w += qr_(i, k) * qr_(i, c);
+                    w *= tau_[k];
+                    qr_(k, c) -= w;
+                    CT_UNROLL
+                    for (std::size_t i = k + 1; i < Rows; ++i) qr_(i, c) -= w * qr_(i, k);
+                }
+            }
+
+            if (abs(qr_(k, k)) <= tol) full_rank_ = false;
+        }
+    }
+
+    // False when R has a (numerically) zero diagonal entry, i.e. A is column rank deficient
+    [[nodiscard]] bool ok() const noexcept { return full_rank_; }
+
+    // Least-squares solution of A x = b (exact when Rows == Cols)
+    [[nodiscard]] vec<Cols, T> solve(const vec<Rows, T>& b) const noexcept {
+        std::array<T, Rows> y{};
+        CT_UNROLL
+        for (std::size_t i = 0; i < Rows; ++i) y[i] = b[i];
+        apply_qt(y.data());
+
+        vec<Cols, T> x{};
+        CT_UNROLL
+        for (std::size_t ri = 0; ri < Cols; ++ri) {
+            const std::size_t i = Cols - 1 - ri;
+            T acc = y[i];
+            CT_UNROLL
+            for (std::size_t j = i + 1; j < Cols; ++j) acc -= qr_(i, j) * x[j];
+            x[i] = acc / qr_(i, i);
+        }
+        return x;
+    }
+
+    // Determinant of a square A from the diagonal of R and the reflector count
+    [[nodiscard]] T det() const noexcept requires (Rows == Cols) {
+        T d = T{1};
+        CT_UNROLL
+        for (std::size_t i = 0; i < Cols; ++i) {
+            d *= qr_(i, i);
+            //NOTE: Each non-trivial reflector has determinant -1
+            if (tau_[i] != T{}) d = -d;
+        }
+        return d;
+    }
+
+    [[nodiscard]] mat<Cols, Cols, T> matrix_r() const noexcept {
+        mat<Cols, Cols, T> r{};
+        CT_UNROLL
+        for (std::size_t c = 0; c < Cols; ++c) {
+            CT_UNROLL
+            for (std::size_t i = 0; i <= c; ++i) r(i, c) = qr_(i, c);
+        }
+        return r;
+    }
+
+    // Thin Q (Rows x Cols) with orthonormal columns
+    [[nodiscard]] mat<Rows, Cols, T> matrix_q() const noexcept {
+        mat<Rows, Cols, T> q{};
+        CT_UNROLL
+        for (std::size_t c = 0; c < Cols; ++c) {
+            std::array<T, Rows> e{};
+            e[c] = T{1};
+            apply_q(e.data());
+            CT_UNROLL
+            for (std::size_t i = 0; i < Rows; ++i) q(i, c) = e[i];
+        }
+        return q;
+    }
+
+private:
+    // y <- H_k y with H_k = I - tau_k v_k v_k^T, v_k = (0.., 1, qr_(k+1.., k))
+    void reflect(std::size_t k, T* y) const noexcept {
+        if (tau_[k] == T{}) return;
+        T w = y[k];
+        for (std::size_t i = k + 1; i < Rows; ++i) w += qr_(i, k) * y[i];
+        w *= tau_[k];
+        y[k] -= w;
+        for (std::size_t i = k + 1; i < Rows; ++i) y[i] -= w * qr_(i, k);
+    }
+
+    void apply_qt(T* y) const noexcept {
+        CT_UNROLL
+        for (std::size_t k = 0; k < Cols; ++k) reflect(k, y);
+    }
+
+    void apply_q(T* y) const noexcept {
+        CT_UNROLL
+        for (std::size_t k = 0; k < Cols; ++k) reflect(Cols - 1 - k, y);
+    }
+
+    mat<Rows, Cols, T> qr_;
+    std::array<T, Cols> tau_{};
+    bool full_rank_{true};
+};
+
+} // namespace ct
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "./eigen.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace ct {
+
+// Thin singular value decomposition A = U diag(s) V^T of a fixed-size Rows x Cols matrix,
+// Rows >= Cols, by one-sided (Hestenes) Jacobi: columns of A are rotated pairwise until
+// orthogonal, so A^T A is never formed and small singular values keep full relative accuracy.
+// Singular values are sorted descending; U is Rows x Cols, V is Cols x Cols.
+template<std::size_t Rows, std::size_t Cols, floating_point T>
+requires (Rows >= Cols)
+class svd {
+public:
+    explicit svd(const mat<Rows, Cols, T>& m) noexcept : u_(m), v_(mat<Cols, Cols, T>::identity()) {
+        for (std::size_t sweep = 0; sweep < detail::jacobi_max_sweeps; ++sweep) {
+            bool rotated = false;
+
+            CT_UNROLL
+            for (std::size_t p = 0; p + 1 < Cols; ++p) {
+                CT_UNROLL
+                for (std::size_t q = p + 1; q < Cols; ++q) {
+                    T alpha{};
+                    T beta{};
+                    T gamma{};
+                    CT_UNROLL
+                    for (std::size_t k = 0; k < Rows; ++k) {
+                        alpha += u_(k, p) * u_(k, p);
+                        beta += u_(k, q) * u_(k, q);
+                        gamma += u_(k, p) * u_(k, q);
+                    }
+                    if (abs(gamma) <= epsilon<T> * sqrt(alpha * beta) || gamma == T{}) continue;
+                    rotated = true;
+
+                    const auto [c, s] = detail::jacobi_rotation(alpha, beta, gamma);
+                    CT_UNROLL
+                    for (std::size_t k = 0; k < Rows; ++k) {
+                        const T ukp = u_(k, p);
+                        const T ukq = u_(k, q);
+                        u_(k, p) = c * ukp - s * ukq;
+                        u_(k, q) = s * ukp + c * ukq;
+                    }
+                    CT_UNROLL
+                    for (std::size_t k = 0; k < Cols; ++k) {
+                        const T vkp = v_(k, p);
+                        const T vkq = v_(k, q);
+                        v_(k, p) = c * vkp - s * vkq;
+                        v_(k, q) = s * vkp + c * vkq;
+                    }
+                }
+            }
+
+            if (!rotated) break;
+        }
+
+        CT_UNROLL
+        for (std::size_t j = 0; j < Cols; ++j) {
+            T n{};
+            CT_UNROLL
+            for (std::size_t k = 0; k < Rows; ++k) n += u_(k, j) * u_(k, j);
+            s_[j] = sqrt(n);
+            //NOTE: The U column of a zero singular value is left zero rather than made up
+            if (s_[j] > T{}) {
+                const T inv = T{1} / s_[j];
+                CT_UNROLL
+                for (std::size_t k = 0; k < Rows; ++k) u_(k, j) *= inv;
+            }
+        }
+
+        CT_UNROLL
+        for (std::size_t i = 0; i + 1 < Cols; ++i) {
+            std::size_t best = i;
+            CT_UNROLL
+            for (std::size_t j = i + 1; j < Cols; ++j) {
+                if (s_[j] > s_[best]) best = j;
+            }
+            if (best == i) continue;
+            std::swap(s_[i], s_[best]);
+            CT_UNROLL
+            for (std::size_t k = 0; k < Rows; ++k) std::swap(u_(k, i), u_(k, best));
+            CT_UNROLL
+            for (std::size_t k = 0; k < Cols; ++k) std::swap(v_(k, i), v_(k, best));
+        }
+    }
+
+    [[nodiscard]] const vec<Cols, T>& singular_values() const noexcept { return s_; }
+    [[nodiscard]] const mat<Rows, Cols, T>& matrix_u() const noexcept { return u_; }
+    [[nodiscard]] const mat<Cols, Cols, T>& matrix_v() const noexcept { return v_; }
+
+    // Number of singular values above tolerance * s_max (default: Rows * eps)
+    [[nodiscard]] std::size_t rank(T tolerance = epsilon<T> * static_cast<T>(Rows)) const noexcept {
+        std::size_t r = 0;
+        CT_UNROLL
+        for (std::size_t i = 0; i < Cols; ++i) {
+            if (s_[i] > tolerance * s_[0]) ++r;
+        }
+        return r;
+    }
+
+    // Minimum-norm least-squares solution, x = V diag(1/s) U^T b, dropping values below rank()
+    [[nodiscard]] vec<Cols, T> solve(const vec<Rows, T>& b,
+                                     T tolerance = epsilon<T> * static_cast<T>(Rows)) const noexcept {
+        vec<Cols, T> x{};
+        CT_UNROLL
+        for (std::size_t j = 0; j < Cols; ++j) {
+            if (!(s_[j] > tolerance * s_[0])) continue;
+            T acc{};
+            CT_UNROLL
+            for (std::size_t k = 0; k < Rows; ++k) acc += u_(k, j) * b[k];
+            acc /= s_[j];
+            CT_UNROLL
+            for (std::size_t i = 0; i < Cols; ++i) x[i] += v_(i, j) * acc;
+        }
+        return x;
+    }
+
+private:
+    mat<Rows, Cols, T> u_;
+    mat<Cols, Cols, T> v_;
+    vec<Cols, T> s_{};
+};
+
+} // namespace ct
+
+// Branch-free specialization for 3x3
+#include "./svd3.hpp" // IWYU pragma: export
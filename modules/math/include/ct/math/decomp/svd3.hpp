@@ -0,0 +1,443 @@
+#pragma once
+
+#include "./svd.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../mat/mat3.hpp"
+#include "../vec/vec3.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+
+namespace ct {
+
+namespace detail {
+
+// 3x3 SVD after McAdams et al., "Computing the Singular Value Decomposition of 3x3 matrices
+// with minimal branching and elementary floating point operations". A fixed number of
+// approximate Jacobi rotations diagonalize A^T A, accumulated as a quaternion so V stays a
+// rotation; columns of A V are sorted by norm and a Givens QR yields U and the diagonal.
+// No data-dependent branches, so V may be T or pack<T, W>.
+
+template<floating_point T>
+inline constexpr int svd3_sweeps = sizeof(T) <= 4 ? 6 : 8;
+
+template<typename V, typename M>
+CT_FORCE_INLINE void cond_swap(const M& c, V& x, V& y) noexcept {
+    const V z = x;
+    x = select(c, y, x);
+    y = select(c, z, y);
+}
+
+// Swap that keeps the determinant: the column moved to the front is negated
+template<typename V, typename M>
+CT_FORCE_INLINE void cond_neg_swap(const M& c, V& x, V& y) noexcept {
+    const V z = -x;
+    x = select(c, y, x);
+    y = select(c, z, y);
+}
+
+// One conjugation S <- Q^T S Q on the (p, q) pair currently in slot (1, 2), then a cyclic
+// relabeling so the next pair lands there. X, Y, Z pick the quaternion axis for this pair.
+template<floating_point T, std::size_t X, std::size_t Y, std::size_t Z, typename V>
+CT_FORCE_INLINE void svd3_jacobi_conjugation(V& s11, V& s21, V& s22, V& s31, V& s32, V& s33, V (&q)[4]) noexcept {
+    //NOTE: 4 gamma^2 with gamma = 3 + 2 sqrt(2); beyond it the half-angle estimate is replaced by pi / 8
+    constexpr T four_gamma_sq = T(5.828427124746190);
+    constexpr T cstar = T(0.9238795325112867);
+    constexpr T sstar = T(0.3826834323650898);
+
+    V ch = T{2} * (s11 - s22);
+    V sh = s21;
+    const auto exact = four_gamma_sq * sh * sh < ch * ch;
+    const V w = T{1} / sqrt(ch * ch + sh * sh);
+    ch = select(exact, w * ch, splat<V>(cstar));
+    sh = select(exact, w * sh, splat<V>(sstar));
+
+    const V a = ch * ch - sh * sh;
+    const V b = T{2} * sh * ch;
+
+    const V t11 = s11;
+    const V t21 = s21;
+    const V t22 = s22;
+    const V t31 = s31;
+    const V t32 = s32;
+    const V t33 = s33;
+
+    s11 = a * (a * t11 + b * t21) + b * (a * t21 + b * t22);
+    s21 = a * (a * t21 - b * t11) + b * (a * t22 - b * t21);
+    s22 = a * (a * t22 - b * t21) - b * (a * t21 - b * t11);
+    s31 = a * t31 + b * t32;
+    s32 = a * t32 - b * t31;
+    s33 = t33;
+
+    const V tx = q[0] * sh;
+    const V ty = q[1] * sh;
+    const V tz = q[2] * sh;
+    const V tmp[3] = {tx, ty, tz};
+    const V shw = sh * q[3];
+    q[0] *= ch;
+    q[1] *= ch;
+    q[2] *= ch;
+    q[3] *= ch;
+    q[Z] += shw;
+    q[3] -= tmp[Z];
+    q[X] += tmp[Y];
+    q[Y] -= tmp[X];
+
+    // Rotate the labels: (1, 2, 3) -> (2, 3, 1)
+    const V n11 = s22;
+    const V n21 = s32;
+    const V n22 = s33;
+    const V n31 = s21;
+    const V n32 = s31;
+    const V n33 = s11;
+    s11 = n11;
+    s21 = n21;
+    s22 = n22;
+    s31 = n31;
+    s32 = n32;
+    s33 = n33;
+}
+
+// Givens rotation (as a half-angle quaternion pair) that annihilates a2 below pivot a1
+template<floating_point T, typename V>
+CT_FORCE_INLINE void svd3_qr_givens(const V& a1, const V& a2, V& ch, V& sh) noexcept {
+    constexpr T eps = epsilon<T> * T{8};
+    const V rho = sqrt(a1 * a1 + a2 * a2);
+    sh = select(rho > eps, a2, splat<V>(T{}));
+    ch = abs(a1) + max(rho, splat<V>(eps));
+    cond_swap(a1 < T{}, sh, ch);
+    const V w = T{1} / sqrt(ch * ch + sh * sh);
+    ch *= w;
+    sh *= w;
+}
+
+// a, u, v are row-major a[r][c]. On return A = U diag(s) V^T with U and V proper rotations,
+// |s0| >= |s1| >= |s2|, and only s2 possibly negative (it carries the sign of det A).
+template<floating_point T, typename V>
+CT_FORCE_INLINE void svd3_kernel(const V (&a)[3][3], V (&u)[3][3], V (&s)[3], V (&v)[3][3]) noexcept {
+    // Lower triangle of A^T A
+    V s11 = a[0][0] * a[0][0] + a[1][0] * a[1][0] + a[2][0] * a[2][0];
+    V s21 = a[0][1] * a[0][0] + a[1][1] * a[1][0] + a[2][1] * a[2][0];
+    V s22 = a[0][1] * a[0][1] + a[1][1] * a[1][1] + a[2][1] * a[2][1];
+    V s31 = a[0][2] * a[0][0] + a[1][2] * a[1][0] + a[2][2] * a[2][0];
+    V s32 = a[0][2] * a[0][1] + a[1][2] * a[1][1] + a[2][2] * a[2][1];
+    V s33 = a[0][2] * a[0][2] + a[1][2] * a[1][2] + a[2][2] * a[2][2];
+
+    V q[4] = {splat<V>(T{}), splat<V>(T{}), splat<V>(T{}), splat<V>(T{1})};
+    CT_UNROLL
+    for (int sweep = 0; sweep < svd3_sweeps<T>; ++sweep) {
+        svd3_jacobi_conjugation<T, 0, 1, 2>(s11, s21, s22, s31, s32, s33, q);
+        svd3_jacobi_conjugation<T, 1, 2, 0>(s11, s21, s22, s31, s32, s33, q);
+        svd3_jacobi_conjugation<T, 2, 0, 1>(s11, s21, s22, s31, s32, s33, q);
+    }
+
+    {
+        const V inv = T{1} / sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        const V x = q[0] * inv;
+        const V y = q[1] * inv;
+        const V z = q[2] * inv;
+        const V w = q[3] * inv;
+        v[0][0] = T{1} - T{2} * (y * y + z * z);
+        v[0][1] = T{2} * (x * y - w * z);
+        v[0][2] = T{2} * (x * z + w * y);
+        v[1][0] = T{2} * (x * y + w * z);
+        v[1][1] = T{1} - T{2} * (x * x + z * z);
+        v[1][2] = T{2} * (y * z - w * x);
+        v[2][0] = T{2} * (x * z - w * y);
+        v[2][1] = T{2} * (y * z + w * x);
+        v[2][2] = T{1} - T{2} * (x * x + y * y);
+    }
+
+    // B = A V
+    V b[3][3];
+    CT_UNROLL
+    for (std::size_t r = 0; r < 3; ++r) {
+        CT_UNROLL
+        for (std::size_t c = 0; c < 3; ++c) {
+            b[r][c] = a[r][0] * v[0][c] + a[r][1] * v[1][c] + a[r][2] * v[2][c];
+        }
+    }
+
+    // Sort columns of B (and V) by decreasing norm
+    V rho1 = b[0][0] * b[0][0] + b[1][0] * b[1][0] + b[2][0] * b[2][0];
+    V rho2 = b[0][1] * b[0][1] + b[1][1] * b[1][1] + b[2][1] * b[2][1];
+    V rho3 = b[0][2] * b[0][2] + b[1][2] * b[1][2] + b[2][2] * b[2][2];
+
+    const auto c12 = rho1 < rho2;
+    CT_UNROLL
+    for (std::size_t r = 0; r < 3; ++r) {
+        cond_neg_swap(c12, b[r][0], b[r][1]);
+        cond_neg_swap(c12, v[r][0], v[r][1]);
+    }
+    cond_swap(c12, rho1, rho2);
+
+    const auto c13 = rho1 < rho3;
+    CT_UNROLL
+    for (std::size_t r = 0; r < 3; ++r) {
+        cond_neg_swap(c13, b[r][0], b[r][2]);
+        cond_neg_swap(c13, v[r][0], v[r][2]);
+    }
+    cond_swap(c13, rho1, rho3);
+
+    const auto c23 = rho2 < rho3;
+    CT_UNROLL
+    for (std::size_t r = 0; r < 3; ++r) {
+        cond_neg_swap(c23, b[r][1], b[r][2]);
+        cond_neg_swap(c23, v[r][1], v[r][2]);
+    }
+
+    // QR of B by three Givens rotations: (1, 2), (1, 3), (2, 3)
+    V ch1, sh1, ch2, sh2, ch3, sh3;
+    svd3_qr_givens<T>(b[0][0], b[1][0], ch1, sh1);
+    V ga = T{1} - T{2} * sh1 * sh1;
+    V gb = T{2} * ch1 * sh1;
+    V r1[3][3];
+    CT_UNROLL
+    for (std::size_t c = 0; c < 3; ++c) {
+        r1[0][c] = ga * b[0][c] + gb * b[1][c];
+        r1[1][c] = ga * b[1][c] - gb * b[0][c];
+        r1[2][c] = b[2][c];
+    }
+
+    svd3_qr_givens<T>(r1[0][0], r1[2][0], ch2, sh2);
+    ga = T{1} - T{2} * sh2 * sh2;
+    gb = T{2} * ch2 * sh2;
+    CT_UNROLL
+    for (std::size_t c = 0; c < 3; ++c) {
+        b[0][c] = ga * r1[0][c] + gb * r1[2][c];
+        b[1][c] = r1[1][c];
+        b[2][c] = ga * r1[2][c] - gb * r1[0][c];
+    }
+
+    svd3_qr_givens<T>(b[1][1], b[2][1], ch3, sh3);
+    ga = T{1} - T{2} * sh3 * sh3;
+    gb = T{2} * ch3 * sh3;
+    s[0] = b[0][0];
+    s[1] = ga * b[1][1] + gb * b[2][1];
+    s[2] = ga * b[2][2] - gb * b[1][2];
+
+    // U = Q1 Q2 Q3 in closed form
+    const V sh12 = sh1 * sh1;
+    const V sh22 = sh2 * sh2;
+    const V sh32 = sh3 * sh3;
+    const V m1 = T{2} * sh12 - T{1};
+    const V m2 = T{2} * sh22 - T{1};
+    const V m3 = T{2} * sh32 - T{1};
+
+    u[0][0] = m1 * m2;
+    u[0][1] = T{4} * ch2 * ch3 * m1 * sh2 * sh3 + T{2} * ch1 * sh1 * m3;
+    u[0][2] = T{4} * ch1 * ch3 * sh1 * sh3 - T{2} * ch2 * m1 * sh2 * m3;
+    u[1][0] = -T{2} * ch1 * sh1 * m2;
+    u[1][1] = T{-8} * ch1 * ch2 * ch3 * sh1 * sh2 * sh3 + m1 * m3;
+    u[1][2] = T{4} * sh1 * (ch3 * sh1 * sh3 + ch1 * ch2 * sh2 * m3) - T{2} * ch3 * sh3;
+    u[2][0] = T{2} * ch2 * sh2;
+    u[2][1] = -T{2} * ch3 * m2 * sh3;
+    u[2][2] = m2 * m3;
+}
+
+} // namespace detail
+
+// Branch-free 3x3 specialization of svd: fixed work per matrix, suited to per-correspondence
+// use (Kabsch alignment, essential matrix decomposition, re-orthonormalizing rotations).
+// matrix_u(), matrix_v() and singular_values() follow the generic contract (s >= 0, sorted
+// descending). rotation_u(), rotation_v() and signed_singular_values() give the variant with
+// det(U) = det(V) = +1, where s2 carries the sign of det(A).
+template<floating_point T>
+class svd<3, 3, T> {
+public:
+    explicit svd(const mat<3, 3, T>& m) noexcept {
+        const T a[3][3] = {{m(0, 0), m(0, 1), m(0, 2)},
+                           {m(1, 0), m(1, 1), m(1, 2)},
+                           {m(2, 0), m(2, 1), m(2, 2)}};
+        T u[3][3];
+        T s[3];
+        T v[3][3];
+        detail::svd3_kernel<T>(a, u, s, v);
+        for (std::size_t r = 0; r < 3; ++r) {
+            for (std::size_t c = 0; c < 3; ++c) {
+                u_(r, c) = u[r][c];
+                v_(r, c) = v[r][c];
+            }
+        }
+        s_ = vec<3, T>(s[0], s[1], s[2]);
+    }
+
+    [[nodiscard]] vec<3, T> singular_values() const noexcept {
+        return vec<3, T>(abs(s_[0]), abs(s_[1]), abs(s_[2]));
+    }
+
+    [[nodiscard]] mat<3, 3, T> matrix_u() const noexcept {
+        mat<3, 3, T> u = u_;
+        for (std::size_t c = 0; c < 3; ++c) {
+            if (s_[c] < T{}) {
+                for (std::size_t r = 0; r < 3; ++r) u(r, c) = -u(r, c);
+            }
+        }
+        return u;
+    }
+
+    [[nodiscard]] const mat<3, 3, T>& matrix_v() const noexcept { return v_; }
+
+    [[nodiscard]] const vec<3, T>& signed_singular_values() const noexcept { return s_; }
+    [[nodiscard]] const mat<3, 3, T>& rotation_u() const noexcept { return u_; }
+    [[nodiscard]] const mat<3, 3, T>& rotation_v() const noexcept { return v_; }
+
+    [[nodiscard]] std::size_t rank(T tolerance = epsilon<T> * T{3}) const noexcept {
+        const vec<3, T> s = singular_values();
+        std::size_t r = 0;
+        for (std::size_t i = 0; i < 3; ++i) {
+            if (s[i] > tolerance * s[0]) ++r;
+        }
+        return r;
+    }
+
+    [[nodiscard]] vec<3, T> solve(const vec<3, T>& b, T tolerance = epsilon<T> * T{3}) const noexcept {
+        vec<3, T> x{};
+        for (std::size_t j = 0; j < 3; ++j) {
+            if (!(abs(s_[j]) > tolerance * abs(s_[0]))) continue;
+            const T acc = (u_(0, j) * b[0] + u_(1, j) * b[1] + u_(2, j) * b[2]) / s_[j];
+            for (std::size_t i = 0; i < 3; ++i) x[i] += v_(i, j) * acc;
+        }
+        return x;
+    }
+
+private:
+    mat<3, 3, T> u_;
+    mat<3, 3, T> v_;
+    vec<3, T> s_;
+};
+
+// A = R S with R the closest rotation to A and S symmetric. For det(A) < 0 the smallest
+// stretch is negative so R stays a proper rotation.
+template<floating_point T>
+struct polar_decomposition {
+    mat<3, 3, T> rotation;
+    mat<3, 3, T> stretch;
+};
+
+namespace detail {
+
+template<floating_point T, typename V>
+CT_FORCE_INLINE void polar3_from_svd(const V (&u)[3][3], const V (&s)[3], const V (&v)[3][3],
+                                     V (&r)[3][3], V (&st)[3][3]) noexcept {
+    CT_UNROLL
+    for (std::size_t i = 0; i < 3; ++i) {
+        CT_UNROLL
+        for (std::size_t j = 0; j < 3; ++j) {
+            r[i][j] = u[i][0] * v[j][0] + u[i][1] * v[j][1] + u[i][2] * v[j][2];
+            st[i][j] = v[i][0] * s[0] * v[j][0] + v[i][1] * s[1] * v[j][1] + v[i][2] * s[2] * v[j][2];
+        }
+    }
+}
+
+} // namespace detail
+
+template<floating_point T>
+[[nodiscard]] polar_decomposition<T> polar(const mat<3, 3, T>& m) noexcept {
+    const T a[3][3] = {{m(0, 0), m(0, 1), m(0, 2)},
+                       {m(1, 0), m(1, 1), m(1, 2)},
+                       {m(2, 0), m(2, 1), m(2, 2)}};
+    T u[3][3];
+    T s[3];
+    T v[3][3];
+    detail::svd3_kernel<T>(a, u, s, v);
+
+    T r[3][3];
+    T st[3][3];
+    detail::polar3_from_svd<T>(u, s, v, r, st);
+
+    polar_decomposition<T> out;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            out.rotation(i, j) = r[i][j];
+            out.stretch(i, j) = st[i][j];
+        }
+    }
+    return out;
+}
+
+// Matrices decomposed per call of the batch kernel
+inline constexpr std::size_t svd3_batch_width = 8;
+
+namespace detail {
+
+template<floating_point T>
+using svd3_lanes = pack<T, svd3_batch_width>;
+
+// Transposes up to svd3_batch_width matrices into lanes; missing lanes get identity
+template<floating_point T>
+CT_FORCE_INLINE void svd3_gather(std::span<const mat<3, 3, T>> a, std::size_t first, std::size_t count,
+                                 svd3_lanes<T> (&out)[3][3]) noexcept {
+    for (std::size_t r = 0; r < 3; ++r) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            for (std::size_t l = 0; l < svd3_batch_width; ++l) {
+                out[r][c].set(l, l < count ? a[first + l](r, c) : (r == c ? T{1} : T{}));
+            }
+        }
+    }
+}
+
+template<floating_point T>
+CT_FORCE_INLINE void svd3_scatter(const svd3_lanes<T> (&in)[3][3], std::span<mat<3, 3, T>> out,
+                                  std::size_t first, std::size_t count) noexcept {
+    for (std::size_t l = 0; l < count; ++l) {
+        for (std::size_t r = 0; r < 3; ++r) {
+            for (std::size_t c = 0; c < 3; ++c) out[first + l](r, c) = in[r][c][l];
+        }
+    }
+}
+
+} // namespace detail
+
+// Decomposes a.size() matrices, svd3_batch_width at a time in SIMD lanes. Outputs are the
+// rotation variant: A = U diag(s) V^T with det(U) = det(V) = +1, s2 signed.
+template<floating_point T>
+void svd_batch(std::span<const mat<3, 3, T>> a, std::span<mat<3, 3, T>> u,
+               std::span<vec<3, T>> s, std::span<mat<3, 3, T>> v) noexcept {
+    assert(u.size() >= a.size() && s.size() >= a.size() && v.size() >= a.size());
+    using lanes = detail::svd3_lanes<T>;
+
+    for (std::size_t first = 0; first < a.size(); first += svd3_batch_width) {
+        const std::size_t count = min(svd3_batch_width, a.size() - first);
+        lanes la[3][3];
+        lanes lu[3][3];
+        lanes ls[3];
+        lanes lv[3][3];
+        detail::svd3_gather(a, first, count, la);
+        detail::svd3_kernel<T>(la, lu, ls, lv);
+        detail::svd3_scatter<T>(lu, u, first, count);
+        detail::svd3_scatter<T>(lv, v, first, count);
+        for (std::size_t l = 0; l < count; ++l) s[first + l] = vec<3, T>(ls[0][l], ls[1][l], ls[2][l]);
+    }
+}
+
+// Batched polar(); stretch may be empty when only the rotations are wanted
+template<floating_point T>
+void polar_batch(std::span<const mat<3, 3, T>> a, std::span<mat<3, 3, T>> rotation,
+                 std::span<mat<3, 3, T>> stretch = {}) noexcept {
+    assert(rotation.size() >= a.size() && (stretch.empty() || stretch.size() >= a.size()));
+    using lanes = detail::svd3_lanes<T>;
+
+    for (std::size_t first = 0; first < a.size(); first += svd3_batch_width) {
+        const std::size_t count = min(svd3_batch_width, a.size() - first);
+        lanes la[3][3];
+        lanes lu[3][3];
+        lanes ls[3];
+        lanes lv[3][3];
+        detail::svd3_gather(a, first, count, la);
+        detail::svd3_kernel<T>(la, lu, ls, lv);
+
+        lanes lr[3][3];
+        lanes lst[3][3];
+        detail::polar3_from_svd<T>(lu, ls, lv, lr, lst);
+        detail::svd3_scatter<T>(lr, rotation, first, count);
+        if (!stretch.empty()) detail::svd3_scatter<T>(lst, stretch, first, count);
+    }
+}
+
+} // namespace ct
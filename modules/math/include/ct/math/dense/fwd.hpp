@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+
+namespace ct {
+
+template<arithmetic T>
+class matX;
+
+template<arithmetic T>
+class vecX;
+
+// Non-owning strided views; T may be const-qualified for read-only access
+template<typename T>
+class matX_view;
+
+template<typename T>
+class vecX_view;
+
+} // namespace ct
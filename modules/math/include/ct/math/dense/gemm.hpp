@@ -0,0 +1,273 @@
+#pragma once
+
+#include "./fwd.hpp"
+#include "./view.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/simd.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace ct {
+
+namespace detail {
+
+// Register tile of the micro-kernel: MR rows (two vector registers per column) by NR columns
+template<typename T>
+inline constexpr std::size_t gemm_mr = 2 * simd_lanes<T>;
+template<typename T>
+inline constexpr std::size_t gemm_nr = 6;
+
+// Cache blocking: a KC x NR sliver of B stays in L1, an MC x KC block of A in L2,
+// a KC x NC panel of B in L3
+template<typename T>
+inline constexpr std::size_t gemm_kc = 256;
+template<typename T>
+inline constexpr std::size_t gemm_mc = (128 * 1024 / (gemm_kc<T> * sizeof(T))) / gemm_mr<T> * gemm_mr<T>;
+template<typename T>
+inline constexpr std::size_t gemm_nc = 680 * gemm_nr<T>;
+
+//NOTE: Below this many multiply-adds packing costs more than it saves
+inline constexpr std::size_t gemm_small_work = 32 * 32 * 32;
+//NOTE: Below this many multiply-adds the pool wake-up dominates
+inline constexpr std::size_t parallel_min_work = 64 * 64 * 64;
+
+// Packs an mc x kc block of A into row panels of MR, zero padding the last panel.
+// Layout: panel p holds kc columns of MR contiguous values.
+template<typename T>
+void gemm_pack_a(matX_view<const T> a, std::size_t kc, std::size_t mc, T* CT_RESTRICT out) noexcept {
+    constexpr std::size_t MR = gemm_mr<T>;
+    for (std::size_t ip = 0; ip < mc; ip += MR) {
+        const std::size_t mr = mc - ip < MR ? mc - ip : MR;
+        for (std::size_t p = 0; p < kc; ++p) {
+            std::size_t i = 0;
+            for (; i < mr; ++i) out[i] = a(ip + i, p);
+            for (; i < MR; ++i) out[i] = T{};
+            out += MR;
+        }
+    }
+}
+
+// Packs a kc x nc panel of B into column slivers of NR, zero padding the last sliver
+template<typename T>
+void gemm_pack_b(matX_view<const T> b, std::size_t kc, std::size_t nc, T* CT_RESTRICT out) noexcept {
+    constexpr std::size_t NR = gemm_nr<T>;
+    for (std::size_t jp = 0; jp < nc; jp += NR) {
+        const std::size_t nr = nc - jp < NR ? nc - jp : NR;
+        for (std::size_t p = 0; p < kc; ++p) {
+            std::size_t j = 0;
+            for (; j < nr; ++j) out[j] = b(p, jp + j);
+            for (; j < NR; ++j) out[j] = T{};
+            out += NR;
+        }
+    }
+}
+
+// acc = A_panel * B_sliver over kc; the MR loop maps onto vector registers
+template<typename T>
+CT_FORCE_INLINE void gemm_micro_kernel(std::size_t kc, const T* CT_RESTRICT a, const T* CT_RESTRICT b,
+                                       T (&acc)[gemm_nr<T>][gemm_mr<T>]) noexcept {
+    constexpr std::size_t MR = gemm_mr<T>;
+    constexpr std::size_t NR = gemm_nr<T>;
+    for (std::size_t j = 0; j < NR; ++j) {
+        CT_VECTORIZE
+        for (std::size_t i = 0; i < MR; ++i) acc[j][i] = T{};
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        for (std::size_t j = 0; j < NR; ++j) {
+            const T bj = b[j];
+            CT_VECTORIZE
+            for (std::size_t i = 0; i < MR; ++i) acc[j][i] += a[i] * bj;
+        }
+        a += MR;
+        b += NR;
+    }
+}
+
+template<typename T>
+void gemm_macro_kernel(T alpha, const T* ap, const T* bp, std::size_t mc, std::size_t nc,
+                       std::size_t kc, matX_view<T> c) noexcept {
+    constexpr std::size_t MR = gemm_mr<T>;
+    constexpr std::size_t NR = gemm_nr<T>;
+    alignas(cache_line) T acc[NR][MR];
+
+    for (std::size_t jr = 0; jr < nc; jr += NR) {
+        const std::size_t nr = nc - jr < NR ? nc - jr : NR;
+        const T* b = bp + jr * kc;
+        for (std::size_t ir = 0; ir < mc; ir += MR) {
+            const std::size_t mr = mc - ir < MR ? mc - ir : MR;
+            gemm_micro_kernel<T>(kc, ap + ir * kc, b, acc);
+
+            if (c.row_stride() == 1 && mr == MR) {
+                for (std::size_t j = 0; j < nr; ++j) {
+                    T* CT_RESTRICT dst = &c(ir, jr + j);
+                    CT_VECTORIZE
+                    for (std::size_t i = 0; i < MR; ++i) dst[i] += alpha * acc[j][i];
+                }
+            } else {
+                for (std::size_t j = 0; j < nr; ++j) {
+                    for (std::size_t i = 0; i < mr; ++i) c(ir + i, jr + j) += alpha * acc[j][i];
+                }
+            }
+        }
+    }
+}
+
+// Contiguous dot product with one partial sum per lane so the loop vectorizes without
+// relying on -ffast-math reassociation
+template<typename T>
+[[nodiscard]] T dot_contiguous(const T* CT_RESTRICT a, const T* CT_RESTRICT b, std::size_t n) noexcept {
+    constexpr std::size_t L = simd_lanes<T>;
+    T part[L]{};
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        CT_VECTORIZE
+        for (std::size_t l = 0; l < L; ++l) part[l] += a[i + l] * b[i + l];
+    }
+    T acc{};
+    for (std::size_t l = 0; l < L; ++l) acc += part[l];
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+template<typename T>
+void scale_in_place(matX_view<T> c, T beta) noexcept {
+    if (beta == T{1}) return;
+    for (std::size_t j = 0; j < c.cols(); ++j) {
+        for (std::size_t i = 0; i < c.rows(); ++i) {
+            //NOTE: beta == 0 overwrites so NaN/Inf already in C do not leak into the result
+            c(i, j) = beta == T{} ? T{} : beta * c(i, j);
+        }
+    }
+}
+
+template<typename T>
+void gemm_naive(T alpha, matX_view<const T> a, matX_view<const T> b, matX_view<T> c) noexcept {
+    for (std::size_t j = 0; j < c.cols(); ++j) {
+        for (std::size_t p = 0; p < a.cols(); ++p) {
+            const T bpj = alpha * b(p, j);
+            for (std::size_t i = 0; i < c.rows(); ++i) c(i, j) += a(i, p) * bpj;
+        }
+    }
+}
+
+} // namespace detail
+
+// C = alpha * A * B + beta * C
+// Packed, cache-blocked product with a register-tiled micro-kernel. Row blocks of C are
+// spread over the global thread pool once the product is large enough to amortize it.
+// Any of the views may be strided or transposed.
+template<arithmetic T>
+void gemm(T alpha, std::type_identity_t<matX_view<const T>> a, std::type_identity_t<matX_view<const T>> b,
+          T beta, std::type_identity_t<matX_view<T>> c) {
+    assert(a.rows() == c.rows() && b.cols() == c.cols() && a.cols() == b.rows());
+
+    const std::size_t m = c.rows();
+    const std::size_t n = c.cols();
+    const std::size_t k = a.cols();
+
+    detail::scale_in_place(c, beta);
+    if (m == 0 || n == 0 || k == 0 || alpha == T{}) return;
+
+    if (m * n * k <= detail::gemm_small_work) {
+        detail::gemm_naive(alpha, a, b, c);
+        return;
+    }
+
+    constexpr std::size_t MR = detail::gemm_mr<T>;
+    constexpr std::size_t NR = detail::gemm_nr<T>;
+    constexpr std::size_t MC = detail::gemm_mc<T>;
+    constexpr std::size_t KC = detail::gemm_kc<T>;
+    constexpr std::size_t NC = detail::gemm_nc<T>;
+
+    const bool threaded = m * n * k >= detail::parallel_min_work;
+
+    aligned_vector<T> bpack(KC * ((NC < n ? NC : n) + NR));
+
+    for (std::size_t jc = 0; jc < n; jc += NC) {
+        const std::size_t nc = n - jc < NC ? n - jc : NC;
+        for (std::size_t pc = 0; pc < k; pc += KC) {
+            const std::size_t kc = k - pc < KC ? k - pc : KC;
+
+            detail::gemm_pack_b<T>(b.block(pc, jc, kc, nc), kc, nc, bpack.data());
+
+            auto rows = [&](std::size_t ib, std::size_t ie) {
+                thread_local aligned_vector<T> apack;
+                if (apack.size() < KC * (MC + MR)) apack.resize(KC * (MC + MR));
+
+                for (std::size_t ic = ib; ic < ie; ic += MC) {
+                    const std::size_t mc = ie - ic < MC ? ie - ic : MC;
+                    detail::gemm_pack_a<T>(a.block(ic, pc, mc, kc), kc, mc, apack.data());
+                    detail::gemm_macro_kernel<T>(alpha, apack.data(), bpack.data(), mc, nc, kc,
+                                                 c.block(ic, jc, mc, nc));
+                }
+            };
+
+            if (threaded) {
+                parallel_for(0, m, MC, rows);
+            } else {
+                rows(0, m);
+            }
+        }
+    }
+}
+
+// y = alpha * A * x + beta * y
+template<arithmetic T>
+void gemv(T alpha, std::type_identity_t<matX_view<const T>> a, std::type_identity_t<vecX_view<const T>> x,
+          T beta, std::type_identity_t<vecX_view<T>> y) {
+    assert(a.rows() == y.size() && a.cols() == x.size());
+
+    const std::size_t m = a.rows();
+    const std::size_t n = a.cols();
+
+    for (std::size_t i = 0; i < m; ++i) {
+        y[i] = beta == T{} ? T{} : beta * y[i];
+    }
+    if (m == 0 || n == 0 || alpha == T{}) return;
+
+    const bool threaded = m * n >= detail::parallel_min_work / 16;
+
+    if (a.row_stride() == 1 && y.contiguous()) {
+        // Column-major: accumulate scaled columns into a contiguous slice of y
+        auto rows = [&](std::size_t ib, std::size_t ie) {
+            T* CT_RESTRICT dst = y.data() + ib;
+            const std::size_t len = ie - ib;
+            for (std::size_t j = 0; j < n; ++j) {
+                const T xj = alpha * x[j];
+                const T* CT_RESTRICT src = a.data() + ib + j * a.col_stride();
+                CT_VECTORIZE
+                for (std::size_t i = 0; i < len; ++i) dst[i] += src[i] * xj;
+            }
+        };
+        if (threaded) {
+            parallel_for(0, m, parallel_grain(m, 256), rows);
+        } else {
+            rows(0, m);
+        }
+        return;
+    }
+
+    // Row-major or transposed view: one dot product per row
+    auto rows = [&](std::size_t ib, std::size_t ie) {
+        for (std::size_t i = ib; i < ie; ++i) {
+            T acc{};
+            if (a.col_stride() == 1 && x.contiguous()) {
+                acc = detail::dot_contiguous(a.data() + i * a.row_stride(), x.data(), n);
+            } else {
+                for (std::size_t j = 0; j < n; ++j) acc += a(i, j) * x[j];
+            }
+            y[i] += alpha * acc;
+        }
+    };
+    if (threaded) {
+        parallel_for(0, m, parallel_grain(m, 64), rows);
+    } else {
+        rows(0, m);
+    }
+}
+
+} // namespace ct
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "./fwd.hpp"
+#include "./view.hpp"
+#include "./vecx.hpp"
+#include "./gemm.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/aligned.hpp"
+#include "../common/functions.hpp"
+
+#include <cassert>
+#include <cstddef>
+
+namespace ct {
+
+//NOTE: Column-major storage like the fixed-size mat: element (r, c) at data[c * rows + r]
+template<arithmetic T>
+class matX {
+public:
+    using value_type = T;
+
+    matX() = default;
+
+    matX(std::size_t rows, std::size_t cols, T value = T{})
+        : rows_(rows), cols_(cols), data_(rows * cols, value) {}
+
+    template<std::size_t R, std::size_t C>
+    explicit matX(const mat<R, C, T>& m) : rows_(R), cols_(C), data_(m.data(), m.data() + R * C) {}
+
+    template<typename U>
+    requires std::is_same_v<std::remove_const_t<U>, T>
+    explicit matX(const matX_view<U>& v) : rows_(v.rows()), cols_(v.cols()), data_(v.size()) {
+        view().assign(v);
+    }
+
+    [[nodiscard]] static matX zeros(std::size_t rows, std::size_t cols) { return matX(rows, cols); }
+
+    [[nodiscard]] static matX identity(std::size_t n) {
+        matX r(n, n);
+        for (std::size_t i = 0; i < n; ++i) r(i, i) = T{1};
+        return r;
+    }
+
+    [[nodiscard]] T& operator()(std::size_t r, std::size_t c) noexcept {
+        assert(r < rows_ && c < cols_);
+        return data_[c * rows_ + r];
+    }
+
+    [[nodiscard]] const T& operator()(std::size_t r, std::size_t c) const noexcept {
+        assert(r < rows_ && c < cols_);
+        return data_[c * rows_ + r];
+    }
+
+    [[nodiscard]] T* data() noexcept { return data_.data(); }
+    [[nodiscard]] const T* data() const noexcept { return data_.data(); }
+    [[nodiscard]] std::size_t rows() const noexcept { return rows_; }
+    [[nodiscard]] std::size_t cols() const noexcept { return cols_; }
+    [[nodiscard]] std::size_t size() const noexcept { return data_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return data_.empty(); }
+
+    // Existing contents are not preserved in any meaningful layout
+    void resize(std::size_t rows, std::size_t cols, T value = T{}) {
+        rows_ = rows;
+        cols_ = cols;
+        data_.assign(rows * cols, value);
+    }
+
+    void fill(T value) noexcept { for (auto& v : data_) v = value; }
+    void set_zero() noexcept { fill(T{}); }
+
+    [[nodiscard]] matX_view<T> view() noexcept { return matX_view<T>(data_.data(), rows_, cols_); }
+    [[nodiscard]] matX_view<const T> view() const noexcept { return matX_view<const T>(data_.data(), rows_, cols_); }
+
+    operator matX_view<T>() noexcept { return view(); }
+    operator matX_view<const T>() const noexcept { return view(); }
+
+    [[nodiscard]] matX_view<T> block(std::size_t r, std::size_t c, std::size_t nrows, std::size_t ncols) noexcept {
+        return view().block(r, c, nrows, ncols);
+    }
+
+    [[nodiscard]] matX_view<const T> block(std::size_t r, std::size_t c, std::size_t nrows, std::size_t ncols) const noexcept {
+        return view().block(r, c, nrows, ncols);
+    }
+
+    [[nodiscard]] vecX_view<T> col(std::size_t c) noexcept { return view().col(c); }
+    [[nodiscard]] vecX_view<const T> col(std::size_t c) const noexcept { return view().col(c); }
+    [[nodiscard]] vecX_view<T> row(std::size_t r) noexcept { return view().row(r); }
+    [[nodiscard]] vecX_view<const T> row(std::size_t r) const noexcept { return view().row(r); }
+
+    template<std::size_t R, std::size_t C>
+    [[nodiscard]] mat<R, C, T> fixed(std::size_t r = 0, std::size_t c = 0) const noexcept {
+        return view().template fixed<R, C>(r, c);
+    }
+
+    template<std::size_t R, std::size_t C>
+    void set_block(std::size_t r, std::size_t c, const mat<R, C, T>& m) noexcept {
+        view().assign(m, r, c);
+    }
+
+    matX& operator+=(const matX& o) noexcept {
+        assert(o.rows_ == rows_ && o.cols_ == cols_);
+        //NOTE: Not CT_RESTRICT, o may be *this (m += m); element i only touches element i
+        T* d = data();
+        const T* s = o.data();
+        const std::size_t n = size();
+        CT_VECTORIZE
+        for (std::size_t i = 0; i < n; ++i) d[i] += s[i];
+        return *this;
+    }
+
+    matX& operator-=(const matX& o) noexcept {
+        assert(o.rows_ == rows_ && o.cols_ == cols_);
+        T* d = data();
+        const T* s = o.data();
+        const std::size_t n = size();
+        CT_VECTORIZE
+        for (std::size_t i = 0; i < n; ++i) d[i] -= s[i];
+        return *this;
+    }
+
+    matX& operator*=(T s) noexcept {
+        for (auto& v : data_) v *= s;
+        return *this;
+    }
+
+    matX& operator/=(T s) noexcept {
+        assert(s != T{});
+        for (auto& v : data_) v /= s;
+        return *this;
+    }
+
+    [[nodiscard]] friend matX operator+(matX a, const matX& b) { a += b; return a; }
+    [[nodiscard]] friend matX operator-(matX a, const matX& b) { a -= b; return a; }
+    [[nodiscard]] friend matX operator*(matX a, T s) { a *= s; return a; }
+    [[nodiscard]] friend matX operator*(T s, matX a) { a *= s; return a; }
+    [[nodiscard]] friend matX operator/(matX a, T s) { a /= s; return a; }
+
+    [[nodiscard]] friend matX operator*(const matX& a, const matX& b) {
+        matX r(a.rows_, b.cols_);
+        gemm<T>(T{1}, a.view(), b.view(), T{}, r.view());
+        return r;
+    }
+
+    [[nodiscard]] friend vecX<T> operator*(const matX& a, const vecX<T>& x) {
+        vecX<T> y(a.rows_);
+        gemv<T>(T{1}, a.view(), x.view(), T{}, y.view());
+        return y;
+    }
+
+    [[nodiscard]] matX transpose() const {
+        matX r(cols_, rows_);
+        r.view().assign(view().transpose());
+        return r;
+    }
+
+    [[nodiscard]] friend bool operator==(const matX& a, const matX& b) noexcept {
+        if (a.rows_ != b.rows_ || a.cols_ != b.cols_) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if constexpr (floating_point<T>) {
+                if (!approx_equal(a.data_[i], b.data_[i])) return false;
+            } else {
+                if (a.data_[i] != b.data_[i]) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    std::size_t rows_{0};
+    std::size_t cols_{0};
+    aligned_vector<T> data_;
+};
+
+// A^T * A without forming the transpose, the usual normal-equation product
+template<arithmetic T>
+[[nodiscard]] matX<T> transpose_times_self(const matX<T>& a) {
+    matX<T> r(a.cols(), a.cols());
+    gemm<T>(T{1}, a.view().transpose(), a.view(), T{}, r.view());
+    return r;
+}
+
+} // namespace ct
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "./fwd.hpp"
+#include "./view.hpp"
+#include "./gemm.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/aligned.hpp"
+#include "../common/functions.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+
+namespace ct {
+
+// Heap-allocated vector of runtime size; storage is cache-line aligned and contiguous
+template<arithmetic T>
+class vecX {
+public:
+    using value_type = T;
+
+    vecX() = default;
+
+    explicit vecX(std::size_t n, T value = T{}) : data_(n, value) {}
+
+    vecX(std::initializer_list<T> values) : data_(values.begin(), values.end()) {}
+
+    template<std::size_t N>
+    explicit vecX(const vec<N, T>& v) : data_(v.data(), v.data() + N) {}
+
+    template<typename U>
+    requires std::is_same_v<std::remove_const_t<U>, T>
+    explicit vecX(const vecX_view<U>& v) : data_(v.size()) {
+        view().assign(v);
+    }
+
+    [[nodiscard]] static vecX zeros(std::size_t n) { return vecX(n); }
+
+    [[nodiscard]] T& operator[](std::size_t i) noexcept {
+        assert(i < data_.size());
+        return data_[i];
+    }
+
+    [[nodiscard]] const T& operator[](std::size_t i) const noexcept {
+        assert(i < data_.size());
+        return data_[i];
+    }
+
+    [[nodiscard]] T* data() noexcept { return data_.data(); }
+    [[nodiscard]] const T* data() const noexcept { return data_.data(); }
+    [[nodiscard]] std::size_t size() const noexcept { return data_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return data_.empty(); }
+
+    [[nodiscard]] T* begin() noexcept { return data_.data(); }
+    [[nodiscard]] T* end() noexcept { return data_.data() + data_.size(); }
+    [[nodiscard]] const T* begin() const noexcept { return data_.data(); }
+    [[nodiscard]] const T* end() const noexcept { return data_.data() + data_.size(); }
+
+    void resize(std::size_t n, T value = T{}) { data_.resize(n, value); }
+    void fill(T value) noexcept { for (auto& v : data_) v = value; }
+    void set_zero() noexcept { fill(T{}); }
+
+    [[nodiscard]] vecX_view<T> view() noexcept { return vecX_view<T>(data_.data(), data_.size()); }
+    [[nodiscard]] vecX_view<const T> view() const noexcept { return vecX_view<const T>(data_.data(), data_.size()); }
+
+    operator vecX_view<T>() noexcept { return view(); }
+    operator vecX_view<const T>() const noexcept { return view(); }
+
+    [[nodiscard]] vecX_view<T> segment(std::size_t begin, std::size_t count) noexcept {
+        return view().segment(begin, count);
+    }
+
+    [[nodiscard]] vecX_view<const T> segment(std::size_t begin, std::size_t count) const noexcept {
+        return view().segment(begin, count);
+    }
+
+    template<std::size_t N>
+    [[nodiscard]] vec<N, T> fixed(std::size_t begin = 0) const noexcept { return view().template fixed<N>(begin); }
+
+    vecX& operator+=(const vecX& o) noexcept {
+        assert(o.size() == size());
+        //NOTE: Not CT_RESTRICT, o may be *this (v += v); element i only touches element i
+        T* d = data();
+        const T* s = o.data();
+        const std::size_t n = size();
+        CT_VECTORIZE
+        for (std::size_t i = 0; i < n; ++i) d[i] += s[i];
+        return *this;
+    }
+
+    vecX& operator-=(const vecX& o) noexcept {
+        assert(o.size() == size());
+        T* d = data();
+        const T* s = o.data();
+        const std::size_t n = size();
+        CT_VECTORIZE
+        for (std::size_t i = 0; i < n; ++i) d[i] -= s[i];
+        return *this;
+    }
+
+    vecX& operator*=(T s) noexcept {
+        for (auto& v : data_) v *= s;
+        return *this;
+    }
+
+    vecX& operator/=(T s) noexcept {
+        assert(s != T{});
+        for (auto& v : data_) v /= s;
+        return *this;
+    }
+
+    [[nodiscard]] friend vecX operator+(vecX a, const vecX& b) { a += b; return a; }
+    [[nodiscard]] friend vecX operator-(vecX a, const vecX& b) { a -= b; return a; }
+    [[nodiscard]] friend vecX operator*(vecX v, T s) { v *= s; return v; }
+    [[nodiscard]] friend vecX operator*(T s, vecX v) { v *= s; return v; }
+    [[nodiscard]] friend vecX operator/(vecX v, T s) { v /= s; return v; }
+
+    [[nodiscard]] vecX operator-() const {
+        vecX r(size());
+        for (std::size_t i = 0; i < size(); ++i) r[i] = -data_[i];
+        return r;
+    }
+
+    [[nodiscard]] friend bool operator==(const vecX& a, const vecX& b) noexcept {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if constexpr (floating_point<T>) {
+                if (!approx_equal(a[i], b[i])) return false;
+            } else {
+                if (a[i] != b[i]) return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] T dot(const vecX& o) const noexcept {
+        assert(o.size() == size());
+        return detail::dot_contiguous(data(), o.data(), size());
+    }
+
+    [[nodiscard]] T length_squared() const noexcept { return dot(*this); }
+    [[nodiscard]] T length() const noexcept { return sqrt(length_squared()); }
+
+    [[nodiscard]] vecX normalized() const {
+        const T l = length();
+        if (l == T{}) return vecX(size());
+        return *this / l;
+    }
+
+    vecX& normalize() noexcept {
+        const T l = length();
+        if (l != T{}) *this /= l;
+        return *this;
+    }
+
+private:
+    aligned_vector<T> data_;
+};
+
+template<arithmetic T>
+[[nodiscard]] T dot(const vecX<T>& a, const vecX<T>& b) noexcept {
+    return a.dot(b);
+}
+
+} // namespace ct
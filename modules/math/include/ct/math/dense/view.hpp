@@ -0,0 +1,216 @@
+#pragma once
+
+#include "./fwd.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"     // IWYU pragma: keep
+#include "../mat/mat4.hpp"     // IWYU pragma: keep
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"     // IWYU pragma: keep
+#include "../vec/vec3.hpp"     // IWYU pragma: keep
+#include "../vec/vec4.hpp"     // IWYU pragma: keep
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace ct {
+
+//NOTE: Element (r, c) lives at data[r * row_stride + c * col_stride]. Column-major storage
+// has row_stride == 1 and col_stride == leading dimension; a transposed view swaps the two.
+template<typename T>
+class matX_view {
+public:
+    using value_type = std::remove_const_t<T>;
+    using element_type = T;
+
+    constexpr matX_view() noexcept = default;
+
+    constexpr matX_view(T* data, std::size_t rows, std::size_t cols) noexcept
+        : data_(data), rows_(rows), cols_(cols), rs_(1), cs_(rows) {}
+
+    constexpr matX_view(T* data, std::size_t rows, std::size_t cols,
+                        std::size_t row_stride, std::size_t col_stride) noexcept
+        : data_(data), rows_(rows), cols_(cols), rs_(row_stride), cs_(col_stride) {}
+
+    template<typename U>
+    requires (std::is_const_v<T> && std::is_same_v<std::remove_const_t<T>, U>)
+    constexpr matX_view(const matX_view<U>& other) noexcept
+        : data_(other.data()), rows_(other.rows()), cols_(other.cols()),
+          rs_(other.row_stride()), cs_(other.col_stride()) {}
+
+    [[nodiscard]] constexpr T& operator()(std::size_t r, std::size_t c) const noexcept {
+        assert(r < rows_ && c < cols_);
+        return data_[r * rs_ + c * cs_];
+    }
+
+    [[nodiscard]] constexpr T* data() const noexcept { return data_; }
+    [[nodiscard]] constexpr std::size_t rows() const noexcept { return rows_; }
+    [[nodiscard]] constexpr std::size_t cols() const noexcept { return cols_; }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return rows_ * cols_; }
+    [[nodiscard]] constexpr std::size_t row_stride() const noexcept { return rs_; }
+    [[nodiscard]] constexpr std::size_t col_stride() const noexcept { return cs_; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return rows_ == 0 || cols_ == 0; }
+
+    [[nodiscard]] constexpr matX_view block(std::size_t r, std::size_t c,
+                                            std::size_t nrows, std::size_t ncols) const noexcept {
+        assert(r + nrows <= rows_ && c + ncols <= cols_);
+        return matX_view(data_ + r * rs_ + c * cs_, nrows, ncols, rs_, cs_);
+    }
+
+    [[nodiscard]] constexpr vecX_view<T> col(std::size_t c) const noexcept {
+        assert(c < cols_);
+        return vecX_view<T>(data_ + c * cs_, rows_, rs_);
+    }
+
+    [[nodiscard]] constexpr vecX_view<T> row(std::size_t r) const noexcept {
+        assert(r < rows_);
+        return vecX_view<T>(data_ + r * rs_, cols_, cs_);
+    }
+
+    [[nodiscard]] constexpr matX_view transpose() const noexcept {
+        return matX_view(data_, cols_, rows_, cs_, rs_);
+    }
+
+    // Copies a compile-time sized block out of the view
+    template<std::size_t R, std::size_t C>
+    [[nodiscard]] constexpr mat<R, C, value_type> fixed(std::size_t r = 0, std::size_t c = 0) const noexcept {
+        assert(r + R <= rows_ && c + C <= cols_);
+        mat<R, C, value_type> m{};
+        for (std::size_t j = 0; j < C; ++j) {
+            for (std::size_t i = 0; i < R; ++i) {
+                m(i, j) = (*this)(r + i, c + j);
+            }
+        }
+        return m;
+    }
+
+    template<std::size_t R, std::size_t C>
+    requires (!std::is_const_v<T>)
+    constexpr void assign(const mat<R, C, value_type>& m, std::size_t r = 0, std::size_t c = 0) const noexcept {
+        assert(r + R <= rows_ && c + C <= cols_);
+        for (std::size_t j = 0; j < C; ++j) {
+            for (std::size_t i = 0; i < R; ++i) {
+                (*this)(r + i, c + j) = m(i, j);
+            }
+        }
+    }
+
+    template<typename U>
+    requires (!std::is_const_v<T>)
+    constexpr void assign(const matX_view<U>& other) const noexcept {
+        assert(other.rows() == rows_ && other.cols() == cols_);
+        for (std::size_t j = 0; j < cols_; ++j) {
+            for (std::size_t i = 0; i < rows_; ++i) {
+                (*this)(i, j) = static_cast<value_type>(other(i, j));
+            }
+        }
+    }
+
+    constexpr void fill(value_type value) const noexcept requires (!std::is_const_v<T>) {
+        for (std::size_t j = 0; j < cols_; ++j) {
+            for (std::size_t i = 0; i < rows_; ++i) {
+                (*this)(i, j) = value;
+            }
+        }
+    }
+
+private:
+    T* data_{nullptr};
+    std::size_t rows_{0};
+    std::size_t cols_{0};
+    std::size_t rs_{1};
+    std::size_t cs_{0};
+};
+
+template<typename T>
+class vecX_view {
+public:
+    using value_type = std::remove_const_t<T>;
+    using element_type = T;
+
+    constexpr vecX_view() noexcept = default;
+
+    constexpr vecX_view(T* data, std::size_t size, std::size_t stride = 1) noexcept
+        : data_(data), size_(size), stride_(stride) {}
+
+    template<typename U>
+    requires (std::is_const_v<T> && std::is_same_v<std::remove_const_t<T>, U>)
+    constexpr vecX_view(const vecX_view<U>& other) noexcept
+        : data_(other.data()), size_(other.size()), stride_(other.stride()) {}
+
+    [[nodiscard]] constexpr T& operator[](std::size_t i) const noexcept {
+        assert(i < size_);
+        return data_[i * stride_];
+    }
+
+    [[nodiscard]] constexpr T* data() const noexcept { return data_; }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] constexpr std::size_t stride() const noexcept { return stride_; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] constexpr bool contiguous() const noexcept { return stride_ == 1; }
+
+    [[nodiscard]] constexpr vecX_view segment(std::size_t begin, std::size_t count) const noexcept {
+        assert(begin + count <= size_);
+        return vecX_view(data_ + begin * stride_, count, stride_);
+    }
+
+    // Interprets the elements as a single column
+    [[nodiscard]] constexpr matX_view<T> as_col() const noexcept {
+        return matX_view<T>(data_, size_, 1, stride_, size_ * stride_);
+    }
+
+    template<std::size_t N>
+    [[nodiscard]] constexpr vec<N, value_type> fixed(std::size_t begin = 0) const noexcept {
+        assert(begin + N <= size_);
+        vec<N, value_type> v{};
+        for (std::size_t i = 0; i < N; ++i) v[i] = (*this)[begin + i];
+        return v;
+    }
+
+    template<std::size_t N>
+    requires (!std::is_const_v<T>)
+    constexpr void assign(const vec<N, value_type>& v, std::size_t begin = 0) const noexcept {
+        assert(begin + N <= size_);
+        for (std::size_t i = 0; i < N; ++i) (*this)[begin + i] = v[i];
+    }
+
+    template<typename U>
+    requires (!std::is_const_v<T>)
+    constexpr void assign(const vecX_view<U>& other) const noexcept {
+        assert(other.size() == size_);
+        for (std::size_t i = 0; i < size_; ++i) (*this)[i] = static_cast<value_type>(other[i]);
+    }
+
+    constexpr void fill(value_type value) const noexcept requires (!std::is_const_v<T>) {
+        for (std::size_t i = 0; i < size_; ++i) (*this)[i] = value;
+    }
+
+private:
+    T* data_{nullptr};
+    std::size_t size_{0};
+    std::size_t stride_{1};
+};
+
+// Views over the fixed-size types; both store their elements contiguously (mat column-major)
+template<std::size_t R, std::size_t C, arithmetic T>
+[[nodiscard]] constexpr matX_view<T> view(mat<R, C, T>& m) noexcept {
+    return matX_view<T>(m.data(), R, C);
+}
+
+template<std::size_t R, std::size_t C, arithmetic T>
+[[nodiscard]] constexpr matX_view<const T> view(const mat<R, C, T>& m) noexcept {
+    return matX_view<const T>(m.data(), R, C);
+}
+
+template<std::size_t N, arithmetic T>
+[[nodiscard]] constexpr vecX_view<T> view(vec<N, T>& v) noexcept {
+    return vecX_view<T>(v.data(), N);
+}
+
+template<std::size_t N, arithmetic T>
+[[nodiscard]] constexpr vecX_view<const T> view(const vec<N, T>& v) noexcept {
+    return vecX_view<const T>(v.data(), N);
+}
+
+} // namespace ct
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "./simd.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace ct {
+
+template<typename T, std::size_t Align = cache_line>
+struct aligned_allocator {
+    static_assert(Align >= alignof(T), "alignment must not be weaker than the type's own");
+
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = aligned_allocator<U, Align>; };
+
+    constexpr aligned_allocator() noexcept = default;
+
+    template<typename U>
+    constexpr aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t{Align});
+    }
+
+    template<typename U>
+    [[nodiscard]] friend constexpr bool operator==(const aligned_allocator&, const aligned_allocator<U, Align>&) noexcept {
+        return true;
+    }
+};
+
+template<typename T, std::size_t Align = cache_line>
+using aligned_vector = std::vector<T, aligned_allocator<T, Align>>;
+
+} // namespace ct
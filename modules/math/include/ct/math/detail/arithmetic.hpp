@@ -11,8 +11,30 @@ concept integral = std::integral<T>;
 template<typename T>
 concept floating_point = std::floating_point<T>;
 
+// Class types that store a floating-point value in fewer bits (f16, bf16). They convert
+// to float for any computation and are accepted wherever a scalar is only stored,
+// copied or combined with + - * /
 template<typename T>
-concept arithmetic = integral<T> || floating_point<T>;
+inline constexpr bool is_storage_float = false;
+
+template<typename T>
+concept storage_float = is_storage_float<T>;
+
+// Dual numbers (ct::jet) carry a value and its first derivatives. They are accepted
+// wherever a scalar is stored or combined with + - * /, and bring their own overloads of
+// the math functions, so geometry written against T can be differentiated
+template<typename T>
+inline constexpr bool is_dual_number = false;
+
+template<typename T>
+concept dual_number = is_dual_number<T>;
+
+// Scalars that behave like real numbers under the math functions
+template<typename T>
+concept real = floating_point<T> || dual_number<T>;
+
+template<typename T>
+concept arithmetic = integral<T> || floating_point<T> || storage_float<T> || dual_number<T>;
 
 template<typename T>
 concept signed_arithmetic = arithmetic<T> && std::signed_integral<T>;
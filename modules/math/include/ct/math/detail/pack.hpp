@@ -0,0 +1,496 @@
+#pragma once
+
+#include "./arithmetic.hpp"
+#include "./simd.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+//NOTE: GCC and clang get the lanes as a native vector type. Plain arrays with per-lane loops
+// also vectorize, but at -O3 GCC fully unrolls the short loops into scalar code first.
+#if defined(__GNUC__) || defined(__clang__)
+    #define CT_PACK_NATIVE 1
+#else
+    #define CT_PACK_NATIVE 0
+#endif
+
+// CT_PACK_LANES(stmt) runs stmt once on whole vectors or once per lane i; CT_LANE(x) names
+// lane i of x in the second case
+#if CT_PACK_NATIVE
+    #define CT_LANE(x) (x)
+    #define CT_PACK_LANES(stmt) stmt;
+    #define CT_PACK_COMPARE_LANES(r, a, op, b) r = a op b;
+#else
+    #define CT_LANE(x) (x)[i]
+    #define CT_PACK_LANES(stmt) for (std::size_t i = 0; i < W; ++i) stmt;
+    #define CT_PACK_COMPARE_LANES(r, a, op, b) for (std::size_t i = 0; i < W; ++i) r[i] = a[i] op b[i] ? -1 : 0;
+#endif
+
+namespace ct {
+
+namespace detail {
+
+template<typename T>
+using lane_int_t = std::conditional_t<sizeof(T) == 8, std::int64_t,
+                   std::conditional_t<sizeof(T) == 4, std::int32_t,
+                   std::conditional_t<sizeof(T) == 2, std::int16_t, std::int8_t>>>;
+
+#if CT_PACK_NATIVE
+//NOTE: The attribute must sit on a typedef; GCC drops it from a dependent alias template
+template<typename T, std::size_t W>
+struct lanes_of {
+    typedef T type __attribute__((vector_size(sizeof(T) * W)));
+};
+
+template<typename T, std::size_t W>
+using lanes_t = typename lanes_of<T, W>::type;
+#endif
+
+} // namespace detail
+
+// Per-lane boolean, all bits set or clear, as wide as the lane it came from
+template<arithmetic T, std::size_t W>
+struct pack_mask {
+    using lane_type = detail::lane_int_t<T>;
+#if CT_PACK_NATIVE
+    using storage_type = detail::lanes_t<lane_type, W>;
+    storage_type v;
+#else
+    lane_type v[W];
+#endif
+
+    [[nodiscard]] bool operator[](std::size_t i) const noexcept { return v[i] != 0; }
+
+    [[nodiscard]] friend CT_FORCE_INLINE pack_mask operator&&(const pack_mask& a, const pack_mask& b) noexcept {
+        pack_mask r;
+        CT_PACK_LANES(CT_LANE(r.v) = CT_LANE(a.v) & CT_LANE(b.v))
+        return r;
+    }
+
+    [[nodiscard]] friend CT_FORCE_INLINE pack_mask operator||(const pack_mask& a, const pack_mask& b) noexcept {
+        pack_mask r;
+        CT_PACK_LANES(CT_LANE(r.v) = CT_LANE(a.v) | CT_LANE(b.v))
+        return r;
+    }
+
+    [[nodiscard]] CT_FORCE_INLINE pack_mask operator!() const noexcept {
+        pack_mask r;
+        CT_PACK_LANES(CT_LANE(r.v) = ~CT_LANE(v))
+        return r;
+    }
+};
+
+// W independent lanes of T with element-wise operators. A kernel written once against a
+// value type V runs on a single problem with V = T and on W problems at once with
+// V = pack<T, W>. Control flow is expressed with masks and select() instead of branches.
+template<arithmetic T, std::size_t W>
+struct pack {
+    static_assert(W > 0 && (W & (W - 1)) == 0, "lane count must be a power of two");
+
+    using value_type = T;
+    using mask_type = pack_mask<T, W>;
+    static constexpr std::size_t width = W;
+
+#if CT_PACK_NATIVE
+    detail::lanes_t<T, W> v;
+#else
+    T v[W];
+#endif
+
+    [[nodiscard]] static CT_FORCE_INLINE pack broadcast(T s) noexcept {
+        pack r;
+#if CT_PACK_NATIVE
+        r.v = s - detail::lanes_t<T, W>{};
+#else
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = s;
+#endif
+        return r;
+    }
+
+    [[nodiscard]] static CT_FORCE_INLINE pack load(const T* p) noexcept {
+        pack r;
+        std::memcpy(&r.v, p, sizeof(T) * W);
+        return r;
+    }
+
+    CT_FORCE_INLINE void store(T* p) const noexcept {
+        std::memcpy(p, &v, sizeof(T) * W);
+    }
+
+    [[nodiscard]] T operator[](std::size_t i) const noexcept { return v[i]; }
+    void set(std::size_t i, T s) noexcept { v[i] = s; }
+
+#define CT_PACK_ARITH(op)                                                                                        \
+    CT_FORCE_INLINE pack& operator op##=(const pack& o) noexcept {                                               \
+        CT_PACK_LANES(CT_LANE(v) op##= CT_LANE(o.v))                                                             \
+        return *this;                                                                                            \
+    }                                                                                                            \
+    CT_FORCE_INLINE pack& operator op##=(T s) noexcept { return *this op##= broadcast(s); }                      \
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator op(const pack& a, const pack& b) noexcept {               \
+        pack r = a;                                                                                              \
+        return r op##= b;                                                                                        \
+    }                                                                                                            \
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator op(const pack& a, T s) noexcept {                        \
+        pack r = a;                                                                                              \
+        return r op##= broadcast(s);                                                                             \
+    }                                                                                                            \
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator op(T s, const pack& b) noexcept { return broadcast(s) op##= b; }
+
+    CT_PACK_ARITH(+)
+    CT_PACK_ARITH(-)
+    CT_PACK_ARITH(*)
+    CT_PACK_ARITH(/)
+
+#undef CT_PACK_ARITH
+
+    [[nodiscard]] CT_FORCE_INLINE pack operator-() const noexcept {
+        pack r;
+        CT_PACK_LANES(CT_LANE(r.v) = -CT_LANE(v))
+        return r;
+    }
+
+#define CT_PACK_COMPARE(op)                                                                             \
+    [[nodiscard]] friend CT_FORCE_INLINE mask_type operator op(const pack& a, const pack& b) noexcept { \
+        mask_type r;                                                                                    \
+        CT_PACK_COMPARE_LANES(r.v, a.v, op, b.v)                                                        \
+        return r;                                                                                       \
+    }                                                                                                   \
+    [[nodiscard]] friend CT_FORCE_INLINE mask_type operator op(const pack& a, T s) noexcept {           \
+        return a op broadcast(s);                                                                       \
+    }
+
+    CT_PACK_COMPARE(<)
+    CT_PACK_COMPARE(<=)
+    CT_PACK_COMPARE(>)
+    CT_PACK_COMPARE(>=)
+    CT_PACK_COMPARE(==)
+    CT_PACK_COMPARE(!=)
+
+#undef CT_PACK_COMPARE
+
+    // Bitwise operators and shifts on integer lanes, used to take floating-point lanes apart
+#define CT_PACK_BITWISE(op)                                                                                      \
+    CT_FORCE_INLINE pack& operator op##=(const pack& o) noexcept requires integral<T> {                          \
+        CT_PACK_LANES(CT_LANE(v) op##= CT_LANE(o.v))                                                             \
+        return *this;                                                                                            \
+    }                                                                                                            \
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator op(const pack& a, const pack& b) noexcept                 \
+    requires integral<T> {                                                                                       \
+        pack r = a;                                                                                              \
+        return r op##= b;                                                                                        \
+    }                                                                                                            \
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator op(const pack& a, T s) noexcept requires integral<T> {    \
+        pack r = a;                                                                                              \
+        return r op##= broadcast(s);                                                                             \
+    }
+
+    CT_PACK_BITWISE(&)
+    CT_PACK_BITWISE(|)
+    CT_PACK_BITWISE(^)
+
+#undef CT_PACK_BITWISE
+
+    [[nodiscard]] CT_FORCE_INLINE pack operator~() const noexcept requires integral<T> {
+        pack r;
+        CT_PACK_LANES(CT_LANE(r.v) = ~CT_LANE(v))
+        return r;
+    }
+
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator<<(const pack& a, int s) noexcept requires integral<T> {
+        pack r;
+        CT_PACK_LANES(CT_LANE(r.v) = CT_LANE(a.v) << s)
+        return r;
+    }
+
+    [[nodiscard]] friend CT_FORCE_INLINE pack operator>>(const pack& a, int s) noexcept requires integral<T> {
+        pack r;
+        CT_PACK_LANES(CT_LANE(r.v) = CT_LANE(a.v) >> s)
+        return r;
+    }
+};
+
+// The mask may come from lanes of another type of the same width, e.g. integer lanes
+// selecting between float lanes
+template<arithmetic M, arithmetic T, std::size_t W>
+requires (sizeof(M) == sizeof(T))
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> select(const pack_mask<M, W>& m, const pack<T, W>& a, const pack<T, W>& b) noexcept {
+    pack<T, W> r;
+#if CT_PACK_NATIVE
+    using bits = typename pack_mask<M, W>::storage_type;
+    r.v = (detail::lanes_t<T, W>)(((bits)a.v & m.v) | ((bits)b.v & ~m.v));
+#else
+    for (std::size_t i = 0; i < W; ++i) r.v[i] = m.v[i] ? a.v[i] : b.v[i];
+#endif
+    return r;
+}
+
+template<arithmetic T>
+[[nodiscard]] constexpr T select(bool m, T a, T b) noexcept {
+    return m ? a : b;
+}
+
+// Scalar or broadcast constant of the kernel's value type
+template<typename V, arithmetic T>
+[[nodiscard]] CT_FORCE_INLINE V splat(T s) noexcept {
+    if constexpr (std::is_arithmetic_v<V>) {
+        return static_cast<V>(s);
+    } else {
+        return V::broadcast(static_cast<typename V::value_type>(s));
+    }
+}
+
+// The kernel value type with U lanes in place of its own: U for a scalar, pack<U, W> for a pack
+template<typename V, arithmetic U>
+struct rebind_lanes {
+    using type = U;
+};
+
+template<arithmetic T, std::size_t W, arithmetic U>
+struct rebind_lanes<pack<T, W>, U> {
+    using type = pack<U, W>;
+};
+
+template<typename V, arithmetic U>
+using rebind_lanes_t = typename rebind_lanes<V, U>::type;
+
+// std::bit_cast per lane; the scalar overload lets one kernel serve both value types
+template<arithmetic U, arithmetic T, std::size_t W>
+requires (sizeof(U) == sizeof(T))
+[[nodiscard]] CT_FORCE_INLINE pack<U, W> lane_bit_cast(const pack<T, W>& a) noexcept {
+    pack<U, W> r;
+    std::memcpy(&r.v, &a.v, sizeof(T) * W);
+    return r;
+}
+
+template<arithmetic U, arithmetic T>
+requires (sizeof(U) == sizeof(T))
+[[nodiscard]] constexpr U lane_bit_cast(T a) noexcept {
+    return std::bit_cast<U>(a);
+}
+
+template<arithmetic T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE bool any(const pack_mask<T, W>& m) noexcept {
+    for (std::size_t i = 0; i < W; ++i) {
+        if (m.v[i] != 0) return true;
+    }
+    return false;
+}
+
+template<arithmetic T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE bool all(const pack_mask<T, W>& m) noexcept {
+    for (std::size_t i = 0; i < W; ++i) {
+        if (m.v[i] == 0) return false;
+    }
+    return true;
+}
+
+[[nodiscard]] constexpr bool any(bool m) noexcept { return m; }
+[[nodiscard]] constexpr bool all(bool m) noexcept { return m; }
+
+template<arithmetic T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> abs(const pack<T, W>& a) noexcept {
+    return select(a < T{}, -a, a);
+}
+
+template<arithmetic T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> min(const pack<T, W>& a, const pack<T, W>& b) noexcept {
+    return select(b < a, b, a);
+}
+
+template<arithmetic T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> max(const pack<T, W>& a, const pack<T, W>& b) noexcept {
+    return select(a < b, b, a);
+}
+
+// std::sqrt may set errno, which keeps compilers from vectorizing it unless the whole build
+// uses -fno-math-errno; the square root instructions are issued directly instead.
+template<floating_point T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> sqrt(const pack<T, W>& a) noexcept {
+    alignas(64) T x[W];
+    a.store(x);
+    [[maybe_unused]] std::size_t i = 0;
+    if constexpr (std::is_same_v<T, float>) {
+#if defined(__AVX__)
+        for (; i + 8 <= W; i += 8) _mm256_store_ps(x + i, _mm256_sqrt_ps(_mm256_load_ps(x + i)));
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= W; i += 4) _mm_store_ps(x + i, _mm_sqrt_ps(_mm_load_ps(x + i)));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; i + 4 <= W; i += 4) vst1q_f32(x + i, vsqrtq_f32(vld1q_f32(x + i)));
+#endif
+    } else if constexpr (std::is_same_v<T, double>) {
+#if defined(__AVX__)
+        for (; i + 4 <= W; i += 4) _mm256_store_pd(x + i, _mm256_sqrt_pd(_mm256_load_pd(x + i)));
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 2 <= W; i += 2) _mm_store_pd(x + i, _mm_sqrt_pd(_mm_load_pd(x + i)));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; i + 2 <= W; i += 2) vst1q_f64(x + i, vsqrtq_f64(vld1q_f64(x + i)));
+#endif
+    }
+    for (; i < W; ++i) x[i] = std::sqrt(x[i]);
+    return pack<T, W>::load(x);
+}
+
+
+namespace detail {
+
+// Lane l of the result is lane Pick::at(l) of the concatenation (a, b); Pick::at must be
+// constexpr so the native path compiles to fixed shuffles
+template<typename Pick, arithmetic T, std::size_t W, std::size_t... L>
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> permute2(const pack<T, W>& a, const pack<T, W>& b,
+                                                  std::index_sequence<L...>) noexcept {
+    pack<T, W> r;
+#if CT_PACK_NATIVE
+    r.v = __builtin_shufflevector(a.v, b.v, static_cast<int>(Pick::at(L))...);
+#else
+    ((r.v[L] = Pick::at(L) < W ? a.v[Pick::at(L)] : b.v[Pick::at(L) - W]), ...);
+#endif
+    return r;
+}
+
+template<typename Pick, arithmetic T, std::size_t W>
+[[nodiscard]] CT_FORCE_INLINE pack<T, W> permute2(const pack<T, W>& a, const pack<T, W>& b) noexcept {
+    return permute2<Pick>(a, b, std::make_index_sequence<W>{});
+}
+
+// Member C of the triples in three packs: the ones in the first two packs, then the rest
+template<std::size_t W, std::size_t C>
+struct pick3_low {
+    static constexpr std::size_t at(std::size_t l) noexcept { return 3 * l + C < 2 * W ? 3 * l + C : 0; }
+};
+
+template<std::size_t W, std::size_t C>
+struct pick3_high {
+    static constexpr std::size_t at(std::size_t l) noexcept { return 3 * l + C < 2 * W ? l : 3 * l + C - W; }
+};
+
+// Pack J of the interleaved triples: members 0 and 1 first, then member 2
+template<std::size_t W, std::size_t J>
+struct place3_low {
+    static constexpr std::size_t at(std::size_t l) noexcept {
+        const std::size_t f = J * W + l;
+        return f % 3 == 0 ? f / 3 : f % 3 == 1 ? W + f / 3 : 0;
+    }
+};
+
+template<std::size_t W, std::size_t J>
+struct place3_high {
+    static constexpr std::size_t at(std::size_t l) noexcept {
+        const std::size_t f = J * W + l;
+        return f % 3 == 2 ? W + f / 3 : l;
+    }
+};
+
+template<std::size_t Odd>
+struct pick_unzip {
+    static constexpr std::size_t at(std::size_t l) noexcept { return 2 * l + Odd; }
+};
+
+template<std::size_t W, std::size_t High>
+struct pick_zip {
+    static constexpr std::size_t at(std::size_t l) noexcept { return (l % 2 ? W : 0) + High * (W / 2) + l / 2; }
+};
+
+} // namespace detail
+
+// Splits the W triples held consecutively in p0, p1, p2 into one pack per member
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void deinterleave(const pack<T, W>& p0, const pack<T, W>& p1, const pack<T, W>& p2,
+                                  pack<T, W>& a, pack<T, W>& b, pack<T, W>& c) noexcept {
+    a = detail::permute2<detail::pick3_high<W, 0>>(detail::permute2<detail::pick3_low<W, 0>>(p0, p1), p2);
+    b = detail::permute2<detail::pick3_high<W, 1>>(detail::permute2<detail::pick3_low<W, 1>>(p0, p1), p2);
+    c = detail::permute2<detail::pick3_high<W, 2>>(detail::permute2<detail::pick3_low<W, 2>>(p0, p1), p2);
+}
+
+// Inverse of deinterleave()
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void interleave(const pack<T, W>& a, const pack<T, W>& b, const pack<T, W>& c,
+                                pack<T, W>& p0, pack<T, W>& p1, pack<T, W>& p2) noexcept {
+    p0 = detail::permute2<detail::place3_high<W, 0>>(detail::permute2<detail::place3_low<W, 0>>(a, b), c);
+    p1 = detail::permute2<detail::place3_high<W, 1>>(detail::permute2<detail::place3_low<W, 1>>(a, b), c);
+    p2 = detail::permute2<detail::place3_high<W, 2>>(detail::permute2<detail::place3_low<W, 2>>(a, b), c);
+}
+
+// Transposes W consecutive triples at p (an array of vec3, say) into one pack per member
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void load_interleaved(const T* p, pack<T, W>& a, pack<T, W>& b, pack<T, W>& c) noexcept {
+    using P = pack<T, W>;
+    deinterleave(P::load(p), P::load(p + W), P::load(p + 2 * W), a, b, c);
+}
+
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void store_interleaved(T* p, const pack<T, W>& a, const pack<T, W>& b, const pack<T, W>& c) noexcept {
+    pack<T, W> p0, p1, p2;
+    interleave(a, b, c, p0, p1, p2);
+    p0.store(p);
+    p1.store(p + W);
+    p2.store(p + 2 * W);
+}
+
+// Splits lanes of the concatenation (a, b) by parity: even lanes to e, odd lanes to o
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void unzip(const pack<T, W>& a, const pack<T, W>& b, pack<T, W>& e, pack<T, W>& o) noexcept {
+    e = detail::permute2<detail::pick_unzip<0>>(a, b);
+    o = detail::permute2<detail::pick_unzip<1>>(a, b);
+}
+
+// Same for quadruples (an array of quat or vec4), as two rounds of even/odd unzips
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void load_interleaved(const T* p, pack<T, W>& a, pack<T, W>& b, pack<T, W>& c, pack<T, W>& d) noexcept {
+    using P = pack<T, W>;
+    using even = detail::pick_unzip<0>;
+    using odd = detail::pick_unzip<1>;
+    const P p0 = P::load(p);
+    const P p1 = P::load(p + W);
+    const P p2 = P::load(p + 2 * W);
+    const P p3 = P::load(p + 3 * W);
+    const P ac0 = detail::permute2<even>(p0, p1);
+    const P bd0 = detail::permute2<odd>(p0, p1);
+    const P ac1 = detail::permute2<even>(p2, p3);
+    const P bd1 = detail::permute2<odd>(p2, p3);
+    a = detail::permute2<even>(ac0, ac1);
+    c = detail::permute2<odd>(ac0, ac1);
+    b = detail::permute2<even>(bd0, bd1);
+    d = detail::permute2<odd>(bd0, bd1);
+}
+
+template<arithmetic T, std::size_t W>
+CT_FORCE_INLINE void store_interleaved(T* p, const pack<T, W>& a, const pack<T, W>& b, const pack<T, W>& c,
+                                       const pack<T, W>& d) noexcept {
+    if constexpr (W == 1) {
+        a.store(p);
+        b.store(p + 1);
+        c.store(p + 2);
+        d.store(p + 3);
+    } else {
+        using P = pack<T, W>;
+        using lo = detail::pick_zip<W, 0>;
+        using hi = detail::pick_zip<W, 1>;
+        const P ac0 = detail::permute2<lo>(a, c);
+        const P ac1 = detail::permute2<hi>(a, c);
+        const P bd0 = detail::permute2<lo>(b, d);
+        const P bd1 = detail::permute2<hi>(b, d);
+        detail::permute2<lo>(ac0, bd0).store(p);
+        detail::permute2<hi>(ac0, bd0).store(p + W);
+        detail::permute2<lo>(ac1, bd1).store(p + 2 * W);
+        detail::permute2<hi>(ac1, bd1).store(p + 3 * W);
+    }
+}
+
+} // namespace ct
+
+#undef CT_LANE
+#undef CT_PACK_LANES
+#undef CT_PACK_COMPARE_LANES
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+// Kernels in the math module are written as fixed-width lane loops over
+// contiguous data so the compiler emits vector code for whatever ISA the
+// target is built for. These constants pick the lane count and alignment.
+// CT_UNROLL marks loops with small compile-time trip counts (fixed-size
+// factorizations) that should be peeled completely.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #define CT_RESTRICT __restrict
+    #define CT_FORCE_INLINE __forceinline
+    #define CT_VECTORIZE __pragma(loop(ivdep))
+    #define CT_UNROLL
+#elif defined(__clang__)
+    #define CT_RESTRICT __restrict__
+    #define CT_FORCE_INLINE inline __attribute__((always_inline))
+    #define CT_VECTORIZE _Pragma("clang loop vectorize(enable) interleave(enable)")
+    #define CT_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+    #define CT_RESTRICT __restrict__
+    #define CT_FORCE_INLINE inline __attribute__((always_inline))
+    #define CT_VECTORIZE _Pragma("GCC ivdep")
+    #define CT_UNROLL _Pragma("GCC unroll 16")
+#else
+    #define CT_RESTRICT
+    #define CT_FORCE_INLINE inline
+    #define CT_VECTORIZE
+    #define CT_UNROLL
+#endif
+
+namespace ct {
+
+#if defined(__AVX512F__)
+inline constexpr std::size_t simd_bytes = 64;
+#elif defined(__AVX__)
+inline constexpr std::size_t simd_bytes = 32;
+#elif defined(__SSE2__) || defined(__ARM_NEON) || defined(_M_X64)
+inline constexpr std::size_t simd_bytes = 16;
+#else
+inline constexpr std::size_t simd_bytes = 8;
+#endif
+
+//NOTE: Heap buffers are aligned to a cache line regardless of the vector width
+inline constexpr std::size_t cache_line = 64;
+
+template<typename T>
+inline constexpr std::size_t simd_lanes = simd_bytes / sizeof(T) > 0 ? simd_bytes / sizeof(T) : 1;
+
+} // namespace ct
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "./fft.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../dense/view.hpp"
+#include "../parallel/parallel.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace ct {
+
+namespace fft {
+
+namespace detail {
+
+//NOTE: Element-wise spectrum products split into chunks of this many bins
+inline constexpr std::size_t spectrum_grain = 64 * 1024;
+
+// rows x cols real buffer padded to fast transform sizes, with cols kept even so the row
+// transforms take the half-size path
+struct padded_size {
+    std::size_t rows;
+    std::size_t cols;
+
+    padded_size(std::size_t min_rows, std::size_t min_cols) noexcept
+        : rows(smooth_size(min_rows, false)), cols(smooth_size(min_cols, true)) {}
+
+    [[nodiscard]] std::size_t half() const noexcept { return cols / 2 + 1; }
+};
+
+// Half spectrum of src placed at the top-left of a zeroed padded buffer
+template<floating_point T>
+[[nodiscard]] std::vector<std::complex<T>> padded_spectrum(matX_view<const T> src, const padded_size& size) {
+    std::vector<T> buffer(size.rows * size.cols, T{});
+    const matX_view<T> padded(buffer.data(), size.rows, size.cols, size.cols, 1);
+    for (std::size_t r = 0; r < src.rows(); ++r) {
+        for (std::size_t c = 0; c < src.cols(); ++c) padded(r, c) = src(r, c);
+    }
+    std::vector<std::complex<T>> spectrum(size.rows * size.half());
+    rfft_2d<T>(padded, matX_view<std::complex<T>>(spectrum.data(), size.rows, size.half(), size.half(), 1));
+    return spectrum;
+}
+
+template<floating_point T>
+[[nodiscard]] std::vector<T> padded_signal(const std::vector<std::complex<T>>& spectrum, const padded_size& size) {
+    std::vector<T> buffer(size.rows * size.cols);
+    irfft_2d<T>(matX_view<const std::complex<T>>(spectrum.data(), size.rows, size.half(), size.half(), 1),
+                matX_view<T>(buffer.data(), size.rows, size.cols, size.cols, 1));
+    return buffer;
+}
+
+// a[i] = a[i] * b[i], or a[i] * conj(b[i])
+template<floating_point T>
+void multiply_spectra(std::vector<std::complex<T>>& a, const std::vector<std::complex<T>>& b, bool conjugate) {
+    assert(a.size() == b.size());
+    parallel_for(0, a.size(), parallel_grain(a.size(), spectrum_grain), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) a[i] *= conjugate ? std::conj(b[i]) : b[i];
+    });
+}
+
+// Full correlation of image with templ, top-left anchored: c(y, x) = sum templ(i, j) image(y + i, x + j)
+template<floating_point T>
+[[nodiscard]] std::vector<T> correlate_padded(matX_view<const T> image, matX_view<const T> templ, const padded_size& size) {
+    auto spectrum = padded_spectrum(image, size);
+    multiply_spectra(spectrum, padded_spectrum(templ, size), true);
+    return padded_signal(spectrum, size);
+}
+
+} // namespace detail
+
+// Convolution of an image with a kernel, same size as the image, centred on kernel element
+// (rows / 2, cols / 2) with zeros outside the image. Costs O(n log n) regardless of the
+// kernel size, so it pays off over direct filtering from roughly 11 x 11 kernels up.
+template<floating_point T>
+void convolve(matX_view<const T> image, matX_view<const T> kernel, matX_view<T> out) {
+    assert(out.rows() == image.rows() && out.cols() == image.cols());
+    if (image.empty() || kernel.empty()) return;
+    const detail::padded_size size(image.rows() + kernel.rows() - 1, image.cols() + kernel.cols() - 1);
+    auto spectrum = detail::padded_spectrum(image, size);
+    detail::multiply_spectra(spectrum, detail::padded_spectrum(kernel, size), false);
+    const std::vector<T> full = detail::padded_signal(spectrum, size);
+
+    const std::size_t r0 = kernel.rows() / 2;
+    const std::size_t c0 = kernel.cols() / 2;
+    for (std::size_t r = 0; r < out.rows(); ++r) {
+        const T* row = full.data() + (r + r0) * size.cols + c0;
+        for (std::size_t c = 0; c < out.cols(); ++c) out(r, c) = row[c];
+    }
+}
+
+// Cross-correlation over the positions where templ lies inside image:
+// out(y, x) = sum templ(i, j) image(y + i, x + j), out being (H - h + 1) x (W - w + 1)
+template<floating_point T>
+void correlate(matX_view<const T> image, matX_view<const T> templ, matX_view<T> out) {
+    assert(templ.rows() <= image.rows() && templ.cols() <= image.cols());
+    assert(out.rows() == image.rows() - templ.rows() + 1 && out.cols() == image.cols() - templ.cols() + 1);
+    if (templ.empty()) return;
+    //NOTE: Circular wrap only reaches positions past the valid range, so no extra padding is needed
+    const detail::padded_size size(image.rows(), image.cols());
+    const std::vector<T> full = detail::correlate_padded(image, templ, size);
+    for (std::size_t r = 0; r < out.rows(); ++r) {
+        for (std::size_t c = 0; c < out.cols(); ++c) out(r, c) = full[r * size.cols + c];
+    }
+}
+
+// Zero-mean normalized cross-correlation (template matching) over the same positions as
+// correlate(), in [-1, 1]. Window means and energies come from integral images, so the
+// cost is one correlation plus O(H W). Flat windows, where the score is undefined, get 0.
+template<floating_point T>
+void correlate_normalized(matX_view<const T> image, matX_view<const T> templ, matX_view<T> out) {
+    assert(templ.rows() <= image.rows() && templ.cols() <= image.cols());
+    assert(out.rows() == image.rows() - templ.rows() + 1 && out.cols() == image.cols() - templ.cols() + 1);
+    if (templ.empty()) return;
+    const std::size_t th = templ.rows();
+    const std::size_t tw = templ.cols();
+    const auto count = static_cast<double>(th * tw);
+
+    double mean = 0;
+    for (std::size_t r = 0; r < th; ++r) {
+        for (std::size_t c = 0; c < tw; ++c) mean += templ(r, c);
+    }
+    mean /= count;
+    std::vector<T> centred(th * tw);
+    double templ_energy = 0;
+    for (std::size_t r = 0; r < th; ++r) {
+        for (std::size_t c = 0; c < tw; ++c) {
+            const double v = templ(r, c) - mean;
+            centred[r * tw + c] = static_cast<T>(v);
+            templ_energy += v * v;
+        }
+    }
+
+    //NOTE: sum (I - mean_I) t' == sum I t' because t' sums to zero
+    const detail::padded_size size(image.rows(), image.cols());
+    const std::vector<T> full = detail::correlate_padded(
+        image, matX_view<const T>(centred.data(), th, tw, tw, 1), size);
+
+    // Integral images of I and I^2, in double so large images keep their low bits
+    const std::size_t ih = image.rows() + 1;
+    const std::size_t iw = image.cols() + 1;
+    std::vector<double> sum(ih * iw, 0.0);
+    std::vector<double> sum_sq(ih * iw, 0.0);
+    for (std::size_t r = 1; r < ih; ++r) {
+        double row = 0;
+        double row_sq = 0;
+        for (std::size_t c = 1; c < iw; ++c) {
+            const double v = image(r - 1, c - 1);
+            row += v;
+            row_sq += v * v;
+            sum[r * iw + c] = sum[(r - 1) * iw + c] + row;
+            sum_sq[r * iw + c] = sum_sq[(r - 1) * iw + c] + row_sq;
+        }
+    }
+
+    const double eps = templ_energy * count * std::numeric_limits<T>::epsilon();
+    parallel_for(0, out.rows(), parallel_grain(out.rows(), 16), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            for (std::size_t c = 0; c < out.cols(); ++c) {
+                const auto box = [&](const std::vector<double>& s) {
+                    return s[(r + th) * iw + c + tw] - s[r * iw + c + tw] - s[(r + th) * iw + c] + s[r * iw + c];
+                };
+                const double s1 = box(sum);
+                const double variance = std::max(box(sum_sq) - s1 * s1 / count, 0.0);
+                const double denom = std::sqrt(variance * templ_energy);
+                const double score = denom > eps ? full[r * size.cols + c] / denom : 0.0;
+                out(r, c) = static_cast<T>(std::clamp(score, -1.0, 1.0));
+            }
+        }
+    });
+}
+
+template<floating_point T>
+struct phase_shift {
+    vec<2, T> shift; // (x, y) such that moved(p) ~ reference(p - shift)
+    T response;      // Correlation peak, 1 for an exact circular shift
+};
+
+// Translation between two equally sized images from the peak of the inverse normalized
+// cross-power spectrum, refined to sub-pixel precision with a 3 x 3 centroid. Shifts are
+// circular, so they resolve up to half the image size in either direction; apply a window
+// to both images first when their borders differ.
+template<floating_point T>
+[[nodiscard]] phase_shift<T> phase_correlate(matX_view<const T> reference, matX_view<const T> moved) {
+    assert(reference.rows() == moved.rows() && reference.cols() == moved.cols());
+    const std::size_t rows = reference.rows();
+    const std::size_t cols = reference.cols();
+    if (reference.empty()) return {vec<2, T>(T{}, T{}), T{}};
+    const std::size_t half = cols / 2 + 1;
+
+    std::vector<std::complex<T>> a(rows * half);
+    std::vector<std::complex<T>> b(rows * half);
+    rfft_2d<T>(reference, matX_view<std::complex<T>>(a.data(), rows, half, half, 1));
+    rfft_2d<T>(moved, matX_view<std::complex<T>>(b.data(), rows, half, half, 1));
+
+    const T tiny = std::numeric_limits<T>::min() / std::numeric_limits<T>::epsilon();
+    parallel_for(0, b.size(), parallel_grain(b.size(), detail::spectrum_grain), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::complex<T> cross = b[i] * std::conj(a[i]);
+            b[i] = cross / (std::abs(cross) + tiny);
+        }
+    });
+
+    std::vector<T> response(rows * cols);
+    irfft_2d<T>(matX_view<const std::complex<T>>(b.data(), rows, half, half, 1),
+                matX_view<T>(response.data(), rows, cols, cols, 1));
+
+    const std::size_t peak = static_cast<std::size_t>(std::max_element(response.begin(), response.end()) - response.begin());
+    const std::size_t pr = peak / cols;
+    const std::size_t pc = peak % cols;
+
+    //NOTE: Centroid over the 3 x 3 neighbourhood, wrapping around the borders like the shift does
+    T weight{};
+    T dx{};
+    T dy{};
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            const std::size_t r = (pr + rows + i - 1) % rows;
+            const std::size_t c = (pc + cols + j - 1) % cols;
+            const T w = std::max(response[r * cols + c], T{});
+            weight += w;
+            dy += w * (static_cast<T>(i) - T{1});
+            dx += w * (static_cast<T>(j) - T{1});
+        }
+    }
+    if (weight > T{}) {
+        dx /= weight;
+        dy /= weight;
+    }
+
+    const auto wrap = [](std::size_t at, std::size_t n) {
+        return at > n / 2 ? static_cast<T>(at) - static_cast<T>(n) : static_cast<T>(at);
+    };
+    return {vec<2, T>(wrap(pc, cols) + dx, wrap(pr, rows) + dy), response[peak]};
+}
+
+} // namespace fft
+
+} // namespace ct
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "./plan.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../dense/view.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace ct {
+
+namespace fft {
+
+// Plan for real input of size n and its n / 2 + 1 non-redundant outputs. Even sizes run as
+// a complex transform of n / 2 (even samples as real parts, odd as imaginary) followed by a
+// split step; odd sizes run as a complex transform of n. Unscaled in both directions, and
+// shared between threads like plan.
+template<floating_point T>
+class real_plan {
+public:
+    explicit real_plan(std::size_t n)
+        : n_(n), half_(n % 2 == 0 ? n / 2 : 0), plan_(plan<T>::cached(n % 2 == 0 ? n / 2 : n)) {
+        assert(n > 0);
+        if (half_ > 0) {
+            tw_re_.resize(half_ + 1);
+            tw_im_.resize(half_ + 1);
+            for (std::size_t k = 0; k <= half_; ++k) detail::unit_root(k, n_, tw_re_[k], tw_im_[k]);
+        }
+    }
+
+    [[nodiscard]] static std::shared_ptr<const real_plan> cached(std::size_t n) {
+        static std::mutex mutex;
+        static std::unordered_map<std::size_t, std::shared_ptr<const real_plan>> cache;
+        {
+            std::lock_guard lock(mutex);
+            if (auto it = cache.find(n); it != cache.end()) return it->second;
+        }
+        auto built = std::make_shared<const real_plan>(n);
+        std::lock_guard lock(mutex);
+        return cache.emplace(n, std::move(built)).first->second;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return n_; }
+    [[nodiscard]] std::size_t spectrum_size() const noexcept { return n_ / 2 + 1; }
+
+    [[nodiscard]] std::size_t scratch_size() const noexcept {
+        return 2 * plan_->size() + plan_->scratch_size(1);
+    }
+
+    // out[k * out_stride] = X_k for k <= n / 2, from in[j * in_stride]
+    void forward(const T* in, std::size_t in_stride, std::complex<T>* out, std::size_t out_stride,
+                 T* scratch) const noexcept {
+        const std::size_t m = plan_->size();
+        T* zr = scratch;
+        T* zi = scratch + m;
+        if (half_ == 0) {
+            for (std::size_t j = 0; j < m; ++j) {
+                zr[j] = in[j * in_stride];
+                zi[j] = T{};
+            }
+            plan_->transform(zr, zi, 1, false, scratch + 2 * m);
+            for (std::size_t k = 0; k <= n_ / 2; ++k) out[k * out_stride] = std::complex<T>(zr[k], zi[k]);
+            return;
+        }
+
+        for (std::size_t j = 0; j < m; ++j) {
+            zr[j] = in[2 * j * in_stride];
+            zi[j] = in[(2 * j + 1) * in_stride];
+        }
+        plan_->transform(zr, zi, 1, false, scratch + 2 * m);
+        //NOTE: E = (Z_k + conj Z_{h-k}) / 2 and O = (Z_k - conj Z_{h-k}) / 2i are the spectra of
+        // the even and odd samples, and X_k = E + W^k O
+        for (std::size_t k = 0; k <= half_; ++k) {
+            const std::size_t a = k == half_ ? 0 : k;
+            const std::size_t b = k == 0 ? 0 : half_ - k;
+            const T er = (zr[a] + zr[b]) / T{2};
+            const T ei = (zi[a] - zi[b]) / T{2};
+            const T orr = (zi[a] + zi[b]) / T{2};
+            const T oi = (zr[b] - zr[a]) / T{2};
+            out[k * out_stride] = std::complex<T>(er + orr * tw_re_[k] - oi * tw_im_[k],
+                                                  ei + orr * tw_im_[k] + oi * tw_re_[k]);
+        }
+    }
+
+    // out[j * out_stride] = n x_j from the n / 2 + 1 values in[k * in_stride]; the imaginary
+    // parts of X_0 and, for even n, X_{n/2} are ignored
+    void inverse(const std::complex<T>* in, std::size_t in_stride, T* out, std::size_t out_stride,
+                 T* scratch) const noexcept {
+        const std::size_t m = plan_->size();
+        T* zr = scratch;
+        T* zi = scratch + m;
+        if (half_ == 0) {
+            for (std::size_t k = 0; k <= n_ / 2; ++k) {
+                const std::complex<T> x = in[k * in_stride];
+                zr[k] = x.real();
+                zi[k] = k == 0 ? T{} : x.imag();
+                if (k > 0) {
+                    zr[n_ - k] = x.real();
+                    zi[n_ - k] = -x.imag();
+                }
+            }
+            plan_->transform(zr, zi, 1, true, scratch + 2 * m);
+            for (std::size_t j = 0; j < n_; ++j) out[j * out_stride] = zr[j];
+            return;
+        }
+
+        //NOTE: Z_k = 2 (E + i O) with E = (X_k + conj X_{h-k}) / 2 and O = (X_k - conj X_{h-k}) / 2 W^-k
+        for (std::size_t k = 0; k < half_; ++k) {
+            std::complex<T> x = in[k * in_stride];
+            std::complex<T> y = std::conj(in[(half_ - k) * in_stride]);
+            if (k == 0) {
+                x.imag(T{});
+                y.imag(T{});
+            }
+            const T er = x.real() + y.real();
+            const T ei = x.imag() + y.imag();
+            const T dr = x.real() - y.real();
+            const T di = x.imag() - y.imag();
+            const T orr = dr * tw_re_[k] + di * tw_im_[k];
+            const T oi = di * tw_re_[k] - dr * tw_im_[k];
+            zr[k] = er - oi;
+            zi[k] = ei + orr;
+        }
+        plan_->transform(zr, zi, 1, true, scratch + 2 * m);
+        for (std::size_t j = 0; j < m; ++j) {
+            out[2 * j * out_stride] = zr[j];
+            out[(2 * j + 1) * out_stride] = zi[j];
+        }
+    }
+
+private:
+    std::size_t n_;
+    std::size_t half_;
+    std::shared_ptr<const plan<T>> plan_;
+    std::vector<T> tw_re_;
+    std::vector<T> tw_im_;
+};
+
+namespace detail {
+
+//NOTE: 2D passes below this many elements stay on the calling thread
+inline constexpr std::size_t fft_parallel_min = 64 * 1024;
+
+// Columns a column pass transforms together, two registers wide
+template<floating_point T>
+inline constexpr std::size_t column_tile = 2 * simd_lanes<T>;
+
+// Grain over `count` rows or tiles of `work` elements each
+[[nodiscard]] inline std::size_t pass_grain(std::size_t count, std::size_t work) noexcept {
+    if (count * work < fft_parallel_min) return count;
+    return parallel_grain(count, 1);
+}
+
+template<floating_point T>
+void row_pass(matX_view<const std::complex<T>> in, matX_view<std::complex<T>> out, bool inverse, T scale) {
+    const std::size_t rows = in.rows();
+    const std::size_t cols = in.cols();
+    const auto p = plan<T>::cached(cols);
+    parallel_for(0, rows, pass_grain(rows, cols), [&](std::size_t begin, std::size_t end) {
+        std::vector<T> work(2 * cols + p->scratch_size(1));
+        T* re = work.data();
+        T* im = re + cols;
+        for (std::size_t r = begin; r < end; ++r) {
+            for (std::size_t c = 0; c < cols; ++c) {
+                const std::complex<T> v = in(r, c);
+                re[c] = v.real();
+                im[c] = v.imag();
+            }
+            p->transform(re, im, 1, inverse, im + cols);
+            for (std::size_t c = 0; c < cols; ++c) out(r, c) = std::complex<T>(re[c] * scale, im[c] * scale);
+        }
+    });
+}
+
+// Transforms the columns of in into out, column_tile of them per batched plan call
+template<floating_point T>
+void column_pass(matX_view<const std::complex<T>> in, matX_view<std::complex<T>> out, bool inverse, T scale) {
+    const std::size_t rows = in.rows();
+    const std::size_t cols = in.cols();
+    constexpr std::size_t tile = column_tile<T>;
+    const std::size_t tiles = (cols + tile - 1) / tile;
+    const auto p = plan<T>::cached(rows);
+    parallel_for(0, tiles, pass_grain(tiles, rows * tile), [&](std::size_t begin, std::size_t end) {
+        std::vector<T> work(2 * rows * tile + p->scratch_size(tile));
+        T* re = work.data();
+        T* im = re + rows * tile;
+        for (std::size_t t = begin; t < end; ++t) {
+            const std::size_t c0 = t * tile;
+            const std::size_t b = std::min(tile, cols - c0);
+            for (std::size_t r = 0; r < rows; ++r) {
+                for (std::size_t c = 0; c < b; ++c) {
+                    const std::complex<T> v = in(r, c0 + c);
+                    re[r * b + c] = v.real();
+                    im[r * b + c] = v.imag();
+                }
+            }
+            p->transform(re, im, b, inverse, im + rows * tile);
+            for (std::size_t r = 0; r < rows; ++r) {
+                for (std::size_t c = 0; c < b; ++c) {
+                    out(r, c0 + c) = std::complex<T>(re[r * b + c] * scale, im[r * b + c] * scale);
+                }
+            }
+        }
+    });
+}
+
+template<floating_point T>
+void transform_1d(std::span<const std::complex<T>> in, std::span<std::complex<T>> out, bool inverse) {
+    assert(in.size() == out.size());
+    const std::size_t n = in.size();
+    if (n == 0) return;
+    const auto p = plan<T>::cached(n);
+    std::vector<T> work(2 * n + p->scratch_size(1));
+    T* re = work.data();
+    T* im = re + n;
+    for (std::size_t i = 0; i < n; ++i) {
+        re[i] = in[i].real();
+        im[i] = in[i].imag();
+    }
+    p->transform(re, im, 1, inverse, im + n);
+    const T scale = inverse ? T{1} / static_cast<T>(n) : T{1};
+    for (std::size_t i = 0; i < n; ++i) out[i] = std::complex<T>(re[i] * scale, im[i] * scale);
+}
+
+} // namespace detail
+
+// 1D transforms of any size. forward() is unscaled and inverse() divides by n, so
+// inverse(forward(x)) == x. in and out may be the same buffer.
+template<floating_point T>
+void forward(std::span<const std::complex<T>> in, std::type_identity_t<std::span<std::complex<T>>> out) {
+    detail::transform_1d(in, out, false);
+}
+
+template<floating_point T>
+void inverse(std::span<const std::complex<T>> in, std::type_identity_t<std::span<std::complex<T>>> out) {
+    detail::transform_1d(in, out, true);
+}
+
+// Spectrum of real input: out.size() == in.size() / 2 + 1, the rest being conjugate-symmetric
+template<floating_point T>
+void rfft(std::span<const T> in, std::type_identity_t<std::span<std::complex<T>>> out) {
+    assert(!in.empty() && out.size() == in.size() / 2 + 1);
+    const auto p = real_plan<T>::cached(in.size());
+    std::vector<T> scratch(p->scratch_size());
+    p->forward(in.data(), 1, out.data(), 1, scratch.data());
+}
+
+// Real signal of size out.size() from its in.size() == out.size() / 2 + 1 spectrum, scaled by 1 / n
+template<floating_point T>
+void irfft(std::span<const std::complex<T>> in, std::type_identity_t<std::span<T>> out) {
+    assert(!out.empty() && in.size() == out.size() / 2 + 1);
+    const std::size_t n = out.size();
+    const auto p = real_plan<T>::cached(n);
+    std::vector<T> scratch(p->scratch_size());
+    p->inverse(in.data(), 1, out.data(), 1, scratch.data());
+    const T scale = T{1} / static_cast<T>(n);
+    for (T& v : out) v *= scale;
+}
+
+// 2D transforms over rows x cols views (any strides, so image rows with padding work as
+// they are). Rows go first, then columns in tiles batched through the plan; both passes
+// run over the thread pool. inverse_2d divides by rows * cols. out may alias in.
+template<floating_point T>
+void forward_2d(matX_view<const std::complex<T>> in, matX_view<std::complex<T>> out) {
+    assert(in.rows() == out.rows() && in.cols() == out.cols());
+    if (in.empty()) return;
+    detail::row_pass<T>(in, out, false, T{1});
+    detail::column_pass<T>(out, out, false, T{1});
+}
+
+template<floating_point T>
+void inverse_2d(matX_view<const std::complex<T>> in, matX_view<std::complex<T>> out) {
+    assert(in.rows() == out.rows() && in.cols() == out.cols());
+    if (in.empty()) return;
+    detail::row_pass<T>(in, out, true, T{1});
+    detail::column_pass<T>(out, out, true, T{1} / static_cast<T>(in.rows() * in.cols()));
+}
+
+// Half spectrum of a real rows x cols image: out is rows x (cols / 2 + 1)
+template<floating_point T>
+void rfft_2d(matX_view<const T> in, matX_view<std::complex<T>> out) {
+    const std::size_t rows = in.rows();
+    const std::size_t cols = in.cols();
+    assert(out.rows() == rows && out.cols() == cols / 2 + 1);
+    if (in.empty()) return;
+    const auto p = real_plan<T>::cached(cols);
+    parallel_for(0, rows, detail::pass_grain(rows, cols), [&](std::size_t begin, std::size_t end) {
+        std::vector<T> scratch(p->scratch_size());
+        for (std::size_t r = begin; r < end; ++r) {
+            p->forward(&in(r, 0), in.col_stride(), &out(r, 0), out.col_stride(), scratch.data());
+        }
+    });
+    detail::column_pass<T>(out, out, false, T{1});
+}
+
+// Real rows x cols image from its rows x (cols / 2 + 1) half spectrum, scaled by 1 / (rows * cols)
+template<floating_point T>
+void irfft_2d(matX_view<const std::complex<T>> in, matX_view<T> out) {
+    const std::size_t rows = out.rows();
+    const std::size_t cols = out.cols();
+    assert(in.rows() == rows && in.cols() == cols / 2 + 1);
+    if (out.empty()) return;
+    const std::size_t half = cols / 2 + 1;
+    std::vector<std::complex<T>> tmp(rows * half);
+    const matX_view<std::complex<T>> t(tmp.data(), rows, half, half, 1);
+    detail::column_pass<T>(in, t, true, T{1} / static_cast<T>(rows * cols));
+
+    const auto p = real_plan<T>::cached(cols);
+    parallel_for(0, rows, detail::pass_grain(rows, cols), [&](std::size_t begin, std::size_t end) {
+        std::vector<T> scratch(p->scratch_size());
+        for (std::size_t r = begin; r < end; ++r) {
+            p->inverse(tmp.data() + r * half, 1, &out(r, 0), out.col_stride(), scratch.data());
+        }
+    });
+}
+
+} // namespace fft
+
+} // namespace ct
@@ -0,0 +1,411 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <unordered_map>
+#include <vector>
+
+namespace ct {
+
+namespace fft {
+
+namespace detail {
+
+//NOTE: Prime factors up to max_radix get a direct butterfly; a size with a larger prime
+// factor is transformed with Bluestein's algorithm on a 2^a 3^b 5^c size instead
+inline constexpr std::size_t max_radix = 13;
+
+// Smallest 2^a 3^b 5^c >= n, optionally even
+[[nodiscard]] inline std::size_t smooth_size(std::size_t n, bool even) noexcept {
+    if (n <= 1) return even ? 2 : 1;
+    std::size_t best = ~std::size_t{0};
+    for (std::size_t p5 = 1; p5 < best; p5 *= 5) {
+        for (std::size_t p35 = p5; p35 < best; p35 *= 3) {
+            std::size_t v = p35;
+            while (v < n || (even && (v & 1))) v *= 2;
+            if (v < best) best = v;
+        }
+    }
+    return best;
+}
+
+// exp(-2 pi i k / n), with k reduced first so large tables stay exact to the last bit of T
+template<floating_point T>
+void unit_root(std::uint64_t k, std::uint64_t n, T& re, T& im) noexcept {
+    const double a = -2.0 * std::numbers::pi * static_cast<double>(k % n) / static_cast<double>(n);
+    re = static_cast<T>(std::cos(a));
+    im = static_cast<T>(std::sin(a));
+}
+
+template<typename V, floating_point T>
+[[nodiscard]] CT_FORCE_INLINE V load(const T* p) noexcept {
+    if constexpr (std::is_same_v<V, T>) {
+        return *p;
+    } else {
+        return V::load(p);
+    }
+}
+
+template<typename V, floating_point T>
+CT_FORCE_INLINE void store(T* p, const V& v) noexcept {
+    if constexpr (std::is_same_v<V, T>) {
+        *p = v;
+    } else {
+        v.store(p);
+    }
+}
+
+// cos / sin(2 pi t k / P) for t, k in 1..(P - 1) / 2, row t - 1
+template<std::size_t P, floating_point T>
+struct odd_radix_table {
+    static constexpr std::size_t half = (P - 1) / 2;
+    std::array<T, half * half> c{};
+    std::array<T, half * half> s{};
+
+    odd_radix_table() noexcept {
+        for (std::size_t t = 1; t <= half; ++t) {
+            for (std::size_t k = 1; k <= half; ++k) {
+                const double a = 2.0 * std::numbers::pi * static_cast<double>((t * k) % P) / static_cast<double>(P);
+                c[(t - 1) * half + k - 1] = static_cast<T>(std::cos(a));
+                s[(t - 1) * half + k - 1] = static_cast<T>(std::sin(a));
+            }
+        }
+    }
+
+    [[nodiscard]] static const odd_radix_table& get() noexcept {
+        static const odd_radix_table table;
+        return table;
+    }
+};
+
+// One radix-P butterfly of a decimation-in-frequency Stockham stage on split complex
+// lanes: inputs t at x + t * in_step, outputs k at y + k * out_step, output k scaled by the
+// twiddle w[k - 1]. V is T or a pack running W independent butterflies.
+template<std::size_t P, typename V, floating_point T>
+CT_FORCE_INLINE void butterfly(const T* CT_RESTRICT xr, const T* CT_RESTRICT xi, std::size_t in_step,
+                               T* CT_RESTRICT yr, T* CT_RESTRICT yi, std::size_t out_step,
+                               const T* wr, const T* wi) noexcept {
+    std::array<V, P> ar;
+    std::array<V, P> ai;
+    CT_UNROLL
+    for (std::size_t t = 0; t < P; ++t) {
+        ar[t] = load<V>(xr + t * in_step);
+        ai[t] = load<V>(xi + t * in_step);
+    }
+
+    std::array<V, P> br;
+    std::array<V, P> bi;
+    if constexpr (P == 2) {
+        br[0] = ar[0] + ar[1]; bi[0] = ai[0] + ai[1];
+        br[1] = ar[0] - ar[1]; bi[1] = ai[0] - ai[1];
+    } else if constexpr (P == 4) {
+        const V t0r = ar[0] + ar[2], t0i = ai[0] + ai[2];
+        const V t1r = ar[0] - ar[2], t1i = ai[0] - ai[2];
+        const V t2r = ar[1] + ar[3], t2i = ai[1] + ai[3];
+        const V t3r = ar[1] - ar[3], t3i = ai[1] - ai[3];
+        br[0] = t0r + t2r; bi[0] = t0i + t2i;
+        br[2] = t0r - t2r; bi[2] = t0i - t2i;
+        // t1 -/+ i t3
+        br[1] = t1r + t3i; bi[1] = t1i - t3r;
+        br[3] = t1r - t3i; bi[3] = t1i + t3r;
+    } else {
+        // X_k = a_0 + sum_t (a_t + a_{P-t}) cos - i (a_t - a_{P-t}) sin, paired with X_{P-k}
+        constexpr std::size_t h = (P - 1) / 2;
+        const auto& tab = odd_radix_table<P, T>::get();
+        std::array<V, h> ur;
+        std::array<V, h> ui;
+        std::array<V, h> vr;
+        std::array<V, h> vi;
+        br[0] = ar[0];
+        bi[0] = ai[0];
+        CT_UNROLL
+        for (std::size_t t = 1; t <= h; ++t) {
+            ur[t - 1] = ar[t] + ar[P - t]; ui[t - 1] = ai[t] + ai[P - t];
+            vr[t - 1] = ar[t] - ar[P - t]; vi[t - 1] = ai[t] - ai[P - t];
+            br[0] += ur[t - 1];
+            bi[0] += ui[t - 1];
+        }
+        CT_UNROLL
+        for (std::size_t k = 1; k <= h; ++k) {
+            V sr = ar[0];
+            V si = ai[0];
+            V dr = splat<V>(T{});
+            V di = splat<V>(T{});
+            CT_UNROLL
+            for (std::size_t t = 1; t <= h; ++t) {
+                const T c = tab.c[(t - 1) * h + k - 1];
+                const T s = tab.s[(t - 1) * h + k - 1];
+                sr += ur[t - 1] * c;
+                si += ui[t - 1] * c;
+                dr += vr[t - 1] * s;
+                di += vi[t - 1] * s;
+            }
+            br[k] = sr + di;     bi[k] = si - dr;
+            br[P - k] = sr - di; bi[P - k] = si + dr;
+        }
+    }
+
+    store(yr, br[0]);
+    store(yi, bi[0]);
+    CT_UNROLL
+    for (std::size_t k = 1; k < P; ++k) {
+        const T c = wr[k - 1];
+        const T s = wi[k - 1];
+        store(yr + k * out_step, br[k] * c - bi[k] * s);
+        store(yi + k * out_step, br[k] * s + bi[k] * c);
+    }
+}
+
+// Stage of the Stockham autosort: the current length P * m runs with stride s over b lanes,
+// so a butterfly covers L = s * b contiguous values, vectorized whenever L fills a register
+template<std::size_t P, floating_point T>
+void run_stage(std::size_t m, std::size_t lanes, const T* tw_re, const T* tw_im,
+               const T* CT_RESTRICT xr, const T* CT_RESTRICT xi, T* CT_RESTRICT yr, T* CT_RESTRICT yi) noexcept {
+    constexpr std::size_t W = simd_lanes<T>;
+    using V = pack<T, W>;
+    const std::size_t in_step = m * lanes;
+    for (std::size_t j = 0; j < m; ++j) {
+        const T* wr = tw_re + j * (P - 1);
+        const T* wi = tw_im + j * (P - 1);
+        const T* ir = xr + j * lanes;
+        const T* ii = xi + j * lanes;
+        T* orr = yr + j * P * lanes;
+        T* oi = yi + j * P * lanes;
+        std::size_t v = 0;
+        if constexpr (W > 1) {
+            for (; v + W <= lanes; v += W) butterfly<P, V>(ir + v, ii + v, in_step, orr + v, oi + v, lanes, wr, wi);
+        }
+        for (; v < lanes; ++v) butterfly<P, T>(ir + v, ii + v, in_step, orr + v, oi + v, lanes, wr, wi);
+    }
+}
+
+} // namespace detail
+
+// Plan for complex DFTs of one size n, X_k = sum_j x_j exp(-2 pi i jk / n), unscaled in
+// both directions. Sizes whose prime factors are all <= 13 run as a mixed-radix Stockham
+// autosort (radix 4, 2, 3, 5, 7, 11, 13); other sizes use Bluestein's chirp-z algorithm
+// on a padded 2^a 3^b 5^c size, so every n is O(n log n).
+//
+// Data is split complex: re and im arrays. A plan transforms b interleaved sequences at
+// once, element i of sequence c at re[i * b + c], which is how column passes of 2D
+// transforms fill whole SIMD registers from the first stage on. A plan is immutable after
+// construction; one instance is shared by any number of threads, each with its own scratch.
+template<floating_point T>
+class plan {
+public:
+    explicit plan(std::size_t n) : n_(n) {
+        assert(n > 0);
+        std::size_t rest = n;
+        std::vector<std::size_t> radices;
+        while (rest % 4 == 0) { radices.push_back(4); rest /= 4; }
+        if (rest % 2 == 0) { radices.push_back(2); rest /= 2; }
+        for (std::size_t p = 3; p <= detail::max_radix; p += 2) {
+            while (rest % p == 0) { radices.push_back(p); rest /= p; }
+        }
+        if (rest != 1) {
+            build_bluestein();
+            return;
+        }
+
+        std::size_t s = 1;
+        for (const std::size_t p : radices) {
+            const std::size_t len = n_ / s;
+            stage st{p, len / p, {}, {}};
+            st.tw_re.resize(st.m * (p - 1));
+            st.tw_im.resize(st.m * (p - 1));
+            for (std::size_t j = 0; j < st.m; ++j) {
+                for (std::size_t k = 1; k < p; ++k) {
+                    detail::unit_root(std::uint64_t{j} * k, len, st.tw_re[j * (p - 1) + k - 1], st.tw_im[j * (p - 1) + k - 1]);
+                }
+            }
+            stages_.push_back(std::move(st));
+            s *= p;
+        }
+    }
+
+    // Shared plan for size n, built on first use. Thread-safe.
+    [[nodiscard]] static std::shared_ptr<const plan> cached(std::size_t n) {
+        static std::mutex mutex;
+        static std::unordered_map<std::size_t, std::shared_ptr<const plan>> cache;
+        {
+            std::lock_guard lock(mutex);
+            if (auto it = cache.find(n); it != cache.end()) return it->second;
+        }
+        //NOTE: Built unlocked: a Bluestein plan asks the cache for its padded size
+        auto built = std::make_shared<const plan>(n);
+        std::lock_guard lock(mutex);
+        return cache.emplace(n, std::move(built)).first->second;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return n_; }
+    [[nodiscard]] bool bluestein() const noexcept { return static_cast<bool>(sub_); }
+
+    // Values of T that transform() needs as scratch for b sequences
+    [[nodiscard]] std::size_t scratch_size(std::size_t b = 1) const noexcept {
+        if (sub_) return 2 * sub_->size() * b + sub_->scratch_size(b);
+        return 2 * n_ * b;
+    }
+
+    // In-place DFT of b interleaved sequences; inverse conjugates the roots. Unscaled.
+    void transform(T* re, T* im, std::size_t b, bool inverse, T* scratch) const noexcept {
+        const std::size_t count = n_ * b;
+        if (inverse) negate(im, count);
+        if (sub_) {
+            transform_bluestein(re, im, b, scratch);
+        } else {
+            transform_stockham(re, im, b, scratch, scratch + count);
+        }
+        if (inverse) negate(im, count);
+    }
+
+private:
+    struct stage {
+        std::size_t radix;
+        std::size_t m;
+        std::vector<T> tw_re;
+        std::vector<T> tw_im;
+    };
+
+    static void negate(T* v, std::size_t count) noexcept {
+        CT_VECTORIZE
+        for (std::size_t i = 0; i < count; ++i) v[i] = -v[i];
+    }
+
+    void transform_stockham(T* re, T* im, std::size_t b, T* tr, T* ti) const noexcept {
+        bool in_place = true;
+        std::size_t s = 1;
+        for (const stage& st : stages_) {
+            const T* xr = in_place ? re : tr;
+            const T* xi = in_place ? im : ti;
+            T* yr = in_place ? tr : re;
+            T* yi = in_place ? ti : im;
+            const std::size_t lanes = s * b;
+            const T* wr = st.tw_re.data();
+            const T* wi = st.tw_im.data();
+            switch (st.radix) {
+                case 2:  detail::run_stage<2>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                case 3:  detail::run_stage<3>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                case 4:  detail::run_stage<4>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                case 5:  detail::run_stage<5>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                case 7:  detail::run_stage<7>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                case 11: detail::run_stage<11>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                case 13: detail::run_stage<13>(st.m, lanes, wr, wi, xr, xi, yr, yi); break;
+                default: assert(false);
+            }
+            in_place = !in_place;
+            s *= st.radix;
+        }
+        if (!in_place) {
+            const std::size_t count = n_ * b;
+            std::copy(tr, tr + count, re);
+            std::copy(ti, ti + count, im);
+        }
+    }
+
+    // X_k = w_k sum_j (x_j w_j) conj(w_{k-j}) with w_k = exp(-pi i k^2 / n): a circular
+    // convolution of size M >= 2n - 1 done with the sub-plan, whose kernel spectrum is
+    // precomputed with the 1 / M of the inverse folded in
+    void build_bluestein() {
+        const std::size_t m = detail::smooth_size(2 * n_ - 1, false);
+        sub_ = cached(m);
+        chirp_re_.resize(n_);
+        chirp_im_.resize(n_);
+        for (std::size_t k = 0; k < n_; ++k) {
+            const std::uint64_t kk = std::uint64_t{k} * k;
+            detail::unit_root(kk % (2 * n_), 2 * n_, chirp_re_[k], chirp_im_[k]);
+        }
+        kernel_re_.assign(m, T{});
+        kernel_im_.assign(m, T{});
+        for (std::size_t k = 0; k < n_; ++k) {
+            kernel_re_[k] = chirp_re_[k];
+            kernel_im_[k] = -chirp_im_[k];
+            if (k > 0) {
+                kernel_re_[m - k] = chirp_re_[k];
+                kernel_im_[m - k] = -chirp_im_[k];
+            }
+        }
+        std::vector<T> scratch(sub_->scratch_size(1));
+        sub_->transform(kernel_re_.data(), kernel_im_.data(), 1, false, scratch.data());
+        const T scale = T{1} / static_cast<T>(m);
+        for (std::size_t k = 0; k < m; ++k) {
+            kernel_re_[k] *= scale;
+            kernel_im_[k] *= scale;
+        }
+    }
+
+    void transform_bluestein(T* re, T* im, std::size_t b, T* scratch) const noexcept {
+        const std::size_t m = sub_->size();
+        T* ar = scratch;
+        T* ai = scratch + m * b;
+        T* rest = scratch + 2 * m * b;
+        for (std::size_t k = 0; k < n_; ++k) {
+            const T cr = chirp_re_[k];
+            const T ci = chirp_im_[k];
+            CT_VECTORIZE
+            for (std::size_t c = 0; c < b; ++c) {
+                const T xr = re[k * b + c];
+                const T xi = im[k * b + c];
+                ar[k * b + c] = xr * cr - xi * ci;
+                ai[k * b + c] = xr * ci + xi * cr;
+            }
+        }
+        std::fill(ar + n_ * b, ar + m * b, T{});
+        std::fill(ai + n_ * b, ai + m * b, T{});
+
+        sub_->transform(ar, ai, b, false, rest);
+        for (std::size_t k = 0; k < m; ++k) {
+            const T kr = kernel_re_[k];
+            const T ki = kernel_im_[k];
+            CT_VECTORIZE
+            for (std::size_t c = 0; c < b; ++c) {
+                const T xr = ar[k * b + c];
+                const T xi = ai[k * b + c];
+                ar[k * b + c] = xr * kr - xi * ki;
+                ai[k * b + c] = xr * ki + xi * kr;
+            }
+        }
+        sub_->transform(ar, ai, b, true, rest);
+
+        for (std::size_t k = 0; k < n_; ++k) {
+            const T cr = chirp_re_[k];
+            const T ci = chirp_im_[k];
+            CT_VECTORIZE
+            for (std::size_t c = 0; c < b; ++c) {
+                const T xr = ar[k * b + c];
+                const T xi = ai[k * b + c];
+                re[k * b + c] = xr * cr - xi * ci;
+                im[k * b + c] = xr * ci + xi * cr;
+            }
+        }
+    }
+
+    std::size_t n_;
+    std::vector<stage> stages_;
+
+    std::shared_ptr<const plan> sub_;
+    std::vector<T> chirp_re_;
+    std::vector<T> chirp_im_;
+    std::vector<T> kernel_re_;
+    std::vector<T> kernel_im_;
+};
+
+// Smallest size >= n that transforms without Bluestein at the best speed (2^a 3^b 5^c),
+// for padding convolutions
+[[nodiscard]] inline std::size_t good_size(std::size_t n) noexcept {
+    return detail::smooth_size(n, false);
+}
+
+} // namespace fft
+
+} // namespace ct
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "./primitives.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "../common/functions.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace ct {
+
+// Boxes and triangles tested per call of the batch kernels: 8 floats with AVX, 16 with
+// AVX-512. Blocks are transposed from the AoS arrays into one pack per coordinate by lane
+// shuffles, so callers keep plain std::vector<aabb<T>> / std::vector<triangle<T>>.
+template<floating_point T>
+inline constexpr std::size_t geom_batch_width = simd_lanes<T>;
+
+namespace detail {
+
+template<floating_point T>
+using geom_lanes = pack<T, geom_batch_width<T>>;
+
+//NOTE: Below this many boxes the pool wake-up costs more than the work
+inline constexpr std::size_t geom_parallel_min = 64 * 1024;
+
+// The lanes past count are padded with default (empty) boxes or degenerate triangles, which
+// the kernels evaluate and the callers discard
+template<typename Prim, std::size_t W>
+CT_FORCE_INLINE const typename Prim::value_type* geom_block(const Prim* src, std::size_t count, Prim (&pad)[W]) noexcept {
+    using T = typename Prim::value_type;
+    if (count == W) return reinterpret_cast<const T*>(src);
+    for (std::size_t l = 0; l < W; ++l) pad[l] = l < count ? src[l] : Prim{};
+    return reinterpret_cast<const T*>(pad);
+}
+
+// W boxes are 2W corners lo0 hi0 lo1 hi1 ...: transpose them as vec3 and split by parity
+template<floating_point T>
+CT_FORCE_INLINE void aabb_load(const aabb<T>* boxes, std::size_t count, geom_lanes<T> (&lo)[3],
+                               geom_lanes<T> (&hi)[3]) noexcept {
+    constexpr std::size_t W = geom_batch_width<T>;
+    aabb<T> pad[W];
+    const T* p = geom_block(boxes, count, pad);
+    geom_lanes<T> a[3];
+    geom_lanes<T> b[3];
+    load_interleaved(p, a[0], a[1], a[2]);
+    load_interleaved(p + 3 * W, b[0], b[1], b[2]);
+    for (std::size_t i = 0; i < 3; ++i) unzip(a[i], b[i], lo[i], hi[i]);
+}
+
+// W triangles are 3W vertices: transpose them as vec3, then split each coordinate in threes
+template<floating_point T>
+CT_FORCE_INLINE void triangle_load(const triangle<T>* tris, std::size_t count, geom_lanes<T> (&a)[3],
+                                   geom_lanes<T> (&b)[3], geom_lanes<T> (&c)[3]) noexcept {
+    constexpr std::size_t W = geom_batch_width<T>;
+    triangle<T> pad[W];
+    const T* p = geom_block(tris, count, pad);
+    geom_lanes<T> v[3][3];
+    for (std::size_t k = 0; k < 3; ++k) load_interleaved(p + 3 * W * k, v[k][0], v[k][1], v[k][2]);
+    for (std::size_t i = 0; i < 3; ++i) deinterleave(v[0][i], v[1][i], v[2][i], a[i], b[i], c[i]);
+}
+
+// frustum::test(aabb) on W boxes; returns lanes holding the containment values
+template<floating_point T>
+CT_FORCE_INLINE geom_lanes<T> frustum_aabb_lanes(const frustum<T>& f, const geom_lanes<T> (&lo)[3],
+                                                 const geom_lanes<T> (&hi)[3]) noexcept {
+    using P = geom_lanes<T>;
+    P c[3];
+    P e[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        c[i] = (lo[i] + hi[i]) * T(0.5);
+        e[i] = (hi[i] - lo[i]) * T(0.5);
+    }
+    auto plane_test = [&](const plane<T>& pl, P& d, P& r) {
+        d = c[0] * pl.normal.x + c[1] * pl.normal.y + c[2] * pl.normal.z + pl.d;
+        r = e[0] * abs(pl.normal.x) + e[1] * abs(pl.normal.y) + e[2] * abs(pl.normal.z);
+    };
+    P d;
+    P r;
+    plane_test(f.planes[0], d, r);
+    auto outside = d < -r;
+    auto straddle = d < r;
+    for (std::size_t k = 1; k < 6; ++k) {
+        plane_test(f.planes[k], d, r);
+        outside = outside || d < -r;
+        straddle = straddle || d < r;
+    }
+    const P in = P::broadcast(static_cast<T>(containment::inside));
+    const P part = P::broadcast(static_cast<T>(containment::intersects));
+    const P out = P::broadcast(static_cast<T>(containment::outside));
+    return select(outside, out, select(straddle, part, in));
+}
+
+// Moller-Trumbore on lanes (two-sided): returns the lanes where the ray crosses the
+// triangle, with the distance t and the barycentrics u, v; t is not range-checked
+template<typename P>
+CT_FORCE_INLINE auto ray_triangle_lanes(const P (&o)[3], const P (&d)[3], const P (&a)[3], const P (&b)[3],
+                                        const P (&c)[3], P& t, P& u, P& v) noexcept {
+    using T = typename P::value_type;
+    const P e1x = b[0] - a[0], e1y = b[1] - a[1], e1z = b[2] - a[2];
+    const P e2x = c[0] - a[0], e2y = c[1] - a[1], e2z = c[2] - a[2];
+    const P px = d[1] * e2z - d[2] * e2y, py = d[2] * e2x - d[0] * e2z, pz = d[0] * e2y - d[1] * e2x;
+    const P det = e1x * px + e1y * py + e1z * pz;
+    const auto ok = abs(det) > std::numeric_limits<T>::min();
+    const P inv = T{1} / select(ok, det, P::broadcast(T{1}));
+    const P sx = o[0] - a[0], sy = o[1] - a[1], sz = o[2] - a[2];
+    u = (sx * px + sy * py + sz * pz) * inv;
+    const P qx = sy * e1z - sz * e1y, qy = sz * e1x - sx * e1z, qz = sx * e1y - sy * e1x;
+    v = (d[0] * qx + d[1] * qy + d[2] * qz) * inv;
+    t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+    return ok && u >= T{} && v >= T{} && u + v <= T{1};
+}
+
+template<floating_point T>
+void frustum_classify_range(const frustum<T>& f, std::span<const aabb<T>> boxes, std::span<containment> out,
+                            std::size_t begin, std::size_t end) noexcept {
+    constexpr std::size_t W = geom_batch_width<T>;
+    for (std::size_t i = begin; i < end; i += W) {
+        const std::size_t count = min(W, end - i);
+        geom_lanes<T> lo[3];
+        geom_lanes<T> hi[3];
+        aabb_load(boxes.data() + i, count, lo, hi);
+        const geom_lanes<T> r = frustum_aabb_lanes(f, lo, hi);
+        for (std::size_t l = 0; l < count; ++l) out[i + l] = static_cast<containment>(static_cast<int>(r[l]));
+    }
+}
+
+} // namespace detail
+
+// out[i] = f.test(boxes[i]), geom_batch_width<T> boxes per step
+template<floating_point T>
+void classify(const frustum<T>& f, std::type_identity_t<std::span<const aabb<T>>> boxes,
+              std::span<containment> out) {
+    assert(out.size() >= boxes.size());
+    constexpr std::size_t W = geom_batch_width<T>;
+    if (boxes.size() >= detail::geom_parallel_min) {
+        //NOTE: Chunks are whole blocks so every block but the last is full
+        const std::size_t grain = (parallel_grain(boxes.size(), 16 * 1024) + W - 1) / W * W;
+        parallel_for(0, boxes.size(), grain, [&](std::size_t b, std::size_t e) {
+            detail::frustum_classify_range(f, boxes, out, b, e);
+        });
+    } else {
+        detail::frustum_classify_range(f, boxes, out, 0, boxes.size());
+    }
+}
+
+// Writes the indices of the boxes not entirely outside f, in order, and returns how many;
+// visible must hold boxes.size() indices
+template<floating_point T>
+std::size_t cull(const frustum<T>& f, std::type_identity_t<std::span<const aabb<T>>> boxes,
+                 std::span<std::uint32_t> visible) noexcept {
+    assert(visible.size() >= boxes.size());
+    constexpr std::size_t W = geom_batch_width<T>;
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < boxes.size(); i += W) {
+        const std::size_t count = min(W, boxes.size() - i);
+        detail::geom_lanes<T> lo[3];
+        detail::geom_lanes<T> hi[3];
+        detail::aabb_load(boxes.data() + i, count, lo, hi);
+        const detail::geom_lanes<T> r = detail::frustum_aabb_lanes(f, lo, hi);
+        for (std::size_t l = 0; l < count; ++l) {
+            visible[n] = static_cast<std::uint32_t>(i + l);
+            n += static_cast<std::size_t>(r[l] != static_cast<T>(containment::outside));
+        }
+    }
+    return n;
+}
+
+// t[i] = intersect(r, boxes[i], t_min, t_max): entry distance, infinity on a miss
+template<floating_point T>
+void intersect(const ray<T>& r, std::type_identity_t<std::span<const aabb<T>>> boxes,
+               std::type_identity_t<std::span<T>> t, T t_min = T{},
+               T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    assert(t.size() >= boxes.size());
+    constexpr std::size_t W = geom_batch_width<T>;
+    using P = detail::geom_lanes<T>;
+    const vec<3, T> inv = ray_inverse_direction(r);
+    const P miss = P::broadcast(std::numeric_limits<T>::infinity());
+    for (std::size_t i = 0; i < boxes.size(); i += W) {
+        const std::size_t count = min(W, boxes.size() - i);
+        P lo[3];
+        P hi[3];
+        detail::aabb_load(boxes.data() + i, count, lo, hi);
+        P tn = P::broadcast(t_min);
+        P tf = P::broadcast(t_max);
+        for (std::size_t k = 0; k < 3; ++k) {
+            const P t0 = (lo[k] - r.origin[k]) * inv[k];
+            const P t1 = (hi[k] - r.origin[k]) * inv[k];
+            tn = max(tn, min(t0, t1));
+            tf = min(tf, max(t0, t1));
+        }
+        const P hit = select(tn <= tf, tn, miss);
+        if (count == W) {
+            hit.store(t.data() + i);
+        } else {
+            for (std::size_t l = 0; l < count; ++l) t[i + l] = hit[l];
+        }
+    }
+}
+
+// Closest hit of r among tris (Moller-Trumbore, two-sided), geom_batch_width<T> per step
+template<floating_point T>
+[[nodiscard]] ray_hit<T> intersect(const ray<T>& r, std::type_identity_t<std::span<const triangle<T>>> tris,
+                                   T t_min = T{}, T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    constexpr std::size_t W = geom_batch_width<T>;
+    using P = detail::geom_lanes<T>;
+    using I = pack<detail::lane_int_t<T>, W>;
+
+    P o[3];
+    P d[3];
+    for (std::size_t k = 0; k < 3; ++k) {
+        o[k] = P::broadcast(r.origin[k]);
+        d[k] = P::broadcast(r.direction[k]);
+    }
+    I lane;
+    for (std::size_t l = 0; l < W; ++l) lane.set(l, static_cast<detail::lane_int_t<T>>(l));
+
+    //NOTE: Strict < keeps the first of equal hits, as the scalar loop does; starting one ulp
+    //      above t_max still accepts a hit at exactly t_max like scalar intersect()
+    P best_t = P::broadcast(std::nextafter(t_max, std::numeric_limits<T>::infinity()));
+    P best_u = P::broadcast(T{});
+    P best_v = P::broadcast(T{});
+    I best_i = I::broadcast(-1);
+    for (std::size_t i = 0; i < tris.size(); i += W) {
+        const std::size_t count = min(W, tris.size() - i);
+        P a[3];
+        P b[3];
+        P c[3];
+        detail::triangle_load(tris.data() + i, count, a, b, c);
+        P t;
+        P u;
+        P v;
+        const auto hit = detail::ray_triangle_lanes(o, d, a, b, c, t, u, v) && t >= t_min && t < best_t;
+        best_t = select(hit, t, best_t);
+        best_u = select(hit, u, best_u);
+        best_v = select(hit, v, best_v);
+        best_i = select(hit, lane + static_cast<detail::lane_int_t<T>>(i), best_i);
+    }
+
+    ray_hit<T> h;
+    for (std::size_t l = 0; l < W; ++l) {
+        //NOTE: Lanes hold interleaved triangles, so equal t falls back to the lower index
+        const auto i = static_cast<std::uint32_t>(best_i[l]);
+        if (best_i[l] >= 0 && (!h.hit() || best_t[l] < h.t || (best_t[l] == h.t && i < h.index))) {
+            h.t = best_t[l];
+            h.u = best_u[l];
+            h.v = best_v[l];
+            h.index = i;
+        }
+    }
+    return h;
+}
+
+} // namespace ct
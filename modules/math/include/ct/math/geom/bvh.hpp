@@ -0,0 +1,665 @@
+#pragma once
+
+#include "./primitives.hpp"
+#include "./batch.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "../common/functions.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ct {
+
+struct bvh_settings {
+    // Ranges of at most this many primitives always become leaves
+    std::uint32_t min_leaf_size{2};
+    // Ranges above this are always split; in between the SAH decides
+    std::uint32_t max_leaf_size{8};
+    // Cost of visiting a node relative to testing one primitive
+    float traversal_cost{1.0f};
+};
+
+// 32 bytes for float. Children are allocated in pairs, so an interior node only
+// stores its left child; the right one is index + 1.
+template<floating_point T>
+struct bvh_node {
+    vec<3, T> lo;
+    std::uint32_t index{0};  // leaf: first slot in bvh::primitives(), interior: left child
+    vec<3, T> hi;
+    std::uint32_t count{0};  // leaf: number of primitives, interior: 0
+
+    [[nodiscard]] constexpr bool leaf() const noexcept { return count != 0; }
+    [[nodiscard]] constexpr aabb<T> bounds() const noexcept { return aabb<T>(lo, hi); }
+};
+
+static_assert(sizeof(bvh_node<float>) == 32);
+
+// Rays traced together by the span overloads of bvh::intersect(): 8 with AVX and
+// AVX-512 for float, 4 with SSE or for double on AVX
+template<floating_point T>
+inline constexpr std::size_t bvh_packet_width = simd_lanes<T> < 8 ? simd_lanes<T> : 8;
+
+namespace detail {
+
+inline constexpr std::size_t bvh_bin_count = 16;
+
+//NOTE: Ranges larger than this are binned in parallel; smaller ones become subtrees
+// that are built on one thread each
+inline constexpr std::size_t bvh_parallel_min = 16 * 1024;
+
+//NOTE: Past this depth ranges are split at the median so the tree stays shallower
+// than the fixed traversal stacks
+inline constexpr std::size_t bvh_sah_depth = 24;
+inline constexpr std::size_t bvh_stack_size = 64;
+
+inline constexpr std::size_t bvh_packet_parallel_min = 1024;
+
+// What the build moves around: the box of one primitive and its index in the input.
+// Partitioning these instead of bare indices keeps binning a sequential scan.
+template<floating_point T>
+struct bvh_ref {
+    aabb<T> box;
+    std::uint32_t index;
+};
+
+template<floating_point T>
+struct bvh_bins {
+    std::array<std::array<aabb<T>, bvh_bin_count>, 3> box{};
+    std::array<std::array<std::uint32_t, bvh_bin_count>, 3> count{};
+
+    void merge(const bvh_bins& o) noexcept {
+        for (std::size_t a = 0; a < 3; ++a) {
+            for (std::size_t i = 0; i < bvh_bin_count; ++i) {
+                box[a][i].expand(o.box[a][i]);
+                count[a][i] += o.count[a][i];
+            }
+        }
+    }
+};
+
+// Primitives [begin, end) under node, with the bounds of their boxes and centroids
+template<floating_point T>
+struct bvh_range {
+    std::uint32_t node;
+    std::uint32_t begin;
+    std::uint32_t end;
+    std::uint32_t depth;
+    aabb<T> box;
+    aabb<T> centroids;
+};
+
+// Centroid -> bin mapping of one range; binning and partitioning use the same one
+template<floating_point T>
+struct bvh_binner {
+    vec<3, T> lo;
+    vec<3, T> scale;
+
+    explicit bvh_binner(const aabb<T>& centroids) noexcept : lo(centroids.lo) {
+        const vec<3, T> size = centroids.size();
+        for (std::size_t a = 0; a < 3; ++a) {
+            scale[a] = size[a] > T{} ? static_cast<T>(bvh_bin_count) / size[a] : T{};
+        }
+    }
+
+    [[nodiscard]] std::size_t operator()(const vec<3, T>& c, std::size_t axis) const noexcept {
+        const T f = (c[axis] - lo[axis]) * scale[axis];
+        return min(bvh_bin_count - 1, static_cast<std::size_t>(max(f, T{})));
+    }
+};
+
+template<floating_point T>
+struct bvh_packet {
+    static constexpr std::size_t width = bvh_packet_width<T>;
+    using lanes = pack<T, width>;
+    using index_lanes = pack<lane_int_t<T>, width>;
+
+    lanes o[3];
+    lanes d[3];
+    lanes inv[3];
+    lanes t_min;
+    lanes t;
+    lanes u;
+    lanes v;
+    index_lanes index;
+
+    // Lanes past count repeat the first ray; store() drops them
+    void load(const ray<T>* rays, std::size_t count, T lo, T hi) noexcept {
+        for (std::size_t l = 0; l < width; ++l) {
+            const ray<T>& r = rays[l < count ? l : 0];
+            for (std::size_t k = 0; k < 3; ++k) {
+                o[k].set(l, r.origin[k]);
+                d[k].set(l, r.direction[k]);
+            }
+        }
+        for (std::size_t k = 0; k < 3; ++k) inv[k] = T{1} / d[k];
+        t_min = lanes::broadcast(lo);
+        //NOTE: Leaves compare strictly against t; one ulp above hi still accepts a hit at
+        //      exactly hi like the single-ray intersect()
+        t = lanes::broadcast(std::nextafter(hi, std::numeric_limits<T>::infinity()));
+        u = lanes::broadcast(T{});
+        v = lanes::broadcast(T{});
+        index = index_lanes::broadcast(-1);
+    }
+
+    void store(ray_hit<T>* hits, std::size_t count) const noexcept {
+        for (std::size_t l = 0; l < count; ++l) {
+            ray_hit<T> h;
+            if (index[l] >= 0) {
+                h.t = t[l];
+                h.u = u[l];
+                h.v = v[l];
+                h.index = static_cast<std::uint32_t>(index[l]);
+            }
+            hits[l] = h;
+        }
+    }
+
+    // Slab test of every lane against b, clipped to [t_min, t]
+    [[nodiscard]] CT_FORCE_INLINE auto enters(const vec<3, T>& lo, const vec<3, T>& hi, lanes& tn) const noexcept {
+        tn = t_min;
+        lanes tf = t;
+        for (std::size_t k = 0; k < 3; ++k) {
+            const lanes t0 = (lo[k] - o[k]) * inv[k];
+            const lanes t1 = (hi[k] - o[k]) * inv[k];
+            tn = max(tn, min(t0, t1));
+            tf = min(tf, max(t0, t1));
+        }
+        return tn <= tf;
+    }
+};
+
+} // namespace detail
+
+// Bounding volume hierarchy over boxes or triangles. The tree stores primitive indices
+// only, so queries take the same span it was built from (or its refitted successor);
+// hit indices refer to that span.
+//
+// Construction bins centroids into 16 buckets per axis and splits at the lowest SAH
+// cost. The top of the tree is split with parallel binning until ranges drop below
+// 16k primitives, then those subtrees are built concurrently. Nodes are stored parent
+// before children, which lets refit() run as one reverse sweep.
+template<floating_point T>
+class bvh {
+public:
+    using value_type = T;
+    using node = bvh_node<T>;
+    using index_type = std::uint32_t;
+
+    bvh() = default;
+
+    explicit bvh(std::span<const aabb<T>> bounds, const bvh_settings& settings = {}) { build(bounds, settings); }
+    explicit bvh(std::span<const triangle<T>> tris, const bvh_settings& settings = {}) { build(tris, settings); }
+
+    void build(std::span<const aabb<T>> bounds, const bvh_settings& settings = {}) {
+        build_with(bounds.size(), settings, [&](std::size_t i) { return bounds[i]; });
+    }
+
+    void build(std::span<const triangle<T>> tris, const bvh_settings& settings = {}) {
+        build_with(tris.size(), settings, [&](std::size_t i) { return tris[i].bounds(); });
+    }
+
+    // Recomputes every node box for moved primitives, keeping the topology. Cheap
+    // compared to build(), but the tree degrades as primitives drift from where
+    // they were at build time.
+    void refit(std::span<const aabb<T>> bounds) {
+        assert(bounds.size() == indices_.size());
+        refit_with([&](index_type i) { return bounds[i]; });
+    }
+
+    void refit(std::span<const triangle<T>> tris) {
+        assert(tris.size() == indices_.size());
+        refit_with([&](index_type i) { return tris[i].bounds(); });
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return nodes_.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return indices_.size(); }
+    [[nodiscard]] aabb<T> bounds() const noexcept { return empty() ? aabb<T>{} : nodes_[0].bounds(); }
+
+    // Node 0 is the root; leaves cover primitives()[index, index + count)
+    [[nodiscard]] std::span<const node> nodes() const noexcept { return nodes_; }
+    [[nodiscard]] std::span<const index_type> primitives() const noexcept { return indices_; }
+
+    // Closest-hit traversal, nearer child first. fn(i, hit) tests primitive i against r
+    // within [t_min, hit.t] and overwrites hit when it finds a closer one.
+    template<typename F>
+    void traverse(const ray<T>& r, ray_hit<T>& hit, F&& fn, T t_min = T{}) const {
+        if (empty()) return;
+        const vec<3, T> inv = ray_inverse_direction(r);
+        struct entry {
+            index_type node;
+            T t;
+        };
+        std::array<entry, detail::bvh_stack_size> stack;
+        std::size_t sp = 0;
+        auto enter = [&](const node& nd) { return ct::intersect(r.origin, inv, nd.bounds(), t_min, hit.t); };
+        //NOTE: A miss is infinity, which an unbounded hit.t does not reject by itself
+        auto reaches = [&](T t) { return t != std::numeric_limits<T>::infinity() && t <= hit.t; };
+        entry cur{0, enter(nodes_[0])};
+        if (!reaches(cur.t)) return;
+        for (;;) {
+            const node& nd = nodes_[cur.node];
+            if (nd.leaf()) {
+                for (index_type k = nd.index; k < nd.index + nd.count; ++k) fn(indices_[k], hit);
+            } else {
+                const T tl = enter(nodes_[nd.index]);
+                const T tr = enter(nodes_[nd.index + 1]);
+                const bool hl = reaches(tl);
+                const bool hr = reaches(tr);
+                if (hl && hr) {
+                    const bool left_first = tl <= tr;
+                    assert(sp < stack.size());
+                    stack[sp++] = left_first ? entry{nd.index + 1, tr} : entry{nd.index, tl};
+                    cur = left_first ? entry{nd.index, tl} : entry{nd.index + 1, tr};
+                    continue;
+                }
+                if (hl || hr) {
+                    cur = hl ? entry{nd.index, tl} : entry{nd.index + 1, tr};
+                    continue;
+                }
+            }
+            // Pop, skipping subtrees that start beyond a hit found meanwhile
+            do {
+                if (sp == 0) return;
+                cur = stack[--sp];
+            } while (cur.t > hit.t);
+        }
+    }
+
+    [[nodiscard]] ray_hit<T> intersect(const ray<T>& r, std::span<const triangle<T>> tris, T t_min = T{},
+                                       T t_max = std::numeric_limits<T>::infinity()) const {
+        ray_hit<T> hit;
+        hit.t = t_max;
+        traverse(r, hit, [&](index_type i, ray_hit<T>& best) {
+            const ray_hit<T> h = ct::intersect(r, tris[i], t_min, best.t);
+            if (h.hit() && (!best.hit() || h.t < best.t)) {
+                best = h;
+                best.index = i;
+            }
+        }, t_min);
+        if (!hit.hit()) hit.t = std::numeric_limits<T>::infinity();
+        return hit;
+    }
+
+    [[nodiscard]] ray_hit<T> intersect(const ray<T>& r, std::span<const aabb<T>> boxes, T t_min = T{},
+                                       T t_max = std::numeric_limits<T>::infinity()) const {
+        ray_hit<T> hit;
+        hit.t = t_max;
+        const vec<3, T> inv = ray_inverse_direction(r);
+        traverse(r, hit, [&](index_type i, ray_hit<T>& best) {
+            const T t = ct::intersect(r.origin, inv, boxes[i], t_min, best.t);
+            if (t != std::numeric_limits<T>::infinity() && (!best.hit() || t < best.t)) {
+                best.t = t;
+                best.index = i;
+            }
+        }, t_min);
+        if (!hit.hit()) hit.t = std::numeric_limits<T>::infinity();
+        return hit;
+    }
+
+    // hits[i] = intersect(rays[i], tris, ...), tracing bvh_packet_width<T> rays per
+    // traversal with one box test for the whole packet per node. Pays off when the rays
+    // of a packet are coherent (neighbouring pixels of a camera, a picking grid).
+    void intersect(std::span<const ray<T>> rays, std::span<const triangle<T>> tris, std::span<ray_hit<T>> hits,
+                   T t_min = T{}, T t_max = std::numeric_limits<T>::infinity()) const {
+        using packet = detail::bvh_packet<T>;
+        using lanes = typename packet::lanes;
+        using index_lanes = typename packet::index_lanes;
+        trace_packets(rays, hits, t_min, t_max, [&](index_type i, packet& p) {
+            const triangle<T>& tri = tris[i];
+            lanes a[3];
+            lanes b[3];
+            lanes c[3];
+            for (std::size_t k = 0; k < 3; ++k) {
+                a[k] = lanes::broadcast(tri.a[k]);
+                b[k] = lanes::broadcast(tri.b[k]);
+                c[k] = lanes::broadcast(tri.c[k]);
+            }
+            lanes t;
+            lanes u;
+            lanes v;
+            const auto hit = detail::ray_triangle_lanes(p.o, p.d, a, b, c, t, u, v) && t >= p.t_min && t < p.t;
+            p.t = select(hit, t, p.t);
+            p.u = select(hit, u, p.u);
+            p.v = select(hit, v, p.v);
+            p.index = select(hit, index_lanes::broadcast(static_cast<detail::lane_int_t<T>>(i)), p.index);
+        });
+    }
+
+    void intersect(std::span<const ray<T>> rays, std::span<const aabb<T>> boxes, std::span<ray_hit<T>> hits,
+                   T t_min = T{}, T t_max = std::numeric_limits<T>::infinity()) const {
+        using packet = detail::bvh_packet<T>;
+        using lanes = typename packet::lanes;
+        using index_lanes = typename packet::index_lanes;
+        trace_packets(rays, hits, t_min, t_max, [&](index_type i, packet& p) {
+            lanes tn;
+            const auto hit = p.enters(boxes[i].lo, boxes[i].hi, tn) && tn < p.t;
+            p.t = select(hit, tn, p.t);
+            p.index = select(hit, index_lanes::broadcast(static_cast<detail::lane_int_t<T>>(i)), p.index);
+        });
+    }
+
+    // Calls fn(i) for every primitive stored in a leaf whose box overlaps the query;
+    // the candidates still have to be tested against the primitives themselves
+    template<typename F>
+    void query(const aabb<T>& box, F&& fn) const {
+        visit([&](const node& nd) { return nd.bounds().overlaps(box); }, fn);
+    }
+
+    template<typename F>
+    void query(const sphere<T>& s, F&& fn) const {
+        visit([&](const node& nd) { return s.overlaps(nd.bounds()); }, fn);
+    }
+
+private:
+    [[nodiscard]] static node make_node(const aabb<T>& box) noexcept {
+        node nd;
+        nd.lo = box.lo;
+        nd.hi = box.hi;
+        return nd;
+    }
+
+    template<typename F>
+    void build_with(std::size_t n, const bvh_settings& settings, F&& bound_of) {
+        assert(n < std::numeric_limits<index_type>::max());
+        assert(settings.min_leaf_size >= 1 && settings.min_leaf_size <= settings.max_leaf_size);
+        nodes_.clear();
+        indices_.resize(n);
+        if (n == 0) return;
+
+        std::vector<detail::bvh_ref<T>> refs(n);
+        detail::bvh_range<T> root{0, 0, static_cast<index_type>(n), 0, {}, {}};
+        {
+            const std::size_t grain = parallel_grain(n, 16 * 1024);
+            std::vector<detail::bvh_range<T>> partial((n + grain - 1) / grain);
+            parallel_for(0, n, grain, [&](std::size_t b, std::size_t e) {
+                detail::bvh_range<T>& p = partial[b / grain];
+                for (std::size_t i = b; i < e; ++i) {
+                    refs[i] = {bound_of(i), static_cast<index_type>(i)};
+                    p.box.expand(refs[i].box);
+                    p.centroids.expand(refs[i].box.center());
+                }
+            });
+            for (const auto& p : partial) {
+                root.box.expand(p.box);
+                root.centroids.expand(p.centroids);
+            }
+        }
+        nodes_.push_back(make_node(root.box));
+
+        std::vector<detail::bvh_range<T>> jobs;
+        std::vector<detail::bvh_range<T>> frontier{root};
+        while (!frontier.empty()) {
+            const detail::bvh_range<T> r = frontier.back();
+            frontier.pop_back();
+            if (r.end - r.begin <= detail::bvh_parallel_min) {
+                jobs.push_back(r);
+                continue;
+            }
+            split(refs, settings, r, nodes_, frontier, true);
+        }
+
+        // Largest first so the pool's dynamic scheduling balances the tail
+        std::sort(jobs.begin(), jobs.end(), [](const auto& x, const auto& y) {
+            return x.end - x.begin > y.end - y.begin;
+        });
+        std::vector<std::vector<node>> subtrees(jobs.size());
+        parallel_for(0, jobs.size(), 1, [&](std::size_t jb, std::size_t je) {
+            for (std::size_t j = jb; j < je; ++j) {
+                detail::bvh_range<T> r = jobs[j];
+                std::vector<node>& out = subtrees[j];
+                out.reserve(2 * (r.end - r.begin) / settings.min_leaf_size);
+                out.push_back(make_node(r.box));
+                r.node = 0;
+                std::vector<detail::bvh_range<T>> stack{r};
+                while (!stack.empty()) {
+                    const detail::bvh_range<T> s = stack.back();
+                    stack.pop_back();
+                    split(refs, settings, s, out, stack, false);
+                }
+            }
+        });
+
+        // Subtree roots go to the slots their parents reserved, the rest is appended
+        for (std::size_t j = 0; j < jobs.size(); ++j) {
+            const std::vector<node>& sub = subtrees[j];
+            const auto base = static_cast<index_type>(nodes_.size() - 1);
+            auto relocate = [&](node nd) {
+                if (!nd.leaf()) nd.index += base;
+                return nd;
+            };
+            nodes_[jobs[j].node] = relocate(sub[0]);
+            for (std::size_t k = 1; k < sub.size(); ++k) nodes_.push_back(relocate(sub[k]));
+        }
+
+        parallel_for(0, n, parallel_grain(n, 64 * 1024), [&](std::size_t b, std::size_t e) {
+            for (std::size_t k = b; k < e; ++k) indices_[k] = refs[k].index;
+        });
+    }
+
+    static void bin(std::span<const detail::bvh_ref<T>> refs, const detail::bvh_binner<T>& binner,
+                    detail::bvh_bins<T>& bins, bool parallel) {
+        auto fill = [&](std::size_t begin, std::size_t end, detail::bvh_bins<T>& out) {
+            for (std::size_t k = begin; k < end; ++k) {
+                const aabb<T>& box = refs[k].box;
+                const vec<3, T> c = box.center();
+                for (std::size_t a = 0; a < 3; ++a) {
+                    const std::size_t j = binner(c, a);
+                    out.box[a][j].expand(box);
+                    ++out.count[a][j];
+                }
+            }
+        };
+        if (!parallel) {
+            fill(0, refs.size(), bins);
+            return;
+        }
+        //NOTE: Chunk partials are merged in chunk order, so the tree does not depend on
+        // the thread count
+        const std::size_t grain = parallel_grain(refs.size(), 4096);
+        std::vector<detail::bvh_bins<T>> partial((refs.size() + grain - 1) / grain);
+        parallel_for(0, refs.size(), grain, [&](std::size_t begin, std::size_t end) {
+            fill(begin, end, partial[begin / grain]);
+        });
+        for (const auto& p : partial) bins.merge(p);
+    }
+
+    // Turns r into a leaf or splits it, appending both children to out and their
+    // ranges to pending
+    void split(std::vector<detail::bvh_ref<T>>& refs, const bvh_settings& settings, const detail::bvh_range<T>& r,
+               std::vector<node>& out, std::vector<detail::bvh_range<T>>& pending, bool parallel) {
+        const std::uint32_t n = r.end - r.begin;
+        auto make_leaf = [&] {
+            out[r.node].index = r.begin;
+            out[r.node].count = n;
+        };
+        if (n <= settings.min_leaf_size) {
+            make_leaf();
+            return;
+        }
+
+        const auto first = refs.begin() + r.begin;
+        const auto last = refs.begin() + r.end;
+        const detail::bvh_binner<T> binner(r.centroids);
+        std::size_t axis = 3;
+        std::size_t split_bin = 0;
+        T best = std::numeric_limits<T>::infinity();
+        detail::bvh_bins<T> bins;
+        const bool spread = binner.scale.x > T{} || binner.scale.y > T{} || binner.scale.z > T{};
+        if (r.depth < detail::bvh_sah_depth && spread) {
+            bin(std::span<const detail::bvh_ref<T>>(refs).subspan(r.begin, n), binner, bins, parallel);
+            for (std::size_t a = 0; a < 3; ++a) {
+                if (binner.scale[a] == T{}) continue;
+                // right[j]: SAH term of bins [j, count)
+                std::array<T, detail::bvh_bin_count> right{};
+                aabb<T> box;
+                std::uint32_t cnt = 0;
+                for (std::size_t j = detail::bvh_bin_count - 1; j > 0; --j) {
+                    box.expand(bins.box[a][j]);
+                    cnt += bins.count[a][j];
+                    right[j] = cnt ? box.surface_area() * static_cast<T>(cnt) : T{};
+                }
+                box = aabb<T>{};
+                cnt = 0;
+                for (std::size_t j = 0; j + 1 < detail::bvh_bin_count; ++j) {
+                    box.expand(bins.box[a][j]);
+                    cnt += bins.count[a][j];
+                    if (cnt == 0 || cnt == n) continue;
+                    const T cost = box.surface_area() * static_cast<T>(cnt) + right[j + 1];
+                    if (cost < best) {
+                        best = cost;
+                        axis = a;
+                        split_bin = j;
+                    }
+                }
+            }
+        }
+
+        const T area = r.box.surface_area();
+        const T split_cost = static_cast<T>(settings.traversal_cost) + (area > T{} ? best / area : T{});
+        if (n <= settings.max_leaf_size && (axis == 3 || split_cost >= static_cast<T>(n))) {
+            make_leaf();
+            return;
+        }
+
+        detail::bvh_range<T> left{0, r.begin, 0, r.depth + 1, {}, {}};
+        detail::bvh_range<T> right{0, 0, r.end, r.depth + 1, {}, {}};
+        decltype(refs.begin()) mid;
+        if (axis != 3) {
+            mid = std::partition(first, last, [&](const detail::bvh_ref<T>& ref) {
+                return binner(ref.box.center(), axis) <= split_bin;
+            });
+        } else {
+            // All centroids coincide, or the tree got too deep: halve along the widest axis
+            const vec<3, T> size = r.centroids.size();
+            const std::size_t a = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+            mid = first + n / 2;
+            std::nth_element(first, mid, last, [&](const detail::bvh_ref<T>& x, const detail::bvh_ref<T>& y) {
+                return x.box.lo[a] + x.box.hi[a] < y.box.lo[a] + y.box.hi[a];
+            });
+        }
+        left.end = right.begin = static_cast<index_type>(mid - refs.begin());
+        for (auto it = first; it != last; ++it) {
+            detail::bvh_range<T>& side = it < mid ? left : right;
+            side.box.expand(it->box);
+            side.centroids.expand(it->box.center());
+        }
+
+        left.node = static_cast<index_type>(out.size());
+        right.node = left.node + 1;
+        out[r.node].index = left.node;
+        out[r.node].count = 0;
+        out.push_back(make_node(left.box));
+        out.push_back(make_node(right.box));
+        pending.push_back(right);
+        pending.push_back(left);
+    }
+
+    template<typename F>
+    void refit_with(F&& bound_of) {
+        const std::size_t n = nodes_.size();
+        parallel_for(0, n, parallel_grain(n, 8192), [&](std::size_t b, std::size_t e) {
+            for (std::size_t k = b; k < e; ++k) {
+                node& nd = nodes_[k];
+                if (!nd.leaf()) continue;
+                aabb<T> box;
+                for (index_type j = nd.index; j < nd.index + nd.count; ++j) box.expand(bound_of(indices_[j]));
+                nd.lo = box.lo;
+                nd.hi = box.hi;
+            }
+        });
+        // Children always follow their parent
+        for (std::size_t k = n; k-- > 0;) {
+            node& nd = nodes_[k];
+            if (nd.leaf()) continue;
+            const aabb<T> box = merge(nodes_[nd.index].bounds(), nodes_[nd.index + 1].bounds());
+            nd.lo = box.lo;
+            nd.hi = box.hi;
+        }
+    }
+
+    template<typename Leaf>
+    void trace_packets(std::span<const ray<T>> rays, std::span<ray_hit<T>> hits, T t_min, T t_max,
+                       Leaf&& leaf) const {
+        assert(hits.size() >= rays.size());
+        using packet = detail::bvh_packet<T>;
+        constexpr std::size_t W = packet::width;
+        auto run = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i += W) {
+                const std::size_t count = min(W, end - i);
+                packet p;
+                p.load(rays.data() + i, count, t_min, t_max);
+                if (!empty()) trace_packet(p, leaf);
+                p.store(hits.data() + i, count);
+            }
+        };
+        if (rays.size() >= detail::bvh_packet_parallel_min) {
+            const std::size_t grain = (parallel_grain(rays.size(), 256) + W - 1) / W * W;
+            parallel_for(0, rays.size(), grain, run);
+        } else {
+            run(0, rays.size());
+        }
+    }
+
+    // Every node is tested once for the whole packet; children are visited in the order
+    // that suits the packet's first ray
+    template<typename Leaf>
+    void trace_packet(detail::bvh_packet<T>& p, Leaf& leaf) const {
+        typename detail::bvh_packet<T>::lanes tn;
+        const vec<3, T> dir(p.d[0][0], p.d[1][0], p.d[2][0]);
+        std::array<index_type, detail::bvh_stack_size> stack;
+        std::size_t sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            const node& nd = nodes_[stack[--sp]];
+            if (!any(p.enters(nd.lo, nd.hi, tn))) continue;
+            if (nd.leaf()) {
+                for (index_type k = nd.index; k < nd.index + nd.count; ++k) leaf(indices_[k], p);
+                continue;
+            }
+            const node& l = nodes_[nd.index];
+            const node& r = nodes_[nd.index + 1];
+            const vec<3, T> gap = (r.lo + r.hi) - (l.lo + l.hi);
+            const std::size_t a = abs(gap.x) >= abs(gap.y) && abs(gap.x) >= abs(gap.z) ? 0 : (abs(gap.y) >= abs(gap.z) ? 1 : 2);
+            const bool left_first = (gap[a] >= T{}) == (dir[a] >= T{});
+            assert(sp + 2 <= stack.size());
+            stack[sp++] = left_first ? nd.index + 1 : nd.index;
+            stack[sp++] = left_first ? nd.index : nd.index + 1;
+        }
+    }
+
+    template<typename Test, typename F>
+    void visit(Test&& test, F& fn) const {
+        if (empty() || !test(nodes_[0])) return;
+        std::array<index_type, detail::bvh_stack_size> stack;
+        std::size_t sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            const node& nd = nodes_[stack[--sp]];
+            if (nd.leaf()) {
+                for (index_type k = nd.index; k < nd.index + nd.count; ++k) fn(indices_[k]);
+                continue;
+            }
+            for (index_type c = nd.index; c < nd.index + 2; ++c) {
+                if (test(nodes_[c])) {
+                    assert(sp < stack.size());
+                    stack[sp++] = c;
+                }
+            }
+        }
+    }
+
+    std::vector<node> nodes_;
+    std::vector<index_type> indices_;
+};
+
+} // namespace ct
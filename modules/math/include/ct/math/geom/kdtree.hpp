@@ -0,0 +1,455 @@
+#pragma once
+
+#include "./primitives.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/pack.hpp"
+#include "../common/functions.hpp"
+#include "../vec/vec3.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ct {
+
+template<floating_point T>
+struct kd_neighbor {
+    static constexpr std::uint32_t none = ~std::uint32_t{0};
+
+    std::uint32_t index = none;
+    T distance_squared = std::numeric_limits<T>::infinity();
+};
+
+struct kd_search_settings {
+    // Stop a k-NN search after this many leaves, 0 for exact search. The first leaf is
+    // the one containing the query; later ones follow depth-first, near side before far,
+    // so the cap is a budget rather than a closest-leaves guarantee.
+    std::size_t max_leaves{0};
+    // Skip subtrees unless they may hold a point closer than 1 / (1 + epsilon) times
+    // the current k-th distance; results are then within (1 + epsilon) of the true ones
+    double epsilon{0.0};
+};
+
+namespace detail {
+
+inline constexpr std::size_t kd_stack_size = 64;
+
+//NOTE: Below this many queries a batch runs on the calling thread
+inline constexpr std::size_t kd_parallel_min = 256;
+
+// Bounded max-heap of the k best candidates so far, kept in caller storage
+template<floating_point T>
+struct kd_heap {
+    kd_neighbor<T>* data;
+    std::size_t k;
+    std::size_t size = 0;
+
+    [[nodiscard]] T worst() const noexcept {
+        return size < k ? std::numeric_limits<T>::infinity() : data[0].distance_squared;
+    }
+
+    void push(std::uint32_t index, T d2) noexcept {
+        auto less = [](const kd_neighbor<T>& a, const kd_neighbor<T>& b) {
+            return a.distance_squared < b.distance_squared;
+        };
+        if (size < k) {
+            data[size++] = {index, d2};
+            std::push_heap(data, data + size, less);
+        } else if (d2 < data[0].distance_squared) {
+            std::pop_heap(data, data + size, less);
+            data[size - 1] = {index, d2};
+            std::push_heap(data, data + size, less);
+        }
+    }
+
+    // Sorts the candidates nearest first and pads the remaining slots
+    void finish() noexcept {
+        std::sort_heap(data, data + size, [](const kd_neighbor<T>& a, const kd_neighbor<T>& b) {
+            return a.distance_squared < b.distance_squared;
+        });
+        for (std::size_t i = size; i < k; ++i) data[i] = kd_neighbor<T>{};
+    }
+};
+
+// out[q * k, q * k + k) = query(queries[q], heap) for every query, in parallel
+template<floating_point T, typename Query>
+void kd_batch_knn(std::span<const vec<3, T>> queries, std::size_t k, std::span<kd_neighbor<T>> out,
+                  const Query& query) {
+    assert(out.size() >= queries.size() * k);
+    auto run = [&](std::size_t b, std::size_t e) {
+        for (std::size_t q = b; q < e; ++q) {
+            kd_heap<T> heap{out.data() + q * k, k};
+            query(queries[q], heap);
+            heap.finish();
+        }
+    };
+    if (queries.size() >= kd_parallel_min) {
+        parallel_for(0, queries.size(), parallel_grain(queries.size(), 64), run);
+    } else {
+        run(0, queries.size());
+    }
+}
+
+// Neighbors of queries[q] end up in out[offsets[q], offsets[q + 1]); chunks collect
+// their results separately and are concatenated in order
+template<floating_point T, typename Query>
+void kd_batch_radius(std::span<const vec<3, T>> queries, std::vector<std::uint32_t>& offsets,
+                     std::vector<kd_neighbor<T>>& out, const Query& query) {
+    offsets.assign(queries.size() + 1, 0);
+    out.clear();
+    const std::size_t grain = queries.size() >= kd_parallel_min ? parallel_grain(queries.size(), 64)
+                                                                : max(queries.size(), std::size_t{1});
+    std::vector<std::vector<kd_neighbor<T>>> partial((queries.size() + grain - 1) / grain);
+    parallel_for(0, queries.size(), grain, [&](std::size_t b, std::size_t e) {
+        std::vector<kd_neighbor<T>>& found = partial[b / grain];
+        for (std::size_t q = b; q < e; ++q) {
+            const std::size_t before = found.size();
+            query(queries[q], found);
+            offsets[q + 1] = static_cast<std::uint32_t>(found.size() - before);
+        }
+    });
+    for (std::size_t q = 0; q < queries.size(); ++q) offsets[q + 1] += offsets[q];
+    out.reserve(offsets.back());
+    for (const auto& p : partial) out.insert(out.end(), p.begin(), p.end());
+}
+
+} // namespace detail
+
+// Static KD-tree over a point cloud. The tree is implicit: a complete binary tree of
+// median splits whose node i has children 2i + 1 and 2i + 2, so only the split value
+// and axis of each interior node are stored. Leaves are buckets of about bucket_size
+// points kept contiguous in structure-of-arrays form and scanned in SIMD lanes.
+//
+// The build splits every level in parallel. Results report the position of each point
+// in the span given at construction, or the matching entry of ids when given.
+template<floating_point T>
+class kd_tree {
+public:
+    using value_type = T;
+    using neighbor = kd_neighbor<T>;
+
+    kd_tree() = default;
+
+    explicit kd_tree(std::span<const vec<3, T>> points, std::size_t bucket_size = 16)
+        : kd_tree(points, {}, bucket_size) {}
+
+    kd_tree(std::span<const vec<3, T>> points, std::span<const std::uint32_t> ids, std::size_t bucket_size = 16) {
+        assert(ids.empty() || ids.size() == points.size());
+        assert(bucket_size >= 1);
+        build(points, ids, bucket_size);
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return ids_.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return ids_.size(); }
+    [[nodiscard]] std::size_t depth() const noexcept { return depth_; }
+
+    // Bucket order: point(i) has id ids()[i]
+    [[nodiscard]] vec<3, T> point(std::size_t i) const noexcept { return vec<3, T>(x_[i], y_[i], z_[i]); }
+    [[nodiscard]] std::span<const std::uint32_t> ids() const noexcept { return ids_; }
+
+    // The min(k, size()) nearest points to q, nearest first; out must hold k entries and
+    // any beyond size() are left as kd_neighbor{}. Returns the number found.
+    std::size_t knn(const vec<3, T>& q, std::size_t k, std::span<neighbor> out,
+                    const kd_search_settings& settings = {}) const noexcept {
+        assert(out.size() >= k);
+        detail::kd_heap<T> heap{out.data(), k};
+        search_knn(q, heap, settings);
+        heap.finish();
+        return heap.size;
+    }
+
+    // out[i * k, i * k + k) = knn(queries[i], k), queries spread over the pool
+    void knn(std::span<const vec<3, T>> queries, std::size_t k, std::span<neighbor> out,
+             const kd_search_settings& settings = {}) const {
+        detail::kd_batch_knn<T>(queries, k, out, [&](const vec<3, T>& q, detail::kd_heap<T>& heap) {
+            search_knn(q, heap, settings);
+        });
+    }
+
+    // Appends every point within r of q to out, in no particular order
+    void radius(const vec<3, T>& q, T r, std::vector<neighbor>& out) const { search_radius(q, r * r, out); }
+
+    // Neighbors of queries[i] are out[offsets[i], offsets[i + 1])
+    void radius(std::span<const vec<3, T>> queries, T r, std::vector<std::uint32_t>& offsets,
+                std::vector<neighbor>& out) const {
+        detail::kd_batch_radius<T>(queries, offsets, out, [&](const vec<3, T>& q, std::vector<neighbor>& found) {
+            search_radius(q, r * r, found);
+        });
+    }
+
+    // Continues a k-NN search in heap, which may already hold candidates from elsewhere
+    void search_knn(const vec<3, T>& q, detail::kd_heap<T>& heap, const kd_search_settings& settings) const noexcept {
+        if (empty() || heap.k == 0) return;
+        const T slack = static_cast<T>((1.0 + settings.epsilon) * (1.0 + settings.epsilon));
+        std::array<cell, detail::kd_stack_size> stack;
+        std::size_t sp = 0;
+        stack[sp++] = cell{};
+        std::size_t leaves = 0;
+        while (sp > 0) {
+            cell c = stack[--sp];
+            if (c.bound * slack > heap.worst()) continue;
+            // Descend to the leaf on the query's side, deferring the far children
+            while (c.node < interior_) {
+                const std::uint8_t a = axis_[c.node];
+                const T off = q[a] - split_[c.node];
+                const std::uint32_t near = 2 * c.node + (off < T{} ? 1 : 2);
+                const cell far = c.across(a, off, off < T{} ? near + 1 : near - 1);
+                if (far.bound * slack <= heap.worst()) {
+                    assert(sp < stack.size());
+                    stack[sp++] = far;
+                }
+                c.node = near;
+            }
+            scan_knn(q, c.node - interior_, heap);
+            if (settings.max_leaves != 0 && ++leaves >= settings.max_leaves) return;
+        }
+    }
+
+    // Appends the points with squared distance at most r2
+    void search_radius(const vec<3, T>& q, T r2, std::vector<neighbor>& out) const {
+        if (empty()) return;
+        std::array<cell, detail::kd_stack_size> stack;
+        std::size_t sp = 0;
+        stack[sp++] = cell{};
+        while (sp > 0) {
+            cell c = stack[--sp];
+            while (c.node < interior_) {
+                const std::uint8_t a = axis_[c.node];
+                const T off = q[a] - split_[c.node];
+                const std::uint32_t near = 2 * c.node + (off < T{} ? 1 : 2);
+                const cell far = c.across(a, off, off < T{} ? near + 1 : near - 1);
+                if (far.bound <= r2) {
+                    assert(sp < stack.size());
+                    stack[sp++] = far;
+                }
+                c.node = near;
+            }
+            const std::size_t leaf = c.node - interior_;
+            for (std::size_t i = leaf_begin(leaf), end = leaf_begin(leaf + 1); i < end; ++i) {
+                const T d2 = distance_squared(q, i);
+                if (d2 <= r2) out.push_back({ids_[i], d2});
+            }
+        }
+    }
+
+private:
+    // Subtree still to visit, with the squared distance from the query to its cell
+    // accumulated per axis (Arya and Mount): crossing a split on an axis replaces that
+    // axis' term instead of taking the max, which bounds the cell much more tightly
+    struct cell {
+        std::uint32_t node = 0;
+        T bound{};
+        std::array<T, 3> off{};
+
+        [[nodiscard]] cell across(std::uint8_t a, T d, std::uint32_t child) const noexcept {
+            cell c = *this;
+            c.node = child;
+            c.bound += d * d - off[a] * off[a];
+            c.off[a] = d;
+            return c;
+        }
+    };
+
+    [[nodiscard]] std::size_t leaf_begin(std::size_t leaf) const noexcept {
+        return static_cast<std::size_t>(static_cast<std::uint64_t>(leaf) * ids_.size() >> depth_);
+    }
+
+    [[nodiscard]] T distance_squared(const vec<3, T>& q, std::size_t i) const noexcept {
+        const T dx = x_[i] - q.x;
+        const T dy = y_[i] - q.y;
+        const T dz = z_[i] - q.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Distances of a whole bucket in lanes; only lanes that beat the current k-th
+    // candidate reach the heap
+    void scan_knn(const vec<3, T>& q, std::size_t leaf, detail::kd_heap<T>& heap) const noexcept {
+        using P = pack<T, simd_lanes<T>>;
+        constexpr std::size_t W = P::width;
+        std::size_t i = leaf_begin(leaf);
+        const std::size_t end = leaf_begin(leaf + 1);
+        for (; i + W <= end; i += W) {
+            const P dx = P::load(x_.data() + i) - q.x;
+            const P dy = P::load(y_.data() + i) - q.y;
+            const P dz = P::load(z_.data() + i) - q.z;
+            const P d2 = dx * dx + dy * dy + dz * dz;
+            if (!any(d2 < heap.worst())) continue;
+            for (std::size_t l = 0; l < W; ++l) {
+                if (d2[l] < heap.worst()) heap.push(ids_[i + l], d2[l]);
+            }
+        }
+        for (; i < end; ++i) {
+            const T d2 = distance_squared(q, i);
+            if (d2 < heap.worst()) heap.push(ids_[i], d2);
+        }
+    }
+
+    void build(std::span<const vec<3, T>> points, std::span<const std::uint32_t> ids, std::size_t bucket_size) {
+        const std::size_t n = points.size();
+        assert(n < std::numeric_limits<std::uint32_t>::max());
+        depth_ = 0;
+        while ((n >> depth_) > bucket_size) ++depth_;
+        assert(depth_ < detail::kd_stack_size);
+        interior_ = (std::uint32_t{1} << depth_) - 1;
+        split_.assign(interior_, T{});
+        axis_.assign(interior_, 0);
+        ids_.resize(n);
+
+        struct item {
+            vec<3, T> p;
+            std::uint32_t id;
+        };
+        std::vector<item> items(n);
+        parallel_for(0, n, parallel_grain(n, 64 * 1024), [&](std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; ++i) {
+                items[i] = {points[i], ids.empty() ? static_cast<std::uint32_t>(i) : ids[i]};
+            }
+        });
+
+        // Level by level: every node of a level owns a disjoint range, so they split in
+        // parallel. Each node splits its widest axis at the median of its leaf range.
+        for (std::size_t level = 0; level < depth_; ++level) {
+            const std::size_t first = (std::size_t{1} << level) - 1;
+            const std::size_t count = std::size_t{1} << level;
+            const std::size_t span_leaves = std::size_t{1} << (depth_ - level);
+            auto split_nodes = [&](std::size_t b, std::size_t e) {
+                for (std::size_t k = b; k < e; ++k) {
+                    const auto lo = items.begin() + static_cast<std::ptrdiff_t>(leaf_begin(k * span_leaves));
+                    const auto hi = items.begin() + static_cast<std::ptrdiff_t>(leaf_begin((k + 1) * span_leaves));
+                    const auto mid = items.begin() +
+                                     static_cast<std::ptrdiff_t>(leaf_begin(k * span_leaves + span_leaves / 2));
+                    aabb<T> box;
+                    for (auto it = lo; it != hi; ++it) box.expand(it->p);
+                    const vec<3, T> size = box.size();
+                    const std::uint8_t a = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+                    std::nth_element(lo, mid, hi, [a](const item& x, const item& y) { return x.p[a] < y.p[a]; });
+                    axis_[first + k] = a;
+                    split_[first + k] = mid == hi ? T{} : mid->p[a];
+                }
+            };
+            const std::size_t per_node = n >> level;
+            parallel_for(0, count, max(std::size_t{1}, (64 * 1024) / max(per_node, std::size_t{1})), split_nodes);
+        }
+
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+        parallel_for(0, n, parallel_grain(n, 64 * 1024), [&](std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; ++i) {
+                x_[i] = items[i].p.x;
+                y_[i] = items[i].p.y;
+                z_[i] = items[i].p.z;
+                ids_[i] = items[i].id;
+            }
+        });
+    }
+
+    std::size_t depth_ = 0;
+    std::uint32_t interior_ = 0;  // interior nodes, leaf j is node interior_ + j
+    std::vector<T> split_;
+    std::vector<std::uint8_t> axis_;
+    aligned_vector<T> x_;
+    aligned_vector<T> y_;
+    aligned_vector<T> z_;
+    std::vector<std::uint32_t> ids_;
+};
+
+// Point set that grows by insertion: a few static kd_trees whose sizes at least double
+// from one to the next, plus a small unindexed buffer. A full buffer becomes a tree,
+// merging with the smaller trees it catches up with, so every point is rebuilt into
+// O(log n) trees over its lifetime. Queries search every tree and the buffer.
+// Ids are insertion order.
+template<floating_point T>
+class kd_forest {
+public:
+    using value_type = T;
+    using neighbor = kd_neighbor<T>;
+
+    explicit kd_forest(std::size_t bucket_size = 16, std::size_t buffer_size = 1024)
+        : bucket_size_(bucket_size), buffer_size_(buffer_size) {}
+
+    [[nodiscard]] std::size_t size() const noexcept { return points_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return points_.empty(); }
+    [[nodiscard]] std::size_t trees() const noexcept { return trees_.size(); }
+    [[nodiscard]] const vec<3, T>& point(std::uint32_t id) const noexcept { return points_[id]; }
+
+    void insert(const vec<3, T>& p) { insert(std::span<const vec<3, T>>(&p, 1)); }
+
+    void insert(std::span<const vec<3, T>> points) {
+        assert(points_.size() + points.size() < std::numeric_limits<std::uint32_t>::max());
+        points_.insert(points_.end(), points.begin(), points.end());
+        if (points_.size() - buffered_ < buffer_size_) return;
+
+        std::vector<std::uint32_t> ids(points_.size() - buffered_);
+        for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = static_cast<std::uint32_t>(buffered_ + i);
+        buffered_ = points_.size();
+        while (!trees_.empty() && trees_.back().size() <= ids.size()) {
+            const auto old = trees_.back().ids();
+            ids.insert(ids.end(), old.begin(), old.end());
+            trees_.pop_back();
+        }
+        std::vector<vec<3, T>> pts(ids.size());
+        for (std::size_t i = 0; i < ids.size(); ++i) pts[i] = points_[ids[i]];
+        trees_.emplace_back(pts, ids, bucket_size_);
+    }
+
+    // As kd_tree::knn; max_leaves applies to each tree separately
+    std::size_t knn(const vec<3, T>& q, std::size_t k, std::span<neighbor> out,
+                    const kd_search_settings& settings = {}) const noexcept {
+        assert(out.size() >= k);
+        detail::kd_heap<T> heap{out.data(), k};
+        search_knn(q, heap, settings);
+        heap.finish();
+        return heap.size;
+    }
+
+    void knn(std::span<const vec<3, T>> queries, std::size_t k, std::span<neighbor> out,
+             const kd_search_settings& settings = {}) const {
+        detail::kd_batch_knn<T>(queries, k, out, [&](const vec<3, T>& q, detail::kd_heap<T>& heap) {
+            search_knn(q, heap, settings);
+        });
+    }
+
+    void radius(const vec<3, T>& q, T r, std::vector<neighbor>& out) const { search_radius(q, r * r, out); }
+
+    void radius(std::span<const vec<3, T>> queries, T r, std::vector<std::uint32_t>& offsets,
+                std::vector<neighbor>& out) const {
+        detail::kd_batch_radius<T>(queries, offsets, out, [&](const vec<3, T>& q, std::vector<neighbor>& found) {
+            search_radius(q, r * r, found);
+        });
+    }
+
+private:
+    // Largest tree first: it usually holds the nearest points, which tightens the
+    // bound for the rest
+    void search_knn(const vec<3, T>& q, detail::kd_heap<T>& heap, const kd_search_settings& settings) const noexcept {
+        for (const auto& t : trees_) t.search_knn(q, heap, settings);
+        for (std::size_t i = buffered_; i < points_.size(); ++i) {
+            heap.push(static_cast<std::uint32_t>(i), (points_[i] - q).length_squared());
+        }
+    }
+
+    void search_radius(const vec<3, T>& q, T r2, std::vector<neighbor>& out) const {
+        for (const auto& t : trees_) t.search_radius(q, r2, out);
+        for (std::size_t i = buffered_; i < points_.size(); ++i) {
+            const T d2 = (points_[i] - q).length_squared();
+            if (d2 <= r2) out.push_back({static_cast<std::uint32_t>(i), d2});
+        }
+    }
+
+    std::size_t bucket_size_;
+    std::size_t buffer_size_;
+    std::vector<vec<3, T>> points_;
+    std::size_t buffered_ = 0;  // points_[buffered_, size()) are not in a tree yet
+    std::vector<kd_tree<T>> trees_;
+};
+
+} // namespace ct
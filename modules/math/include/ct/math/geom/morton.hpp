@@ -0,0 +1,302 @@
+#pragma once
+
+#include "./primitives.hpp"
+#include "./reduce.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec2.hpp"
+#include "../vec/vec3.hpp"
+#include "../parallel/parallel.hpp"
+#include "../parallel/sort.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+//NOTE: pdep / pext are microcoded on AMD before Zen 3; builds for those should leave BMI2 off
+#if defined(__BMI2__)
+    #include <immintrin.h>
+    #define CT_MORTON_BMI2 1
+#else
+    #define CT_MORTON_BMI2 0
+#endif
+
+namespace ct {
+
+namespace detail {
+
+inline constexpr std::uint64_t morton2_mask = 0x5555'5555'5555'5555ull;
+inline constexpr std::uint64_t morton3_mask = 0x1249'2492'4924'9249ull;
+
+//NOTE: Codes are computed in blocks of this many points; below morton_parallel_min one thread
+inline constexpr std::size_t morton_block = 256;
+inline constexpr std::size_t morton_parallel_min = 16 * 1024;
+
+// Bit spreading by shifts and masks: the fallback without BMI2, and the form the batch
+// loops vectorize
+[[nodiscard]] constexpr std::uint64_t spread2(std::uint64_t x) noexcept {
+    x &= 0xFFFF'FFFFull;
+    x = (x | (x << 16)) & 0x0000'FFFF'0000'FFFFull;
+    x = (x | (x << 8)) & 0x00FF'00FF'00FF'00FFull;
+    x = (x | (x << 4)) & 0x0F0F'0F0F'0F0F'0F0Full;
+    x = (x | (x << 2)) & 0x3333'3333'3333'3333ull;
+    x = (x | (x << 1)) & 0x5555'5555'5555'5555ull;
+    return x;
+}
+
+[[nodiscard]] constexpr std::uint32_t compact2(std::uint64_t x) noexcept {
+    x &= 0x5555'5555'5555'5555ull;
+    x = (x | (x >> 1)) & 0x3333'3333'3333'3333ull;
+    x = (x | (x >> 2)) & 0x0F0F'0F0F'0F0F'0F0Full;
+    x = (x | (x >> 4)) & 0x00FF'00FF'00FF'00FFull;
+    x = (x | (x >> 8)) & 0x0000'FFFF'0000'FFFFull;
+    x = (x | (x >> 16)) & 0xFFFF'FFFFull;
+    return static_cast<std::uint32_t>(x);
+}
+
+[[nodiscard]] constexpr std::uint64_t spread3(std::uint64_t x) noexcept {
+    x &= 0x1F'FFFFull;
+    x = (x | (x << 32)) & 0x001F'0000'0000'FFFFull;
+    x = (x | (x << 16)) & 0x001F'0000'FF00'00FFull;
+    x = (x | (x << 8)) & 0x100F'00F0'0F00'F00Full;
+    x = (x | (x << 4)) & 0x10C3'0C30'C30C'30C3ull;
+    x = (x | (x << 2)) & 0x1249'2492'4924'9249ull;
+    return x;
+}
+
+[[nodiscard]] constexpr std::uint32_t compact3(std::uint64_t x) noexcept {
+    x &= 0x1249'2492'4924'9249ull;
+    x = (x | (x >> 2)) & 0x10C3'0C30'C30C'30C3ull;
+    x = (x | (x >> 4)) & 0x100F'00F0'0F00'F00Full;
+    x = (x | (x >> 8)) & 0x001F'0000'FF00'00FFull;
+    x = (x | (x >> 16)) & 0x001F'0000'0000'FFFFull;
+    x = (x | (x >> 32)) & 0x1F'FFFFull;
+    return static_cast<std::uint32_t>(x);
+}
+
+// Skilling's transform between axes and the "transposed" Hilbert index, whose bits read
+// x[0], x[1], ..., x[D - 1] from the top level down are the index itself
+// (Skilling, "Programming the Hilbert curve", 2004)
+template<std::size_t D>
+constexpr void hilbert_from_axes(std::array<std::uint32_t, D>& x, std::uint32_t bits) noexcept {
+    const std::uint32_t m = std::uint32_t{1} << (bits - 1);
+    for (std::uint32_t q = m; q > 1; q >>= 1) {
+        const std::uint32_t p = q - 1;
+        for (std::size_t i = 0; i < D; ++i) {
+            if (x[i] & q) {
+                x[0] ^= p;
+            } else {
+                const std::uint32_t t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+    for (std::size_t i = 1; i < D; ++i) x[i] ^= x[i - 1];
+    std::uint32_t t = 0;
+    for (std::uint32_t q = m; q > 1; q >>= 1) {
+        if (x[D - 1] & q) t ^= q - 1;
+    }
+    for (std::size_t i = 0; i < D; ++i) x[i] ^= t;
+}
+
+template<std::size_t D>
+constexpr void hilbert_to_axes(std::array<std::uint32_t, D>& x, std::uint32_t bits) noexcept {
+    const std::uint32_t t = x[D - 1] >> 1;
+    for (std::size_t i = D - 1; i > 0; --i) x[i] ^= x[i - 1];
+    x[0] ^= t;
+    for (std::uint64_t q = 2; q != (std::uint64_t{1} << bits); q <<= 1) {
+        const auto p = static_cast<std::uint32_t>(q - 1);
+        const auto qb = static_cast<std::uint32_t>(q);
+        for (std::size_t i = D; i-- > 0;) {
+            if (x[i] & qb) {
+                x[0] ^= p;
+            } else {
+                const std::uint32_t s = (x[0] ^ x[i]) & p;
+                x[0] ^= s;
+                x[i] ^= s;
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+// Morton (Z-order) codes: the bits of the coordinates interleaved, x in the lowest bit.
+// 2D takes 32 bits per axis, 3D 21 bits per axis; both fit a 64-bit code. With BMI2 each
+// axis is one pdep / pext.
+[[nodiscard]] constexpr std::uint64_t morton2_encode(std::uint32_t x, std::uint32_t y) noexcept {
+#if CT_MORTON_BMI2
+    if (!std::is_constant_evaluated()) {
+        return _pdep_u64(x, detail::morton2_mask) | _pdep_u64(y, detail::morton2_mask << 1);
+    }
+#endif
+    return detail::spread2(x) | (detail::spread2(y) << 1);
+}
+
+[[nodiscard]] constexpr vec<2, std::uint32_t> morton2_decode(std::uint64_t code) noexcept {
+#if CT_MORTON_BMI2
+    if (!std::is_constant_evaluated()) {
+        return vec<2, std::uint32_t>(static_cast<std::uint32_t>(_pext_u64(code, detail::morton2_mask)),
+                                     static_cast<std::uint32_t>(_pext_u64(code, detail::morton2_mask << 1)));
+    }
+#endif
+    return vec<2, std::uint32_t>(detail::compact2(code), detail::compact2(code >> 1));
+}
+
+[[nodiscard]] constexpr std::uint64_t morton3_encode(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept {
+    assert(x < (1u << 21) && y < (1u << 21) && z < (1u << 21));
+#if CT_MORTON_BMI2
+    if (!std::is_constant_evaluated()) {
+        return _pdep_u64(x, detail::morton3_mask) | _pdep_u64(y, detail::morton3_mask << 1) |
+               _pdep_u64(z, detail::morton3_mask << 2);
+    }
+#endif
+    return detail::spread3(x) | (detail::spread3(y) << 1) | (detail::spread3(z) << 2);
+}
+
+[[nodiscard]] constexpr vec<3, std::uint32_t> morton3_decode(std::uint64_t code) noexcept {
+#if CT_MORTON_BMI2
+    if (!std::is_constant_evaluated()) {
+        return vec<3, std::uint32_t>(static_cast<std::uint32_t>(_pext_u64(code, detail::morton3_mask)),
+                                     static_cast<std::uint32_t>(_pext_u64(code, detail::morton3_mask << 1)),
+                                     static_cast<std::uint32_t>(_pext_u64(code, detail::morton3_mask << 2)));
+    }
+#endif
+    return vec<3, std::uint32_t>(detail::compact3(code), detail::compact3(code >> 1), detail::compact3(code >> 2));
+}
+
+// Hilbert codes on a 2^bits grid per axis. Neighbouring codes are always neighbouring
+// cells, which Morton codes do not guarantee, at O(bits) cost per code. The curve depends
+// on bits: codes are only comparable when made with the same value.
+[[nodiscard]] constexpr std::uint64_t hilbert2_encode(std::uint32_t x, std::uint32_t y,
+                                                      std::uint32_t bits = 32) noexcept {
+    assert(bits >= 1 && bits <= 32);
+    std::array<std::uint32_t, 2> a{x, y};
+    detail::hilbert_from_axes(a, bits);
+    return morton2_encode(a[1], a[0]);
+}
+
+[[nodiscard]] constexpr vec<2, std::uint32_t> hilbert2_decode(std::uint64_t code, std::uint32_t bits = 32) noexcept {
+    assert(bits >= 1 && bits <= 32);
+    const vec<2, std::uint32_t> t = morton2_decode(code);
+    std::array<std::uint32_t, 2> a{t[1], t[0]};
+    detail::hilbert_to_axes(a, bits);
+    return vec<2, std::uint32_t>(a[0], a[1]);
+}
+
+[[nodiscard]] constexpr std::uint64_t hilbert3_encode(std::uint32_t x, std::uint32_t y, std::uint32_t z,
+                                                      std::uint32_t bits = 21) noexcept {
+    assert(bits >= 1 && bits <= 21);
+    std::array<std::uint32_t, 3> a{x, y, z};
+    detail::hilbert_from_axes(a, bits);
+    return morton3_encode(a[2], a[1], a[0]);
+}
+
+[[nodiscard]] constexpr vec<3, std::uint32_t> hilbert3_decode(std::uint64_t code, std::uint32_t bits = 21) noexcept {
+    assert(bits >= 1 && bits <= 21);
+    const vec<3, std::uint32_t> t = morton3_decode(code);
+    std::array<std::uint32_t, 3> a{t[2], t[1], t[0]};
+    detail::hilbert_to_axes(a, bits);
+    return vec<3, std::uint32_t>(a[0], a[1], a[2]);
+}
+
+// Maps points inside bounds onto a 2^bits grid per axis; points outside are clamped to the
+// border cells. A flat axis maps to cell 0.
+template<floating_point T>
+struct grid_quantizer {
+    vec<3, T> origin{};
+    vec<3, T> scale{};
+    std::uint32_t bits{21};
+
+    constexpr grid_quantizer() noexcept = default;
+
+    constexpr explicit grid_quantizer(const aabb<T>& bounds, std::uint32_t bits_ = 21) noexcept
+        : origin(bounds.lo), bits(bits_) {
+        assert(bits_ >= 1 && bits_ <= 21);
+        const T cells = static_cast<T>(std::uint32_t{1} << bits_);
+        const vec<3, T> size = bounds.size();
+        for (std::size_t i = 0; i < 3; ++i) scale[i] = size[i] > T{} ? cells / size[i] : T{};
+    }
+
+    [[nodiscard]] constexpr vec<3, std::uint32_t> operator()(const vec<3, T>& p) const noexcept {
+        const T top = static_cast<T>((std::uint32_t{1} << bits) - 1);
+        vec<3, std::uint32_t> c;
+        for (std::size_t i = 0; i < 3; ++i) {
+            T v = (p[i] - origin[i]) * scale[i];
+            v = v > T{} ? v : T{};
+            v = v < top ? v : top;
+            c[i] = static_cast<std::uint32_t>(v);
+        }
+        return c;
+    }
+};
+
+enum class space_curve { morton, hilbert };
+
+namespace detail {
+
+template<floating_point T>
+void spatial_code_block(const vec<3, T>* p, std::size_t n, const grid_quantizer<T>& grid,
+                        space_curve curve, std::uint64_t* out) noexcept {
+    std::array<std::uint32_t, morton_block> x;
+    std::array<std::uint32_t, morton_block> y;
+    std::array<std::uint32_t, morton_block> z;
+    for (std::size_t i = 0; i < n; ++i) {
+        const vec<3, std::uint32_t> c = grid(p[i]);
+        x[i] = c.x;
+        y[i] = c.y;
+        z[i] = c.z;
+    }
+    if (curve == space_curve::hilbert) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = hilbert3_encode(x[i], y[i], z[i], grid.bits);
+        return;
+    }
+#if CT_MORTON_BMI2
+    for (std::size_t i = 0; i < n; ++i) out[i] = morton3_encode(x[i], y[i], z[i]);
+#else
+    CT_VECTORIZE
+    for (std::size_t i = 0; i < n; ++i) out[i] = spread3(x[i]) | (spread3(y[i]) << 1) | (spread3(z[i]) << 2);
+#endif
+}
+
+} // namespace detail
+
+// out[i] = code of grid(points[i]) on the chosen curve. Large inputs run over the thread pool.
+template<floating_point T>
+void spatial_codes(std::span<const vec<3, T>> points, const grid_quantizer<T>& grid,
+                   std::span<std::uint64_t> out, space_curve curve = space_curve::morton) {
+    assert(points.size() == out.size());
+    const std::size_t n = points.size();
+    auto run = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; b += detail::morton_block) {
+            const std::size_t count = end - b < detail::morton_block ? end - b : detail::morton_block;
+            detail::spatial_code_block(points.data() + b, count, grid, curve, out.data() + b);
+        }
+    };
+    if (n >= detail::morton_parallel_min) {
+        const std::size_t grain = parallel_grain(n, 4 * detail::morton_block);
+        parallel_for(0, n, grain - grain % detail::morton_block, run);
+    } else {
+        run(0, n);
+    }
+}
+
+// Order that visits the points along a space-filling curve over their bounds, for storing
+// them with gather() so that nearby points sit in nearby memory. A 2^16 grid per axis keeps
+// the codes to 48 bits, so the sort makes six passes.
+template<floating_point T>
+[[nodiscard]] std::vector<std::uint32_t> spatial_order(std::span<const vec<3, T>> points,
+                                                       space_curve curve = space_curve::morton) {
+    const grid_quantizer<T> grid(reduce::bounds(points), 16);
+    std::vector<std::uint64_t> codes(points.size());
+    spatial_codes(points, grid, std::span<std::uint64_t>(codes), curve);
+    return radix_order(std::span<const std::uint64_t>(codes));
+}
+
+} // namespace ct
@@ -0,0 +1,427 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../common/functions.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec4.hpp"
+#include "../vec/functions.hpp"
+#include "../mat/mat3.hpp"
+#include "../mat/mat4.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace ct {
+
+enum class containment : std::uint8_t {
+    outside,
+    intersects,
+    inside,
+};
+
+// Axis-aligned box [lo, hi]. The default box is empty (lo = +inf, hi = -inf), so that
+// expanding it by anything yields exactly that thing.
+template<floating_point T>
+struct aabb {
+    using value_type = T;
+
+    vec<3, T> lo = vec<3, T>(std::numeric_limits<T>::infinity());
+    vec<3, T> hi = vec<3, T>(-std::numeric_limits<T>::infinity());
+
+    constexpr aabb() noexcept = default;
+    constexpr aabb(const vec<3, T>& lo_, const vec<3, T>& hi_) noexcept : lo(lo_), hi(hi_) {}
+
+    [[nodiscard]] static constexpr aabb from_center_extent(const vec<3, T>& c, const vec<3, T>& e) noexcept {
+        return aabb(c - e, c + e);
+    }
+
+    [[nodiscard]] static constexpr aabb from_points(std::span<const vec<3, T>> points) noexcept {
+        aabb b;
+        for (const auto& p : points) b.expand(p);
+        return b;
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept { return lo.x > hi.x || lo.y > hi.y || lo.z > hi.z; }
+
+    [[nodiscard]] constexpr vec<3, T> center() const noexcept { return (lo + hi) * (T{1} / T{2}); }
+    // Half size
+    [[nodiscard]] constexpr vec<3, T> extent() const noexcept { return (hi - lo) * (T{1} / T{2}); }
+    [[nodiscard]] constexpr vec<3, T> size() const noexcept { return hi - lo; }
+
+    [[nodiscard]] constexpr T surface_area() const noexcept {
+        const vec<3, T> d = hi - lo;
+        return T{2} * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    [[nodiscard]] constexpr T volume() const noexcept {
+        const vec<3, T> d = hi - lo;
+        return d.x * d.y * d.z;
+    }
+
+    constexpr aabb& expand(const vec<3, T>& p) noexcept {
+        lo = min(lo, p);
+        hi = max(hi, p);
+        return *this;
+    }
+
+    constexpr aabb& expand(const aabb& b) noexcept {
+        lo = min(lo, b.lo);
+        hi = max(hi, b.hi);
+        return *this;
+    }
+
+    [[nodiscard]] constexpr bool contains(const vec<3, T>& p) const noexcept {
+        return p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y && p.z >= lo.z && p.z <= hi.z;
+    }
+
+    [[nodiscard]] constexpr bool contains(const aabb& b) const noexcept {
+        return b.lo.x >= lo.x && b.hi.x <= hi.x && b.lo.y >= lo.y && b.hi.y <= hi.y && b.lo.z >= lo.z && b.hi.z <= hi.z;
+    }
+
+    [[nodiscard]] constexpr bool overlaps(const aabb& b) const noexcept {
+        return lo.x <= b.hi.x && hi.x >= b.lo.x && lo.y <= b.hi.y && hi.y >= b.lo.y && lo.z <= b.hi.z && hi.z >= b.lo.z;
+    }
+
+    [[nodiscard]] constexpr vec<3, T> closest_point(const vec<3, T>& p) const noexcept { return min(max(p, lo), hi); }
+
+    [[nodiscard]] constexpr T distance_squared(const vec<3, T>& p) const noexcept {
+        return (closest_point(p) - p).length_squared();
+    }
+
+    // Bounds of the box under an affine m (Arvo): |m| maps the extent
+    [[nodiscard]] constexpr aabb transformed(const mat<4, 4, T>& m) const noexcept {
+        const vec<3, T> c = center();
+        const vec<3, T> e = extent();
+        vec<3, T> nc;
+        vec<3, T> ne;
+        for (std::size_t i = 0; i < 3; ++i) {
+            nc[i] = m(i, 0) * c.x + m(i, 1) * c.y + m(i, 2) * c.z + m(i, 3);
+            ne[i] = abs(m(i, 0)) * e.x + abs(m(i, 1)) * e.y + abs(m(i, 2)) * e.z;
+        }
+        return from_center_extent(nc, ne);
+    }
+};
+
+template<floating_point T>
+[[nodiscard]] constexpr aabb<T> merge(const aabb<T>& a, const aabb<T>& b) noexcept {
+    return aabb<T>(min(a.lo, b.lo), max(a.hi, b.hi));
+}
+
+template<floating_point T>
+struct sphere {
+    using value_type = T;
+
+    vec<3, T> center{};
+    T radius{};
+
+    [[nodiscard]] constexpr bool contains(const vec<3, T>& p) const noexcept {
+        return (p - center).length_squared() <= radius * radius;
+    }
+
+    [[nodiscard]] constexpr bool overlaps(const sphere& s) const noexcept {
+        const T r = radius + s.radius;
+        return (s.center - center).length_squared() <= r * r;
+    }
+
+    [[nodiscard]] constexpr bool overlaps(const aabb<T>& b) const noexcept {
+        return b.distance_squared(center) <= radius * radius;
+    }
+
+    [[nodiscard]] constexpr aabb<T> bounds() const noexcept {
+        return aabb<T>::from_center_extent(center, vec<3, T>(radius));
+    }
+};
+
+// Points p with dot(normal, p) + d = 0; the normal side is positive
+template<floating_point T>
+struct plane {
+    using value_type = T;
+
+    vec<3, T> normal{T{0}, T{0}, T{1}};
+    T d{};
+
+    [[nodiscard]] static plane from_point_normal(const vec<3, T>& p, const vec<3, T>& n) noexcept {
+        const vec<3, T> u = n.normalized();
+        return {u, -u.dot(p)};
+    }
+
+    // Normal along (b - a) x (c - a), so counter-clockwise points face the positive side
+    [[nodiscard]] static plane from_points(const vec<3, T>& a, const vec<3, T>& b, const vec<3, T>& c) noexcept {
+        return from_point_normal(a, (b - a).cross(c - a));
+    }
+
+    [[nodiscard]] constexpr T signed_distance(const vec<3, T>& p) const noexcept { return normal.dot(p) + d; }
+
+    [[nodiscard]] constexpr vec<3, T> project(const vec<3, T>& p) const noexcept {
+        return p - normal * signed_distance(p);
+    }
+
+    // Rescales (normal, d) so that signed_distance() is in world units
+    [[nodiscard]] plane normalized() const noexcept {
+        const T inv = T{1} / normal.length();
+        return {normal * inv, d * inv};
+    }
+};
+
+// origin + t direction; t is measured in lengths of direction, which need not be unit
+template<floating_point T>
+struct ray {
+    using value_type = T;
+
+    vec<3, T> origin{};
+    vec<3, T> direction{T{0}, T{0}, T{1}};
+
+    [[nodiscard]] constexpr vec<3, T> at(T t) const noexcept { return origin + direction * t; }
+};
+
+template<floating_point T>
+struct triangle {
+    using value_type = T;
+
+    vec<3, T> a{};
+    vec<3, T> b{};
+    vec<3, T> c{};
+
+    // Unnormalized, twice the area long; counter-clockwise is the front
+    [[nodiscard]] constexpr vec<3, T> normal() const noexcept { return (b - a).cross(c - a); }
+    [[nodiscard]] constexpr vec<3, T> centroid() const noexcept { return (a + b + c) * (T{1} / T{3}); }
+    [[nodiscard]] constexpr aabb<T> bounds() const noexcept { return aabb<T>(min(min(a, b), c), max(max(a, b), c)); }
+};
+
+// Oriented box: the columns of axes are its orthonormal local axes, extent the half sizes
+template<floating_point T>
+struct obb {
+    using value_type = T;
+
+    vec<3, T> center{};
+    vec<3, T> extent{};
+    mat<3, 3, T> axes = mat<3, 3, T>::identity();
+
+    // A box under an affine m with rotation and scale but no shear
+    [[nodiscard]] static obb from_aabb(const aabb<T>& b, const mat<4, 4, T>& m) noexcept {
+        const vec<3, T> c = b.center();
+        const vec<3, T> e = b.extent();
+        obb o;
+        for (std::size_t i = 0; i < 3; ++i) {
+            o.center[i] = m(i, 0) * c.x + m(i, 1) * c.y + m(i, 2) * c.z + m(i, 3);
+        }
+        for (std::size_t j = 0; j < 3; ++j) {
+            const vec<3, T> col(m(0, j), m(1, j), m(2, j));
+            const T len = col.length();
+            o.extent[j] = e[j] * len;
+            const vec<3, T> u = len > T{} ? col / len : vec<3, T>{};
+            for (std::size_t i = 0; i < 3; ++i) o.axes(i, j) = u[i];
+        }
+        return o;
+    }
+
+    // p in the box frame
+    [[nodiscard]] constexpr vec<3, T> to_local(const vec<3, T>& p) const noexcept {
+        const vec<3, T> d = p - center;
+        return vec<3, T>(axes(0, 0) * d.x + axes(1, 0) * d.y + axes(2, 0) * d.z,
+                         axes(0, 1) * d.x + axes(1, 1) * d.y + axes(2, 1) * d.z,
+                         axes(0, 2) * d.x + axes(1, 2) * d.y + axes(2, 2) * d.z);
+    }
+
+    [[nodiscard]] constexpr bool contains(const vec<3, T>& p) const noexcept {
+        const vec<3, T> l = to_local(p);
+        return abs(l.x) <= extent.x && abs(l.y) <= extent.y && abs(l.z) <= extent.z;
+    }
+
+    // Half width of the box along unit n
+    [[nodiscard]] constexpr T radius_along(const vec<3, T>& n) const noexcept {
+        T r{};
+        for (std::size_t j = 0; j < 3; ++j) {
+            r += extent[j] * abs(n.x * axes(0, j) + n.y * axes(1, j) + n.z * axes(2, j));
+        }
+        return r;
+    }
+
+    [[nodiscard]] constexpr aabb<T> bounds() const noexcept {
+        vec<3, T> e;
+        for (std::size_t i = 0; i < 3; ++i) {
+            e[i] = abs(axes(i, 0)) * extent.x + abs(axes(i, 1)) * extent.y + abs(axes(i, 2)) * extent.z;
+        }
+        return aabb<T>::from_center_extent(center, e);
+    }
+};
+
+// Six inward-facing planes in world units. from_matrix() reads them off a clip matrix
+// in the OpenGL convention of perspective() and ortho(): pass proj * view for world
+// space, or proj alone for view space.
+template<floating_point T>
+struct frustum {
+    using value_type = T;
+
+    enum side : std::size_t { left, right, bottom, top, z_near, z_far };
+
+    std::array<plane<T>, 6> planes{};
+
+    // Gribb-Hartmann: each plane is row 3 of m plus or minus row 0, 1 or 2
+    [[nodiscard]] static frustum from_matrix(const mat<4, 4, T>& m) noexcept {
+        frustum f;
+        for (std::size_t r = 0; r < 3; ++r) {
+            const vec<3, T> n3(m(3, 0), m(3, 1), m(3, 2));
+            const vec<3, T> nr(m(r, 0), m(r, 1), m(r, 2));
+            f.planes[2 * r] = plane<T>{n3 + nr, m(3, 3) + m(r, 3)}.normalized();
+            f.planes[2 * r + 1] = plane<T>{n3 - nr, m(3, 3) - m(r, 3)}.normalized();
+        }
+        return f;
+    }
+
+    [[nodiscard]] constexpr bool contains(const vec<3, T>& p) const noexcept {
+        for (const auto& pl : planes) {
+            if (pl.signed_distance(p) < T{}) return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr containment test(const sphere<T>& s) const noexcept {
+        containment r = containment::inside;
+        for (const auto& pl : planes) {
+            const T d = pl.signed_distance(s.center);
+            if (d < -s.radius) return containment::outside;
+            if (d < s.radius) r = containment::intersects;
+        }
+        return r;
+    }
+
+    // Center-extent form: the box straddles a plane when |d| < dot(|n|, extent)
+    [[nodiscard]] constexpr containment test(const aabb<T>& b) const noexcept {
+        const vec<3, T> c = b.center();
+        const vec<3, T> e = b.extent();
+        containment r = containment::inside;
+        for (const auto& pl : planes) {
+            const T d = pl.signed_distance(c);
+            const T rad = abs(pl.normal.x) * e.x + abs(pl.normal.y) * e.y + abs(pl.normal.z) * e.z;
+            if (d < -rad) return containment::outside;
+            if (d < rad) r = containment::intersects;
+        }
+        return r;
+    }
+
+    [[nodiscard]] constexpr containment test(const obb<T>& b) const noexcept {
+        containment r = containment::inside;
+        for (const auto& pl : planes) {
+            const T d = pl.signed_distance(b.center);
+            const T rad = b.radius_along(pl.normal);
+            if (d < -rad) return containment::outside;
+            if (d < rad) r = containment::intersects;
+        }
+        return r;
+    }
+};
+
+// Closest hit of a ray query: t along the ray, barycentrics (u, v) of the hit for
+// triangles (the point is (1 - u - v) a + u b + v c), and the primitive index
+template<floating_point T>
+struct ray_hit {
+    static constexpr std::uint32_t none = ~std::uint32_t{0};
+
+    T t = std::numeric_limits<T>::infinity();
+    T u{};
+    T v{};
+    std::uint32_t index = none;
+
+    [[nodiscard]] constexpr bool hit() const noexcept { return index != none; }
+};
+
+// The intersect() overloads below return the entry distance in [t_min, t_max], or
+// infinity when the ray misses; a ray starting inside a solid hits it at t_min.
+
+// Slab test with the reciprocal direction precomputed (see ray_inverse_direction())
+template<floating_point T>
+[[nodiscard]] constexpr T intersect(const vec<3, T>& origin, const vec<3, T>& inv_dir, const aabb<T>& b,
+                                    T t_min, T t_max) noexcept {
+    T tn = t_min;
+    T tf = t_max;
+    for (std::size_t i = 0; i < 3; ++i) {
+        const T t0 = (b.lo[i] - origin[i]) * inv_dir[i];
+        const T t1 = (b.hi[i] - origin[i]) * inv_dir[i];
+        tn = max(tn, min(t0, t1));
+        tf = min(tf, max(t0, t1));
+    }
+    return tn <= tf ? tn : std::numeric_limits<T>::infinity();
+}
+
+template<floating_point T>
+[[nodiscard]] constexpr vec<3, T> ray_inverse_direction(const ray<T>& r) noexcept {
+    return vec<3, T>(T{1} / r.direction.x, T{1} / r.direction.y, T{1} / r.direction.z);
+}
+
+template<floating_point T>
+[[nodiscard]] constexpr T intersect(const ray<T>& r, const aabb<T>& b, T t_min = T{},
+                                    T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    return intersect(r.origin, ray_inverse_direction(r), b, t_min, t_max);
+}
+
+template<floating_point T>
+[[nodiscard]] inline T intersect(const ray<T>& r, const sphere<T>& s, T t_min = T{},
+                                 T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    constexpr T miss = std::numeric_limits<T>::infinity();
+    const vec<3, T> oc = r.origin - s.center;
+    const T a = r.direction.length_squared();
+    const T hb = oc.dot(r.direction);
+    const T c = oc.length_squared() - s.radius * s.radius;
+    const T disc = hb * hb - a * c;
+    if (disc < T{}) return miss;
+    const T sq = sqrt(disc);
+    const T t0 = (-hb - sq) / a;
+    const T t1 = (-hb + sq) / a;
+    if (t1 < t_min || t0 > t_max) return miss;
+    return max(t0, t_min);
+}
+
+template<floating_point T>
+[[nodiscard]] constexpr T intersect(const ray<T>& r, const plane<T>& p, T t_min = T{},
+                                    T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    constexpr T miss = std::numeric_limits<T>::infinity();
+    const T den = p.normal.dot(r.direction);
+    if (den == T{}) return miss;
+    const T t = -p.signed_distance(r.origin) / den;
+    return t >= t_min && t <= t_max ? t : miss;
+}
+
+template<floating_point T>
+[[nodiscard]] constexpr T intersect(const ray<T>& r, const obb<T>& b, T t_min = T{},
+                                    T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    const vec<3, T> o = b.to_local(r.origin);
+    const vec<3, T> d = b.to_local(r.origin + r.direction) - o;
+    return intersect(ray<T>{o, d}, aabb<T>(-b.extent, b.extent), t_min, t_max);
+}
+
+// Moller-Trumbore, two-sided; index is 0 on a hit
+template<floating_point T>
+[[nodiscard]] constexpr ray_hit<T> intersect(const ray<T>& r, const triangle<T>& tri, T t_min = T{},
+                                             T t_max = std::numeric_limits<T>::infinity()) noexcept {
+    ray_hit<T> h;
+    const vec<3, T> e1 = tri.b - tri.a;
+    const vec<3, T> e2 = tri.c - tri.a;
+    const vec<3, T> p = r.direction.cross(e2);
+    const T det = e1.dot(p);
+    if (abs(det) <= std::numeric_limits<T>::min()) return h;
+    const T inv = T{1} / det;
+    const vec<3, T> s = r.origin - tri.a;
+    const T u = s.dot(p) * inv;
+    const vec<3, T> q = s.cross(e1);
+    const T v = r.direction.dot(q) * inv;
+    const T t = e2.dot(q) * inv;
+    if (u < T{} || v < T{} || u + v > T{1} || t < t_min || t > t_max) return h;
+    h.t = t;
+    h.u = u;
+    h.v = v;
+    h.index = 0;
+    return h;
+}
+
+static_assert(std::is_trivially_copyable_v<aabb<float>>);
+static_assert(std::is_trivially_copyable_v<triangle<float>>);
+static_assert(sizeof(aabb<float>) == 6 * sizeof(float));
+static_assert(sizeof(triangle<float>) == 9 * sizeof(float));
+
+} // namespace ct
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "./primitives.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/functions.hpp"
+#include "../mat/mat3.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ct {
+
+// Mean and covariance of a (weighted) point set. The covariance is normalized by the total
+// weight, which is the point count for unweighted sets.
+template<floating_point T>
+struct point_moments {
+    T weight{};
+    vec<3, T> mean{};
+    mat<3, 3, T> covariance{};
+};
+
+namespace detail {
+
+//NOTE: Partials are formed over fixed blocks of this many elements and combined pairwise
+// in block order, so a result depends on the input alone and never on the thread count
+inline constexpr std::size_t reduce_block = 4096;
+inline constexpr std::size_t reduce_parallel_min = 64 * 1024;
+
+template<floating_point T>
+inline constexpr std::size_t reduce_width = simd_lanes<T>;
+
+template<floating_point T>
+using reduce_lanes = pack<T, reduce_width<T>>;
+
+// Kahan-compensated running sum over V = T or pack<T, W>; value() = sum - c
+template<typename V>
+struct kahan {
+    V sum = splat<V>(0);
+    V c = splat<V>(0);
+
+    CT_FORCE_INLINE void add(const V& x) noexcept {
+        const V y = x - c;
+        const V t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+
+    void merge(const kahan& o) noexcept {
+        add(o.sum);
+        add(-o.c);
+    }
+
+    [[nodiscard]] V value() const noexcept { return sum - c; }
+};
+
+// Folds the lanes in lane order into one compensated scalar
+template<floating_point T, std::size_t W>
+[[nodiscard]] kahan<T> fold(const kahan<pack<T, W>>& k) noexcept {
+    kahan<T> r;
+    for (std::size_t i = 0; i < W; ++i) r.merge(kahan<T>{k.sum[i], k.c[i]});
+    return r;
+}
+
+template<floating_point T, std::size_t K>
+struct kahan_set {
+    std::array<kahan<T>, K> terms{};
+
+    void merge(const kahan_set& o) noexcept {
+        for (std::size_t i = 0; i < K; ++i) terms[i].merge(o.terms[i]);
+    }
+
+    [[nodiscard]] T operator[](std::size_t i) const noexcept { return terms[i].value(); }
+};
+
+template<floating_point T>
+struct bounds_part {
+    aabb<T> box{};
+
+    void merge(const bounds_part& o) noexcept {
+        box.lo = min(box.lo, o.box.lo);
+        box.hi = max(box.hi, o.box.hi);
+    }
+};
+
+// Runs block(begin, end) -> Part on every reduce_block-sized block, over the pool when the
+// input is large, and merges the partials as a balanced tree in block order
+template<typename Part, typename F>
+[[nodiscard]] Part reduce_blocks(std::size_t n, F&& block) {
+    const std::size_t blocks = (n + reduce_block - 1) / reduce_block;
+    if (blocks <= 1) return block(0, n);
+
+    std::vector<Part> parts(blocks);
+    auto run = [&](std::size_t b, std::size_t e) {
+        for (std::size_t k = b; k < e; ++k) parts[k] = block(k * reduce_block, std::min(n, (k + 1) * reduce_block));
+    };
+    if (n >= reduce_parallel_min) {
+        parallel_for(0, blocks, parallel_grain(blocks, 1), run);
+    } else {
+        run(0, blocks);
+    }
+    for (std::size_t step = 1; step < blocks; step *= 2) {
+        for (std::size_t i = 0; i + step < blocks; i += 2 * step) parts[i].merge(parts[i + step]);
+    }
+    return parts[0];
+}
+
+// Block kernels. Whole register groups go through the lanes, the remainder through the
+// same accumulators one element at a time. w is only read when Weighted is set.
+
+template<bool Weighted, floating_point T>
+[[nodiscard]] kahan_set<T, 2> sum_block(const T* x, const T* w, std::size_t n) noexcept {
+    using P = reduce_lanes<T>;
+    constexpr std::size_t W = reduce_width<T>;
+    kahan<P> sx, sw;
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const P v = P::load(x + i);
+        if constexpr (Weighted) {
+            const P wv = P::load(w + i);
+            sx.add(v * wv);
+            sw.add(wv);
+        } else {
+            sx.add(v);
+        }
+    }
+    kahan_set<T, 2> r{{fold(sx), fold(sw)}};
+    for (; i < n; ++i) {
+        if constexpr (Weighted) {
+            r.terms[0].add(x[i] * w[i]);
+            r.terms[1].add(w[i]);
+        } else {
+            r.terms[0].add(x[i]);
+        }
+    }
+    return r;
+}
+
+template<bool Weighted, floating_point T>
+[[nodiscard]] kahan_set<T, 4> sum_block(const vec<3, T>* p, const T* w, std::size_t n) noexcept {
+    using P = reduce_lanes<T>;
+    constexpr std::size_t W = reduce_width<T>;
+    kahan<P> sx, sy, sz, sw;
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        P x, y, z;
+        load_interleaved(reinterpret_cast<const T*>(p + i), x, y, z);
+        if constexpr (Weighted) {
+            const P wv = P::load(w + i);
+            x *= wv;
+            y *= wv;
+            z *= wv;
+            sw.add(wv);
+        }
+        sx.add(x);
+        sy.add(y);
+        sz.add(z);
+    }
+    kahan_set<T, 4> r{{fold(sx), fold(sy), fold(sz), fold(sw)}};
+    for (; i < n; ++i) {
+        const T wi = Weighted ? w[i] : T{1};
+        r.terms[0].add(p[i].x * wi);
+        r.terms[1].add(p[i].y * wi);
+        r.terms[2].add(p[i].z * wi);
+        if constexpr (Weighted) r.terms[3].add(wi);
+    }
+    return r;
+}
+
+// Second moments about m: xx, xy, xz, yy, yz, zz
+template<bool Weighted, floating_point T>
+[[nodiscard]] kahan_set<T, 6> scatter_block(const vec<3, T>* p, const T* w, std::size_t n, const vec<3, T>& m) noexcept {
+    using P = reduce_lanes<T>;
+    constexpr std::size_t W = reduce_width<T>;
+    const P mx = P::broadcast(m.x);
+    const P my = P::broadcast(m.y);
+    const P mz = P::broadcast(m.z);
+    kahan<P> sxx, sxy, sxz, syy, syz, szz;
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        P x, y, z;
+        load_interleaved(reinterpret_cast<const T*>(p + i), x, y, z);
+        x -= mx;
+        y -= my;
+        z -= mz;
+        P wx = x, wy = y, wz = z;
+        if constexpr (Weighted) {
+            const P wv = P::load(w + i);
+            wx *= wv;
+            wy *= wv;
+            wz *= wv;
+        }
+        sxx.add(wx * x);
+        sxy.add(wx * y);
+        sxz.add(wx * z);
+        syy.add(wy * y);
+        syz.add(wy * z);
+        szz.add(wz * z);
+    }
+    kahan_set<T, 6> r{{fold(sxx), fold(sxy), fold(sxz), fold(syy), fold(syz), fold(szz)}};
+    for (; i < n; ++i) {
+        const vec<3, T> d = p[i] - m;
+        const vec<3, T> wd = Weighted ? d * w[i] : d;
+        r.terms[0].add(wd.x * d.x);
+        r.terms[1].add(wd.x * d.y);
+        r.terms[2].add(wd.x * d.z);
+        r.terms[3].add(wd.y * d.y);
+        r.terms[4].add(wd.y * d.z);
+        r.terms[5].add(wd.z * d.z);
+    }
+    return r;
+}
+
+template<floating_point T>
+[[nodiscard]] bounds_part<T> bounds_block(const vec<3, T>* p, std::size_t n) noexcept {
+    using P = reduce_lanes<T>;
+    constexpr std::size_t W = reduce_width<T>;
+    bounds_part<T> r;
+    std::size_t i = 0;
+    if (n >= W) {
+        P lx, ly, lz;
+        load_interleaved(reinterpret_cast<const T*>(p), lx, ly, lz);
+        P hx = lx, hy = ly, hz = lz;
+        for (i = W; i + W <= n; i += W) {
+            P x, y, z;
+            load_interleaved(reinterpret_cast<const T*>(p + i), x, y, z);
+            lx = min(lx, x);
+            ly = min(ly, y);
+            lz = min(lz, z);
+            hx = max(hx, x);
+            hy = max(hy, y);
+            hz = max(hz, z);
+        }
+        for (std::size_t l = 0; l < W; ++l) {
+            r.box.lo = min(r.box.lo, vec<3, T>(lx[l], ly[l], lz[l]));
+            r.box.hi = max(r.box.hi, vec<3, T>(hx[l], hy[l], hz[l]));
+        }
+    }
+    for (; i < n; ++i) {
+        r.box.lo = min(r.box.lo, p[i]);
+        r.box.hi = max(r.box.hi, p[i]);
+    }
+    return r;
+}
+
+template<bool Weighted, floating_point T>
+[[nodiscard]] kahan_set<T, 4> point_sums(std::span<const vec<3, T>> points, const T* w) {
+    return reduce_blocks<kahan_set<T, 4>>(points.size(), [&](std::size_t b, std::size_t e) {
+        return sum_block<Weighted>(points.data() + b, w + (Weighted ? b : 0), e - b);
+    });
+}
+
+template<bool Weighted, floating_point T>
+[[nodiscard]] point_moments<T> moments(std::span<const vec<3, T>> points, const T* w) {
+    point_moments<T> r;
+    if (points.empty()) return r;
+
+    const kahan_set<T, 4> s = point_sums<Weighted>(points, w);
+    r.weight = Weighted ? s[3] : static_cast<T>(points.size());
+    assert(r.weight > T{});
+    r.mean = vec<3, T>(s[0], s[1], s[2]) / r.weight;
+
+    const kahan_set<T, 6> c = reduce_blocks<kahan_set<T, 6>>(points.size(), [&](std::size_t b, std::size_t e) {
+        return scatter_block<Weighted>(points.data() + b, w + (Weighted ? b : 0), e - b, r.mean);
+    });
+    const T inv = T{1} / r.weight;
+    r.covariance = mat<3, 3, T>(layout::rowm,
+                                c[0] * inv, c[1] * inv, c[2] * inv,
+                                c[1] * inv, c[3] * inv, c[4] * inv,
+                                c[2] * inv, c[4] * inv, c[5] * inv);
+    return r;
+}
+
+} // namespace detail
+
+// Reductions over large arrays of scalars and points. Every sum is Kahan-compensated in
+// SIMD lanes within fixed-size blocks, and the block partials are added as a balanced
+// tree. Large inputs run over the thread pool, with results bit-identical to the
+// single-threaded ones. Weighted variants take one weight per element.
+namespace reduce {
+
+template<floating_point T>
+[[nodiscard]] T sum(std::span<const T> values) {
+    return detail::reduce_blocks<detail::kahan_set<T, 2>>(values.size(), [&](std::size_t b, std::size_t e) {
+        return detail::sum_block<false>(values.data() + b, static_cast<const T*>(nullptr), e - b);
+    })[0];
+}
+
+// sum of w[i] * values[i]
+template<floating_point T>
+[[nodiscard]] T sum(std::span<const T> values, std::type_identity_t<std::span<const T>> weights) {
+    assert(weights.size() == values.size());
+    return detail::reduce_blocks<detail::kahan_set<T, 2>>(values.size(), [&](std::size_t b, std::size_t e) {
+        return detail::sum_block<true>(values.data() + b, weights.data() + b, e - b);
+    })[0];
+}
+
+template<floating_point T>
+[[nodiscard]] T mean(std::span<const T> values) {
+    assert(!values.empty());
+    return sum(values) / static_cast<T>(values.size());
+}
+
+template<floating_point T>
+[[nodiscard]] T mean(std::span<const T> values, std::type_identity_t<std::span<const T>> weights) {
+    assert(weights.size() == values.size() && !values.empty());
+    const auto s = detail::reduce_blocks<detail::kahan_set<T, 2>>(values.size(), [&](std::size_t b, std::size_t e) {
+        return detail::sum_block<true>(values.data() + b, weights.data() + b, e - b);
+    });
+    assert(s[1] > T{});
+    return s[0] / s[1];
+}
+
+template<floating_point T>
+[[nodiscard]] vec<3, T> sum(std::span<const vec<3, T>> points) {
+    const auto s = detail::point_sums<false>(points, static_cast<const T*>(nullptr));
+    return {s[0], s[1], s[2]};
+}
+
+template<floating_point T>
+[[nodiscard]] vec<3, T> sum(std::span<const vec<3, T>> points, std::type_identity_t<std::span<const T>> weights) {
+    assert(weights.size() == points.size());
+    const auto s = detail::point_sums<true>(points, weights.data());
+    return {s[0], s[1], s[2]};
+}
+
+template<floating_point T>
+[[nodiscard]] vec<3, T> mean(std::span<const vec<3, T>> points) {
+    assert(!points.empty());
+    return sum(points) / static_cast<T>(points.size());
+}
+
+template<floating_point T>
+[[nodiscard]] vec<3, T> mean(std::span<const vec<3, T>> points, std::type_identity_t<std::span<const T>> weights) {
+    assert(weights.size() == points.size() && !points.empty());
+    const auto s = detail::point_sums<true>(points, weights.data());
+    assert(s[3] > T{});
+    return vec<3, T>(s[0], s[1], s[2]) / s[3];
+}
+
+// Two passes: the mean, then the second moments about it. Empty input gives all zeros.
+template<floating_point T>
+[[nodiscard]] point_moments<T> moments(std::span<const vec<3, T>> points) {
+    return detail::moments<false>(points, static_cast<const T*>(nullptr));
+}
+
+template<floating_point T>
+[[nodiscard]] point_moments<T> moments(std::span<const vec<3, T>> points,
+                                       std::type_identity_t<std::span<const T>> weights) {
+    assert(weights.size() == points.size());
+    return detail::moments<true>(points, weights.data());
+}
+
+template<floating_point T>
+[[nodiscard]] mat<3, 3, T> covariance(std::span<const vec<3, T>> points) {
+    return moments(points).covariance;
+}
+
+template<floating_point T>
+[[nodiscard]] mat<3, 3, T> covariance(std::span<const vec<3, T>> points,
+                                      std::type_identity_t<std::span<const T>> weights) {
+    return moments(points, weights).covariance;
+}
+
+// Empty input gives the empty (inverted) box
+template<floating_point T>
+[[nodiscard]] aabb<T> bounds(std::span<const vec<3, T>> points) {
+    return detail::reduce_blocks<detail::bounds_part<T>>(points.size(), [&](std::size_t b, std::size_t e) {
+        return detail::bounds_block(points.data() + b, e - b);
+    }).box;
+}
+
+} // namespace reduce
+
+} // namespace ct
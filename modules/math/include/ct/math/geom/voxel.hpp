@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ct {
+
+namespace detail {
+
+// splitmix64 finalizer: every input bit reaches every output bit
+[[nodiscard]] constexpr std::uint64_t mix64(std::uint64_t z) noexcept {
+    z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11ebull;
+    return z ^ (z >> 31);
+}
+
+} // namespace detail
+
+// Integer cell of p on a grid of cubes with side 1 / inv_cell, rounding toward -inf so
+// that cells straddling 0 are not twice as wide
+template<floating_point T>
+[[nodiscard]] inline vec<3, int> voxel_coord(const vec<3, T>& p, T inv_cell) noexcept {
+    return vec<3, int>(static_cast<int>(std::floor(p.x * inv_cell)),
+                       static_cast<int>(std::floor(p.y * inv_cell)),
+                       static_cast<int>(std::floor(p.z * inv_cell)));
+}
+
+// Hash for integer voxel coordinates, for std::unordered_map<vec3i, V, voxel_hash> and
+// open-addressing tables that take the low bits. All 96 coordinate bits are mixed, so
+// neighbouring voxels land in unrelated buckets, unlike the xor-of-primes hash.
+struct voxel_hash {
+    [[nodiscard]] constexpr std::size_t operator()(const vec<3, int>& v) const noexcept {
+        const auto x = static_cast<std::uint64_t>(static_cast<std::uint32_t>(v.x));
+        const auto y = static_cast<std::uint64_t>(static_cast<std::uint32_t>(v.y));
+        const auto z = static_cast<std::uint64_t>(static_cast<std::uint32_t>(v.z));
+        return static_cast<std::size_t>(detail::mix64(detail::mix64((x | (y << 32)) + 0x9e37'79b9'7f4a'7c15ull) ^ z));
+    }
+};
+
+} // namespace ct
+
+template<>
+struct std::hash<ct::vec<3, int>> : ct::voxel_hash {};
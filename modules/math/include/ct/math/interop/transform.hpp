@@ -1,14 +1,18 @@
 #pragma once
 
 #include "../mat/fwd.hpp"
+#include "../mat/mat3.hpp"
 #include "../mat/mat4.hpp"      // IWYU pragma: keep
 #include "../vec/fwd.hpp"
 #include "../vec/vec3.hpp"    // IWYU pragma: keep  
 #include "../detail/arithmetic.hpp"
 #include "../common/functions.hpp"      // IWYU pragma: keep
 #include "../common/constants.hpp"    // IWYU pragma: keep
+#include "../detail/pack.hpp"
 
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 
 namespace ct {
 
@@ -123,4 +127,257 @@ template<floating_point T>
                         T{0},                  T{0},                  T{0},                      T{1});
 }
 
+namespace detail {
+
+//NOTE: Slack on the 0 0 0 1 row and on R^T R = I when a raw matrix is claimed affine or rigid
+template<floating_point T>
+inline constexpr T transform_tolerance = epsilon<T> * T{1024};
+
+// out = a * b for affine a and b: every column is a.col(0..2) weighted by b's column,
+// plus a.col(3) for the translation, so the 0 0 0 1 row comes out exact
+template<floating_point T>
+CT_FORCE_INLINE void affine_mul_lanes(const mat<4, 4, T>& a, const mat<4, 4, T>& b, mat<4, 4, T>& out) noexcept {
+    using P = pack<T, 4>;
+    const P a0 = P::load(&a(0, 0));
+    const P a1 = P::load(&a(0, 1));
+    const P a2 = P::load(&a(0, 2));
+    const P a3 = P::load(&a(0, 3));
+    for (std::size_t j = 0; j < 3; ++j) {
+        (a0 * b(0, j) + a1 * b(1, j) + a2 * b(2, j)).store(&out(0, j));
+    }
+    (a0 * b(0, 3) + a1 * b(1, 3) + a2 * b(2, 3) + a3).store(&out(0, 3));
+}
+
+} // namespace detail
+
+template<floating_point T>
+[[nodiscard]] constexpr bool is_affine(const mat<4, 4, T>& m, T tolerance = detail::transform_tolerance<T>) noexcept {
+    return abs(m(3, 0)) <= tolerance && abs(m(3, 1)) <= tolerance && abs(m(3, 2)) <= tolerance &&
+           abs(m(3, 3) - T{1}) <= tolerance;
+}
+
+// Affine with an orthonormal, right-handed upper 3x3
+template<floating_point T>
+[[nodiscard]] constexpr bool is_rigid(const mat<4, 4, T>& m, T tolerance = detail::transform_tolerance<T>) noexcept {
+    if (!is_affine(m, tolerance)) return false;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = i; j < 3; ++j) {
+            const T d = m(0, i) * m(0, j) + m(1, i) * m(1, j) + m(2, i) * m(2, j);
+            if (abs(d - (i == j ? T{1} : T{0})) > tolerance) return false;
+        }
+    }
+    const T det = m(0, 0) * (m(1, 1) * m(2, 2) - m(2, 1) * m(1, 2))
+                - m(0, 1) * (m(1, 0) * m(2, 2) - m(2, 0) * m(1, 2))
+                + m(0, 2) * (m(1, 0) * m(2, 1) - m(2, 0) * m(1, 1));
+    return det > T{};
+}
+
+// A 4x4 transform whose class is known: affine (bottom row 0 0 0 1) or rigid (rotation
+// plus translation). Composing is a 3x4 product, the inverse is a 3x3 inverse or, for a
+// rigid transform, a transpose, and applying it to a point is 9 multiply-adds. The full
+// matrix is kept, so matrix() is free and a transform3 passes wherever a mat4 is read.
+//
+// The class is trusted from the factories and from products and inverses of transform3s;
+// a raw matrix is only checked, by assert, when it is wrapped.
+template<transform_kind K, floating_point T>
+class transform3 {
+public:
+    using value_type = T;
+    using matrix_type = mat<4, 4, T>;
+
+    static constexpr transform_kind kind = K;
+
+    constexpr transform3() noexcept : m_(matrix_type::identity()) {}
+
+    explicit constexpr transform3(const matrix_type& m) noexcept : m_(m) {
+        assert(K == transform_kind::rigid ? is_rigid(m) : is_affine(m));
+    }
+
+    constexpr transform3(const mat<3, 3, T>& linear, const vec<3, T>& translation) noexcept
+        : m_(layout::rowm,
+             linear(0, 0), linear(0, 1), linear(0, 2), translation[0],
+             linear(1, 0), linear(1, 1), linear(1, 2), translation[1],
+             linear(2, 0), linear(2, 1), linear(2, 2), translation[2],
+             T{0},         T{0},         T{0},         T{1}) {
+        assert(K == transform_kind::affine || is_rigid(m_));
+    }
+
+    // A rigid transform is also affine
+    template<transform_kind L>
+        requires (K == transform_kind::affine && L == transform_kind::rigid)
+    constexpr transform3(const transform3<L, T>& other) noexcept : m_(other.matrix()) {}
+
+    [[nodiscard]] static constexpr transform3 translate(const vec<3, T>& v) noexcept {
+        return transform3(ct::translate(v), trusted{});
+    }
+
+    [[nodiscard]] static constexpr transform3 scale(const vec<3, T>& v) noexcept
+        requires (K == transform_kind::affine) {
+        return transform3(ct::scale(v), trusted{});
+    }
+
+    [[nodiscard]] static constexpr transform3 scale(T s) noexcept requires (K == transform_kind::affine) {
+        return transform3(ct::scale(s), trusted{});
+    }
+
+    [[nodiscard]] static transform3 rotate_x(T angle) noexcept { return transform3(ct::rotate_x(angle), trusted{}); }
+    [[nodiscard]] static transform3 rotate_y(T angle) noexcept { return transform3(ct::rotate_y(angle), trusted{}); }
+    [[nodiscard]] static transform3 rotate_z(T angle) noexcept { return transform3(ct::rotate_z(angle), trusted{}); }
+
+    [[nodiscard]] static transform3 rotate(T angle, const vec<3, T>& axis) noexcept {
+        return transform3(ct::rotate(angle, axis), trusted{});
+    }
+
+    // rotate_x * rotate_y * rotate_z, as ct::rotate(angles)
+    [[nodiscard]] static transform3 rotate(const vec<3, T>& angles) noexcept {
+        return rotate_x(angles[0]) * rotate_y(angles[1]) * rotate_z(angles[2]);
+    }
+
+    // The view matrix of lookAt, which is rigid
+    [[nodiscard]] static transform3 look_at(const vec<3, T>& eye, const vec<3, T>& center,
+                                            const vec<3, T>& up) noexcept {
+        return transform3(ct::lookAt(eye, center, up), trusted{});
+    }
+
+    [[nodiscard]] constexpr const matrix_type& matrix() const noexcept { return m_; }
+
+    constexpr operator const matrix_type&() const noexcept { return m_; }
+
+    [[nodiscard]] constexpr mat<3, 3, T> linear() const noexcept {
+        return mat<3, 3, T>(layout::rowm,
+                            m_(0, 0), m_(0, 1), m_(0, 2),
+                            m_(1, 0), m_(1, 1), m_(1, 2),
+                            m_(2, 0), m_(2, 1), m_(2, 2));
+    }
+
+    [[nodiscard]] constexpr vec<3, T> translation() const noexcept {
+        return vec<3, T>(m_(0, 3), m_(1, 3), m_(2, 3));
+    }
+
+    [[nodiscard]] constexpr vec<3, T> transform_point(const vec<3, T>& p) const noexcept {
+        return vec<3, T>(m_(0, 0) * p[0] + m_(0, 1) * p[1] + m_(0, 2) * p[2] + m_(0, 3),
+                         m_(1, 0) * p[0] + m_(1, 1) * p[1] + m_(1, 2) * p[2] + m_(1, 3),
+                         m_(2, 0) * p[0] + m_(2, 1) * p[1] + m_(2, 2) * p[2] + m_(2, 3));
+    }
+
+    [[nodiscard]] constexpr vec<3, T> transform_vector(const vec<3, T>& v) const noexcept {
+        return vec<3, T>(m_(0, 0) * v[0] + m_(0, 1) * v[1] + m_(0, 2) * v[2],
+                         m_(1, 0) * v[0] + m_(1, 1) * v[1] + m_(1, 2) * v[2],
+                         m_(2, 0) * v[0] + m_(2, 1) * v[1] + m_(2, 2) * v[2]);
+    }
+
+    // As a point, like se3
+    [[nodiscard]] constexpr vec<3, T> operator*(const vec<3, T>& p) const noexcept { return transform_point(p); }
+
+    // Rigid: (R^T, -R^T t). Affine: (A^-1, -A^-1 t) by cofactors, falling back to the
+    // identity like mat3::inverse when A is singular relative to the length of its columns.
+    [[nodiscard]] transform3 inverse() const noexcept {
+        const matrix_type& m = m_;
+        mat<3, 3, T> a;
+        if constexpr (K == transform_kind::rigid) {
+            a = mat<3, 3, T>(layout::rowm,
+                             m(0, 0), m(1, 0), m(2, 0),
+                             m(0, 1), m(1, 1), m(2, 1),
+                             m(0, 2), m(1, 2), m(2, 2));
+        } else {
+            const T c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+            const T c10 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+            const T c20 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+            const T d = m(0, 0) * c00 + m(0, 1) * c10 + m(0, 2) * c20;
+            //NOTE: |d| is at most the product of the column lengths (Hadamard), so comparing
+            //      against that keeps uniformly small or large scales invertible
+            const T bound = vec<3, T>(m(0, 0), m(1, 0), m(2, 0)).length() *
+                            vec<3, T>(m(0, 1), m(1, 1), m(2, 1)).length() *
+                            vec<3, T>(m(0, 2), m(1, 2), m(2, 2)).length();
+            if (abs(d) <= epsilon<T> * bound) return transform3();
+
+            const T inv_det = T{1} / d;
+            a = mat<3, 3, T>(layout::rowm,
+                             c00 * inv_det,
+                             (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * inv_det,
+                             (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * inv_det,
+
+                             c10 * inv_det,
+                             (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * inv_det,
+                             (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * inv_det,
+
+                             c20 * inv_det,
+                             (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * inv_det,
+                             (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * inv_det);
+        }
+        const vec<3, T> t = translation();
+        return transform3(a, vec<3, T>(-(a(0, 0) * t[0] + a(0, 1) * t[1] + a(0, 2) * t[2]),
+                                       -(a(1, 0) * t[0] + a(1, 1) * t[1] + a(1, 2) * t[2]),
+                                       -(a(2, 0) * t[0] + a(2, 1) * t[1] + a(2, 2) * t[2])), trusted{});
+    }
+
+    // Rigid only: re-orthonormalizes the rotation (Gram-Schmidt on its columns), for poses
+    // built up from long chains of products
+    [[nodiscard]] transform3 orthonormalized() const noexcept requires (K == transform_kind::rigid) {
+        const mat<3, 3, T> r = linear();
+        const vec<3, T> x = vec<3, T>(r(0, 0), r(1, 0), r(2, 0)).normalized();
+        vec<3, T> y(r(0, 1), r(1, 1), r(2, 1));
+        y = (y - x * x.dot(y)).normalized();
+        const vec<3, T> z = x.cross(y);
+        return transform3(mat<3, 3, T>(layout::rowm,
+                                       x[0], y[0], z[0],
+                                       x[1], y[1], z[1],
+                                       x[2], y[2], z[2]), translation(), trusted{});
+    }
+
+    // Rigid * rigid stays rigid; anything with an affine operand is affine
+    template<transform_kind L>
+    [[nodiscard]] transform3<K == transform_kind::rigid && L == transform_kind::rigid ? transform_kind::rigid
+                                                                                        : transform_kind::affine, T>
+    operator*(const transform3<L, T>& rhs) const noexcept {
+        using result = transform3<K == transform_kind::rigid && L == transform_kind::rigid ? transform_kind::rigid
+                                                                                             : transform_kind::affine, T>;
+        matrix_type r;
+        detail::affine_mul_lanes(m_, rhs.matrix(), r);
+        return result(r, typename result::trusted{});
+    }
+
+    template<transform_kind L>
+    constexpr transform3& operator*=(const transform3<L, T>& rhs) noexcept
+        requires (K == transform_kind::affine || L == transform_kind::rigid) {
+        return *this = *this * rhs;
+    }
+
+    // Projective * affine: the affine operand's last row is 0 0 0 1, so 48 multiply-adds
+    [[nodiscard]] friend matrix_type operator*(const matrix_type& a, const transform3& b) noexcept {
+        matrix_type r;
+        detail::affine_mul_lanes(a, b.m_, r);
+        return r;
+    }
+
+    // Affine * projective: the first three rows of a times b, with b's last row copied
+    [[nodiscard]] friend matrix_type operator*(const transform3& a, const matrix_type& b) noexcept {
+        matrix_type r;
+        for (std::size_t j = 0; j < 4; ++j) {
+            for (std::size_t i = 0; i < 3; ++i) {
+                r(i, j) = a.m_(i, 0) * b(0, j) + a.m_(i, 1) * b(1, j) + a.m_(i, 2) * b(2, j) + a.m_(i, 3) * b(3, j);
+            }
+            r(3, j) = b(3, j);
+        }
+        return r;
+    }
+
+private:
+    template<transform_kind, floating_point>
+    friend class transform3;
+
+    struct trusted {};
+
+    constexpr transform3(const matrix_type& m, trusted) noexcept : m_(m) {}
+
+    constexpr transform3(const mat<3, 3, T>& linear, const vec<3, T>& translation, trusted) noexcept
+        : m_(layout::rowm,
+             linear(0, 0), linear(0, 1), linear(0, 2), translation[0],
+             linear(1, 0), linear(1, 1), linear(1, 2), translation[1],
+             linear(2, 0), linear(2, 1), linear(2, 2), translation[2],
+             T{0},         T{0},         T{0},         T{1}) {}
+
+    matrix_type m_;
+};
+
 } // namespace cc
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "./fwd.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../common/functions.hpp"
+#include "../common/constants.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+#include "../mat/mat3.hpp"
+#include "../quat/quat.hpp"
+
+#include <type_traits>
+
+namespace ct {
+
+namespace detail {
+
+// Below this rotation angle the closed forms lose digits to cancellation and the
+// coefficients switch to their Taylor series (truncation error under epsilon<T>)
+template<floating_point T>
+inline constexpr T lie_series_angle = sizeof(T) <= 4 ? T(0.1) : T(0.01);
+
+// Scalar coefficients shared by the SO(3) and SE(3) Jacobians, functions of t = |phi|
+template<floating_point T>
+struct rodrigues_terms {
+    T b;  // (1 - cos t) / t^2
+    T c;  // (t - sin t) / t^3
+    T d;  // 1 / t^2 - (1 + cos t) / (2 t sin t)
+    T e;  // (t^2 + 2 cos t - 2) / (2 t^4)
+    T f;  // (2 t - 3 sin t + t cos t) / (2 t^5)
+};
+
+template<floating_point T>
+[[nodiscard]] inline rodrigues_terms<T> rodrigues(T theta_sq) noexcept {
+    if (theta_sq < lie_series_angle<T> * lie_series_angle<T>) {
+        const T t2 = theta_sq;
+        const T t4 = t2 * t2;
+        return {T{1} / T{2} - t2 / T{24} + t4 / T{720},
+                T{1} / T{6} - t2 / T{120} + t4 / T{5040},
+                T{1} / T{12} + t2 / T{720} + t4 / T{30240},
+                T{1} / T{24} - t2 / T{720} + t4 / T{40320},
+                T{1} / T{120} - t2 / T{2520} + t4 / T{120960}};
+    }
+    const T t = sqrt(theta_sq);
+    //NOTE: Half-angle forms keep 1 - cos t and cot(t / 2) accurate up to t = pi
+    const T sh = sin(t / T{2});
+    const T ch = cos(t / T{2});
+    const T s = T{2} * sh * ch;
+    const T one_minus_c = T{2} * sh * sh;
+    const T t4 = theta_sq * theta_sq;
+    return {one_minus_c / theta_sq,
+            (t - s) / (theta_sq * t),
+            T{1} / theta_sq - ch / (T{2} * t * sh),
+            (theta_sq - T{2} * one_minus_c) / (T{2} * t4),
+            (T{2} * t - T{3} * s + t * (T{1} - one_minus_c)) / (T{2} * t4 * t)};
+}
+
+} // namespace detail
+
+// Rotation group SO(3) stored as a unit quaternion (16 bytes for float). Tangent vectors
+// are rotation vectors phi = angle * axis; exp() and log() map between the two, and the
+// Jacobians relate perturbations in the tangent space to perturbations of the group:
+// exp(phi + d) ~ exp(J_l(phi) d) exp(phi) ~ exp(phi) exp(J_r(phi) d).
+template<floating_point T>
+class so3 {
+public:
+    using value_type = T;
+    using tangent = vec<3, T>;
+
+    constexpr so3() noexcept = default;
+
+    // Normalizes q; q and -q are the same rotation
+    explicit so3(const quat<T>& q) noexcept : q_(q.normalized()) {}
+
+    [[nodiscard]] static constexpr so3 identity() noexcept { return so3(); }
+
+    [[nodiscard]] static so3 exp(const tangent& phi) noexcept {
+        const T t2 = phi.length_squared();
+        T k;
+        T w;
+        if (t2 < detail::lie_series_angle<T> * detail::lie_series_angle<T>) {
+            k = T{1} / T{2} - t2 / T{48} + t2 * t2 / T{3840};
+            w = T{1} - t2 / T{8} + t2 * t2 / T{384};
+        } else {
+            const T t = sqrt(t2);
+            k = sin(t / T{2}) / t;
+            w = cos(t / T{2});
+        }
+        return so3(unit_tag{}, quat<T>(phi.x * k, phi.y * k, phi.z * k, w));
+    }
+
+    // Rotation matrix to quaternion (Shepperd); m must be orthonormal, use polar() first otherwise
+    [[nodiscard]] static so3 from_matrix(const mat<3, 3, T>& m) noexcept {
+        const T tr = m(0, 0) + m(1, 1) + m(2, 2);
+        if (tr > T{}) {
+            const T s = sqrt(tr + T{1}) * T{2};
+            return so3(quat<T>((m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s, s / T{4}));
+        }
+        if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2)) {
+            const T s = sqrt(T{1} + m(0, 0) - m(1, 1) - m(2, 2)) * T{2};
+            return so3(quat<T>(s / T{4}, (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s, (m(2, 1) - m(1, 2)) / s));
+        }
+        if (m(1, 1) > m(2, 2)) {
+            const T s = sqrt(T{1} + m(1, 1) - m(0, 0) - m(2, 2)) * T{2};
+            return so3(quat<T>((m(0, 1) + m(1, 0)) / s, s / T{4}, (m(1, 2) + m(2, 1)) / s, (m(0, 2) - m(2, 0)) / s));
+        }
+        const T s = sqrt(T{1} + m(2, 2) - m(0, 0) - m(1, 1)) * T{2};
+        return so3(quat<T>((m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / T{4}, (m(1, 0) - m(0, 1)) / s));
+    }
+
+    // Rotation vector with angle in [0, pi]
+    [[nodiscard]] tangent log() const noexcept {
+        //NOTE: Pick the hemisphere with w >= 0 so the angle is the short way round
+        const T sgn = q_.w < T{} ? T{-1} : T{1};
+        const T w = q_.w * sgn;
+        const T n2 = q_.x * q_.x + q_.y * q_.y + q_.z * q_.z;
+        //NOTE: atan2(n, w) / n stays accurate as n -> 0 (atan2 ~ n / w to the last bit), so
+        //      only the identity itself needs its limit 2 / w; an (n / w)^2 series would need
+        //      many terms to reach epsilon<T> over the lie_series_angle range
+        const T n = sqrt(n2);
+        T k = n > T{} ? T{2} * atan2(n, w) / n : T{2} / w;
+        k *= sgn;
+        return tangent(q_.x * k, q_.y * k, q_.z * k);
+    }
+
+    [[nodiscard]] constexpr so3 inverse() const noexcept { return so3(unit_tag{}, q_.conjugate()); }
+
+    [[nodiscard]] constexpr const quat<T>& quaternion() const noexcept { return q_; }
+
+    [[nodiscard]] constexpr mat<3, 3, T> matrix() const noexcept {
+        const T xx = q_.x * q_.x;
+        const T yy = q_.y * q_.y;
+        const T zz = q_.z * q_.z;
+        const T xy = q_.x * q_.y;
+        const T xz = q_.x * q_.z;
+        const T yz = q_.y * q_.z;
+        const T wx = q_.w * q_.x;
+        const T wy = q_.w * q_.y;
+        const T wz = q_.w * q_.z;
+        return mat<3, 3, T>(layout::rowm,
+                            T{1} - T{2} * (yy + zz), T{2} * (xy - wz),        T{2} * (xz + wy),
+                            T{2} * (xy + wz),        T{1} - T{2} * (xx + zz), T{2} * (yz - wx),
+                            T{2} * (xz - wy),        T{2} * (yz + wx),        T{1} - T{2} * (xx + yy));
+    }
+
+    // Maps tangent vectors at this element to the identity: Ad(R) = R
+    [[nodiscard]] constexpr mat<3, 3, T> adjoint() const noexcept { return matrix(); }
+
+    // The first-order rescale keeps long composition chains on the unit sphere for four
+    // multiply-adds instead of a square root
+    [[nodiscard]] friend constexpr so3 operator*(const so3& a, const so3& b) noexcept {
+        quat<T> q = a.q_ * b.q_;
+        q *= (T{3} - quat<T>::dot(q, q)) / T{2};
+        return so3(unit_tag{}, q);
+    }
+
+    constexpr so3& operator*=(const so3& o) noexcept { return *this = *this * o; }
+
+    // v' = v + w t + u x t with t = 2 u x v, u the vector part: two cross products
+    [[nodiscard]] friend constexpr vec<3, T> operator*(const so3& r, const vec<3, T>& v) noexcept {
+        const vec<3, T> u(r.q_.x, r.q_.y, r.q_.z);
+        const vec<3, T> t = u.cross(v) * T{2};
+        return v + t * r.q_.w + u.cross(t);
+    }
+
+    // Skew-symmetric matrix with hat(a) b = a x b
+    [[nodiscard]] static constexpr mat<3, 3, T> hat(const tangent& a) noexcept {
+        return mat<3, 3, T>(layout::rowm,
+                            T{0},  -a.z,  a.y,
+                            a.z,   T{0}, -a.x,
+                            -a.y,  a.x,  T{0});
+    }
+
+    [[nodiscard]] static constexpr tangent vee(const mat<3, 3, T>& m) noexcept {
+        return tangent(m(2, 1), m(0, 2), m(1, 0));
+    }
+
+    // J_l(phi) = I + b hat(phi) + c hat(phi)^2
+    [[nodiscard]] static mat<3, 3, T> left_jacobian(const tangent& phi) noexcept {
+        const auto k = detail::rodrigues(phi.length_squared());
+        const mat<3, 3, T> h = hat(phi);
+        return mat<3, 3, T>::identity() + h * k.b + h * h * k.c;
+    }
+
+    // J_l(phi)^-1 = I - hat(phi) / 2 + d hat(phi)^2; singular at |phi| = 2 pi
+    [[nodiscard]] static mat<3, 3, T> left_jacobian_inverse(const tangent& phi) noexcept {
+        const auto k = detail::rodrigues(phi.length_squared());
+        const mat<3, 3, T> h = hat(phi);
+        return mat<3, 3, T>::identity() - h * (T{1} / T{2}) + h * h * k.d;
+    }
+
+    [[nodiscard]] static mat<3, 3, T> right_jacobian(const tangent& phi) noexcept { return left_jacobian(-phi); }
+
+    [[nodiscard]] static mat<3, 3, T> right_jacobian_inverse(const tangent& phi) noexcept {
+        return left_jacobian_inverse(-phi);
+    }
+
+private:
+    struct unit_tag {};
+
+    constexpr so3(unit_tag, const quat<T>& q) noexcept : q_(q) {}
+
+    quat<T> q_{};
+};
+
+// Geodesic interpolation a exp(t log(a^-1 b)), t in [0, 1]; equals slerp along the short arc
+template<floating_point T>
+[[nodiscard]] so3<T> interpolate(const so3<T>& a, const so3<T>& b, T t) noexcept {
+    return a * so3<T>::exp((a.inverse() * b).log() * t);
+}
+
+static_assert(std::is_trivially_copyable_v<so3<float>>);
+static_assert(sizeof(so3<float>) == 16);
+
+} // namespace ct
@@ -4,6 +4,7 @@
 #include "./base.hpp"
 #include "./mat3.hpp"       // IWYU pragma: keep
 #include "./mat4.hpp"       // IWYU pragma: keep
+#include "../decomp/lu.hpp" // IWYU pragma: keep
 #include "../common/functions.hpp"  // IWYU pragma: keep
 #include "../common/constants.hpp" // IWYU pragma: keep
 
@@ -8,4 +8,16 @@ namespace ct {
 template<std::size_t Rows, std::size_t Cols, arithmetic T>
 class mat;
 
+// Which class of 4x4 transform a transform3 is known to hold
+enum class transform_kind { affine, rigid };
+
+template<transform_kind K, floating_point T>
+class transform3;
+
+template<floating_point T>
+using affine3 = transform3<transform_kind::affine, T>;
+
+template<floating_point T>
+using rigid3 = transform3<transform_kind::rigid, T>;
+
 } // namespace cc
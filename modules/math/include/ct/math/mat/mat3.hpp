@@ -166,7 +166,7 @@ public:
     }
 
     [[nodiscard]] constexpr mat transpose() const noexcept {
-        return mat(layout::colm,
+        return mat(layout::rowm,
                    m00, m10, m20,
                    m01, m11, m21,
                    m02, m12, m22);
@@ -193,7 +193,7 @@ public:
              + m02 * (m10 * m21 - m11 * m20);
     }
 
-    [[nodiscard]] mat inverse() const noexcept requires floating_point<T> {
+    [[nodiscard]] mat inverse() const noexcept requires real<T> {
         const T d = det();
         if (abs(d) <= epsilon<T>) {
             return identity();
@@ -185,7 +185,7 @@ public:
     }
 
     [[nodiscard]] constexpr mat transpose() const noexcept {
-        return mat(layout::colm,
+        return mat(layout::rowm,
                    m00, m10, m20, m30,
                    m01, m11, m21, m31,
                    m02, m12, m22, m32,
@@ -231,7 +231,7 @@ public:
                a3 * b2 - a4 * b1 + a5 * b0;
     }
 
-    [[nodiscard]] mat inverse() const noexcept requires floating_point<T> {
+    [[nodiscard]] mat inverse() const noexcept requires real<T> {
         const T a0 = m00 * m11 - m01 * m10;
         const T a1 = m00 * m12 - m02 * m10;
         const T a2 = m00 * m13 - m03 * m10;
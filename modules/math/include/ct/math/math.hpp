@@ -2,8 +2,16 @@
 
 // IWYU pragma: begin_exports
 #include "detail/arithmetic.hpp"
+#include "detail/simd.hpp"
+#include "detail/aligned.hpp"
+#include "detail/pack.hpp"
+#include "parallel/parallel.hpp"
+#include "parallel/sort.hpp"
 #include "common/constants.hpp"
 #include "common/functions.hpp"
+#include "common/half.hpp"
+#include "common/format.hpp"
+#include "common/jet.hpp"
 
 #include "vec/fwd.hpp"
 #include "vec/base.hpp"
@@ -13,6 +21,8 @@
 #include "vec/functions.hpp"
 #include "vec/format.hpp"
 
+#include "common/convert.hpp"
+
 #include "mat/fwd.hpp"
 #include "mat/base.hpp"
 #include "mat/mat3.hpp"
@@ -20,8 +30,55 @@
 #include "mat/functions.hpp"
 #include "mat/format.hpp"
 
+#include "decomp/lu.hpp"
+#include "decomp/llt.hpp"
+#include "decomp/ldlt.hpp"
+#include "decomp/qr.hpp"
+#include "decomp/eigen.hpp"
+#include "decomp/svd.hpp"
+#include "decomp/svd3.hpp"
+
 #include "quat/fwd.hpp"
 #include "quat/quat.hpp"
+#include "quat/batch.hpp"
+
+#include "lie/fwd.hpp"
+#include "lie/so3.hpp"
+#include "lie/se3.hpp"
+
+#include "dense/fwd.hpp"
+#include "dense/view.hpp"
+#include "dense/gemm.hpp"
+#include "dense/vecx.hpp"
+#include "dense/matx.hpp"
+
+#include "sparse/csr.hpp"
+#include "sparse/bsr.hpp"
+#include "sparse/ordering.hpp"
+#include "sparse/cholesky.hpp"
+#include "sparse/pcg.hpp"
+#include "optim/manifold.hpp"
+#include "optim/loss.hpp"
+#include "optim/problem.hpp"
+#include "optim/solver.hpp"
+#include "optim/autodiff.hpp"
+
+#include "fft/plan.hpp"
+#include "fft/fft.hpp"
+#include "fft/convolve.hpp"
+
+#include "scene/hierarchy.hpp"
+
+#include "geom/primitives.hpp"
+#include "geom/batch.hpp"
+#include "geom/bvh.hpp"
+#include "geom/kdtree.hpp"
+#include "geom/reduce.hpp"
+#include "geom/morton.hpp"
+#include "geom/voxel.hpp"
+
+#include "random/engine.hpp"
+#include "random/sample.hpp"
 
 #include "interop/op.hpp"
 #include "interop/transform.hpp"
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "./manifold.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../common/jet.hpp"
+#include "../vec/base.hpp"
+#include "../mat/base.hpp"
+#include "../quat/quat.hpp"
+#include "../lie/so3.hpp"
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ct {
+
+namespace optim {
+
+// How a parameter block is handed to a templated residual with scalar S, and how it is
+// lifted to jets seeded at its tangent offset. Additive blocks keep their shape; rotations
+// arrive as quat<S> perturbed on the left by the tangent increment d, exp(d) x, to first
+// order, which is all a jet can see.
+template<typename P>
+struct autodiff_block;
+
+template<floating_point T>
+struct autodiff_block<T> {
+    template<typename S>
+    using type = S;
+
+    [[nodiscard]] static T value(const T& x) noexcept { return x; }
+
+    template<typename J>
+    [[nodiscard]] static J lift(const T& x, std::size_t offset) noexcept { return J::variable(x, offset); }
+
+    template<typename J>
+    [[nodiscard]] static J constant(const T& x) noexcept { return J(x); }
+};
+
+template<std::size_t N, floating_point T>
+struct autodiff_block<vec<N, T>> {
+    template<typename S>
+    using type = vec<N, S>;
+
+    [[nodiscard]] static const vec<N, T>& value(const vec<N, T>& x) noexcept { return x; }
+
+    template<typename J>
+    [[nodiscard]] static vec<N, J> lift(const vec<N, T>& x, std::size_t offset) noexcept {
+        vec<N, J> r;
+        for (std::size_t i = 0; i < N; ++i) r[i] = J::variable(x[i], offset + i);
+        return r;
+    }
+
+    template<typename J>
+    [[nodiscard]] static vec<N, J> constant(const vec<N, T>& x) noexcept { return vec<N, J>(x); }
+};
+
+template<std::size_t N, floating_point T>
+struct autodiff_block<std::array<T, N>> {
+    template<typename S>
+    using type = std::array<S, N>;
+
+    [[nodiscard]] static const std::array<T, N>& value(const std::array<T, N>& x) noexcept { return x; }
+
+    template<typename J>
+    [[nodiscard]] static std::array<J, N> lift(const std::array<T, N>& x, std::size_t offset) noexcept {
+        std::array<J, N> r;
+        for (std::size_t i = 0; i < N; ++i) r[i] = J::variable(x[i], offset + i);
+        return r;
+    }
+
+    template<typename J>
+    [[nodiscard]] static std::array<J, N> constant(const std::array<T, N>& x) noexcept {
+        std::array<J, N> r;
+        for (std::size_t i = 0; i < N; ++i) r[i] = J(x[i]);
+        return r;
+    }
+};
+
+template<std::size_t R, std::size_t C, floating_point T>
+struct autodiff_block<mat<R, C, T>> {
+    template<typename S>
+    using type = mat<R, C, S>;
+
+    [[nodiscard]] static const mat<R, C, T>& value(const mat<R, C, T>& x) noexcept { return x; }
+
+    template<typename J>
+    [[nodiscard]] static mat<R, C, J> lift(const mat<R, C, T>& x, std::size_t offset) noexcept {
+        mat<R, C, J> r;
+        for (std::size_t c = 0; c < C; ++c) {
+            for (std::size_t i = 0; i < R; ++i) r(i, c) = J::variable(x(i, c), offset + c * R + i);
+        }
+        return r;
+    }
+
+    template<typename J>
+    [[nodiscard]] static mat<R, C, J> constant(const mat<R, C, T>& x) noexcept { return mat<R, C, J>(x); }
+};
+
+namespace detail {
+
+// (d / 2, 1) * q: exp(d) q to first order in d, with d seeded at offset
+template<typename J, floating_point T>
+[[nodiscard]] quat<J> perturb_left(const quat<T>& q, std::size_t offset) noexcept {
+    const J h(T{1} / T{2});
+    const quat<J> e(J::variable(T{}, offset) * h, J::variable(T{}, offset + 1) * h,
+                    J::variable(T{}, offset + 2) * h, J(T{1}));
+    return e * quat<J>(J(q.x), J(q.y), J(q.z), J(q.w));
+}
+
+template<typename J, floating_point T>
+[[nodiscard]] quat<J> lift_constant(const quat<T>& q) noexcept {
+    return quat<J>(J(q.x), J(q.y), J(q.z), J(q.w));
+}
+
+} // namespace detail
+
+template<floating_point T>
+struct autodiff_block<quat<T>> {
+    template<typename S>
+    using type = quat<S>;
+
+    [[nodiscard]] static const quat<T>& value(const quat<T>& x) noexcept { return x; }
+
+    template<typename J>
+    [[nodiscard]] static quat<J> lift(const quat<T>& x, std::size_t offset) noexcept {
+        return detail::perturb_left<J>(x, offset);
+    }
+
+    template<typename J>
+    [[nodiscard]] static quat<J> constant(const quat<T>& x) noexcept { return detail::lift_constant<J>(x); }
+};
+
+template<floating_point T>
+struct autodiff_block<so3<T>> {
+    template<typename S>
+    using type = quat<S>;
+
+    [[nodiscard]] static const quat<T>& value(const so3<T>& x) noexcept { return x.quaternion(); }
+
+    template<typename J>
+    [[nodiscard]] static quat<J> lift(const so3<T>& x, std::size_t offset) noexcept {
+        return detail::perturb_left<J>(x.quaternion(), offset);
+    }
+
+    template<typename J>
+    [[nodiscard]] static quat<J> constant(const so3<T>& x) noexcept { return detail::lift_constant<J>(x.quaternion()); }
+};
+
+// Cost functor for problem::add_residual from a residual written once against its scalar:
+//
+//     struct reprojection {
+//         vec2d uv;
+//         template<typename S>
+//         bool operator()(const vec<4, S>& fxfycxcy, const quat<S>& r, const vec<3, S>& t,
+//                         const vec<3, S>& p, mat<2, 1, S>& res) const;
+//     };
+//     problem.add_residual(optim::make_autodiff<2, vec4d, so3d, vec3d, vec3d>(reprojection{uv}),
+//                          &intrinsics, &rotation, &translation, &point);
+//
+// Jacobians come from one evaluation on jet<T, sum of tangent sizes>; constant blocks are
+// passed as plain constants. When no Jacobian is asked for, the functor runs on T.
+// se3 blocks are not supported; use an so3 block and a vec3 block instead.
+template<typename F, std::size_t R, typename... P>
+class autodiff {
+    static_assert(sizeof...(P) > 0);
+
+    using T = typename manifold<std::tuple_element_t<0, std::tuple<P...>>>::value_type;
+    static constexpr std::size_t K = sizeof...(P);
+    static constexpr std::array<std::size_t, K> sizes{tangent_size_v<P>...};
+
+    static constexpr std::array<std::size_t, K> offsets = [] {
+        std::array<std::size_t, K> o{};
+        for (std::size_t k = 1; k < K; ++k) o[k] = o[k - 1] + sizes[k - 1];
+        return o;
+    }();
+
+public:
+    static constexpr std::size_t residuals = R;
+    static constexpr std::size_t variables = (tangent_size_v<P> + ...);
+
+    using jet_type = jet<T, variables>;
+
+    explicit autodiff(F fn) : fn_(std::move(fn)) {}
+
+    [[nodiscard]] const F& functor() const noexcept { return fn_; }
+
+    bool operator()(const P&... x, mat<R, 1, T>& r, mat<R, tangent_size_v<P>, T>*... j) const {
+        if (((j == nullptr) && ...)) {
+            return static_cast<bool>(fn_(autodiff_block<P>::value(x)..., r));
+        }
+        return evaluate(std::forward_as_tuple(x...), r, std::make_tuple(j...), std::index_sequence_for<P...>{});
+    }
+
+private:
+    template<typename Xs, typename Js, std::size_t... I>
+    bool evaluate(const Xs& x, mat<R, 1, T>& r, const Js& j, std::index_sequence<I...>) const {
+        mat<R, 1, jet_type> rj;
+        const bool ok = static_cast<bool>(fn_(lift<I>(std::get<I>(x), std::get<I>(j) != nullptr)..., rj));
+        if (!ok) return false;
+        for (std::size_t e = 0; e < R; ++e) r(e, 0) = rj(e, 0).value();
+        (extract<I>(rj, std::get<I>(j)), ...);
+        return true;
+    }
+
+    template<std::size_t I, typename X>
+    [[nodiscard]] static auto lift(const X& x, bool variable) noexcept {
+        using block = autodiff_block<X>;
+        return variable ? block::template lift<jet_type>(x, offsets[I]) : block::template constant<jet_type>(x);
+    }
+
+    template<std::size_t I, typename J>
+    static void extract(const mat<R, 1, jet_type>& rj, J* out) noexcept {
+        if (out == nullptr) return;
+        for (std::size_t e = 0; e < R; ++e) {
+            for (std::size_t i = 0; i < sizes[I]; ++i) (*out)(e, i) = rj(e, 0).derivative(offsets[I] + i);
+        }
+    }
+
+    F fn_;
+};
+
+template<std::size_t R, typename... P, typename F>
+[[nodiscard]] autodiff<F, R, P...> make_autodiff(F fn) {
+    return autodiff<F, R, P...>(std::move(fn));
+}
+
+} // namespace optim
+
+} // namespace ct
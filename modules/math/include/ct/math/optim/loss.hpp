@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../common/functions.hpp"
+
+#include <cmath>
+
+namespace ct {
+
+namespace optim {
+
+enum class loss_kind { none, huber, cauchy, tukey };
+
+// Robust loss rho(s) on the squared norm s = |r|^2 of a residual block; the solver
+// minimizes 1/2 sum rho(|r_i|^2). scale is the residual norm where down-weighting
+// starts: Huber grows linearly past it, Cauchy logarithmically, and Tukey ignores
+// residuals beyond it altogether (only use it from a good starting point).
+template<floating_point T>
+struct robust_loss {
+    loss_kind kind{loss_kind::none};
+    T scale{1};
+
+    // rho(s) and rho'(s); the derivative is the weight the block gets in the normal equations
+    struct value {
+        T rho;
+        T weight;
+    };
+
+    [[nodiscard]] static constexpr robust_loss none() noexcept { return {}; }
+    [[nodiscard]] static constexpr robust_loss huber(T delta) noexcept { return {loss_kind::huber, delta}; }
+    [[nodiscard]] static constexpr robust_loss cauchy(T c) noexcept { return {loss_kind::cauchy, c}; }
+    [[nodiscard]] static constexpr robust_loss tukey(T c) noexcept { return {loss_kind::tukey, c}; }
+
+    [[nodiscard]] value evaluate(T s) const noexcept {
+        const T c2 = scale * scale;
+        switch (kind) {
+            case loss_kind::huber: {
+                if (s <= c2) return {s, T{1}};
+                const T r = sqrt(s);
+                return {T{2} * scale * r - c2, scale / r};
+            }
+            case loss_kind::cauchy: {
+                const T u = s / c2;
+                return {c2 * std::log1p(u), T{1} / (T{1} + u)};
+            }
+            case loss_kind::tukey: {
+                if (s >= c2) return {c2 / T{3}, T{0}};
+                const T v = T{1} - s / c2;
+                return {c2 / T{3} * (T{1} - v * v * v), v * v};
+            }
+            default:
+                return {s, T{1}};
+        }
+    }
+};
+
+} // namespace optim
+
+} // namespace ct
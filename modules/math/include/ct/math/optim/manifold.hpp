@@ -0,0 +1,114 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+#include "../mat/base.hpp"
+#include "../quat/quat.hpp"
+#include "../lie/so3.hpp"
+#include "../lie/se3.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+
+namespace ct {
+
+namespace optim {
+
+// How the solver updates a parameter block. tangent_size is the number of unknowns the
+// block adds to the problem and plus(x, d) applies an increment of that many values.
+// Specialize for other parameter types; they must be trivially copyable.
+template<typename P>
+struct manifold;
+
+template<floating_point T>
+struct manifold<T> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = 1;
+
+    static void plus(T& x, const T* d) noexcept { x += d[0]; }
+};
+
+template<std::size_t N, floating_point T>
+struct manifold<vec<N, T>> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = N;
+
+    static void plus(vec<N, T>& x, const T* d) noexcept {
+        for (std::size_t i = 0; i < N; ++i) x[i] += d[i];
+    }
+};
+
+template<std::size_t N, floating_point T>
+struct manifold<std::array<T, N>> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = N;
+
+    static void plus(std::array<T, N>& x, const T* d) noexcept {
+        for (std::size_t i = 0; i < N; ++i) x[i] += d[i];
+    }
+};
+
+// Column-major increments, e.g. a homography as mat<3, 3> with one entry held by the cost
+template<std::size_t R, std::size_t C, floating_point T>
+struct manifold<mat<R, C, T>> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = R * C;
+
+    static void plus(mat<R, C, T>& x, const T* d) noexcept {
+        for (std::size_t c = 0; c < C; ++c) {
+            for (std::size_t r = 0; r < R; ++r) x(r, c) += d[c * R + r];
+        }
+    }
+};
+
+// Rotations and poses take increments in the tangent space on the left, x <- exp(d) x,
+// so the Jacobian of x * p is -hat(x * p) for rotations and se3::point_jacobian for poses.
+// Three (six) unknowns per block instead of four (seven) constrained ones.
+
+template<floating_point T>
+struct manifold<so3<T>> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = 3;
+
+    static void plus(so3<T>& x, const T* d) noexcept { x = so3<T>::exp(vec<3, T>(d[0], d[1], d[2])) * x; }
+};
+
+//NOTE: Renormalized after each step; the cost sees a unit quaternion
+template<floating_point T>
+struct manifold<quat<T>> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = 3;
+
+    static void plus(quat<T>& x, const T* d) noexcept {
+        x = (so3<T>::exp(vec<3, T>(d[0], d[1], d[2])) * so3<T>(x)).quaternion();
+    }
+};
+
+// Twist (rho, phi), as se3::exp
+template<floating_point T>
+struct manifold<se3<T>> {
+    using value_type = T;
+    static constexpr std::size_t tangent_size = 6;
+
+    static void plus(se3<T>& x, const T* d) noexcept {
+        typename se3<T>::tangent xi;
+        for (std::size_t i = 0; i < 6; ++i) xi[i] = d[i];
+        x = se3<T>::exp(xi) * x;
+    }
+};
+
+template<typename P, typename T>
+concept parameter_block = requires(P& x, const T* d) {
+    { manifold<P>::tangent_size } -> std::convertible_to<std::size_t>;
+    manifold<P>::plus(x, d);
+} && std::is_same_v<typename manifold<P>::value_type, T> && std::is_trivially_copyable_v<P>;
+
+template<typename P>
+inline constexpr std::size_t tangent_size_v = manifold<P>::tangent_size;
+
+} // namespace optim
+
+} // namespace ct
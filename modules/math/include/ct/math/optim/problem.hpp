@@ -0,0 +1,357 @@
+#pragma once
+
+#include "./manifold.hpp"
+#include "./loss.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../mat/base.hpp"
+#include "../sparse/csr.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ct {
+
+namespace optim {
+
+template<floating_point T>
+class problem;
+
+namespace detail {
+
+template<floating_point T>
+class normal_equations;
+
+inline constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+//NOTE: Residual blocks per slice below which splitting the evaluation costs more than it saves
+inline constexpr std::size_t slice_min = 1024;
+inline constexpr std::size_t max_slices = 16;
+
+// Slices depend only on the number of residual blocks, never on the thread count, and
+// their partial sums are added in slice order, so results repeat bit for bit
+[[nodiscard]] inline std::size_t slice_count(std::size_t residuals) noexcept {
+    const std::size_t s = residuals / slice_min;
+    return s < 1 ? 1 : s > max_slices ? max_slices : s;
+}
+
+[[nodiscard]] constexpr std::size_t slice_begin(std::size_t n, std::size_t s, std::size_t slices) noexcept {
+    return n * s / slices;
+}
+
+template<typename P>
+inline constexpr char block_tag{};
+
+template<typename G>
+inline constexpr char group_tag{};
+
+// A parameter block with its type erased; the solver only copies and updates it
+template<floating_point T>
+struct block_info {
+    void* data;
+    const void* tag;
+    std::size_t bytes;
+    std::size_t tangent;
+    void (*plus)(void*, const T*);
+    bool constant{false};
+    // Position in the tangent vector, npos for constant blocks
+    std::size_t offset{npos};
+};
+
+template<std::size_t N, typename F>
+CT_FORCE_INLINE void static_for(F&& fn) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (fn.template operator()<I>(), ...);
+    }(std::make_index_sequence<N>{});
+}
+
+// All residual blocks of one cost type and one parameter signature. Evaluation is a
+// virtual call per range, the loop inside runs on fixed-size mats on the stack.
+template<floating_point T>
+class residual_set {
+public:
+    virtual ~residual_set() = default;
+
+    [[nodiscard]] virtual std::size_t size() const noexcept = 0;
+
+    // (row, col) block indices of every pair of variable blocks some residual couples,
+    // with row >= col
+    virtual void couplings(std::span<const block_info<T>> blocks,
+                           std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) const = 0;
+
+    // Resolves where every residual adds into g and into the values of h
+    virtual void bind(std::span<const block_info<T>> blocks, const csr_matrix<T>& h) = 0;
+
+    // Adds J^T W J and J^T W r of residuals [begin, end) and returns their cost
+    virtual T linearize(std::size_t begin, std::size_t end, T* h, T* g) const = 0;
+
+    [[nodiscard]] virtual T cost(std::size_t begin, std::size_t end) const = 0;
+};
+
+template<floating_point T, typename Cost, typename... P>
+class residual_group final : public residual_set<T> {
+public:
+    static constexpr std::size_t R = Cost::residuals;
+    static constexpr std::size_t K = sizeof...(P);
+
+    using residual_type = mat<R, 1, T>;
+    using jacobians = std::tuple<mat<R, tangent_size_v<P>, T>...>;
+
+    void add(Cost cost, const robust_loss<T>& loss, const std::array<std::uint32_t, K>& blocks, P*... params) {
+        items_.push_back({std::move(cost), loss, blocks, {params...}});
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept override { return items_.size(); }
+
+    void couplings(std::span<const block_info<T>> blocks,
+                   std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) const override {
+        for (const item& it : items_) {
+            for (std::size_t k = 0; k < K; ++k) {
+                if (blocks[it.blocks[k]].constant) continue;
+                for (std::size_t l = 0; l < K; ++l) {
+                    if (blocks[it.blocks[l]].constant || it.blocks[l] > it.blocks[k]) continue;
+                    out.emplace_back(it.blocks[k], it.blocks[l]);
+                }
+            }
+        }
+    }
+
+    void bind(std::span<const block_info<T>> blocks, const csr_matrix<T>& h) override {
+        const auto rp = h.row_ptr();
+        layouts_.resize(items_.size());
+        for (std::size_t i = 0; i < items_.size(); ++i) {
+            layout& lay = layouts_[i];
+            for (std::size_t k = 0; k < K; ++k) {
+                const std::size_t ok = blocks[items_[i].blocks[k]].offset;
+                lay.offset[k] = ok;
+                lay.stride[k] = ok == npos ? 0 : rp[ok + 1] - rp[ok];
+            }
+            for (std::size_t k = 0; k < K; ++k) {
+                for (std::size_t l = 0; l < K; ++l) {
+                    const std::size_t ok = lay.offset[k];
+                    const std::size_t ol = lay.offset[l];
+                    lay.pos[k * K + l] = ok == npos || ol == npos || ol > ok ? npos : h.index_of(ok, ol);
+                }
+            }
+        }
+    }
+
+    T linearize(std::size_t begin, std::size_t end, T* CT_RESTRICT h, T* CT_RESTRICT g) const override {
+        T total{};
+        for (std::size_t i = begin; i < end; ++i) {
+            const item& it = items_[i];
+            const layout& lay = layouts_[i];
+            residual_type r{};
+            jacobians j{};
+            if (!evaluate(it, r, &j, &lay, std::index_sequence_for<P...>{})) continue;
+
+            const auto [rho, w] = it.loss.evaluate(squared_norm(r));
+            total += rho;
+            if (w == T{}) continue;
+
+            static_for<K>([&]<std::size_t k>() {
+                if (lay.offset[k] == npos) return;
+                const auto& jk = std::get<k>(j);
+                constexpr std::size_t tk = std::remove_cvref_t<decltype(jk)>::cols;
+                for (std::size_t a = 0; a < tk; ++a) {
+                    T acc{};
+                    for (std::size_t e = 0; e < R; ++e) acc += jk(e, a) * r(e, 0);
+                    g[lay.offset[k] + a] += w * acc;
+                }
+                static_for<K>([&]<std::size_t l>() {
+                    const std::size_t p = lay.pos[k * K + l];
+                    if (p == npos) return;
+                    const auto& jl = std::get<l>(j);
+                    constexpr std::size_t tl = std::remove_cvref_t<decltype(jl)>::cols;
+                    const mat<tk, tl, T> jtj = jk.transpose() * jl;
+                    for (std::size_t a = 0; a < tk; ++a) {
+                        T* CT_RESTRICT row = h + p + a * lay.stride[k];
+                        for (std::size_t b = 0; b < tl; ++b) row[b] += w * jtj(a, b);
+                    }
+                });
+            });
+        }
+        return total / T{2};
+    }
+
+    [[nodiscard]] T cost(std::size_t begin, std::size_t end) const override {
+        T total{};
+        for (std::size_t i = begin; i < end; ++i) {
+            const item& it = items_[i];
+            residual_type r{};
+            if (!evaluate(it, r, nullptr, nullptr, std::index_sequence_for<P...>{})) {
+                return std::numeric_limits<T>::infinity();
+            }
+            total += it.loss.evaluate(squared_norm(r)).rho;
+        }
+        return total / T{2};
+    }
+
+private:
+    struct item {
+        Cost cost;
+        robust_loss<T> loss;
+        std::array<std::uint32_t, K> blocks;
+        std::tuple<P*...> params;
+    };
+
+    // Offsets into g, row lengths of h and value positions of the (k, l) blocks of J^T J
+    struct layout {
+        std::array<std::size_t, K> offset;
+        std::array<std::size_t, K> stride;
+        std::array<std::size_t, K * K> pos;
+    };
+
+    [[nodiscard]] static CT_FORCE_INLINE T squared_norm(const residual_type& r) noexcept {
+        T s{};
+        for (std::size_t e = 0; e < R; ++e) s += r(e, 0) * r(e, 0);
+        return s;
+    }
+
+    //NOTE: Constant blocks get a null Jacobian, as does every block when only the cost is needed
+    template<std::size_t... I>
+    [[nodiscard]] static CT_FORCE_INLINE bool evaluate(const item& it, residual_type& r, jacobians* j,
+                                                       const layout* lay, std::index_sequence<I...>) {
+        return static_cast<bool>(
+            it.cost(*std::get<I>(it.params)..., r,
+                    (j != nullptr && lay->offset[I] != npos ? &std::get<I>(*j) : nullptr)...));
+    }
+
+    std::vector<item> items_;
+    std::vector<layout> layouts_;
+};
+
+} // namespace detail
+
+// A nonlinear least-squares problem: minimize 1/2 sum_i rho_i(|r_i(x)|^2) over parameter
+// blocks the caller owns. A cost functor declares its residual count at compile time and
+// is called with the current parameter values, the residual and one Jacobian per block
+// with respect to that block's tangent increment (see manifold.hpp):
+//
+//     struct reprojection {
+//         static constexpr std::size_t residuals = 2;
+//         vec2d uv;
+//         bool operator()(const se3<double>& pose, const vec3d& p, mat<2, 1, double>& r,
+//                         mat<2, 6, double>* d_pose, mat<2, 3, double>* d_p) const;
+//     };
+//
+// Jacobian pointers are null when the solver does not need them. Returning false marks the
+// parameters as invalid (e.g. a point behind the camera); a step that gets there is
+// rejected. Functors are called concurrently and must not mutate shared state.
+template<floating_point T>
+class problem {
+public:
+    problem() = default;
+
+    problem(const problem&) = delete;
+    problem& operator=(const problem&) = delete;
+    problem(problem&&) noexcept = default;
+    problem& operator=(problem&&) noexcept = default;
+
+    // Registers the blocks on first use; every block of one residual must be distinct
+    template<typename Cost, parameter_block<T>... P>
+    void add_residual(Cost cost, const robust_loss<T>& loss, P*... params) {
+        static_assert(sizeof...(P) > 0, "a residual needs at least one parameter block");
+        static_assert(std::is_invocable_r_v<bool, const Cost&, const P&..., mat<Cost::residuals, 1, T>&,
+                                            mat<Cost::residuals, tangent_size_v<P>, T>*...>,
+                      "cost functor signature does not match its parameter blocks");
+        using group = detail::residual_group<T, Cost, P...>;
+        const std::array<std::uint32_t, sizeof...(P)> ids{add_block(params)...};
+        for (std::size_t k = 0; k < ids.size(); ++k) {
+            for (std::size_t l = 0; l < k; ++l) assert(ids[k] != ids[l]);
+        }
+        group_of<group>().add(std::move(cost), loss, ids, params...);
+        ++residuals_;
+    }
+
+    template<typename Cost, parameter_block<T>... P>
+    void add_residual(Cost cost, P*... params) {
+        add_residual(std::move(cost), robust_loss<T>::none(), params...);
+    }
+
+    // Constant blocks keep their value, e.g. fixed intrinsics or the gauge pose
+    template<parameter_block<T> P>
+    void set_constant(P* x, bool constant = true) {
+        const auto it = index_.find(x);
+        assert(it != index_.end() && blocks_[it->second].tag == &detail::block_tag<P>);
+        blocks_[it->second].constant = constant;
+    }
+
+    template<parameter_block<T> P>
+    [[nodiscard]] bool is_constant(const P* x) const {
+        const auto it = index_.find(x);
+        assert(it != index_.end());
+        return blocks_[it->second].constant;
+    }
+
+    [[nodiscard]] std::size_t residual_blocks() const noexcept { return residuals_; }
+    [[nodiscard]] std::size_t parameter_blocks() const noexcept { return blocks_.size(); }
+
+    // Number of unknowns: the tangent sizes of all variable blocks
+    [[nodiscard]] std::size_t tangent_size() const noexcept {
+        std::size_t n = 0;
+        for (const auto& b : blocks_) n += b.constant ? 0 : b.tangent;
+        return n;
+    }
+
+    // 1/2 sum rho(|r|^2) at the current parameter values; infinite if a functor fails
+    [[nodiscard]] T cost() const {
+        const std::size_t slices = detail::slice_count(residuals_);
+        std::vector<T> partial(slices, T{});
+        parallel_for(0, slices, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end; ++s) {
+                for (const auto& [tag, set] : groups_) {
+                    const std::size_t n = set->size();
+                    partial[s] += set->cost(detail::slice_begin(n, s, slices), detail::slice_begin(n, s + 1, slices));
+                }
+            }
+        });
+        T total{};
+        for (const T c : partial) total += c;
+        return total;
+    }
+
+private:
+    friend class detail::normal_equations<T>;
+
+    template<typename P>
+    std::uint32_t add_block(P* x) {
+        const auto [it, inserted] = index_.try_emplace(x, static_cast<std::uint32_t>(blocks_.size()));
+        if (inserted) {
+            blocks_.push_back({x, &detail::block_tag<P>, sizeof(P), tangent_size_v<P>,
+                               [](void* data, const T* d) { manifold<P>::plus(*static_cast<P*>(data), d); }});
+        }
+        //NOTE: The same address registered as two different types
+        assert(blocks_[it->second].tag == &detail::block_tag<P>);
+        return it->second;
+    }
+
+    template<typename G>
+    G& group_of() {
+        for (auto& [tag, set] : groups_) {
+            if (tag == &detail::group_tag<G>) return static_cast<G&>(*set);
+        }
+        groups_.emplace_back(&detail::group_tag<G>, std::make_unique<G>());
+        return static_cast<G&>(*groups_.back().second);
+    }
+
+    std::vector<detail::block_info<T>> blocks_;
+    std::unordered_map<const void*, std::uint32_t> index_;
+    std::vector<std::pair<const void*, std::unique_ptr<detail::residual_set<T>>>> groups_;
+    std::size_t residuals_{0};
+};
+
+} // namespace optim
+
+} // namespace ct
@@ -0,0 +1,333 @@
+#pragma once
+
+#include "./problem.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../common/functions.hpp"
+#include "../dense/vecx.hpp"
+#include "../sparse/csr.hpp"
+#include "../sparse/cholesky.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace ct {
+
+namespace optim {
+
+enum class method { levenberg_marquardt, gauss_newton };
+
+enum class termination {
+    function_tolerance,
+    gradient_tolerance,
+    step_tolerance,
+    // Damping grew without finding a cost decrease (LM), or a Gauss-Newton step went uphill
+    no_progress,
+    max_iterations,
+    // The starting point is invalid, or the normal equations are singular without damping
+    failed
+};
+
+struct solver_settings {
+    method kind{method::levenberg_marquardt};
+    // Steps tried, accepted or not
+    std::size_t max_iterations{100};
+    // Stops once a step lowers the cost by less than function_tolerance * cost
+    double function_tolerance{1e-10};
+    // Stops once max |J^T W r| <= gradient_tolerance
+    double gradient_tolerance{1e-12};
+    // Stops once |dx| <= step_tolerance
+    double step_tolerance{1e-10};
+    double initial_lambda{1e-4};
+    double max_lambda{1e16};
+    // Clamp on diag(J^T J) as damping scale, so a block that no residual constrains
+    // still gets a regularized, solvable system
+    double min_diagonal{1e-6};
+    double max_diagonal{1e32};
+};
+
+template<floating_point T>
+struct solver_result {
+    T initial_cost{};
+    T final_cost{};
+    std::size_t iterations{0};
+    std::size_t accepted{0};
+    termination reason{termination::failed};
+
+    [[nodiscard]] bool converged() const noexcept {
+        return reason == termination::function_tolerance || reason == termination::gradient_tolerance ||
+               reason == termination::step_tolerance;
+    }
+};
+
+namespace detail {
+
+//NOTE: Cap on the values held by the per-slice copies of J^T J together
+inline constexpr std::size_t slice_budget = 32 * 1024 * 1024;
+
+// J^T W J (lower block triangle, full diagonal blocks) and J^T W r in the tangent space of
+// the variable blocks. The pattern is built once per solve; every linearization refills
+// the values, accumulating fixed slices of the residuals in parallel and adding the
+// slices in order.
+template<floating_point T>
+class normal_equations {
+public:
+    explicit normal_equations(problem<T>& p) : p_(p) {
+        n_ = 0;
+        for (auto& b : p_.blocks_) {
+            b.offset = b.constant ? npos : n_;
+            n_ += b.constant ? 0 : b.tangent;
+        }
+
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+        for (const auto& [tag, set] : p_.groups_) set->couplings(p_.blocks_, pairs);
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+        std::vector<triplet<T>> entries;
+        for (const auto& [rb, cb] : pairs) {
+            const auto& row = p_.blocks_[rb];
+            const auto& col = p_.blocks_[cb];
+            for (std::size_t a = 0; a < row.tangent; ++a) {
+                for (std::size_t b = 0; b < col.tangent; ++b) {
+                    entries.push_back({static_cast<sparse_index>(row.offset + a),
+                                       static_cast<sparse_index>(col.offset + b), T{}});
+                }
+            }
+        }
+        //NOTE: Blocks that no residual touches still need a diagonal for the damping
+        for (std::size_t i = 0; i < n_; ++i) {
+            entries.push_back({static_cast<sparse_index>(i), static_cast<sparse_index>(i), T{}});
+        }
+        h_ = csr_matrix<T>::from_triplets(n_, n_, entries);
+        g_ = vecX<T>(n_);
+
+        diag_pos_.resize(n_);
+        for (std::size_t i = 0; i < n_; ++i) diag_pos_[i] = h_.index_of(i, i);
+
+        for (const auto& [tag, set] : p_.groups_) set->bind(p_.blocks_, h_);
+
+        const std::size_t per_slice = h_.nonzeros() + n_;
+        slices_ = slice_count(p_.residuals_);
+        slices_ = std::min(slices_, std::max<std::size_t>(1, slice_budget / std::max<std::size_t>(per_slice, 1)));
+        if (slices_ > 1) {
+            h_parts_.assign(slices_, std::vector<T>(h_.nonzeros()));
+            g_parts_.assign(slices_, std::vector<T>(n_));
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return n_; }
+    [[nodiscard]] csr_matrix<T>& hessian() noexcept { return h_; }
+    [[nodiscard]] const vecX<T>& gradient() const noexcept { return g_; }
+    [[nodiscard]] std::span<const std::size_t> diagonal_positions() const noexcept { return diag_pos_; }
+
+    // Refills h and g at the current parameters and returns the cost
+    T linearize() {
+        if (slices_ == 1) {
+            h_.set_zero();
+            std::fill(g_.begin(), g_.end(), T{});
+            T cost{};
+            for (const auto& [tag, set] : p_.groups_) cost += set->linearize(0, set->size(), h_.values().data(), g_.data());
+            return cost;
+        }
+
+        std::vector<T> partial(slices_, T{});
+        parallel_for(0, slices_, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end; ++s) {
+                std::fill(h_parts_[s].begin(), h_parts_[s].end(), T{});
+                std::fill(g_parts_[s].begin(), g_parts_[s].end(), T{});
+                for (const auto& [tag, set] : p_.groups_) {
+                    const std::size_t n = set->size();
+                    partial[s] += set->linearize(slice_begin(n, s, slices_), slice_begin(n, s + 1, slices_),
+                                                 h_parts_[s].data(), g_parts_[s].data());
+                }
+            }
+        });
+
+        const auto hv = h_.values();
+        parallel_for(0, hv.size(), parallel_grain(hv.size(), 16 * 1024), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                T acc = h_parts_[0][i];
+                for (std::size_t s = 1; s < slices_; ++s) acc += h_parts_[s][i];
+                hv[i] = acc;
+            }
+        });
+        for (std::size_t i = 0; i < n_; ++i) {
+            T acc = g_parts_[0][i];
+            for (std::size_t s = 1; s < slices_; ++s) acc += g_parts_[s][i];
+            g_[i] = acc;
+        }
+
+        T cost{};
+        for (const T c : partial) cost += c;
+        return cost;
+    }
+
+    void save() {
+        saved_.resize(0);
+        for (const auto& b : p_.blocks_) {
+            if (b.constant) continue;
+            const auto* bytes = static_cast<const std::byte*>(b.data);
+            saved_.insert(saved_.end(), bytes, bytes + b.bytes);
+        }
+    }
+
+    void restore() noexcept {
+        std::size_t at = 0;
+        for (const auto& b : p_.blocks_) {
+            if (b.constant) continue;
+            std::memcpy(b.data, saved_.data() + at, b.bytes);
+            at += b.bytes;
+        }
+    }
+
+    void plus(const vecX<T>& dx) noexcept {
+        for (const auto& b : p_.blocks_) {
+            if (!b.constant) b.plus(b.data, dx.data() + b.offset);
+        }
+    }
+
+private:
+    problem<T>& p_;
+    std::size_t n_{0};
+    csr_matrix<T> h_;
+    vecX<T> g_;
+    std::vector<std::size_t> diag_pos_;
+    std::size_t slices_{1};
+    std::vector<std::vector<T>> h_parts_;
+    std::vector<std::vector<T>> g_parts_;
+    std::vector<std::byte> saved_;
+};
+
+} // namespace detail
+
+// Levenberg-Marquardt with Marquardt's diagonal scaling and Nielsen's damping update, or
+// undamped Gauss-Newton. Robust losses enter as per-residual weights rho'(|r|^2)
+// (iteratively reweighted least squares). Each iteration factorizes the damped normal
+// equations with sparse_llt, analyzed once up front, so problems with thousands of blocks
+// (bundle adjustment, pose graphs) and a single pose (PnP) go through the same path.
+// The parameters hold the best point found when it returns.
+template<floating_point T>
+solver_result<T> solve(problem<T>& p, const solver_settings& settings = {}) {
+    solver_result<T> result;
+    T cost = p.cost();
+    result.initial_cost = result.final_cost = cost;
+    if (!std::isfinite(cost)) return result;
+
+    detail::normal_equations<T> ne(p);
+    const std::size_t n = ne.size();
+    if (n == 0) {
+        result.reason = termination::gradient_tolerance;
+        return result;
+    }
+
+    csr_matrix<T>& h = ne.hessian();
+    const auto hv = h.values();
+    const auto diag_pos = ne.diagonal_positions();
+    sparse_llt<T> llt;
+    llt.analyze(h);
+
+    const bool damped = settings.kind == method::levenberg_marquardt;
+    T lambda = damped ? static_cast<T>(settings.initial_lambda) : T{};
+    T nu{2};
+    bool linearized = false;
+    vecX<T> diag(n);
+    vecX<T> scale(n);
+    vecX<T> rhs(n);
+    result.reason = termination::max_iterations;
+
+    while (result.iterations < settings.max_iterations) {
+        if (!linearized) {
+            ne.linearize();
+            const vecX<T>& g = ne.gradient();
+            T gmax{};
+            for (std::size_t i = 0; i < n; ++i) gmax = max(gmax, abs(g[i]));
+            if (gmax <= static_cast<T>(settings.gradient_tolerance)) {
+                result.reason = termination::gradient_tolerance;
+                break;
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                diag[i] = hv[diag_pos[i]];
+                scale[i] = clamp(diag[i], static_cast<T>(settings.min_diagonal), static_cast<T>(settings.max_diagonal));
+                rhs[i] = -g[i];
+            }
+            linearized = true;
+        }
+        ++result.iterations;
+
+        for (std::size_t i = 0; i < n; ++i) hv[diag_pos[i]] = diag[i] + lambda * scale[i];
+        if (!llt.factorize(h)) {
+            if (!damped) {
+                result.reason = termination::failed;
+                break;
+            }
+            lambda *= nu;
+            nu *= T{2};
+            if (lambda > static_cast<T>(settings.max_lambda)) {
+                result.reason = termination::no_progress;
+                break;
+            }
+            continue;
+        }
+        const vecX<T> dx = llt.solve(rhs);
+
+        T dx_norm2{};
+        T predicted{};
+        for (std::size_t i = 0; i < n; ++i) {
+            dx_norm2 += dx[i] * dx[i];
+            //NOTE: L(0) - L(dx) = (lambda dx^T D dx - dx^T g) / 2 when (H + lambda D) dx = -g
+            predicted += (lambda * scale[i] * dx[i] + rhs[i]) * dx[i];
+        }
+        predicted /= T{2};
+        if (sqrt(dx_norm2) <= static_cast<T>(settings.step_tolerance)) {
+            result.reason = termination::step_tolerance;
+            break;
+        }
+
+        ne.save();
+        ne.plus(dx);
+        const T next = p.cost();
+        const T actual = cost - next;
+        const T rho = predicted > T{} ? actual / predicted : T{-1};
+
+        if (std::isfinite(next) && (damped ? rho > T{} : actual > T{})) {
+            const T previous = cost;
+            cost = next;
+            ++result.accepted;
+            linearized = false;
+            if (damped) {
+                const T t = T{2} * rho - T{1};
+                lambda *= max(T{1} / T{3}, T{1} - t * t * t);
+                nu = T{2};
+            }
+            if (actual <= static_cast<T>(settings.function_tolerance) * previous) {
+                result.reason = termination::function_tolerance;
+                break;
+            }
+        } else {
+            ne.restore();
+            if (!damped) {
+                result.reason = termination::no_progress;
+                break;
+            }
+            lambda *= nu;
+            nu *= T{2};
+            if (lambda > static_cast<T>(settings.max_lambda)) {
+                result.reason = termination::no_progress;
+                break;
+            }
+        }
+    }
+
+    result.final_cost = cost;
+    return result;
+}
+
+} // namespace optim
+
+} // namespace ct
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ct {
+
+// Fork-join pool used by the batch kernels of the math module. The calling
+// thread always takes part in the work, and a run() issued from inside a task
+// executes inline so kernels can nest without deadlocking. Tasks must not throw.
+class thread_pool {
+public:
+    // workers == 0 picks hardware_concurrency() - 1 helpers next to the caller
+    explicit thread_pool(std::size_t workers = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // Number of threads that execute tasks, the caller included
+    [[nodiscard]] std::size_t concurrency() const noexcept { return workers_.size() + 1; }
+
+    // Invokes task(i) for every i in [0, count) and returns once all of them finished
+    void run(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    [[nodiscard]] static thread_pool& global();
+
+private:
+    void worker_loop();
+    void drain(const std::function<void(std::size_t)>& task, std::size_t count);
+
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    const std::function<void(std::size_t)>* task_{nullptr};
+    std::size_t count_{0};
+    std::size_t active_{0};
+    std::uint64_t generation_{0};
+    bool stop_{false};
+
+    std::atomic<std::size_t> next_{0};
+};
+
+// Splits [begin, end) into chunks of `grain` indices and calls fn(chunk_begin, chunk_end)
+// for each of them on the global pool. Chunk boundaries depend only on `grain`, never on
+// the thread count, so per-chunk partial results can be combined deterministically.
+template<typename F>
+void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& fn) {
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+
+    const std::size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1) {
+        fn(begin, end);
+        return;
+    }
+
+    thread_pool::global().run(chunks, [&](std::size_t c) {
+        const std::size_t b = begin + c * grain;
+        const std::size_t e = end - b < grain ? end : b + grain;
+        fn(b, e);
+    });
+}
+
+// Grain that spreads `count` items over the pool in roughly `per_thread` chunks each,
+// but never below `min_grain` items
+[[nodiscard]] inline std::size_t parallel_grain(std::size_t count, std::size_t min_grain,
+                                                std::size_t per_thread = 4) noexcept {
+    const std::size_t slots = thread_pool::global().concurrency() * per_thread;
+    const std::size_t g = (count + slots - 1) / slots;
+    return g < min_grain ? min_grain : g;
+}
+
+} // namespace ct
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "./parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ct {
+
+namespace detail {
+
+inline constexpr std::size_t radix_buckets = 256;
+
+//NOTE: Below this many keys one thread sorts; above it the keys are cut into fixed chunks of
+// radix_grain, each with its own histogram, so the order never depends on the thread count
+inline constexpr std::size_t radix_parallel_min = 64 * 1024;
+inline constexpr std::size_t radix_grain = 32 * 1024;
+
+struct no_values {};
+
+// Stable LSD radix sort, one byte per pass. Every pass counts the digits of each chunk,
+// turns the counts into per-chunk output offsets (digit-major, chunk order) and scatters
+// the chunks in parallel. A pass whose digit is the same for every key is skipped, so
+// codes that use only the low bits of K cost only the passes they need.
+template<std::unsigned_integral K, typename V>
+void radix_sort(K* keys, V* values, std::size_t n) {
+    constexpr bool with_values = !std::is_same_v<V, no_values>;
+    if (n < 2) return;
+
+    std::vector<K> key_tmp(n);
+    std::vector<V> value_tmp(with_values ? n : 0);
+
+    const std::size_t chunks = n >= radix_parallel_min ? (n + radix_grain - 1) / radix_grain : 1;
+    const std::size_t grain = chunks == 1 ? n : radix_grain;
+    std::vector<std::array<std::size_t, radix_buckets>> offsets(chunks);
+
+    K* src_k = keys;
+    K* dst_k = key_tmp.data();
+    V* src_v = values;
+    V* dst_v = value_tmp.data();
+
+    for (std::size_t shift = 0; shift < sizeof(K) * 8; shift += 8) {
+        parallel_for(0, n, grain, [&](std::size_t b, std::size_t e) {
+            auto& h = offsets[b / grain];
+            h.fill(0);
+            for (std::size_t i = b; i < e; ++i) ++h[(src_k[i] >> shift) & 0xFF];
+        });
+
+        bool uniform = false;
+        std::size_t at = 0;
+        for (std::size_t d = 0; d < radix_buckets; ++d) {
+            const std::size_t start = at;
+            for (std::size_t c = 0; c < chunks; ++c) {
+                const std::size_t count = offsets[c][d];
+                offsets[c][d] = at;
+                at += count;
+            }
+            uniform = uniform || at - start == n;
+        }
+        if (uniform) continue;
+
+        parallel_for(0, n, grain, [&](std::size_t b, std::size_t e) {
+            auto& o = offsets[b / grain];
+            for (std::size_t i = b; i < e; ++i) {
+                const std::size_t slot = o[(src_k[i] >> shift) & 0xFF]++;
+                dst_k[slot] = src_k[i];
+                if constexpr (with_values) dst_v[slot] = src_v[i];
+            }
+        });
+        std::swap(src_k, dst_k);
+        if constexpr (with_values) std::swap(src_v, dst_v);
+    }
+
+    if (src_k != keys) {
+        parallel_for(0, n, parallel_grain(n, 256 * 1024), [&](std::size_t b, std::size_t e) {
+            std::memcpy(keys + b, src_k + b, (e - b) * sizeof(K));
+            if constexpr (with_values) std::memcpy(values + b, src_v + b, (e - b) * sizeof(V));
+        });
+    }
+}
+
+} // namespace detail
+
+// Sorts unsigned keys in place, ascending. Large inputs run over the thread pool.
+template<std::unsigned_integral K>
+void radix_sort(std::span<K> keys) {
+    detail::radix_sort<K, detail::no_values>(keys.data(), nullptr, keys.size());
+}
+
+// Sorts keys ascending and applies the same permutation to values; equal keys keep their
+// relative order
+template<std::unsigned_integral K, typename V>
+    requires std::is_trivially_copyable_v<V>
+void radix_sort(std::span<K> keys, std::span<V> values) {
+    assert(keys.size() == values.size());
+    detail::radix_sort(keys.data(), values.data(), keys.size());
+}
+
+// Stable ascending order of keys: keys[order[0]] <= keys[order[1]] <= ...
+template<std::unsigned_integral K>
+[[nodiscard]] std::vector<std::uint32_t> radix_order(std::span<const K> keys) {
+    assert(keys.size() <= std::size_t{0xFFFFFFFF});
+    std::vector<K> sorted(keys.begin(), keys.end());
+    std::vector<std::uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), std::uint32_t{0});
+    detail::radix_sort(sorted.data(), order.data(), sorted.size());
+    return order;
+}
+
+// out[i] = in[order[i]], e.g. to store points in the order returned by radix_order
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+void gather(std::span<const T> in, std::span<const std::uint32_t> order, std::type_identity_t<std::span<T>> out) {
+    assert(order.size() == out.size());
+    parallel_for(0, order.size(), parallel_grain(order.size(), 64 * 1024), [&](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+            assert(order[i] < in.size());
+            out[i] = in[order[i]];
+        }
+    });
+}
+
+} // namespace ct
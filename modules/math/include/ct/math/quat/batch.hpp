@@ -0,0 +1,316 @@
+#pragma once
+
+#include "./quat.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "../common/functions.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+#include "../mat/mat3.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+namespace ct {
+
+// Array kernels over quaternions and vectors. Each block of quat_batch_width<T> elements is
+// transposed into one pack per component by lane shuffles, run through a branch-free kernel
+// written against a value type V (T or pack<T, W>, as in ct::fast), and transposed back.
+// Large inputs are split over the thread pool.
+template<floating_point T>
+inline constexpr std::size_t quat_batch_width = simd_lanes<T>;
+
+namespace detail {
+
+template<floating_point T>
+using quat_lanes = pack<T, quat_batch_width<T>>;
+
+//NOTE: Below this many elements the pool wake-up costs more than the work
+inline constexpr std::size_t quat_parallel_min = 32 * 1024;
+
+template<typename F>
+void quat_batch_for(std::size_t n, F&& fn) {
+    if (n >= quat_parallel_min) {
+        parallel_for(0, n, parallel_grain(n, 8192), fn);
+    } else {
+        fn(0, n);
+    }
+}
+
+template<floating_point T>
+struct quat_soa {
+    quat_lanes<T> x, y, z, w;
+};
+
+template<floating_point T>
+struct vec3_soa {
+    quat_lanes<T> x, y, z;
+};
+
+static_assert(sizeof(quat<float>) == 4 * sizeof(float) && sizeof(vec<3, float>) == 3 * sizeof(float));
+static_assert(sizeof(quat<double>) == 4 * sizeof(double) && sizeof(vec<3, double>) == 3 * sizeof(double));
+
+// AoS to SoA through load_interleaved; a partial block is padded with identities so the
+// kernels never see 0 / 0
+template<floating_point T>
+CT_FORCE_INLINE quat_soa<T> quat_load(const quat<T>* q, std::size_t count) noexcept {
+    constexpr std::size_t W = quat_batch_width<T>;
+    quat_soa<T> s;
+    if (count == W) {
+        load_interleaved(reinterpret_cast<const T*>(q), s.x, s.y, s.z, s.w);
+    } else {
+        quat<T> pad[W];
+        std::copy_n(q, count, pad);
+        load_interleaved(reinterpret_cast<const T*>(pad), s.x, s.y, s.z, s.w);
+    }
+    return s;
+}
+
+template<floating_point T>
+CT_FORCE_INLINE void quat_store(const quat_soa<T>& s, quat<T>* q, std::size_t count) noexcept {
+    constexpr std::size_t W = quat_batch_width<T>;
+    if (count == W) {
+        store_interleaved(reinterpret_cast<T*>(q), s.x, s.y, s.z, s.w);
+    } else {
+        quat<T> pad[W];
+        store_interleaved(reinterpret_cast<T*>(pad), s.x, s.y, s.z, s.w);
+        std::copy_n(pad, count, q);
+    }
+}
+
+template<floating_point T>
+CT_FORCE_INLINE vec3_soa<T> vec3_load(const vec<3, T>* v, std::size_t count) noexcept {
+    constexpr std::size_t W = quat_batch_width<T>;
+    vec3_soa<T> s;
+    if (count == W) {
+        load_interleaved(reinterpret_cast<const T*>(v), s.x, s.y, s.z);
+    } else {
+        vec<3, T> pad[W]{};
+        std::copy_n(v, count, pad);
+        load_interleaved(reinterpret_cast<const T*>(pad), s.x, s.y, s.z);
+    }
+    return s;
+}
+
+template<floating_point T>
+CT_FORCE_INLINE void vec3_store(const vec3_soa<T>& s, vec<3, T>* v, std::size_t count) noexcept {
+    constexpr std::size_t W = quat_batch_width<T>;
+    if (count == W) {
+        store_interleaved(reinterpret_cast<T*>(v), s.x, s.y, s.z);
+    } else {
+        vec<3, T> pad[W];
+        store_interleaved(reinterpret_cast<T*>(pad), s.x, s.y, s.z);
+        std::copy_n(pad, count, v);
+    }
+}
+
+// Two-cross-product rotation by a unit quaternion
+template<floating_point T, typename V>
+CT_FORCE_INLINE void quat_rotate_kernel(const V& qx, const V& qy, const V& qz, const V& qw,
+                                        V& x, V& y, V& z) noexcept {
+    const V tx = (qy * z - qz * y) * T{2};
+    const V ty = (qz * x - qx * z) * T{2};
+    const V tz = (qx * y - qy * x) * T{2};
+    x = x + qw * tx + (qy * tz - qz * ty);
+    y = y + qw * ty + (qz * tx - qx * tz);
+    z = z + qw * tz + (qx * ty - qy * tx);
+}
+
+// Rescales to unit length; anything shorter than epsilon becomes the identity
+template<floating_point T, typename V>
+CT_FORCE_INLINE void quat_normalize_kernel(V& x, V& y, V& z, V& w) noexcept {
+    const V l2 = x * x + y * y + z * z + w * w;
+    const auto ok = l2 > epsilon<T> * epsilon<T>;
+    const V inv = T{1} / sqrt(select(ok, l2, splat<V>(T{1})));
+    x = select(ok, x * inv, splat<V>(T{}));
+    y = select(ok, y * inv, splat<V>(T{}));
+    z = select(ok, z * inv, splat<V>(T{}));
+    w = select(ok, w * inv, splat<V>(T{1}));
+}
+
+// nlerp, or slerp with Slerp = true, between unit a and b along the shorter arc. The slerp
+// angle uses the atan2(|a - b|, |a + b|) form of ct::slerp through ct::fast kernels, so
+// the result carries a few 1e-7 absolute error in either precision and is renormalized.
+template<floating_point T, bool Slerp, typename V>
+CT_FORCE_INLINE void quat_lerp_kernel(const V& ax, const V& ay, const V& az, const V& aw,
+                                      V bx, V by, V bz, V bw, const V& t,
+                                      V& x, V& y, V& z, V& w) noexcept {
+    const V d = ax * bx + ay * by + az * bz + aw * bw;
+    const V sgn = select(d < T{}, splat<V>(T{-1}), splat<V>(T{1}));
+    bx = bx * sgn;
+    by = by * sgn;
+    bz = bz * sgn;
+    bw = bw * sgn;
+
+    V wa = T{1} - t;
+    V wb = t;
+    if constexpr (Slerp) {
+        const V dx = ax - bx, dy = ay - by, dz = az - bz, dw = aw - bw;
+        const V sx = ax + bx, sy = ay + by, sz = az + bz, sw = aw + bw;
+        const V theta = fast_atan2<T>(sqrt(dx * dx + dy * dy + dz * dz + dw * dw),
+                                      sqrt(sx * sx + sy * sy + sz * sz + sw * sw)) * T{2};
+        const V sn = fast_sin<T>(theta);
+        const auto arc = sn > epsilon<T>;
+        const V inv = T{1} / select(arc, sn, splat<V>(T{1}));
+        wa = select(arc, fast_sin<T>(wa * theta) * inv, wa);
+        wb = select(arc, fast_sin<T>(wb * theta) * inv, wb);
+    }
+    x = ax * wa + bx * wb;
+    y = ay * wa + by * wb;
+    z = az * wa + bz * wb;
+    w = aw * wa + bw * wb;
+    quat_normalize_kernel<T>(x, y, z, w);
+}
+
+template<floating_point T, bool Slerp>
+void quat_lerp_blocks(std::span<const quat<T>> a, std::span<const quat<T>> b, std::span<const T> t,
+                      std::span<quat<T>> out, std::size_t begin, std::size_t end) noexcept {
+    constexpr std::size_t W = quat_batch_width<T>;
+    using lanes = quat_lanes<T>;
+    for (std::size_t i = begin; i < end; i += W) {
+        const std::size_t count = min(W, end - i);
+        const quat_soa<T> qa = quat_load(a.data() + i, count);
+        const quat_soa<T> qb = quat_load(b.data() + i, count);
+        lanes tl = lanes::broadcast(T{});
+        if (count == W) {
+            tl = lanes::load(t.data() + i);
+        } else {
+            for (std::size_t l = 0; l < count; ++l) tl.set(l, t[i + l]);
+        }
+        quat_soa<T> r;
+        quat_lerp_kernel<T, Slerp>(qa.x, qa.y, qa.z, qa.w, qb.x, qb.y, qb.z, qb.w, tl, r.x, r.y, r.z, r.w);
+        quat_store(r, out.data() + i, count);
+    }
+}
+
+// Resolves each sample time to its keyframe pair, clamping outside [times.front(), times.back()]
+template<floating_point T, bool Slerp>
+void quat_sample_blocks(std::span<const T> key_times, std::span<const quat<T>> keys, std::span<const T> times,
+                        std::span<quat<T>> out, std::size_t begin, std::size_t end) noexcept {
+    constexpr std::size_t W = quat_batch_width<T>;
+    using lanes = quat_lanes<T>;
+    const std::size_t last = keys.size() - 1;
+    for (std::size_t i = begin; i < end; i += W) {
+        const std::size_t count = min(W, end - i);
+        quat<T> ka[W];
+        quat<T> kb[W];
+        alignas(simd_bytes) T tl[W] = {};
+        for (std::size_t l = 0; l < count; ++l) {
+            const T s = times[i + l];
+            const auto it = std::upper_bound(key_times.begin(), key_times.end(), s);
+            const std::size_t hi = min(static_cast<std::size_t>(it - key_times.begin()), last);
+            const std::size_t lo = hi == 0 ? 0 : hi - 1;
+            const T span_t = key_times[hi] - key_times[lo];
+            ka[l] = keys[lo];
+            kb[l] = keys[hi];
+            tl[l] = span_t > T{} ? clamp((s - key_times[lo]) / span_t, T{}, T{1}) : T{};
+        }
+        const quat_soa<T> qa = quat_load(ka, W);
+        const quat_soa<T> qb = quat_load(kb, W);
+        quat_soa<T> r;
+        quat_lerp_kernel<T, Slerp>(qa.x, qa.y, qa.z, qa.w, qb.x, qb.y, qb.z, qb.w, lanes::load(tl),
+                                   r.x, r.y, r.z, r.w);
+        quat_store(r, out.data() + i, count);
+    }
+}
+
+} // namespace detail
+
+// out[i] = q.rotate(in[i]); q is converted to a matrix once, so it need not be unit.
+// out may alias in.
+template<floating_point T>
+void rotate(const quat<T>& q, std::type_identity_t<std::span<const vec<3, T>>> in,
+            std::type_identity_t<std::span<vec<3, T>>> out) {
+    assert(out.size() >= in.size());
+    constexpr std::size_t W = quat_batch_width<T>;
+    const mat<3, 3, T> r = q.to_mat3();
+    detail::quat_batch_for(in.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i += W) {
+            const std::size_t count = min(W, end - i);
+            const detail::vec3_soa<T> v = detail::vec3_load(in.data() + i, count);
+            detail::vec3_soa<T> o;
+            o.x = v.x * r(0, 0) + v.y * r(0, 1) + v.z * r(0, 2);
+            o.y = v.x * r(1, 0) + v.y * r(1, 1) + v.z * r(1, 2);
+            o.z = v.x * r(2, 0) + v.y * r(2, 1) + v.z * r(2, 2);
+            detail::vec3_store(o, out.data() + i, count);
+        }
+    });
+}
+
+// out[i] = q[i].rotate(in[i]) for unit q[i]; out may alias in
+template<floating_point T>
+void rotate(std::span<const quat<T>> q, std::type_identity_t<std::span<const vec<3, T>>> in,
+            std::type_identity_t<std::span<vec<3, T>>> out) {
+    assert(in.size() == q.size() && out.size() >= q.size());
+    constexpr std::size_t W = quat_batch_width<T>;
+    detail::quat_batch_for(q.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i += W) {
+            const std::size_t count = min(W, end - i);
+            const detail::quat_soa<T> r = detail::quat_load(q.data() + i, count);
+            detail::vec3_soa<T> v = detail::vec3_load(in.data() + i, count);
+            detail::quat_rotate_kernel<T>(r.x, r.y, r.z, r.w, v.x, v.y, v.z);
+            detail::vec3_store(v, out.data() + i, count);
+        }
+    });
+}
+
+// In-place quat::normalize() over the array, for renormalizing after long integration
+template<floating_point T>
+void normalize(std::span<quat<T>> q) {
+    constexpr std::size_t W = quat_batch_width<T>;
+    detail::quat_batch_for(q.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i += W) {
+            const std::size_t count = min(W, end - i);
+            detail::quat_soa<T> r = detail::quat_load(q.data() + i, count);
+            detail::quat_normalize_kernel<T>(r.x, r.y, r.z, r.w);
+            detail::quat_store(r, q.data() + i, count);
+        }
+    });
+}
+
+// out[i] = nlerp(a[i], b[i], t[i])
+template<floating_point T>
+void nlerp(std::span<const quat<T>> a, std::type_identity_t<std::span<const quat<T>>> b,
+           std::type_identity_t<std::span<const T>> t, std::type_identity_t<std::span<quat<T>>> out) {
+    assert(b.size() == a.size() && t.size() == a.size() && out.size() >= a.size());
+    detail::quat_batch_for(a.size(), [&](std::size_t begin, std::size_t end) {
+        detail::quat_lerp_blocks<T, false>(a, b, t, out, begin, end);
+    });
+}
+
+// out[i] = slerp(a[i], b[i], t[i]) to a few 1e-7 (see detail::quat_lerp_kernel)
+template<floating_point T>
+void slerp(std::span<const quat<T>> a, std::type_identity_t<std::span<const quat<T>>> b,
+           std::type_identity_t<std::span<const T>> t, std::type_identity_t<std::span<quat<T>>> out) {
+    assert(b.size() == a.size() && t.size() == a.size() && out.size() >= a.size());
+    detail::quat_batch_for(a.size(), [&](std::size_t begin, std::size_t end) {
+        detail::quat_lerp_blocks<T, true>(a, b, t, out, begin, end);
+    });
+}
+
+// Samples a keyframe track at each of times: key_times ascending, one key per time.
+// Samples outside the track clamp to the first or last key.
+template<floating_point T>
+void sample_nlerp(std::span<const T> key_times, std::type_identity_t<std::span<const quat<T>>> keys,
+                  std::type_identity_t<std::span<const T>> times, std::type_identity_t<std::span<quat<T>>> out) {
+    assert(!keys.empty() && key_times.size() == keys.size() && out.size() >= times.size());
+    detail::quat_batch_for(times.size(), [&](std::size_t begin, std::size_t end) {
+        detail::quat_sample_blocks<T, false>(key_times, keys, times, out, begin, end);
+    });
+}
+
+template<floating_point T>
+void sample_slerp(std::span<const T> key_times, std::type_identity_t<std::span<const quat<T>>> keys,
+                  std::type_identity_t<std::span<const T>> times, std::type_identity_t<std::span<quat<T>>> out) {
+    assert(!keys.empty() && key_times.size() == keys.size() && out.size() >= times.size());
+    detail::quat_batch_for(times.size(), [&](std::size_t begin, std::size_t end) {
+        detail::quat_sample_blocks<T, true>(key_times, keys, times, out, begin, end);
+    });
+}
+
+} // namespace ct
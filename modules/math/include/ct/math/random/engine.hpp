@@ -0,0 +1,206 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace ct {
+
+namespace random {
+
+// Engines satisfy std::uniform_random_bit_generator, so they also plug into <random> and
+// std::shuffle. All of them are a few words of state and fully deterministic for a seed.
+
+// Seed expander: every 64-bit seed, including 0, gives a well-mixed sequence
+class splitmix64 {
+public:
+    using result_type = std::uint64_t;
+
+    constexpr explicit splitmix64(std::uint64_t seed = 0) noexcept : state_(seed) {}
+
+    [[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+    [[nodiscard]] static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept {
+        std::uint64_t z = (state_ += 0x9e37'79b9'7f4a'7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11ebull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// xoshiro256++ (Blackman, Vigna): 256-bit state, period 2^256 - 1, 64-bit outputs.
+// jump() advances by 2^128 draws and long_jump() by 2^192, which is how independent
+// streams are handed out: one long_jump() per thread, one jump() per lane.
+class xoshiro256pp {
+public:
+    using result_type = std::uint64_t;
+
+    constexpr explicit xoshiro256pp(std::uint64_t seed = 0) noexcept {
+        splitmix64 mix(seed);
+        for (auto& w : s_) w = mix();
+    }
+
+    //NOTE: The state must not be all zeros
+    constexpr explicit xoshiro256pp(const std::array<std::uint64_t, 4>& state) noexcept : s_(state) {}
+
+    [[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+    [[nodiscard]] static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept {
+        const std::uint64_t result = std::rotl(s_[0] + s_[3], 23) + s_[0];
+        const std::uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = std::rotl(s_[3], 45);
+        return result;
+    }
+
+    constexpr void jump() noexcept {
+        apply({0x180e'c6d3'3cfd'0abaull, 0xd5a6'1266'f0c9'392cull, 0xa958'2618'e03f'c9aaull, 0x39ab'dc45'29b1'661cull});
+    }
+
+    constexpr void long_jump() noexcept {
+        apply({0x76e1'5d3e'fefd'cbbfull, 0xc500'4e44'1c52'2fb3ull, 0x7771'0069'854e'e241ull, 0x3910'9bb0'2acb'e635ull});
+    }
+
+    // Returns a copy of this engine and moves this one 2^192 draws ahead, so repeated
+    // calls hand out non-overlapping streams, e.g. one per thread
+    constexpr xoshiro256pp split() noexcept {
+        const xoshiro256pp r = *this;
+        long_jump();
+        return r;
+    }
+
+    [[nodiscard]] constexpr const std::array<std::uint64_t, 4>& state() const noexcept { return s_; }
+
+    [[nodiscard]] friend constexpr bool operator==(const xoshiro256pp&, const xoshiro256pp&) noexcept = default;
+
+private:
+    constexpr void apply(const std::array<std::uint64_t, 4>& poly) noexcept {
+        std::array<std::uint64_t, 4> acc{};
+        for (const std::uint64_t word : poly) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (std::uint64_t{1} << b)) {
+                    for (std::size_t i = 0; i < 4; ++i) acc[i] ^= s_[i];
+                }
+                (*this)();
+            }
+        }
+        s_ = acc;
+    }
+
+    std::array<std::uint64_t, 4> s_{};
+};
+
+// PCG32 (O'Neill), XSH-RR output on a 64-bit LCG: 32-bit outputs, 2^63 selectable streams,
+// and advance(n) skips n draws in O(log n)
+class pcg32 {
+public:
+    using result_type = std::uint32_t;
+
+    constexpr explicit pcg32(std::uint64_t seed = 0x853c'49e6'748f'ea9bull, std::uint64_t stream = 0xda3e'39cb'94b9'5bdbull) noexcept
+        : inc_((stream << 1) | 1u) {
+        (*this)();
+        state_ += seed;
+        (*this)();
+    }
+
+    [[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+    [[nodiscard]] static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept {
+        const std::uint64_t old = state_;
+        state_ = old * multiplier + inc_;
+        const auto xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+        const auto rot = static_cast<int>(old >> 59);
+        return std::rotr(xorshifted, rot);
+    }
+
+    // Jump-ahead by composing the LCG step with itself (Brown, "Random number generation
+    // with arbitrary strides")
+    constexpr void advance(std::uint64_t delta) noexcept {
+        std::uint64_t cur_mult = multiplier;
+        std::uint64_t cur_plus = inc_;
+        std::uint64_t acc_mult = 1;
+        std::uint64_t acc_plus = 0;
+        for (; delta > 0; delta >>= 1) {
+            if (delta & 1u) {
+                acc_mult *= cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+            cur_plus = (cur_mult + 1) * cur_plus;
+            cur_mult *= cur_mult;
+        }
+        state_ = acc_mult * state_ + acc_plus;
+    }
+
+    constexpr void discard(std::uint64_t n) noexcept { advance(n); }
+
+    [[nodiscard]] friend constexpr bool operator==(const pcg32&, const pcg32&) noexcept = default;
+
+private:
+    static constexpr std::uint64_t multiplier = 6364136223846793005ull;
+
+    std::uint64_t state_{0};
+    std::uint64_t inc_;
+};
+
+// Eight xoshiro256++ streams stepped together in 64-bit lanes; lane i is the seed engine
+// after i jump()s. The lane count is fixed rather than taken from the target so a seed
+// produces the same numbers on every ISA; narrower targets split the lanes over several
+// registers. Bulk sampling (random/sample.hpp) draws from this engine.
+class xoshiro256pp_lanes {
+public:
+    static constexpr std::size_t width = 8;
+    using lanes_type = pack<std::uint64_t, width>;
+
+    explicit xoshiro256pp_lanes(std::uint64_t seed = 0) noexcept : xoshiro256pp_lanes(xoshiro256pp(seed)) {}
+
+    explicit xoshiro256pp_lanes(xoshiro256pp base) noexcept {
+        for (std::size_t i = 0; i < width; ++i) {
+            for (std::size_t k = 0; k < 4; ++k) s_[k].set(i, base.state()[k]);
+            base.jump();
+        }
+    }
+
+    CT_FORCE_INLINE lanes_type operator()() noexcept {
+        const lanes_type result = rotl(s_[0] + s_[3], 23) + s_[0];
+        const lanes_type t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // The engine of one lane, e.g. to continue a stream with scalar draws
+    [[nodiscard]] xoshiro256pp lane(std::size_t i) const noexcept {
+        return xoshiro256pp({s_[0][i], s_[1][i], s_[2][i], s_[3][i]});
+    }
+
+private:
+    [[nodiscard]] static CT_FORCE_INLINE lanes_type rotl(const lanes_type& x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::array<lanes_type, 4> s_;
+};
+
+} // namespace random
+
+} // namespace ct
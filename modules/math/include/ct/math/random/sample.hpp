@@ -0,0 +1,304 @@
+#pragma once
+
+#include "./engine.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/pack.hpp"
+#include "../common/constants.hpp"
+#include "../common/functions.hpp"
+#include "../vec/base.hpp"
+#include "../vec/vec3.hpp"
+#include "../quat/quat.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace ct {
+
+namespace random {
+
+namespace detail {
+
+using ct::detail::fast_log;
+using ct::detail::fast_sincos;
+
+// 32 random bits from any engine; 64-bit engines give their high half, which is the
+// better-mixed one for xoshiro
+template<typename G>
+[[nodiscard]] constexpr std::uint32_t bits32(G& g) noexcept {
+    if constexpr (sizeof(typename G::result_type) > 4) {
+        return static_cast<std::uint32_t>(g() >> 32);
+    } else {
+        return static_cast<std::uint32_t>(g());
+    }
+}
+
+template<typename G>
+[[nodiscard]] constexpr std::uint64_t bits64(G& g) noexcept {
+    if constexpr (sizeof(typename G::result_type) > 4) {
+        return static_cast<std::uint64_t>(g());
+    } else {
+        const std::uint64_t hi = g();
+        return (hi << 32) | g();
+    }
+}
+
+// Uniform [0, 1) from the top mantissa-width bits: the bits go below the exponent of 1.0
+// and 1.0 is subtracted, which works per lane without an int-to-float conversion
+template<typename V>
+struct lane_value {
+    using type = V;
+};
+
+template<arithmetic T, std::size_t W>
+struct lane_value<pack<T, W>> {
+    using type = T;
+};
+
+template<typename V>
+[[nodiscard]] CT_FORCE_INLINE auto unit_from_bits(const V& bits) noexcept {
+    if constexpr (sizeof(typename lane_value<V>::type) == 8) {
+        return lane_bit_cast<double>((bits >> 12) | splat<V>(0x3ff0'0000'0000'0000ull)) - 1.0;
+    } else {
+        return lane_bit_cast<float>((bits >> 9) | splat<V>(0x3f80'0000u)) - 1.0f;
+    }
+}
+
+// Shared sampling kernels over V = T or pack<T, W>; u, v, w are uniform in [0, 1)
+
+template<floating_point T, typename V>
+CT_FORCE_INLINE void box_muller(const V& u, const V& v, V& z0, V& z1) noexcept {
+    //NOTE: 1 - u is in (0, 1], so the log stays finite
+    const V r = sqrt(splat<V>(-2) * fast_log<T>(splat<V>(1) - u));
+    V s, c;
+    fast_sincos<T>(v * splat<V>(two_pi<T>), s, c);
+    z0 = r * c;
+    z1 = r * s;
+}
+
+// Archimedes: z uniform in [-1, 1] and a uniform azimuth give a uniform point on the sphere
+template<floating_point T, typename V>
+CT_FORCE_INLINE void sphere_point(const V& u, const V& v, V& x, V& y, V& z) noexcept {
+    z = splat<V>(1) - splat<V>(2) * u;
+    const V r = sqrt(max(splat<V>(0), splat<V>(1) - z * z));
+    V s, c;
+    fast_sincos<T>(v * splat<V>(two_pi<T>), s, c);
+    x = r * c;
+    y = r * s;
+}
+
+// Shoemake, "Uniform random rotations" (Graphics Gems III)
+template<floating_point T, typename V>
+CT_FORCE_INLINE void rotation(const V& u, const V& v, const V& w, V& x, V& y, V& z, V& qw) noexcept {
+    const V a = sqrt(splat<V>(1) - u);
+    const V b = sqrt(u);
+    V s1, c1, s2, c2;
+    fast_sincos<T>(v * splat<V>(two_pi<T>), s1, c1);
+    fast_sincos<T>(w * splat<V>(two_pi<T>), s2, c2);
+    x = a * s1;
+    y = a * c1;
+    z = b * s2;
+    qw = b * c2;
+}
+
+// Unit lanes of T from the lanes engine: one draw gives 8 doubles or 16 floats
+template<floating_point T>
+using unit_lanes = pack<T, xoshiro256pp_lanes::width * (8 / sizeof(T))>;
+
+template<floating_point T>
+[[nodiscard]] CT_FORCE_INLINE unit_lanes<T> unit_draw(xoshiro256pp_lanes& g) noexcept {
+    if constexpr (sizeof(T) == 8) {
+        return unit_from_bits(g());
+    } else {
+        const auto bits = g();
+        pack<std::uint32_t, unit_lanes<T>::width> halves;
+        std::memcpy(&halves.v, &bits.v, sizeof(halves.v));
+        return unit_from_bits(halves);
+    }
+}
+
+} // namespace detail
+
+// Uniform in [0, 1) with 23 (float) or 52 (double) random bits, on a grid of 2^-23 or 2^-52
+template<floating_point T, typename G>
+[[nodiscard]] T uniform(G& g) noexcept {
+    if constexpr (sizeof(T) == 8) {
+        return detail::unit_from_bits(detail::bits64(g));
+    } else {
+        return detail::unit_from_bits(detail::bits32(g));
+    }
+}
+
+template<floating_point T, typename G>
+[[nodiscard]] T uniform(G& g, T lo, T hi) noexcept {
+    return lo + (hi - lo) * uniform<T>(g);
+}
+
+template<std::size_t N, floating_point T, typename G>
+[[nodiscard]] vec<N, T> uniform(G& g, const vec<N, T>& lo, const vec<N, T>& hi) noexcept {
+    vec<N, T> r;
+    for (std::size_t i = 0; i < N; ++i) r[i] = uniform(g, lo[i], hi[i]);
+    return r;
+}
+
+// Uniform integer in [0, n) without modulo bias (Lemire, "Fast random integer generation
+// in an interval"): one multiply, and a division only on the rare rejection path
+template<typename G>
+[[nodiscard]] constexpr std::uint32_t bounded(G& g, std::uint32_t n) noexcept {
+    assert(n > 0);
+    std::uint64_t m = static_cast<std::uint64_t>(detail::bits32(g)) * n;
+    auto low = static_cast<std::uint32_t>(m);
+    if (low < n) {
+        const std::uint32_t threshold = (0u - n) % n;
+        while (low < threshold) {
+            m = static_cast<std::uint64_t>(detail::bits32(g)) * n;
+            low = static_cast<std::uint32_t>(m);
+        }
+    }
+    return static_cast<std::uint32_t>(m >> 32);
+}
+
+// Standard normal through Box-Muller; the second variate of the pair is dropped
+template<floating_point T, typename G>
+[[nodiscard]] T normal(G& g, T mean = T{0}, T sigma = T{1}) noexcept {
+    const T u = uniform<T>(g);
+    const T v = uniform<T>(g);
+    T z0, z1;
+    detail::box_muller<T>(u, v, z0, z1);
+    return mean + sigma * z0;
+}
+
+template<floating_point T, typename G>
+[[nodiscard]] vec<3, T> on_sphere(G& g) noexcept {
+    const T u = uniform<T>(g);
+    const T v = uniform<T>(g);
+    vec<3, T> p;
+    detail::sphere_point<T>(u, v, p.x, p.y, p.z);
+    return p;
+}
+
+// Uniformly distributed (Haar) rotation
+template<floating_point T, typename G>
+[[nodiscard]] quat<T> rotation(G& g) noexcept {
+    const T u = uniform<T>(g);
+    const T v = uniform<T>(g);
+    const T w = uniform<T>(g);
+    quat<T> q;
+    detail::rotation<T>(u, v, w, q.x, q.y, q.z, q.w);
+    return q;
+}
+
+// out.size() distinct indices from [0, n), e.g. a RANSAC minimal sample (Floyd's
+// algorithm). Every subset is equally likely; the order within out is not uniform.
+template<typename G>
+void choose(G& g, std::uint32_t n, std::span<std::uint32_t> out) noexcept {
+    assert(out.size() <= n);
+    const auto k = static_cast<std::uint32_t>(out.size());
+    std::size_t filled = 0;
+    for (std::uint32_t j = n - k; j < n; ++j) {
+        const std::uint32_t t = bounded(g, j + 1);
+        const auto taken = out.begin() + static_cast<std::ptrdiff_t>(filled);
+        out[filled++] = std::find(out.begin(), taken, t) == taken ? t : j;
+    }
+}
+
+// Bulk sampling from the lanes engine. Whole draws go straight to the output; the tail
+// of a span takes the first values of one more draw, so a span is filled identically
+// whether it is sampled in one call or in pieces that are multiples of the draw size.
+
+template<floating_point T>
+void fill_uniform(xoshiro256pp_lanes& g, std::span<T> out, T lo = T{0}, T hi = T{1}) noexcept {
+    using P = detail::unit_lanes<T>;
+    constexpr std::size_t W = P::width;
+    const T scale = hi - lo;
+    std::size_t i = 0;
+    for (; i + W <= out.size(); i += W) (detail::unit_draw<T>(g) * scale + lo).store(out.data() + i);
+    if (i < out.size()) {
+        const P r = detail::unit_draw<T>(g) * scale + lo;
+        for (std::size_t l = 0; i < out.size(); ++i, ++l) out[i] = r[l];
+    }
+}
+
+template<floating_point T>
+void fill_normal(xoshiro256pp_lanes& g, std::span<T> out, T mean = T{0}, T sigma = T{1}) noexcept {
+    using P = detail::unit_lanes<T>;
+    constexpr std::size_t W = P::width;
+    for (std::size_t i = 0; i < out.size(); i += 2 * W) {
+        const P u = detail::unit_draw<T>(g);
+        const P v = detail::unit_draw<T>(g);
+        P z[2];
+        detail::box_muller<T>(u, v, z[0], z[1]);
+        for (auto& zk : z) zk = zk * sigma + mean;
+        if (i + 2 * W <= out.size()) {
+            z[0].store(out.data() + i);
+            z[1].store(out.data() + i + W);
+        } else {
+            for (std::size_t l = 0; i + l < out.size(); ++l) out[i + l] = z[l / W][l % W];
+        }
+    }
+}
+
+// Uniform integers in [0, n), Lemire's method on 32-bit halves of the lane draws
+inline void fill_bounded(xoshiro256pp_lanes& g, std::span<std::uint32_t> out, std::uint32_t n) noexcept {
+    assert(n > 0);
+    constexpr std::size_t W = 2 * xoshiro256pp_lanes::width;
+    const std::uint32_t threshold = (0u - n) % n;
+    std::uint32_t bits[W];
+    std::size_t used = W;
+    for (auto& o : out) {
+        std::uint64_t m;
+        do {
+            if (used == W) {
+                const auto draw = g();
+                std::memcpy(bits, &draw.v, sizeof(bits));
+                used = 0;
+            }
+            m = static_cast<std::uint64_t>(bits[used++]) * n;
+        } while (static_cast<std::uint32_t>(m) < threshold);
+        o = static_cast<std::uint32_t>(m >> 32);
+    }
+}
+
+template<floating_point T>
+void fill_on_sphere(xoshiro256pp_lanes& g, std::span<vec<3, T>> out) noexcept {
+    using P = detail::unit_lanes<T>;
+    constexpr std::size_t W = P::width;
+    static_assert(sizeof(vec<3, T>) == 3 * sizeof(T));
+    for (std::size_t i = 0; i < out.size(); i += W) {
+        P x, y, z;
+        detail::sphere_point<T>(detail::unit_draw<T>(g), detail::unit_draw<T>(g), x, y, z);
+        if (i + W <= out.size()) {
+            store_interleaved(reinterpret_cast<T*>(out.data() + i), x, y, z);
+        } else {
+            for (std::size_t l = 0; i + l < out.size(); ++l) out[i + l] = vec<3, T>(x[l], y[l], z[l]);
+        }
+    }
+}
+
+template<floating_point T>
+void fill_rotation(xoshiro256pp_lanes& g, std::span<quat<T>> out) noexcept {
+    using P = detail::unit_lanes<T>;
+    constexpr std::size_t W = P::width;
+    static_assert(sizeof(quat<T>) == 4 * sizeof(T));
+    for (std::size_t i = 0; i < out.size(); i += W) {
+        const P u = detail::unit_draw<T>(g);
+        const P v = detail::unit_draw<T>(g);
+        const P w = detail::unit_draw<T>(g);
+        P x, y, z, qw;
+        detail::rotation<T>(u, v, w, x, y, z, qw);
+        if (i + W <= out.size()) {
+            store_interleaved(reinterpret_cast<T*>(out.data() + i), x, y, z, qw);
+        } else {
+            for (std::size_t l = 0; i + l < out.size(); ++l) out[i + l] = quat<T>(x[l], y[l], z[l], qw[l]);
+        }
+    }
+}
+
+} // namespace random
+
+} // namespace ct
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/pack.hpp"
+#include "../mat/mat4.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ct {
+
+namespace detail {
+
+//NOTE: Levels narrower than this are recomputed on the calling thread
+inline constexpr std::size_t hierarchy_parallel_min = 4096;
+
+// out = a * b by column broadcasts: column j of out is sum_k a.col(k) * b(k, j), one
+// four-lane multiply-add per term regardless of what the compiler makes of operator*
+template<floating_point T>
+CT_FORCE_INLINE void mat4_mul_lanes(const mat<4, 4, T>& a, const mat<4, 4, T>& b, mat<4, 4, T>& out) noexcept {
+    using P = pack<T, 4>;
+    const P a0 = P::load(&a(0, 0));
+    const P a1 = P::load(&a(0, 1));
+    const P a2 = P::load(&a(0, 2));
+    const P a3 = P::load(&a(0, 3));
+    for (std::size_t j = 0; j < 4; ++j) {
+        (a0 * b(0, j) + a1 * b(1, j) + a2 * b(2, j) + a3 * b(3, j)).store(&out(0, j));
+    }
+}
+
+} // namespace detail
+
+// Forest of local transforms with cached world transforms, world = world(parent) * local.
+// Nodes are stored breadth-first, so every level of the forest is a contiguous range
+// that only reads from earlier ranges: update() walks the levels in order and
+// recomputes each one in parallel. A node is recomputed only when its own local
+// transform or an ancestor's changed since the last update().
+//
+// Node ids are the indices of the parent array given at construction; the storage
+// order is exposed through sorted_nodes() for callers that want to stream
+// world_matrices() directly. The structure is fixed once built; rebuild to re-parent.
+template<floating_point T>
+class transform_hierarchy {
+public:
+    using value_type = T;
+    using matrix_type = mat<4, 4, T>;
+    using node_index = std::uint32_t;
+
+    static constexpr node_index no_parent = ~node_index{0};
+
+    transform_hierarchy() = default;
+
+    // parents[i] is the parent of node i or no_parent, and must describe a forest.
+    // Every world matrix starts out dirty.
+    transform_hierarchy(std::span<const node_index> parents, std::span<const matrix_type> locals)
+        : order_(parents.size()), slot_(parents.size()), parent_(parents.size()),
+          local_(parents.size()), world_(parents.size()), dirty_(parents.size(), 1) {
+        assert(locals.size() == parents.size());
+        const std::size_t n = parents.size();
+
+        // Children lists in CSR form, in id order
+        std::vector<node_index> child_ptr(n + 1, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (parents[i] != no_parent) {
+                assert(parents[i] < n && parents[i] != i);
+                ++child_ptr[parents[i] + 1];
+            }
+        }
+        for (std::size_t i = 0; i < n; ++i) child_ptr[i + 1] += child_ptr[i];
+        std::vector<node_index> children(child_ptr[n]);
+        {
+            std::vector<node_index> fill(child_ptr.begin(), child_ptr.end() - 1);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (parents[i] != no_parent) children[fill[parents[i]]++] = static_cast<node_index>(i);
+            }
+        }
+
+        // Breadth-first from the roots
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (parents[i] == no_parent) order_[count++] = static_cast<node_index>(i);
+        }
+        for (std::size_t begin = 0; begin < count;) {
+            const std::size_t end = count;
+            for (std::size_t k = begin; k < end; ++k) {
+                const node_index id = order_[k];
+                for (node_index c = child_ptr[id]; c < child_ptr[id + 1]; ++c) order_[count++] = children[c];
+            }
+            level_begin_.push_back(static_cast<node_index>(end));
+            begin = end;
+        }
+        assert(count == n && "parent array contains a cycle");
+
+        for (std::size_t k = 0; k < n; ++k) slot_[order_[k]] = static_cast<node_index>(k);
+        for (std::size_t k = 0; k < n; ++k) {
+            const node_index p = parents[order_[k]];
+            parent_[k] = p == no_parent ? no_parent : slot_[p];
+            local_[k] = locals[order_[k]];
+        }
+        first_dirty_level_ = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return order_.size(); }
+    [[nodiscard]] std::size_t levels() const noexcept { return level_begin_.size() - 1; }
+
+    [[nodiscard]] node_index parent(node_index node) const noexcept {
+        const node_index p = parent_[slot_[node]];
+        return p == no_parent ? no_parent : order_[p];
+    }
+
+    [[nodiscard]] const matrix_type& local(node_index node) const noexcept { return local_[slot_[node]]; }
+
+    // Valid as of the last update()
+    [[nodiscard]] const matrix_type& world(node_index node) const noexcept { return world_[slot_[node]]; }
+
+    // Not safe to call concurrently with other set_local() or update() calls
+    void set_local(node_index node, const matrix_type& m) noexcept {
+        const node_index k = slot_[node];
+        local_[k] = m;
+        mark(k);
+    }
+
+    void mark_dirty(node_index node) noexcept { mark(slot_[node]); }
+
+    [[nodiscard]] bool dirty() const noexcept { return first_dirty_level_ < levels(); }
+
+    // Recomputes the world matrices under every changed node and returns how many it
+    // touched; clean subtrees cost one flag test per node
+    std::size_t update() {
+        if (!dirty()) return 0;
+
+        std::atomic<std::size_t> recomputed{0};
+        for (std::size_t l = first_dirty_level_; l < levels(); ++l) {
+            const std::size_t begin = level_begin_[l];
+            const std::size_t end = level_begin_[l + 1];
+            auto nodes = [&](std::size_t b, std::size_t e) {
+                std::size_t touched = 0;
+                for (std::size_t k = b; k < e; ++k) {
+                    const node_index p = parent_[k];
+                    if (p == no_parent) {
+                        if (dirty_[k]) {
+                            world_[k] = local_[k];
+                            ++touched;
+                        }
+                    } else if (dirty_[k] | dirty_[p]) {
+                        dirty_[k] = 1;
+                        detail::mat4_mul_lanes(world_[p], local_[k], world_[k]);
+                        ++touched;
+                    }
+                }
+                recomputed.fetch_add(touched, std::memory_order_relaxed);
+            };
+            if (end - begin >= detail::hierarchy_parallel_min) {
+                parallel_for(begin, end, parallel_grain(end - begin, 1024), nodes);
+            } else {
+                nodes(begin, end);
+            }
+        }
+
+        std::fill(dirty_.begin() + static_cast<std::ptrdiff_t>(level_begin_[first_dirty_level_]), dirty_.end(),
+                  std::uint8_t{0});
+        first_dirty_level_ = levels();
+        return recomputed.load(std::memory_order_relaxed);
+    }
+
+    // Marks every node dirty and recomputes the whole forest
+    void update_all() {
+        std::fill(dirty_.begin(), dirty_.end(), std::uint8_t{1});
+        first_dirty_level_ = 0;
+        update();
+    }
+
+    // Storage order: sorted_nodes()[k] is the id whose world matrix is world_matrices()[k]
+    [[nodiscard]] std::span<const node_index> sorted_nodes() const noexcept { return order_; }
+    [[nodiscard]] std::span<const matrix_type> world_matrices() const noexcept { return world_; }
+
+private:
+    void mark(node_index k) noexcept {
+        dirty_[k] = 1;
+        const auto it = std::upper_bound(level_begin_.begin(), level_begin_.end(), k);
+        first_dirty_level_ = std::min(first_dirty_level_, static_cast<std::size_t>(it - level_begin_.begin()) - 1);
+    }
+
+    std::vector<node_index> order_;           // storage slot -> id
+    std::vector<node_index> slot_;            // id -> storage slot
+    std::vector<node_index> parent_;          // parent slot per slot
+    std::vector<node_index> level_begin_{0};  // first slot of each level, then size()
+    aligned_vector<matrix_type> local_;
+    aligned_vector<matrix_type> world_;
+    std::vector<std::uint8_t> dirty_;
+    std::size_t first_dirty_level_ = 0;
+};
+
+} // namespace ct
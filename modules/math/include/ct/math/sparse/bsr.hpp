@@ -0,0 +1,186 @@
+#pragma once
+
+#include "./csr.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../mat/base.hpp"
+#include "../mat/mat3.hpp"     // IWYU pragma: keep
+#include "../mat/mat4.hpp"     // IWYU pragma: keep
+#include "../dense/view.hpp"
+#include "../dense/vecx.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ct {
+
+template<std::size_t BR, std::size_t BC, arithmetic T>
+struct block_triplet {
+    sparse_index row;
+    sparse_index col;
+    mat<BR, BC, T> value;
+};
+
+// Block compressed sparse row matrix whose nonzeros are fixed-size mat<BR, BC, T> blocks,
+// e.g. mat<6, 6> pose blocks or mat<3, 3> landmark blocks. Row/col indices count blocks.
+template<std::size_t BR, std::size_t BC, arithmetic T>
+class bsr_matrix {
+public:
+    using value_type = T;
+    using block_type = mat<BR, BC, T>;
+
+    static constexpr std::size_t block_rows = BR;
+    static constexpr std::size_t block_cols = BC;
+
+    bsr_matrix() = default;
+
+    bsr_matrix(std::size_t rows, std::size_t cols)
+        : rows_(rows), cols_(cols), row_ptr_(rows + 1, 0) {}
+
+    // Duplicate blocks are summed
+    [[nodiscard]] static bsr_matrix from_blocks(std::size_t rows, std::size_t cols,
+                                                std::span<const block_triplet<BR, BC, T>> entries) {
+        bsr_matrix m(rows, cols);
+
+        std::vector<std::size_t> order(entries.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return entries[a].row != entries[b].row ? entries[a].row < entries[b].row
+                                                    : entries[a].col < entries[b].col;
+        });
+
+        m.col_idx_.reserve(entries.size());
+        m.blocks_.reserve(entries.size());
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            const auto& e = entries[order[k]];
+            assert(e.row < rows && e.col < cols);
+            if (k > 0 && entries[order[k - 1]].row == e.row && entries[order[k - 1]].col == e.col) {
+                m.blocks_.back() += e.value;
+                continue;
+            }
+            ++m.row_ptr_[e.row + 1];
+            m.col_idx_.push_back(e.col);
+            m.blocks_.push_back(e.value);
+        }
+        std::partial_sum(m.row_ptr_.begin(), m.row_ptr_.end(), m.row_ptr_.begin());
+        return m;
+    }
+
+    // Block counts
+    [[nodiscard]] std::size_t rows() const noexcept { return rows_; }
+    [[nodiscard]] std::size_t cols() const noexcept { return cols_; }
+    [[nodiscard]] std::size_t nonzero_blocks() const noexcept { return blocks_.size(); }
+
+    // Scalar dimensions
+    [[nodiscard]] std::size_t scalar_rows() const noexcept { return rows_ * BR; }
+    [[nodiscard]] std::size_t scalar_cols() const noexcept { return cols_ * BC; }
+
+    [[nodiscard]] std::span<const std::size_t> row_ptr() const noexcept { return row_ptr_; }
+    [[nodiscard]] std::span<const sparse_index> col_idx() const noexcept { return col_idx_; }
+    [[nodiscard]] std::span<const block_type> blocks() const noexcept { return blocks_; }
+    [[nodiscard]] std::span<block_type> blocks() noexcept { return blocks_; }
+
+    // Position of block (r, c) in blocks(), or nonzero_blocks() when it is not part of the pattern
+    [[nodiscard]] std::size_t index_of(std::size_t r, std::size_t c) const noexcept {
+        assert(r < rows_);
+        const auto b = col_idx_.begin() + static_cast<std::ptrdiff_t>(row_ptr_[r]);
+        const auto e = col_idx_.begin() + static_cast<std::ptrdiff_t>(row_ptr_[r + 1]);
+        const auto it = std::lower_bound(b, e, static_cast<sparse_index>(c));
+        if (it == e || *it != c) return nonzero_blocks();
+        return static_cast<std::size_t>(it - col_idx_.begin());
+    }
+
+    [[nodiscard]] block_type* find(std::size_t r, std::size_t c) noexcept {
+        const std::size_t i = index_of(r, c);
+        return i == nonzero_blocks() ? nullptr : blocks_.data() + i;
+    }
+
+    [[nodiscard]] const block_type* find(std::size_t r, std::size_t c) const noexcept {
+        const std::size_t i = index_of(r, c);
+        return i == nonzero_blocks() ? nullptr : blocks_.data() + i;
+    }
+
+    // Keeps the pattern, zeroes the blocks; for re-accumulating normal equations each iteration
+    void set_zero() noexcept { std::fill(blocks_.begin(), blocks_.end(), block_type{}); }
+
+    // Expands to scalar CSR, e.g. to hand the system to sparse_llt
+    [[nodiscard]] csr_matrix<T> to_csr() const {
+        std::vector<triplet<T>> entries;
+        entries.reserve(blocks_.size() * BR * BC);
+        for (std::size_t r = 0; r < rows_; ++r) {
+            for (std::size_t p = row_ptr_[r]; p < row_ptr_[r + 1]; ++p) {
+                const block_type& b = blocks_[p];
+                for (std::size_t i = 0; i < BR; ++i) {
+                    for (std::size_t j = 0; j < BC; ++j) {
+                        entries.push_back({static_cast<sparse_index>(r * BR + i),
+                                           static_cast<sparse_index>(col_idx_[p] * BC + j), b(i, j)});
+                    }
+                }
+            }
+        }
+        return csr_matrix<T>::from_triplets(scalar_rows(), scalar_cols(), entries);
+    }
+
+private:
+    std::size_t rows_{0};
+    std::size_t cols_{0};
+    std::vector<std::size_t> row_ptr_{0};
+    std::vector<sparse_index> col_idx_;
+    std::vector<block_type> blocks_;
+};
+
+template<arithmetic T>
+using bsr3_matrix = bsr_matrix<3, 3, T>;
+template<arithmetic T>
+using bsr6_matrix = bsr_matrix<6, 6, T>;
+
+// y = alpha * A * x + beta * y on scalar vectors, block rows split over the thread pool
+template<std::size_t BR, std::size_t BC, arithmetic T>
+void spmv(const bsr_matrix<BR, BC, T>& a, std::type_identity_t<vecX_view<const T>> x,
+          std::type_identity_t<vecX_view<T>> y, T alpha = T{1}, T beta = T{}) {
+    assert(x.size() == a.scalar_cols() && y.size() == a.scalar_rows());
+
+    const auto rp = a.row_ptr();
+    const auto ci = a.col_idx();
+    const auto bl = a.blocks();
+
+    auto rows = [&](std::size_t rb, std::size_t re) {
+        for (std::size_t r = rb; r < re; ++r) {
+            T acc[BR]{};
+            for (std::size_t p = rp[r]; p < rp[r + 1]; ++p) {
+                const T* CT_RESTRICT b = bl[p].data();
+                const std::size_t xc = ci[p] * BC;
+                for (std::size_t j = 0; j < BC; ++j) {
+                    const T xj = x[xc + j];
+                    CT_VECTORIZE
+                    for (std::size_t i = 0; i < BR; ++i) acc[i] += b[j * BR + i] * xj;
+                }
+            }
+            for (std::size_t i = 0; i < BR; ++i) {
+                T& out = y[r * BR + i];
+                out = alpha * acc[i] + (beta == T{} ? T{} : beta * out);
+            }
+        }
+    };
+
+    if (a.nonzero_blocks() * BR * BC >= 32 * 1024) {
+        parallel_for(0, a.rows(), parallel_grain(a.rows(), 32), rows);
+    } else {
+        rows(0, a.rows());
+    }
+}
+
+template<std::size_t BR, std::size_t BC, arithmetic T>
+[[nodiscard]] vecX<T> operator*(const bsr_matrix<BR, BC, T>& a, const vecX<T>& x) {
+    vecX<T> y(a.scalar_rows());
+    spmv<BR, BC, T>(a, x.view(), y.view());
+    return y;
+}
+
+} // namespace ct
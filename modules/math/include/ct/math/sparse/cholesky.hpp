@@ -0,0 +1,229 @@
+#pragma once
+
+#include "./csr.hpp"
+#include "./ordering.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../dense/vecx.hpp"
+#include "../common/functions.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace ct {
+
+// Sparse Cholesky factorization P A P^T = L L^T of a symmetric positive definite matrix.
+// Only the lower triangle (col <= row) of A is read. The symbolic analysis (ordering,
+// elimination tree, pattern of L) depends only on the pattern, so a system whose values
+// change every iteration is analyzed once and refactorized cheaply.
+template<floating_point T>
+class sparse_llt {
+public:
+    sparse_llt() = default;
+
+    explicit sparse_llt(const csr_matrix<T>& a, sparse_ordering ordering = sparse_ordering::minimum_degree) {
+        compute(a, ordering);
+    }
+
+    bool compute(const csr_matrix<T>& a, sparse_ordering ordering = sparse_ordering::minimum_degree) {
+        analyze(a, ordering);
+        return factorize(a);
+    }
+
+    void analyze(const csr_matrix<T>& a, sparse_ordering ordering = sparse_ordering::minimum_degree) {
+        assert(a.rows() == a.cols());
+        n_ = a.rows();
+        ok_ = false;
+
+        if (ordering == sparse_ordering::minimum_degree) {
+            perm_ = minimum_degree_ordering(a);
+        } else {
+            perm_.resize(n_);
+            std::iota(perm_.begin(), perm_.end(), std::size_t{0});
+        }
+        pinv_.resize(n_);
+        for (std::size_t k = 0; k < n_; ++k) pinv_[perm_[k]] = k;
+
+        build_permuted_upper(a);
+        build_etree();
+
+        // Column counts of L: row k of L is the elimination-tree reach of column k of C
+        std::vector<std::size_t> counts(n_, 1);
+        std::vector<std::size_t> stack(n_);
+        mark_.assign(n_, npos);
+        for (std::size_t k = 0; k < n_; ++k) {
+            const std::size_t top = ereach(k, stack);
+            for (std::size_t t = top; t < n_; ++t) ++counts[stack[t]];
+        }
+
+        lp_.assign(n_ + 1, 0);
+        std::partial_sum(counts.begin(), counts.end(), lp_.begin() + 1);
+        li_.assign(lp_[n_], 0);
+        lx_.assign(lp_[n_], T{});
+    }
+
+    // Numeric factorization on the pattern passed to analyze(); false if A is not positive definite
+    bool factorize(const csr_matrix<T>& a) {
+        assert(a.rows() == n_ && a.nonzeros() == amap_.size());
+
+        const auto av = a.values();
+        std::fill(cx_.begin(), cx_.end(), T{});
+        for (std::size_t p = 0; p < amap_.size(); ++p) {
+            if (amap_[p] != npos) cx_[amap_[p]] += av[p];
+        }
+
+        std::vector<std::size_t> next(lp_.begin(), lp_.end() - 1);
+        std::vector<std::size_t> stack(n_);
+        std::vector<T> x(n_, T{});
+        mark_.assign(n_, npos);
+
+        for (std::size_t k = 0; k < n_; ++k) {
+            const std::size_t top = ereach(k, stack);
+
+            for (std::size_t p = cp_[k]; p < cp_[k + 1]; ++p) x[ci_[p]] = cx_[p];
+            T d = x[k];
+            x[k] = T{};
+
+            for (std::size_t t = top; t < n_; ++t) {
+                const std::size_t i = stack[t];
+                const T lki = x[i] / lx_[lp_[i]];
+                x[i] = T{};
+                for (std::size_t p = lp_[i] + 1; p < next[i]; ++p) x[li_[p]] -= lx_[p] * lki;
+                d -= lki * lki;
+                const std::size_t p = next[i]++;
+                li_[p] = k;
+                lx_[p] = lki;
+            }
+
+            if (!(d > T{})) {
+                ok_ = false;
+                return false;
+            }
+
+            const std::size_t p = next[k]++;
+            li_[p] = k;
+            lx_[p] = sqrt(d);
+        }
+
+        ok_ = true;
+        return true;
+    }
+
+    [[nodiscard]] bool ok() const noexcept { return ok_; }
+    [[nodiscard]] std::size_t size() const noexcept { return n_; }
+    [[nodiscard]] std::size_t factor_nonzeros() const noexcept { return lp_.empty() ? 0 : lp_[n_]; }
+    [[nodiscard]] const std::vector<std::size_t>& permutation() const noexcept { return perm_; }
+
+    [[nodiscard]] vecX<T> solve(const vecX<T>& b) const {
+        assert(ok_ && b.size() == n_);
+
+        vecX<T> y(n_);
+        for (std::size_t k = 0; k < n_; ++k) y[k] = b[perm_[k]];
+
+        for (std::size_t j = 0; j < n_; ++j) {
+            y[j] /= lx_[lp_[j]];
+            const T yj = y[j];
+            for (std::size_t p = lp_[j] + 1; p < lp_[j + 1]; ++p) y[li_[p]] -= lx_[p] * yj;
+        }
+
+        for (std::size_t j = n_; j-- > 0;) {
+            T acc = y[j];
+            for (std::size_t p = lp_[j] + 1; p < lp_[j + 1]; ++p) acc -= lx_[p] * y[li_[p]];
+            y[j] = acc / lx_[lp_[j]];
+        }
+
+        vecX<T> x(n_);
+        for (std::size_t k = 0; k < n_; ++k) x[perm_[k]] = y[k];
+        return x;
+    }
+
+private:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    // Upper triangle of C = P A P^T in compressed columns, plus where each entry of A lands
+    void build_permuted_upper(const csr_matrix<T>& a) {
+        const auto rp = a.row_ptr();
+        const auto ci = a.col_idx();
+
+        cp_.assign(n_ + 1, 0);
+        amap_.assign(a.nonzeros(), npos);
+        for (std::size_t r = 0; r < n_; ++r) {
+            for (std::size_t p = rp[r]; p < rp[r + 1]; ++p) {
+                if (ci[p] > r) continue;
+                const std::size_t pr = pinv_[r];
+                const std::size_t pc = pinv_[ci[p]];
+                ++cp_[(pr > pc ? pr : pc) + 1];
+            }
+        }
+        std::partial_sum(cp_.begin(), cp_.end(), cp_.begin());
+
+        ci_.assign(cp_[n_], 0);
+        cx_.assign(cp_[n_], T{});
+        std::vector<std::size_t> fill(cp_.begin(), cp_.end() - 1);
+        for (std::size_t r = 0; r < n_; ++r) {
+            for (std::size_t p = rp[r]; p < rp[r + 1]; ++p) {
+                if (ci[p] > r) continue;
+                const std::size_t pr = pinv_[r];
+                const std::size_t pc = pinv_[ci[p]];
+                const std::size_t q = fill[pr > pc ? pr : pc]++;
+                ci_[q] = pr < pc ? pr : pc;
+                amap_[p] = q;
+            }
+        }
+    }
+
+    void build_etree() {
+        parent_.assign(n_, npos);
+        std::vector<std::size_t> ancestor(n_, npos);
+        for (std::size_t k = 0; k < n_; ++k) {
+            for (std::size_t p = cp_[k]; p < cp_[k + 1]; ++p) {
+                std::size_t i = ci_[p];
+                //NOTE: Path compression through `ancestor` keeps this near-linear
+                while (i != npos && i < k) {
+                    const std::size_t next = ancestor[i];
+                    ancestor[i] = k;
+                    if (next == npos) parent_[i] = k;
+                    i = next;
+                }
+            }
+        }
+    }
+
+    // Pattern of row k of L in topological order, returned in stack[top, n)
+    std::size_t ereach(std::size_t k, std::vector<std::size_t>& stack) {
+        std::size_t top = n_;
+        mark_[k] = k;
+        for (std::size_t p = cp_[k]; p < cp_[k + 1]; ++p) {
+            std::size_t i = ci_[p];
+            if (i > k) continue;
+            std::size_t len = 0;
+            for (; mark_[i] != k; i = parent_[i]) {
+                stack[len++] = i;
+                mark_[i] = k;
+            }
+            while (len > 0) stack[--top] = stack[--len];
+        }
+        return top;
+    }
+
+    std::size_t n_{0};
+    bool ok_{false};
+
+    std::vector<std::size_t> perm_;
+    std::vector<std::size_t> pinv_;
+    std::vector<std::size_t> parent_;
+    std::vector<std::size_t> mark_;
+
+    std::vector<std::size_t> cp_;
+    std::vector<std::size_t> ci_;
+    std::vector<T> cx_;
+    std::vector<std::size_t> amap_;
+
+    std::vector<std::size_t> lp_;
+    std::vector<std::size_t> li_;
+    std::vector<T> lx_;
+};
+
+} // namespace ct
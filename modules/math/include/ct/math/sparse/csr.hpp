@@ -0,0 +1,186 @@
+#pragma once
+
+#include "../detail/arithmetic.hpp"
+#include "../detail/simd.hpp"
+#include "../dense/view.hpp"
+#include "../dense/vecx.hpp"
+#include "../parallel/parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ct {
+
+//NOTE: Column indices are 32-bit to halve index traffic in SpMV; offsets stay size_t
+using sparse_index = std::uint32_t;
+
+template<arithmetic T>
+struct triplet {
+    sparse_index row;
+    sparse_index col;
+    T value;
+};
+
+// Compressed sparse row matrix. Column indices within a row are sorted and unique.
+template<arithmetic T>
+class csr_matrix {
+public:
+    using value_type = T;
+
+    csr_matrix() = default;
+
+    csr_matrix(std::size_t rows, std::size_t cols)
+        : rows_(rows), cols_(cols), row_ptr_(rows + 1, 0) {}
+
+    // Duplicate entries are summed
+    [[nodiscard]] static csr_matrix from_triplets(std::size_t rows, std::size_t cols,
+                                                  std::span<const triplet<T>> entries) {
+        csr_matrix m(rows, cols);
+
+        for (const auto& e : entries) {
+            assert(e.row < rows && e.col < cols);
+            ++m.row_ptr_[e.row + 1];
+        }
+        std::partial_sum(m.row_ptr_.begin(), m.row_ptr_.end(), m.row_ptr_.begin());
+
+        std::vector<std::size_t> fill(m.row_ptr_.begin(), m.row_ptr_.end() - 1);
+        std::vector<sparse_index> cols_tmp(entries.size());
+        std::vector<T> vals_tmp(entries.size());
+        for (const auto& e : entries) {
+            const std::size_t p = fill[e.row]++;
+            cols_tmp[p] = e.col;
+            vals_tmp[p] = e.value;
+        }
+
+        m.col_idx_.reserve(entries.size());
+        m.values_.reserve(entries.size());
+
+        std::vector<std::size_t> order;
+        std::size_t out = 0;
+        for (std::size_t r = 0; r < rows; ++r) {
+            const std::size_t b = m.row_ptr_[r];
+            const std::size_t e = m.row_ptr_[r + 1];
+            order.resize(e - b);
+            std::iota(order.begin(), order.end(), b);
+            std::sort(order.begin(), order.end(),
+                      [&](std::size_t x, std::size_t y) { return cols_tmp[x] < cols_tmp[y]; });
+
+            m.row_ptr_[r] = out;
+            for (std::size_t k = 0; k < order.size(); ++k) {
+                const sparse_index c = cols_tmp[order[k]];
+                if (out > m.row_ptr_[r] && m.col_idx_.back() == c) {
+                    m.values_.back() += vals_tmp[order[k]];
+                } else {
+                    m.col_idx_.push_back(c);
+                    m.values_.push_back(vals_tmp[order[k]]);
+                    ++out;
+                }
+            }
+        }
+        m.row_ptr_[rows] = out;
+        return m;
+    }
+
+    [[nodiscard]] std::size_t rows() const noexcept { return rows_; }
+    [[nodiscard]] std::size_t cols() const noexcept { return cols_; }
+    [[nodiscard]] std::size_t nonzeros() const noexcept { return values_.size(); }
+
+    [[nodiscard]] std::span<const std::size_t> row_ptr() const noexcept { return row_ptr_; }
+    [[nodiscard]] std::span<const sparse_index> col_idx() const noexcept { return col_idx_; }
+    [[nodiscard]] std::span<const T> values() const noexcept { return values_; }
+    [[nodiscard]] std::span<T> values() noexcept { return values_; }
+
+    // Position of entry (r, c) in values(), or nonzeros() when it is not part of the pattern
+    [[nodiscard]] std::size_t index_of(std::size_t r, std::size_t c) const noexcept {
+        assert(r < rows_);
+        const auto b = col_idx_.begin() + static_cast<std::ptrdiff_t>(row_ptr_[r]);
+        const auto e = col_idx_.begin() + static_cast<std::ptrdiff_t>(row_ptr_[r + 1]);
+        const auto it = std::lower_bound(b, e, static_cast<sparse_index>(c));
+        if (it == e || *it != c) return nonzeros();
+        return static_cast<std::size_t>(it - col_idx_.begin());
+    }
+
+    [[nodiscard]] T* find(std::size_t r, std::size_t c) noexcept {
+        const std::size_t i = index_of(r, c);
+        return i == nonzeros() ? nullptr : values_.data() + i;
+    }
+
+    [[nodiscard]] T coeff(std::size_t r, std::size_t c) const noexcept {
+        const std::size_t i = index_of(r, c);
+        return i == nonzeros() ? T{} : values_[i];
+    }
+
+    [[nodiscard]] vecX<T> diagonal() const {
+        vecX<T> d(rows_ < cols_ ? rows_ : cols_);
+        for (std::size_t r = 0; r < d.size(); ++r) d[r] = coeff(r, r);
+        return d;
+    }
+
+    // Keeps the pattern, zeroes the values; for refilling systems with a fixed structure
+    void set_zero() noexcept { std::fill(values_.begin(), values_.end(), T{}); }
+
+    [[nodiscard]] csr_matrix transpose() const {
+        csr_matrix t(cols_, rows_);
+        t.col_idx_.resize(nonzeros());
+        t.values_.resize(nonzeros());
+        for (const sparse_index c : col_idx_) ++t.row_ptr_[c + 1];
+        std::partial_sum(t.row_ptr_.begin(), t.row_ptr_.end(), t.row_ptr_.begin());
+
+        std::vector<std::size_t> fill(t.row_ptr_.begin(), t.row_ptr_.end() - 1);
+        for (std::size_t r = 0; r < rows_; ++r) {
+            for (std::size_t p = row_ptr_[r]; p < row_ptr_[r + 1]; ++p) {
+                const std::size_t q = fill[col_idx_[p]]++;
+                t.col_idx_[q] = static_cast<sparse_index>(r);
+                t.values_[q] = values_[p];
+            }
+        }
+        return t;
+    }
+
+private:
+    std::size_t rows_{0};
+    std::size_t cols_{0};
+    std::vector<std::size_t> row_ptr_{0};
+    std::vector<sparse_index> col_idx_;
+    std::vector<T> values_;
+};
+
+// y = alpha * A * x + beta * y, rows split over the global thread pool
+template<arithmetic T>
+void spmv(const csr_matrix<T>& a, std::type_identity_t<vecX_view<const T>> x,
+          std::type_identity_t<vecX_view<T>> y, T alpha = T{1}, T beta = T{}) {
+    assert(x.size() == a.cols() && y.size() == a.rows());
+
+    const std::size_t* CT_RESTRICT rp = a.row_ptr().data();
+    const sparse_index* CT_RESTRICT ci = a.col_idx().data();
+    const T* CT_RESTRICT v = a.values().data();
+
+    auto rows = [&](std::size_t rb, std::size_t re) {
+        for (std::size_t r = rb; r < re; ++r) {
+            T acc{};
+            for (std::size_t p = rp[r]; p < rp[r + 1]; ++p) acc += v[p] * x[ci[p]];
+            y[r] = alpha * acc + (beta == T{} ? T{} : beta * y[r]);
+        }
+    };
+
+    if (a.nonzeros() >= 32 * 1024) {
+        parallel_for(0, a.rows(), parallel_grain(a.rows(), 128), rows);
+    } else {
+        rows(0, a.rows());
+    }
+}
+
+template<arithmetic T>
+[[nodiscard]] vecX<T> operator*(const csr_matrix<T>& a, const vecX<T>& x) {
+    vecX<T> y(a.rows());
+    spmv<T>(a, x.view(), y.view());
+    return y;
+}
+
+} // namespace ct
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "./csr.hpp"
+#include "../detail/arithmetic.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace ct {
+
+enum class sparse_ordering : std::uint8_t {
+    natural,
+    minimum_degree
+};
+
+// Minimum degree ordering on the symmetrized pattern of A. Returns perm with
+// perm[new_index] = old_index. Eliminating a node turns its remaining neighbours into a
+// clique, exactly as Cholesky fill does, so picking the lowest degree first keeps fill low.
+template<arithmetic T>
+[[nodiscard]] std::vector<std::size_t> minimum_degree_ordering(const csr_matrix<T>& a) {
+    const std::size_t n = a.rows();
+    const auto rp = a.row_ptr();
+    const auto ci = a.col_idx();
+
+    std::vector<std::vector<std::size_t>> adj(n);
+    for (std::size_t r = 0; r < n; ++r) {
+        for (std::size_t p = rp[r]; p < rp[r + 1]; ++p) {
+            const std::size_t c = ci[p];
+            if (c == r || c >= n) continue;
+            adj[r].push_back(c);
+            adj[c].push_back(r);
+        }
+    }
+    for (auto& l : adj) {
+        std::sort(l.begin(), l.end());
+        l.erase(std::unique(l.begin(), l.end()), l.end());
+    }
+
+    using entry = std::pair<std::size_t, std::size_t>;  // (degree, node)
+    std::priority_queue<entry, std::vector<entry>, std::greater<>> queue;
+    for (std::size_t i = 0; i < n; ++i) queue.emplace(adj[i].size(), i);
+
+    std::vector<bool> eliminated(n, false);
+    std::vector<std::size_t> perm;
+    perm.reserve(n);
+
+    std::vector<std::size_t> merged;
+    while (!queue.empty()) {
+        const auto [degree, v] = queue.top();
+        queue.pop();
+        //NOTE: Stale entries are skipped lazily instead of being updated in the heap
+        if (eliminated[v] || degree != adj[v].size()) continue;
+
+        eliminated[v] = true;
+        perm.push_back(v);
+
+        const std::vector<std::size_t> nbrs = std::move(adj[v]);
+        adj[v].clear();
+        for (const std::size_t u : nbrs) {
+            auto& au = adj[u];
+            au.erase(std::lower_bound(au.begin(), au.end(), v));
+
+            merged.clear();
+            std::set_union(au.begin(), au.end(), nbrs.begin(), nbrs.end(), std::back_inserter(merged));
+            merged.erase(std::lower_bound(merged.begin(), merged.end(), u));
+            au.swap(merged);
+
+            queue.emplace(au.size(), u);
+        }
+    }
+
+    return perm;
+}
+
+} // namespace ct
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "./csr.hpp"
+#include "./bsr.hpp"
+#include "../detail/arithmetic.hpp"
+#include "../dense/view.hpp"
+#include "../dense/vecx.hpp"
+#include "../mat/base.hpp"
+#include "../decomp/lu.hpp"
+#include "../common/functions.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace ct {
+
+struct pcg_settings {
+    std::size_t max_iterations{500};
+    // Stops once ||r|| <= tolerance * ||b||
+    double tolerance{1e-8};
+};
+
+template<floating_point T>
+struct pcg_result {
+    std::size_t iterations{0};
+    T residual_norm{};
+    bool converged{false};
+};
+
+// z = r
+template<floating_point T>
+struct identity_preconditioner {
+    void apply(vecX_view<const T> r, vecX_view<T> z) const noexcept { z.assign(r); }
+};
+
+// z = diag(A)^-1 r
+template<floating_point T>
+class jacobi_preconditioner {
+public:
+    explicit jacobi_preconditioner(const csr_matrix<T>& a) : inv_diag_(a.rows()) {
+        for (std::size_t i = 0; i < a.rows(); ++i) {
+            const T d = a.coeff(i, i);
+            inv_diag_[i] = abs(d) > epsilon<T> ? T{1} / d : T{1};
+        }
+    }
+
+    void apply(vecX_view<const T> r, vecX_view<T> z) const noexcept {
+        for (std::size_t i = 0; i < r.size(); ++i) z[i] = inv_diag_[i] * r[i];
+    }
+
+private:
+    vecX<T> inv_diag_;
+};
+
+// z = blockdiag(A)^-1 r, inverting every B x B diagonal block once up front
+template<std::size_t B, floating_point T>
+class block_jacobi_preconditioner {
+public:
+    explicit block_jacobi_preconditioner(const bsr_matrix<B, B, T>& a) : inv_blocks_(a.rows()) {
+        for (std::size_t i = 0; i < a.rows(); ++i) {
+            const mat<B, B, T>* d = a.find(i, i);
+            inv_blocks_[i] = d ? inverse(*d) : mat<B, B, T>::identity();
+        }
+    }
+
+    void apply(vecX_view<const T> r, vecX_view<T> z) const noexcept {
+        for (std::size_t b = 0; b < inv_blocks_.size(); ++b) {
+            const mat<B, B, T>& m = inv_blocks_[b];
+            for (std::size_t i = 0; i < B; ++i) {
+                T acc{};
+                for (std::size_t j = 0; j < B; ++j) acc += m(i, j) * r[b * B + j];
+                z[b * B + i] = acc;
+            }
+        }
+    }
+
+private:
+    std::vector<mat<B, B, T>> inv_blocks_;
+};
+
+// Preconditioned conjugate gradient for symmetric positive definite A (csr_matrix or
+// bsr_matrix). x holds the initial guess on entry and the solution on exit.
+template<typename Matrix, typename Preconditioner, floating_point T>
+pcg_result<T> pcg(const Matrix& a, const vecX<T>& b, vecX<T>& x, const Preconditioner& precond,
+                  const pcg_settings& settings = {}) {
+    const std::size_t n = b.size();
+    assert(x.size() == n);
+
+    vecX<T> r(n);
+    vecX<T> z(n);
+    vecX<T> p(n);
+    vecX<T> ap(n);
+
+    // r = b - A x
+    spmv(a, x.view(), r.view());
+    for (std::size_t i = 0; i < n; ++i) r[i] = b[i] - r[i];
+
+    const T b_norm = b.length();
+    const T threshold = static_cast<T>(settings.tolerance) * (b_norm > T{} ? b_norm : T{1});
+
+    pcg_result<T> result;
+    result.residual_norm = r.length();
+    if (result.residual_norm <= threshold) {
+        result.converged = true;
+        return result;
+    }
+
+    precond.apply(r.view(), z.view());
+    p = z;
+    T rz = r.dot(z);
+
+    for (std::size_t it = 0; it < settings.max_iterations; ++it) {
+        spmv(a, p.view(), ap.view());
+        const T pap = p.dot(ap);
+        if (pap <= T{}) break;  //NOTE: A is not positive definite along p
+
+        const T alpha = rz / pap;
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * ap[i];
+        }
+
+        result.iterations = it + 1;
+        result.residual_norm = r.length();
+        if (result.residual_norm <= threshold) {
+            result.converged = true;
+            break;
+        }
+
+        precond.apply(r.view(), z.view());
+        const T rz_next = r.dot(z);
+        const T beta = rz_next / rz;
+        rz = rz_next;
+        for (std::size_t i = 0; i < n; ++i) p[i] = z[i] + beta * p[i];
+    }
+
+    return result;
+}
+
+template<typename Matrix, floating_point T>
+pcg_result<T> pcg(const Matrix& a, const vecX<T>& b, vecX<T>& x, const pcg_settings& settings = {}) {
+    return pcg(a, b, x, identity_preconditioner<T>{}, settings);
+}
+
+} // namespace ct
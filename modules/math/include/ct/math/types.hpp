@@ -3,7 +3,10 @@
 #include "vec/fwd.hpp"
 #include "mat/fwd.hpp"
 #include "quat/fwd.hpp"
+#include "lie/fwd.hpp"
+#include "dense/fwd.hpp"
 #include "detail/arithmetic.hpp"
+#include "common/half.hpp"
 
 #include <cstdint>
 
@@ -32,6 +35,10 @@ using vec2u = vec2<unsigned>;
 using vec3u = vec3<unsigned>;
 using vec4u = vec4<unsigned>;
 
+using vec2h = vec2<f16>;
+using vec3h = vec3<f16>;
+using vec4h = vec4<f16>;
+
 template<arithmetic T = float>
 using mat2 = mat<2, 2, T>;
 template<arithmetic T = float>
@@ -47,7 +54,22 @@ using mat2d = mat2<double>;
 using mat3d = mat3_t<double>;
 using mat4d = mat4_t<double>;
 
+using affine3f = affine3<float>;
+using affine3d = affine3<double>;
+using rigid3f = rigid3<float>;
+using rigid3d = rigid3<double>;
+
 using quatf = quat<float>;
 using quatd = quat<double>;
 
+using so3f = so3<float>;
+using so3d = so3<double>;
+using se3f = se3<float>;
+using se3d = se3<double>;
+
+using matXf = matX<float>;
+using matXd = matX<double>;
+using vecXf = vecX<float>;
+using vecXd = vecX<double>;
+
 } // namespace cc
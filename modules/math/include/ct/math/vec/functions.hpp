@@ -96,4 +96,17 @@ template<std::size_t N, floating_point T>
     return length_squared(b - a);
 }
 
+namespace fast {
+
+// normalize() through fast::rsqrt; a zero vector stays zero
+template<std::size_t N, floating_point T>
+[[nodiscard]] inline vec<N, T> normalize(const vec<N, T>& v) noexcept {
+    const T l2 = v.length_squared();
+    //NOTE: A subnormal l2 overflows the rsqrt estimate; such tiny vectors take the exact path
+    if (l2 < std::numeric_limits<T>::min()) return v.normalized();
+    return v * rsqrt(l2);
+}
+
+} // namespace fast
+
 } // namespace cc
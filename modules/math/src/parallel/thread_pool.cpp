@@ -0,0 +1,102 @@
+#include "ct/math/parallel/parallel.hpp"
+
+namespace ct {
+
+namespace {
+
+thread_local bool tInsideTask = false;
+
+} // namespace
+
+thread_pool::thread_pool(std::size_t workers) {
+    if (workers == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        workers = hw > 1 ? hw - 1 : 0;
+    }
+
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& w : workers_) {
+        w.join();
+    }
+}
+
+thread_pool& thread_pool::global() {
+    static thread_pool pool;
+    return pool;
+}
+
+void thread_pool::drain(const std::function<void(std::size_t)>& task, std::size_t count) {
+    const bool outer = tInsideTask;
+    tInsideTask = true;
+    for (std::size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next_.fetch_add(1, std::memory_order_relaxed)) {
+        task(i);
+    }
+    tInsideTask = outer;
+}
+
+void thread_pool::run(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) return;
+
+    //NOTE: Nested or trivially small jobs run inline on the calling thread
+    if (tInsideTask || workers_.empty() || count == 1) {
+        const bool outer = tInsideTask;
+        tInsideTask = true;
+        for (std::size_t i = 0; i < count; ++i) task(i);
+        tInsideTask = outer;
+        return;
+    }
+
+    std::lock_guard submit(submit_);
+    {
+        std::lock_guard lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(task, count);
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    task_ = nullptr;
+}
+
+void thread_pool::worker_loop() {
+    std::uint64_t seen = 0;
+    for (;;) {
+        std::unique_lock lock(mutex_);
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+
+        seen = generation_;
+        if (task_ == nullptr) continue;
+
+        const auto* task = task_;
+        const std::size_t count = count_;
+        ++active_;
+        lock.unlock();
+
+        drain(*task, count);
+
+        lock.lock();
+        if (--active_ == 0) {
+            done_.notify_all();
+        }
+    }
+}
+
+} // namespace ct
@@ -1,15 +1,27 @@
 #pragma once
 
+#include "ct/base/types/types.hpp"
 #include "ct/math/detail/arithmetic.hpp"
 #include "ct/math/math.hpp"
 
-
+#include <span>
 
 namespace ct::vision {
 
+// Newton iterations of Undistort; wherever Distort is invertible (out to the fold of a
+// strong barrel lens) 10 reach float rounding, a few 1e-4 px at the image corners
+inline constexpr u32 kUndistortIterations = 10;
+
+// Pinhole camera with Brown-Conrady distortion (see camera.md).
+// - intrinsics: K = [fx s cx; 0 fy cy; 0 0 1]
+// - extrinsics: world -> camera transform (x right, y down, z forward)
+// - distortion: (k1, k2, p1, p2, k3), applied to normalized coordinates
+//
+// The span overloads process points in SIMD blocks and split large inputs across the
+// thread pool; out may not alias in.
 struct Camera {
     mat3f intrinsics = mat3f(
-        layout::colm,
+        layout::rowm,
         800.0f,   0.0f, 320.0f,
           0.0f, 800.0f, 240.0f,
           0.0f,   0.0f,   1.0f
@@ -20,6 +32,25 @@ struct Camera {
     Camera() = default;
     Camera(const mat3f& intrinsics, const mat4f& extrinsics)
         : intrinsics(intrinsics), extrinsics(extrinsics) {}
+
+    // Normalized image coordinates (x / z, y / z) -> distorted normalized coordinates
+    [[nodiscard]] vec2f Distort(const vec2f& normalized) const noexcept;
+    void Distort(std::span<const vec2f> normalized, std::span<vec2f> out) const;
+
+    // Inverse of Distort by Newton iteration; meaningless past the fold, where none exists
+    [[nodiscard]] vec2f Undistort(const vec2f& distorted, u32 iterations = kUndistortIterations) const noexcept;
+    void Undistort(std::span<const vec2f> distorted, std::span<vec2f> out,
+                   u32 iterations = kUndistortIterations) const;
+
+    // World point -> pixel. Points at or behind the camera plane (z <= 0) give NaN pixels.
+    [[nodiscard]] vec2f Project(const vec3f& world) const noexcept;
+    void Project(std::span<const vec3f> world, std::span<vec2f> pixels) const;
+
+    // Pixel and depth along the optical axis (camera z) -> world point
+    [[nodiscard]] vec3f Unproject(const vec2f& pixel, float depth,
+                                  u32 iterations = kUndistortIterations) const noexcept;
+    void Unproject(std::span<const vec2f> pixels, std::span<const float> depth, std::span<vec3f> world,
+                   u32 iterations = kUndistortIterations) const;
 };
 
 } // namespace ct::vision
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ct/base/types/types.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace ct::vision {
+
+// Non-owning view of an interleaved image (e.g. 8-bit BGR as channels = 3). stride is in
+// elements between the starts of consecutive rows, so padded rows and sub-images work
+// without copies; a cv::Mat maps to {mat.data, cols, rows, channels, step / elemSize1}.
+template<typename T>
+struct ImageView {
+    T* data{nullptr};
+    u32 width{0};
+    u32 height{0};
+    u32 channels{1};
+    std::size_t stride{0};
+
+    ImageView() = default;
+    ImageView(T* pixels, u32 cols, u32 rows, u32 components = 1, std::size_t rowStride = 0) noexcept
+        : data(pixels), width(cols), height(rows), channels(components),
+          stride(rowStride != 0 ? rowStride : std::size_t{cols} * components) {}
+
+    template<typename U>
+    requires (std::is_const_v<T> && std::is_same_v<std::remove_const_t<T>, U>)
+    ImageView(const ImageView<U>& other) noexcept
+        : data(other.data), width(other.width), height(other.height), channels(other.channels),
+          stride(other.stride) {}
+
+    [[nodiscard]] T* Row(u32 y) const noexcept { return data + y * stride; }
+    [[nodiscard]] bool Empty() const noexcept { return data == nullptr || width == 0 || height == 0; }
+};
+
+} // namespace ct::vision
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ct/base/types/types.hpp"
+#include "ct/vision/image/image.hpp"
+#include "ct/vision/media/frame_pool.hpp"
+
+#include <cstddef>
+
+namespace ct::vision {
+
+// Decoded frame: interleaved 8-bit pixels, BGR for colour sources (the order OpenCV
+// decoders produce). Pixels live in a pooled buffer with rows of `stride` bytes; copying
+// a Frame shares the buffer, and it returns to the pool once every copy is gone.
+struct Frame {
+    FrameBuffer pixels;
+    u32 width{0};
+    u32 height{0};
+    u32 channels{3};
+    std::size_t stride{0};
+    u64 index{0};          // Position in the stream, from 0
+    double timestamp{0.0}; // Seconds from the start of the stream
+
+    [[nodiscard]] ImageView<const u8> View() const noexcept {
+        return {pixels.Data(), width, height, channels, stride};
+    }
+    [[nodiscard]] ImageView<u8> View() noexcept { return {pixels.Data(), width, height, channels, stride}; }
+};
+
+} // namespace ct::vision
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "ct/base/types/types.hpp"
+#include "ct/math/detail/aligned.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ct::vision {
+
+// Frame buffers start on a cache line and rows are padded to it, so SIMD kernels can use
+// aligned loads on any row
+inline constexpr std::size_t kFrameAlignment = cache_line;
+
+[[nodiscard]] constexpr std::size_t AlignedRowBytes(std::size_t bytes) noexcept {
+    return (bytes + kFrameAlignment - 1) / kFrameAlignment * kFrameAlignment;
+}
+
+class FramePool;
+
+namespace detail {
+
+struct FrameSlot {
+    aligned_vector<u8, kFrameAlignment> data;
+    std::atomic<u32> refs{0};
+};
+
+} // namespace detail
+
+// Reference-counted lease on a pooled buffer. Copies share the buffer; when the last one
+// goes away the buffer returns to its pool. Leases keep the pool alive, so frames may
+// outlive the Media that produced them.
+class FrameBuffer {
+public:
+    FrameBuffer() = default;
+    FrameBuffer(const FrameBuffer& other) noexcept;
+    FrameBuffer(FrameBuffer&& other) noexcept;
+    FrameBuffer& operator=(const FrameBuffer& other) noexcept;
+    FrameBuffer& operator=(FrameBuffer&& other) noexcept;
+    ~FrameBuffer();
+
+    [[nodiscard]] u8* Data() const noexcept { return mSlot ? mSlot->data.data() : nullptr; }
+    [[nodiscard]] std::size_t Size() const noexcept { return mSize; }
+    [[nodiscard]] explicit operator bool() const noexcept { return mSlot != nullptr; }
+
+    // Leases sharing this buffer, this one included
+    [[nodiscard]] u32 UseCount() const noexcept { return mSlot ? mSlot->refs.load(std::memory_order_relaxed) : 0; }
+
+    void Reset() noexcept;
+
+private:
+    friend class FramePool;
+    FrameBuffer(ref<FramePool> pool, detail::FrameSlot* slot, std::size_t size) noexcept;
+
+    ref<FramePool> mPool;
+    detail::FrameSlot* mSlot{nullptr};
+    std::size_t mSize{0};
+};
+
+// Fixed set of preallocated buffers handed out as FrameBuffer leases. Buffers are zeroed
+// when allocated, so their pages are mapped before the first frame lands in them; in
+// steady state acquiring and releasing never touches the allocator.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+    // Only Create can name this, so every pool is owned by a ref (Acquire needs shared_from_this)
+    struct Passkey {
+        explicit Passkey() = default;
+    };
+
+public:
+    [[nodiscard]] static ref<FramePool> Create(std::size_t bytes, u32 capacity);
+
+    // A free buffer of at least `bytes`. When every buffer is leased the pool grows by one
+    // rather than stalling the caller; a buffer smaller than `bytes` is regrown in place.
+    [[nodiscard]] FrameBuffer Acquire(std::size_t bytes);
+
+    [[nodiscard]] u32 Capacity() const;
+    [[nodiscard]] u32 Available() const;
+
+    FramePool(Passkey, std::size_t bytes, u32 capacity);
+
+private:
+    friend class FrameBuffer;
+    void Release(detail::FrameSlot* slot) noexcept;
+
+    mutable std::mutex mMutex;
+    std::vector<scope<detail::FrameSlot>> mSlots;
+    std::vector<detail::FrameSlot*> mFree;
+};
+
+} // namespace ct::vision
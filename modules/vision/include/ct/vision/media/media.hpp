@@ -1,20 +1,80 @@
 #pragma once
 
+#include "ct/base/errors/result.hpp"
+#include "ct/base/types/types.hpp"
+#include "ct/vision/media/frame.hpp"
+#include "ct/vision/media/media_index.hpp"
+
 #include <filesystem>
+#include <optional>
 
 namespace ct::vision {
 
+struct MediaSettings {
+    u32 prefetch{4}; // Decoded frames buffered ahead of the consumer (look-ahead)
+    u32 inFlight{4}; // Frames the consumer may hold at once before the frame pool grows
+    bool index{true}; // Load or build the seek index in the background on open, not on first Seek
+    u32 decoders{0}; // Image sequences: files decoded at once, 0 for one per core (at most prefetch)
+    double sequenceFps{30.0}; // Image sequences: frame rate for timestamps, files carry none
+};
 
+struct MediaInfo {
+    u32 width{0};
+    u32 height{0};
+    double fps{0.0};
+    u64 frameCount{0}; // 0 when the container does not report it
+};
 
+// Frame source that decodes ahead on a background thread into a bounded ring of
+// MediaSettings::prefetch frames, so decoding overlaps with processing. The decoder
+// blocks while the ring is full; destroying the Media stops and joins it. Frames are
+// decoded straight into buffers leased from a FramePool sized for prefetch + inFlight
+// frames, so a consumer that drops its frames in time never causes an allocation.
+//
+// Open takes a video file or a directory of images; an image sequence is decoded by
+// several threads at once and reordered, with the same prefetch window.
+//
+// Seeking goes through a MediaIndex of every frame's timestamp and the keyframes. It is
+// built once by scanning the container's packets, without decoding, and cached in a
+// sidecar next to the media (MediaIndex::SidecarPath); later opens load it instead.
 class Media {
 public:
-    Media(std::filesystem::path path);
+    virtual ~Media() = default;
+
+    Media(const Media&) = delete;
+    Media& operator=(const Media&) = delete;
+
+    // Next frame in stream order, waiting for the decoder if none is buffered. After the
+    // last frame every call returns ErrorCode::FILE_EOF; decode failures return
+    // ErrorCode::FILE_READ_ERROR once the frames decoded before them are consumed.
+    [[nodiscard]] virtual result<Frame> Next() = 0;
+
+    // Like Next, but returns std::nullopt instead of waiting when no frame is buffered yet
+    [[nodiscard]] virtual result<std::optional<Frame>> TryNext() = 0;
+
+    // Discards buffered frames and restarts decoding at the keyframe before `frame`, so
+    // the next frame returned is `frame`. Fails with ErrorCode::VALIDATION_OUT_OF_RANGE
+    // past the last frame; other failures are also what Next returns afterwards.
+    [[nodiscard]] virtual result<void> Seek(u64 frame) = 0;
 
+    // Waits for the index if it is still being built (or builds it now). Streams and URLs
+    // have none: Index and Seek fail with ErrorCode::VALIDATION_INVALID_STATE.
+    [[nodiscard]] virtual result<ref<const MediaIndex>> Index() = 0;
+
+    [[nodiscard]] virtual const MediaInfo& Info() const noexcept = 0;
+
+    [[nodiscard]] const std::filesystem::path& Path() const noexcept { return mPath; }
+
+    // A video file, a URL or stream OpenCV can open, or a directory of images.
+    // ErrorCode::FILE_NOT_FOUND when the path is neither a local file nor openable.
+    [[nodiscard]] static result<ref<Media>> Open(const std::filesystem::path& path,
+                                                 const MediaSettings& settings = {});
+
+protected:
+    explicit Media(std::filesystem::path path);
 
 private:
     std::filesystem::path mPath;
 };
 
-
-
-}
+} // namespace ct::vision
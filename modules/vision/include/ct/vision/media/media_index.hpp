@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ct/base/errors/result.hpp"
+#include "ct/base/types/types.hpp"
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace ct::vision {
+
+// Presentation timestamp of every frame plus the frames a decoder can start from. Built
+// once per media file and persisted next to it, so reopening seeks without a re-scan.
+class MediaIndex {
+public:
+    MediaIndex() = default;
+
+    // Appends the next packet in decode order; Finalize puts them in presentation order
+    void Add(double timestamp, bool keyframe);
+    void Finalize();
+
+    [[nodiscard]] u64 FrameCount() const noexcept { return mTimestamps.size(); }
+    [[nodiscard]] std::span<const double> Timestamps() const noexcept { return mTimestamps; }
+    [[nodiscard]] std::span<const u64> Keyframes() const noexcept { return mKeyframes; }
+
+    // Last keyframe at or before frame; 0 when the stream reported none
+    [[nodiscard]] u64 KeyframeBefore(u64 frame) const noexcept;
+
+    // Frame whose timestamp is closest to seconds (as reported for a decoded frame)
+    [[nodiscard]] u64 FrameAt(double seconds) const noexcept;
+
+    // `<media>.ctindex`, next to the media file
+    [[nodiscard]] static std::filesystem::path SidecarPath(const std::filesystem::path& media);
+
+    // The sidecar records the size and modification time of the media it indexes; a
+    // sidecar for a different or modified file fails with PARSE_INVALID_FORMAT
+    [[nodiscard]] static result<MediaIndex> Load(const std::filesystem::path& media);
+    [[nodiscard]] result<void> Save(const std::filesystem::path& media) const;
+
+private:
+    std::vector<double> mTimestamps;
+    std::vector<u64> mKeyframes;
+};
+
+} // namespace ct::vision
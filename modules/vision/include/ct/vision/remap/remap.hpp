@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ct/base/types/types.hpp"
+#include "ct/vision/camera/camera.hpp"
+#include "ct/vision/image/image.hpp"
+
+#include <span>
+#include <vector>
+
+namespace ct::vision {
+
+// Sub-pixel resolution of remap tables: source positions are stored in 1 / 2^kRemapBits
+// pixel steps, so bilinear weights are exact integers summing to 2^(2 kRemapBits)
+inline constexpr u32 kRemapBits = 5;
+
+// Tables kept by RemapTable::Undistort / Rectify, least recently used evicted first
+inline constexpr std::size_t kRemapCacheSize = 8;
+
+// Per-pixel source positions for a fixed camera model, built once and applied to every
+// frame with Remap. Each output pixel stores the integer top-left of its 2 x 2 source
+// footprint as int16 (x, y) plus the packed fractions (fy << kRemapBits | fx): 6 bytes
+// a pixel, so remapping is a gather bound by memory bandwidth.
+class RemapTable {
+public:
+    // Output pixels with intrinsics newIntrinsics looking along rotation (the rectifying
+    // rotation from the camera frame), sampled from the distorted camera image. Tables are
+    // cached on a hash of every parameter, so calling this per frame is cheap.
+    [[nodiscard]] static ref<const RemapTable> Rectify(const Camera& camera, const mat3f& rotation,
+                                                       const mat3f& newIntrinsics, u32 width, u32 height);
+
+    // Rectify with no rotation and the camera's own intrinsics: removes lens distortion
+    [[nodiscard]] static ref<const RemapTable> Undistort(const Camera& camera, u32 width, u32 height);
+
+    static void ClearCache();
+
+    [[nodiscard]] u32 Width() const noexcept { return mWidth; }
+    [[nodiscard]] u32 Height() const noexcept { return mHeight; }
+
+    // 2 * width * height values, (x, y) per pixel in row-major order
+    [[nodiscard]] std::span<const i16> Coordinates() const noexcept { return mCoordinates; }
+    [[nodiscard]] std::span<const u16> Fractions() const noexcept { return mFractions; }
+
+private:
+    RemapTable(u32 width, u32 height);
+
+    [[nodiscard]] static ref<const RemapTable> Build(const Camera& camera, const mat3f& rotation,
+                                                     const mat3f& newIntrinsics, u32 width, u32 height);
+
+    u32 mWidth;
+    u32 mHeight;
+    std::vector<i16> mCoordinates;
+    std::vector<u16> mFractions;
+};
+
+// dst(x, y) = bilinear sample of src at the table position, in 8-bit fixed point. dst must
+// be table-sized with the channel count of src. Sources past the image border read as 0;
+// footprints straddling the border blend with the edge pixels. Rows run across the thread
+// pool, and the weights and blends of each block of pixels run in SIMD lanes.
+void Remap(ImageView<const u8> src, ImageView<u8> dst, const RemapTable& table);
+
+} // namespace ct::vision
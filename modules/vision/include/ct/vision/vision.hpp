@@ -3,6 +3,8 @@
 
 // IWYU pragma: begin_exports
 #include "camera/camera.hpp"
+#include "image/image.hpp"
+#include "remap/remap.hpp"
 #include "media/media.hpp"
 
 // IWYU pragma: end_exports
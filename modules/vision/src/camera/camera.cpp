@@ -1,4 +1,259 @@
+#include "ct/vision/camera/camera.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
 namespace ct::vision {
 
+namespace {
+
+constexpr std::size_t kLanes = simd_lanes<float>;
+using Lanes = pack<float, kLanes>;
+
+//NOTE: Points per thread-pool task; smaller inputs stay on the calling thread
+constexpr std::size_t kParallelGrain = 16 * 1024;
+
+static_assert(sizeof(vec2f) == 2 * sizeof(float) && sizeof(vec3f) == 3 * sizeof(float));
+
+// Intrinsics and distortion unpacked once per call
+struct Lens {
+    float fx, fy, cx, cy, skew;
+    float k1, k2, p1, p2, k3;
+    bool distorted;
+
+    explicit Lens(const Camera& camera) noexcept
+        : fx(camera.intrinsics(0, 0)), fy(camera.intrinsics(1, 1)),
+          cx(camera.intrinsics(0, 2)), cy(camera.intrinsics(1, 2)), skew(camera.intrinsics(0, 1)),
+          k1(camera.distortion[0]), k2(camera.distortion[1]),
+          p1(camera.distortion[2]), p2(camera.distortion[3]), k3(camera.distortion[4]),
+          distorted(k1 != 0.0f || k2 != 0.0f || p1 != 0.0f || p2 != 0.0f || k3 != 0.0f) {}
+};
+
+// The kernels below take float or Lanes, so the single-point and batched paths share one
+// formula
+
+template<typename V>
+CT_FORCE_INLINE void DistortLanes(const Lens& l, V& x, V& y) noexcept {
+    const V xx = x * x;
+    const V yy = y * y;
+    const V xy = x * y;
+    const V r2 = xx + yy;
+    const V radial = 1.0f + r2 * (l.k1 + r2 * (l.k2 + r2 * l.k3));
+    const V dx = 2.0f * l.p1 * xy + l.p2 * (r2 + 2.0f * xx);
+    const V dy = l.p1 * (r2 + 2.0f * yy) + 2.0f * l.p2 * xy;
+    x = x * radial + dx;
+    y = y * radial + dy;
+}
+
+//NOTE: Newton on distort(x, y) = (xd, yd) from (xd, yd). The Jacobian of Brown-Conrady is
+//      symmetric, so the 2x2 solve is a few multiplies. Lanes where its determinant is not
+//      positive (at or past the fold of a strong barrel lens) keep their current estimate
+template<typename V>
+CT_FORCE_INLINE void UndistortLanes(const Lens& l, V& x, V& y, u32 iterations) noexcept {
+    const V xd = x;
+    const V yd = y;
+    for (u32 it = 0; it < iterations; ++it) {
+        const V xx = x * x;
+        const V yy = y * y;
+        const V xy = x * y;
+        const V r2 = xx + yy;
+        const V radial = 1.0f + r2 * (l.k1 + r2 * (l.k2 + r2 * l.k3));
+        const V radial_r2 = l.k1 + r2 * (2.0f * l.k2 + r2 * (3.0f * l.k3));
+        const V ex = x * radial + 2.0f * l.p1 * xy + l.p2 * (r2 + 2.0f * xx) - xd;
+        const V ey = y * radial + l.p1 * (r2 + 2.0f * yy) + 2.0f * l.p2 * xy - yd;
+        const V jxx = radial + 2.0f * xx * radial_r2 + 2.0f * l.p1 * y + 6.0f * l.p2 * x;
+        const V jyy = radial + 2.0f * yy * radial_r2 + 6.0f * l.p1 * y + 2.0f * l.p2 * x;
+        const V jxy = 2.0f * xy * radial_r2 + 2.0f * l.p1 * x + 2.0f * l.p2 * y;
+        const V det = jxx * jyy - jxy * jxy;
+        const auto regular = det > 1e-6f;
+        const V inv_det = 1.0f / select(regular, det, splat<V>(1.0f));
+        x = select(regular, x - (jyy * ex - jxy * ey) * inv_det, x);
+        y = select(regular, y - (jxx * ey - jxy * ex) * inv_det, y);
+    }
+}
+
+template<typename V>
+CT_FORCE_INLINE void ProjectLanes(const Lens& l, const mat4f& e, const V& px, const V& py, const V& pz,
+                                  V& u, V& v) noexcept {
+    const V x = e(0, 0) * px + e(0, 1) * py + e(0, 2) * pz + e(0, 3);
+    const V y = e(1, 0) * px + e(1, 1) * py + e(1, 2) * pz + e(1, 3);
+    const V z = e(2, 0) * px + e(2, 1) * py + e(2, 2) * pz + e(2, 3);
+    const auto front = z > 0.0f;
+    const V inv_z = 1.0f / select(front, z, splat<V>(1.0f));
+    V nx = x * inv_z;
+    V ny = y * inv_z;
+    if (l.distorted) DistortLanes(l, nx, ny);
+    const V nan = splat<V>(std::numeric_limits<float>::quiet_NaN());
+    u = select(front, l.fx * nx + l.skew * ny + l.cx, nan);
+    v = select(front, l.fy * ny + l.cy, nan);
+}
+
+template<typename V>
+CT_FORCE_INLINE void UnprojectLanes(const Lens& l, const mat4f& inv_e, const V& u, const V& v, const V& depth,
+                                    V& px, V& py, V& pz, u32 iterations) noexcept {
+    V y = (v - l.cy) * (1.0f / l.fy);
+    V x = (u - l.cx - l.skew * y) * (1.0f / l.fx);
+    if (l.distorted) UndistortLanes(l, x, y, iterations);
+    const V cx = x * depth;
+    const V cy = y * depth;
+    px = inv_e(0, 0) * cx + inv_e(0, 1) * cy + inv_e(0, 2) * depth + inv_e(0, 3);
+    py = inv_e(1, 0) * cx + inv_e(1, 1) * cy + inv_e(1, 2) * depth + inv_e(1, 3);
+    pz = inv_e(2, 0) * cx + inv_e(2, 1) * cy + inv_e(2, 2) * depth + inv_e(2, 3);
+}
+
+// Runs fn(first, count) over blocks of at most kLanes points, in parallel for large n
+template<typename Fn>
+void ForBlocks(std::size_t n, Fn&& fn) {
+    const std::size_t grain = (parallel_grain(n, kParallelGrain) + kLanes - 1) / kLanes * kLanes;
+    parallel_for(0, n, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i += kLanes) fn(i, std::min(kLanes, end - i));
+    });
+}
+
+// Block loads and stores transpose AoS points to one pack per coordinate; partial blocks
+// go through a padded copy
+
+void LoadBlock(const vec2f* src, std::size_t count, Lanes& x, Lanes& y) noexcept {
+    vec2f pad[kLanes];
+    if (count < kLanes) {
+        for (std::size_t l = 0; l < kLanes; ++l) pad[l] = l < count ? src[l] : vec2f(0.0f, 0.0f);
+        src = pad;
+    }
+    const float* p = reinterpret_cast<const float*>(src);
+    unzip(Lanes::load(p), Lanes::load(p + kLanes), x, y);
+}
+
+void LoadBlock(const vec3f* src, std::size_t count, Lanes& x, Lanes& y, Lanes& z) noexcept {
+    vec3f pad[kLanes];
+    if (count < kLanes) {
+        for (std::size_t l = 0; l < kLanes; ++l) pad[l] = l < count ? src[l] : vec3f(0.0f, 0.0f, 1.0f);
+        src = pad;
+    }
+    load_interleaved(reinterpret_cast<const float*>(src), x, y, z);
+}
 
+void LoadBlock(const float* src, std::size_t count, Lanes& x) noexcept {
+    float pad[kLanes] = {};
+    if (count < kLanes) {
+        std::copy_n(src, count, pad);
+        src = pad;
+    }
+    x = Lanes::load(src);
 }
+
+void StoreBlock(vec2f* dst, std::size_t count, const Lanes& x, const Lanes& y) noexcept {
+    float tmp[2 * kLanes];
+    float* p = count == kLanes ? reinterpret_cast<float*>(dst) : tmp;
+    if constexpr (kLanes == 1) {
+        x.store(p);
+        y.store(p + 1);
+    } else {
+        detail::permute2<detail::pick_zip<kLanes, 0>>(x, y).store(p);
+        detail::permute2<detail::pick_zip<kLanes, 1>>(x, y).store(p + kLanes);
+    }
+    if (p == tmp) std::copy_n(reinterpret_cast<const vec2f*>(tmp), count, dst);
+}
+
+void StoreBlock(vec3f* dst, std::size_t count, const Lanes& x, const Lanes& y, const Lanes& z) noexcept {
+    float tmp[3 * kLanes];
+    float* p = count == kLanes ? reinterpret_cast<float*>(dst) : tmp;
+    store_interleaved(p, x, y, z);
+    if (p == tmp) std::copy_n(reinterpret_cast<const vec3f*>(tmp), count, dst);
+}
+
+mat4f WorldFromCamera(const mat4f& extrinsics) noexcept {
+    return affine3f(extrinsics).inverse().matrix();
+}
+
+} // namespace
+
+vec2f Camera::Distort(const vec2f& normalized) const noexcept {
+    float x = normalized.x;
+    float y = normalized.y;
+    DistortLanes(Lens(*this), x, y);
+    return vec2f(x, y);
+}
+
+void Camera::Distort(std::span<const vec2f> normalized, std::span<vec2f> out) const {
+    assert(out.size() >= normalized.size());
+    const Lens lens(*this);
+    ForBlocks(normalized.size(), [&](std::size_t i, std::size_t count) {
+        Lanes x;
+        Lanes y;
+        LoadBlock(normalized.data() + i, count, x, y);
+        DistortLanes(lens, x, y);
+        StoreBlock(out.data() + i, count, x, y);
+    });
+}
+
+vec2f Camera::Undistort(const vec2f& distorted, u32 iterations) const noexcept {
+    float x = distorted.x;
+    float y = distorted.y;
+    UndistortLanes(Lens(*this), x, y, iterations);
+    return vec2f(x, y);
+}
+
+void Camera::Undistort(std::span<const vec2f> distorted, std::span<vec2f> out, u32 iterations) const {
+    assert(out.size() >= distorted.size());
+    const Lens lens(*this);
+    ForBlocks(distorted.size(), [&](std::size_t i, std::size_t count) {
+        Lanes x;
+        Lanes y;
+        LoadBlock(distorted.data() + i, count, x, y);
+        UndistortLanes(lens, x, y, iterations);
+        StoreBlock(out.data() + i, count, x, y);
+    });
+}
+
+vec2f Camera::Project(const vec3f& world) const noexcept {
+    float u;
+    float v;
+    ProjectLanes(Lens(*this), extrinsics, world.x, world.y, world.z, u, v);
+    return vec2f(u, v);
+}
+
+void Camera::Project(std::span<const vec3f> world, std::span<vec2f> pixels) const {
+    assert(pixels.size() >= world.size());
+    const Lens lens(*this);
+    ForBlocks(world.size(), [&](std::size_t i, std::size_t count) {
+        Lanes x;
+        Lanes y;
+        Lanes z;
+        LoadBlock(world.data() + i, count, x, y, z);
+        Lanes u;
+        Lanes v;
+        ProjectLanes(lens, extrinsics, x, y, z, u, v);
+        StoreBlock(pixels.data() + i, count, u, v);
+    });
+}
+
+vec3f Camera::Unproject(const vec2f& pixel, float depth, u32 iterations) const noexcept {
+    float x;
+    float y;
+    float z;
+    UnprojectLanes(Lens(*this), WorldFromCamera(extrinsics), pixel.x, pixel.y, depth, x, y, z, iterations);
+    return vec3f(x, y, z);
+}
+
+void Camera::Unproject(std::span<const vec2f> pixels, std::span<const float> depth, std::span<vec3f> world,
+                       u32 iterations) const {
+    assert(depth.size() == pixels.size() && world.size() >= pixels.size());
+    const Lens lens(*this);
+    const mat4f inv_e = WorldFromCamera(extrinsics);
+    ForBlocks(pixels.size(), [&](std::size_t i, std::size_t count) {
+        Lanes u;
+        Lanes v;
+        Lanes d;
+        LoadBlock(pixels.data() + i, count, u, v);
+        LoadBlock(depth.data() + i, count, d);
+        Lanes x;
+        Lanes y;
+        Lanes z;
+        UnprojectLanes(lens, inv_e, u, v, d, x, y, z, iterations);
+        StoreBlock(world.data() + i, count, x, y, z);
+    });
+}
+
+} // namespace ct::vision
@@ -0,0 +1,100 @@
+#include "ct/vision/media/frame_pool.hpp"
+
+#include <utility>
+
+namespace ct::vision {
+
+FrameBuffer::FrameBuffer(ref<FramePool> pool, detail::FrameSlot* slot, std::size_t size) noexcept
+    : mPool(std::move(pool)), mSlot(slot), mSize(size) {
+    mSlot->refs.store(1, std::memory_order_relaxed);
+}
+
+FrameBuffer::FrameBuffer(const FrameBuffer& other) noexcept
+    : mPool(other.mPool), mSlot(other.mSlot), mSize(other.mSize) {
+    if (mSlot) mSlot->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameBuffer::FrameBuffer(FrameBuffer&& other) noexcept
+    : mPool(std::move(other.mPool)), mSlot(std::exchange(other.mSlot, nullptr)),
+      mSize(std::exchange(other.mSize, 0)) {}
+
+FrameBuffer& FrameBuffer::operator=(const FrameBuffer& other) noexcept {
+    if (this != &other) {
+        FrameBuffer copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other) noexcept {
+    if (this != &other) {
+        Reset();
+        mPool = std::move(other.mPool);
+        mSlot = std::exchange(other.mSlot, nullptr);
+        mSize = std::exchange(other.mSize, 0);
+    }
+    return *this;
+}
+
+FrameBuffer::~FrameBuffer() {
+    Reset();
+}
+
+void FrameBuffer::Reset() noexcept {
+    if (mSlot && mSlot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        mPool->Release(mSlot);
+    }
+    mSlot = nullptr;
+    mSize = 0;
+    mPool.reset();
+}
+
+FramePool::FramePool(Passkey, std::size_t bytes, u32 capacity) {
+    mSlots.reserve(capacity);
+    mFree.reserve(capacity);
+    for (u32 i = 0; i < capacity; ++i) {
+        auto slot = createScope<detail::FrameSlot>();
+        slot->data.resize(bytes);
+        mFree.push_back(slot.get());
+        mSlots.push_back(std::move(slot));
+    }
+}
+
+ref<FramePool> FramePool::Create(std::size_t bytes, u32 capacity) {
+    return createRef<FramePool>(Passkey{}, bytes, capacity);
+}
+
+FrameBuffer FramePool::Acquire(std::size_t bytes) {
+    detail::FrameSlot* slot = nullptr;
+    {
+        std::lock_guard lock(mMutex);
+        if (mFree.empty()) {
+            //NOTE: Only reached when the consumer holds more frames than the pool was sized for
+            mSlots.push_back(createScope<detail::FrameSlot>());
+            mFree.reserve(mSlots.size());
+            slot = mSlots.back().get();
+        } else {
+            slot = mFree.back();
+            mFree.pop_back();
+        }
+    }
+    if (slot->data.size() < bytes) slot->data.resize(bytes);
+    return FrameBuffer(shared_from_this(), slot, bytes);
+}
+
+void FramePool::Release(detail::FrameSlot* slot) noexcept {
+    std::lock_guard lock(mMutex);
+    mFree.push_back(slot); // capacity reserved for every slot, so this never allocates
+}
+
+u32 FramePool::Capacity() const {
+    std::lock_guard lock(mMutex);
+    return static_cast<u32>(mSlots.size());
+}
+
+u32 FramePool::Available() const {
+    std::lock_guard lock(mMutex);
+    return static_cast<u32>(mFree.size());
+}
+
+} // namespace ct::vision
@@ -0,0 +1,86 @@
+#include "media/frame_queue.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ct::vision {
+
+FrameQueue::FrameQueue(std::size_t capacity)
+    : mSlots(std::max<std::size_t>(capacity, 1)) {}
+
+bool FrameQueue::Push(Frame&& frame) {
+    {
+        std::unique_lock lock(mMutex);
+        mNotFull.wait(lock, [&] { return mClosed || mCount < mSlots.size(); });
+        if (mClosed) return false;
+        mSlots[(mHead + mCount) % mSlots.size()] = std::move(frame);
+        ++mCount;
+    }
+    mNotEmpty.notify_one();
+    return true;
+}
+
+void FrameQueue::Finish(Error error) {
+    {
+        std::lock_guard lock(mMutex);
+        if (!mEnd) mEnd = std::move(error);
+    }
+    mNotEmpty.notify_all();
+}
+
+void FrameQueue::Close() {
+    {
+        std::lock_guard lock(mMutex);
+        mClosed = true;
+    }
+    mNotFull.notify_all();
+    mNotEmpty.notify_all();
+}
+
+void FrameQueue::Reset() {
+    std::lock_guard lock(mMutex);
+    for (Frame& slot : mSlots) slot = Frame{};
+    mHead = 0;
+    mCount = 0;
+    mEnd.reset();
+    mClosed = false;
+}
+
+Frame FrameQueue::Take() {
+    Frame frame = std::move(mSlots[mHead]);
+    mHead = (mHead + 1) % mSlots.size();
+    --mCount;
+    return frame;
+}
+
+result<Frame> FrameQueue::Pop() {
+    Frame frame;
+    {
+        std::unique_lock lock(mMutex);
+        mNotEmpty.wait(lock, [&] { return mCount > 0 || mEnd || mClosed; });
+        if (mCount == 0) {
+            if (mEnd) return err(*mEnd);
+            return err(ErrorCode::VALIDATION_INVALID_STATE, "media is closed");
+        }
+        frame = Take();
+    }
+    mNotFull.notify_one();
+    return frame;
+}
+
+result<std::optional<Frame>> FrameQueue::TryPop() {
+    Frame frame;
+    {
+        std::lock_guard lock(mMutex);
+        if (mCount == 0) {
+            if (mEnd) return err(*mEnd);
+            if (mClosed) return err(ErrorCode::VALIDATION_INVALID_STATE, "media is closed");
+            return std::optional<Frame>();
+        }
+        frame = Take();
+    }
+    mNotFull.notify_one();
+    return std::optional<Frame>(std::move(frame));
+}
+
+} // namespace ct::vision
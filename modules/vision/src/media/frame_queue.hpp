@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ct/base/errors/result.hpp"
+#include "ct/vision/media/frame.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace ct::vision {
+
+// Bounded single-producer / single-consumer ring of decoded frames. The producer ends the
+// stream with Finish(error); the consumer sees that error once the ring is drained.
+class FrameQueue {
+public:
+    explicit FrameQueue(std::size_t capacity);
+
+    // Blocks while the ring is full; false once the queue is closed
+    bool Push(Frame&& frame);
+
+    // No more frames: consumers get `error` after the buffered ones
+    void Finish(Error error);
+
+    // Wakes both sides for shutdown; later pushes are dropped and pops fail
+    void Close();
+
+    // Drops buffered frames and any end or close state, for a restarted producer
+    void Reset();
+
+    [[nodiscard]] result<Frame> Pop();
+    [[nodiscard]] result<std::optional<Frame>> TryPop();
+
+private:
+    [[nodiscard]] Frame Take();
+
+    std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mNotEmpty;
+    std::vector<Frame> mSlots;
+    std::size_t mHead{0};
+    std::size_t mCount{0};
+    std::optional<Error> mEnd;
+    bool mClosed{false};
+};
+
+} // namespace ct::vision
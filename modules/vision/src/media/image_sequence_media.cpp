@@ -0,0 +1,197 @@
+#include "media/image_sequence_media.hpp"
+#include "media/mapped_file.hpp"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ct::vision {
+
+namespace {
+
+constexpr std::array<std::string_view, 8> kExtensions{".png", ".jpg", ".jpeg", ".bmp", ".tga", ".pgm", ".ppm", ".pnm"};
+
+bool IsImage(const std::filesystem::path& file) {
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return std::find(kExtensions.begin(), kExtensions.end(), extension) != kExtensions.end();
+}
+
+// Filename order with digit runs compared as numbers, so frame_9 comes before frame_10
+bool NaturalLess(const std::filesystem::path& a, const std::filesystem::path& b) {
+    const std::string x = a.filename().string();
+    const std::string y = b.filename().string();
+    const auto digit = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; };
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < x.size() && j < y.size()) {
+        if (digit(x[i]) && digit(y[j])) {
+            while (i < x.size() && x[i] == '0') ++i;
+            while (j < y.size() && y[j] == '0') ++j;
+            std::size_t ei = i;
+            std::size_t ej = j;
+            while (ei < x.size() && digit(x[ei])) ++ei;
+            while (ej < y.size() && digit(y[ej])) ++ej;
+            if (ei - i != ej - j) return ei - i < ej - j;
+            if (const int c = x.compare(i, ei - i, y, j, ej - j); c != 0) return c < 0;
+            i = ei;
+            j = ej;
+        } else {
+            if (x[i] != y[j]) return x[i] < y[j];
+            ++i;
+            ++j;
+        }
+    }
+    if (x.size() - i != y.size() - j) return x.size() - i < y.size() - j;
+    return x < y;
+}
+
+struct ImageHeader {
+    int width{0};
+    int height{0};
+    int components{0};
+};
+
+result<ImageHeader> ReadHeader(const std::filesystem::path& file, std::span<const u8> bytes) {
+    if (bytes.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        return err(ErrorCode::FILE_READ_ERROR, "image too large: " + file.string());
+    }
+    ImageHeader header;
+    if (!stbi_info_from_memory(bytes.data(), static_cast<int>(bytes.size()), &header.width, &header.height,
+                               &header.components)) {
+        const char* reason = stbi_failure_reason();
+        return err(ErrorCode::FILE_READ_ERROR, file.string() + ": " + (reason ? reason : "unsupported image"));
+    }
+    return header;
+}
+
+//NOTE: Frames keep the channel layout of the video decoders: grey or BGR, without alpha
+u32 FrameChannels(int components) { return components < 3 ? 1u : 3u; }
+
+void SwapRedBlue(const u8* src, u8* dst, u32 width) {
+    for (u32 x = 0; x < width; ++x) {
+        dst[3 * x + 0] = src[3 * x + 2];
+        dst[3 * x + 1] = src[3 * x + 1];
+        dst[3 * x + 2] = src[3 * x + 0];
+    }
+}
+
+} // namespace
+
+ImageSequenceMedia::ImageSequenceMedia(std::filesystem::path directory, std::vector<std::filesystem::path> files,
+                                       const MediaInfo& info, u32 channels, const MediaSettings& settings)
+    : Media(std::move(directory)), mFiles(std::move(files)), mInfo(info), mFrames(settings.prefetch, info.frameCount) {
+    //NOTE: Claimed frames never exceed the window, so window + consumer covers every lease
+    const std::size_t bytes = AlignedRowBytes(std::size_t{mInfo.width} * channels) * mInfo.height;
+    mPool = FramePool::Create(bytes, settings.prefetch + settings.inFlight);
+
+    //NOTE: Every image decodes on its own, so every frame is a keyframe and nothing needs a scan
+    MediaIndex index;
+    for (u64 i = 0; i < mInfo.frameCount; ++i) index.Add(static_cast<double>(i) / mInfo.fps, true);
+    mIndex = createRef<const MediaIndex>(std::move(index));
+
+    u32 decoders = settings.decoders;
+    if (decoders == 0) decoders = std::max(std::thread::hardware_concurrency(), 1u);
+    decoders = std::clamp<u32>(decoders, 1, std::max<u32>(settings.prefetch, 1));
+    mWorkers.reserve(decoders);
+    for (u32 i = 0; i < decoders; ++i) mWorkers.emplace_back([this] { Decode(); });
+}
+
+ImageSequenceMedia::~ImageSequenceMedia() {
+    mFrames.Close();
+    for (auto& worker : mWorkers) worker.join();
+}
+
+result<void> ImageSequenceMedia::Seek(u64 frame) {
+    if (frame >= mInfo.frameCount) {
+        return err(ErrorCode::VALIDATION_OUT_OF_RANGE,
+                   "frame " + std::to_string(frame) + " is past the end of " + Path().string());
+    }
+    mFrames.Reset(frame);
+    return {};
+}
+
+void ImageSequenceMedia::Decode() {
+    while (const auto ticket = mFrames.Claim()) {
+        mFrames.Put(*ticket, Load(ticket->index));
+    }
+}
+
+result<Frame> ImageSequenceMedia::Load(u64 index) const {
+    const auto& file = mFiles[index];
+    auto mapped = MappedFile::Open(file);
+    //NOTE: Next() reports only FILE_EOF or FILE_READ_ERROR; a file gone since Open is a read error
+    if (!mapped) return err(ErrorCode::FILE_READ_ERROR, mapped.error().Message());
+    const auto bytes = mapped->Bytes();
+    auto header = ReadHeader(file, bytes);
+    if (!header) return err(header.error());
+
+    const int channels = static_cast<int>(FrameChannels(header->components));
+    int width = 0;
+    int height = 0;
+    int components = 0;
+    std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels(
+        stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &components, channels),
+        &stbi_image_free);
+    if (!pixels) {
+        const char* reason = stbi_failure_reason();
+        return err(ErrorCode::FILE_READ_ERROR, file.string() + ": " + (reason ? reason : "decode failed"));
+    }
+
+    Frame frame;
+    frame.width = static_cast<u32>(width);
+    frame.height = static_cast<u32>(height);
+    frame.channels = static_cast<u32>(channels);
+    frame.stride = AlignedRowBytes(std::size_t{frame.width} * frame.channels);
+    frame.pixels = mPool->Acquire(frame.stride * frame.height);
+    const std::size_t row = std::size_t{frame.width} * frame.channels;
+    for (u32 y = 0; y < frame.height; ++y) {
+        const u8* src = pixels.get() + y * row;
+        u8* dst = frame.pixels.Data() + y * frame.stride;
+        if (frame.channels == 3) {
+            SwapRedBlue(src, dst, frame.width);
+        } else {
+            std::memcpy(dst, src, row);
+        }
+    }
+    frame.index = index;
+    frame.timestamp = static_cast<double>(index) / mInfo.fps;
+    return frame;
+}
+
+result<ref<Media>> ImageSequenceMedia::Open(const std::filesystem::path& directory, const MediaSettings& settings) {
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(directory, ec); !ec && it != std::filesystem::directory_iterator();
+         it.increment(ec)) {
+        if (it->is_regular_file(ec) && IsImage(it->path())) files.push_back(it->path());
+    }
+    if (ec) return err(ErrorCode::FILE_READ_ERROR, "could not list " + directory.string());
+    if (files.empty()) return err(ErrorCode::FILE_NOT_FOUND, "no images in " + directory.string());
+    std::sort(files.begin(), files.end(), NaturalLess);
+
+    //NOTE: Only the first header is read here; it sets the nominal geometry and pool size
+    auto first = MappedFile::Open(files.front());
+    if (!first) return err(first.error());
+    auto header = ReadHeader(files.front(), first->Bytes());
+    if (!header) return err(header.error());
+
+    MediaInfo info;
+    info.width = static_cast<u32>(header->width);
+    info.height = static_cast<u32>(header->height);
+    info.fps = settings.sequenceFps > 0.0 ? settings.sequenceFps : 30.0;
+    info.frameCount = files.size();
+    const u32 channels = FrameChannels(header->components);
+    return createRef<ImageSequenceMedia>(directory, std::move(files), info, channels, settings);
+}
+
+} // namespace ct::vision
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ct/vision/media/media.hpp"
+#include "media/reorder_buffer.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace ct::vision {
+
+// Directory of still images (PNG, JPEG, BMP, TGA, PNM), one frame per file in natural
+// filename order. Files are memory-mapped and decoded with stb_image by
+// MediaSettings::decoders threads at once, up to MediaSettings::prefetch frames ahead,
+// and handed out in order through a ReorderBuffer.
+class ImageSequenceMedia final : public Media {
+public:
+    ImageSequenceMedia(std::filesystem::path directory, std::vector<std::filesystem::path> files,
+                       const MediaInfo& info, u32 channels, const MediaSettings& settings);
+    ~ImageSequenceMedia() override;
+
+    [[nodiscard]] result<Frame> Next() override { return mFrames.Pop(); }
+    [[nodiscard]] result<std::optional<Frame>> TryNext() override { return mFrames.TryPop(); }
+    [[nodiscard]] result<void> Seek(u64 frame) override;
+    [[nodiscard]] result<ref<const MediaIndex>> Index() override { return mIndex; }
+    [[nodiscard]] const MediaInfo& Info() const noexcept override { return mInfo; }
+
+    [[nodiscard]] static result<ref<Media>> Open(const std::filesystem::path& directory,
+                                                 const MediaSettings& settings);
+
+private:
+    void Decode();
+    [[nodiscard]] result<Frame> Load(u64 index) const;
+
+    std::vector<std::filesystem::path> mFiles;
+    MediaInfo mInfo;
+    ReorderBuffer mFrames;
+    ref<FramePool> mPool;
+    ref<const MediaIndex> mIndex;
+    std::vector<std::thread> mWorkers;
+};
+
+} // namespace ct::vision
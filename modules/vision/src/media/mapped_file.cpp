@@ -0,0 +1,114 @@
+#include "media/mapped_file.hpp"
+
+#include <utility>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ct::vision {
+
+MappedFile::~MappedFile() { Unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mData(std::exchange(other.mData, nullptr)), mSize(std::exchange(other.mSize, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        mData = std::exchange(other.mData, nullptr);
+        mSize = std::exchange(other.mSize, 0);
+    }
+    return *this;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+result<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        const DWORD error = GetLastError();
+        const bool missing = error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND;
+        return err(missing ? ErrorCode::FILE_NOT_FOUND : ErrorCode::FILE_READ_ERROR,
+                   "could not open " + path.string());
+    }
+
+    MappedFile mapped;
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return err(ErrorCode::FILE_READ_ERROR, "could not stat " + path.string());
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return mapped;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) return err(ErrorCode::FILE_READ_ERROR, "could not map " + path.string());
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) return err(ErrorCode::FILE_READ_ERROR, "could not map " + path.string());
+
+    mapped.mData = static_cast<const u8*>(view);
+    mapped.mSize = static_cast<std::size_t>(size.QuadPart);
+    return mapped;
+}
+
+void MappedFile::Unmap() noexcept {
+    if (mData) UnmapViewOfFile(mData);
+    mData = nullptr;
+    mSize = 0;
+}
+
+#else
+
+result<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        const bool missing = errno == ENOENT;
+        return err(missing ? ErrorCode::FILE_NOT_FOUND : ErrorCode::FILE_READ_ERROR,
+                   "could not open " + path.string());
+    }
+
+    MappedFile mapped;
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return err(ErrorCode::FILE_READ_ERROR, "could not stat " + path.string());
+    }
+    //NOTE: mmap rejects empty mappings; an empty file maps to an empty span
+    if (info.st_size == 0) {
+        ::close(fd);
+        return mapped;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return err(ErrorCode::FILE_READ_ERROR, "could not map " + path.string());
+    //NOTE: The whole file is about to be decoded; start reading it in now
+    ::madvise(view, size, MADV_WILLNEED);
+
+    mapped.mData = static_cast<const u8*>(view);
+    mapped.mSize = size;
+    return mapped;
+}
+
+void MappedFile::Unmap() noexcept {
+    if (mData) ::munmap(const_cast<u8*>(mData), mSize);
+    mData = nullptr;
+    mSize = 0;
+}
+
+#endif
+
+} // namespace ct::vision
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ct/base/errors/result.hpp"
+#include "ct/base/types/types.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace ct::vision {
+
+// Read-only memory mapping of a whole file; decoders read it in place without a copy
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] std::span<const u8> Bytes() const noexcept { return {mData, mSize}; }
+
+    // ErrorCode::FILE_NOT_FOUND only when the file does not exist; any other failure to
+    // open or map it is ErrorCode::FILE_READ_ERROR
+    [[nodiscard]] static result<MappedFile> Open(const std::filesystem::path& path);
+
+private:
+    void Unmap() noexcept;
+
+    const u8* mData{nullptr};
+    std::size_t mSize{0};
+};
+
+} // namespace ct::vision
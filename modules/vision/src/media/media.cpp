@@ -1,14 +1,32 @@
 #include "ct/vision/media/media.hpp"
+#include "media/image_sequence_media.hpp"
+#include "media/video_media.hpp"
+
+#include <string>
+#include <system_error>
+#include <utility>
 
 namespace ct::vision {
 
 
 Media::Media(std::filesystem::path path)
-: mPath(path){
+: mPath(std::move(path)){
 
 }
 
-
+result<ref<Media>> Media::Open(const std::filesystem::path& path, const MediaSettings& settings) {
+    std::error_code ec;
+    const bool local = std::filesystem::exists(path, ec);
+    if (local && std::filesystem::is_directory(path, ec)) return ImageSequenceMedia::Open(path, settings);
+
+    //NOTE: Paths that are not local files go to OpenCV as they are, so URLs and streams open too
+    cv::VideoCapture capture(path.string());
+    if (!capture.isOpened()) {
+        if (!local) return err(ErrorCode::FILE_NOT_FOUND, "media not found: " + path.string());
+        return err(ErrorCode::FILE_READ_ERROR, "could not open media: " + path.string());
+    }
+    return createRef<VideoMedia>(path, std::move(capture), settings);
+}
 
 
 }
@@ -0,0 +1,170 @@
+#include "ct/vision/media/media_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <system_error>
+
+namespace ct::vision {
+
+namespace {
+
+constexpr std::array<char, 8> kMagic{'C', 'T', 'I', 'N', 'D', 'E', 'X', '\0'};
+constexpr u32 kVersion = 1;
+
+// Identity of the indexed file; a sidecar is stale once either changes
+struct Stamp {
+    u64 size{0};
+    i64 modified{0};
+};
+
+result<Stamp> StampOf(const std::filesystem::path& media) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(media, ec);
+    if (ec) return err(ErrorCode::FILE_READ_ERROR, "could not stat media: " + media.string());
+    const auto modified = std::filesystem::last_write_time(media, ec);
+    if (ec) return err(ErrorCode::FILE_READ_ERROR, "could not stat media: " + media.string());
+    return Stamp{static_cast<u64>(size),
+                 static_cast<i64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      modified.time_since_epoch())
+                                      .count())};
+}
+
+template<typename T>
+void Write(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool Read(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+void MediaIndex::Add(double timestamp, bool keyframe) {
+    if (keyframe) mKeyframes.push_back(mTimestamps.size());
+    mTimestamps.push_back(timestamp);
+}
+
+void MediaIndex::Finalize() {
+    //NOTE: With B-frames, packets arrive out of presentation order; frame n of the decoded
+    //      stream is the packet with the n-th smallest timestamp
+    std::vector<u64> order(mTimestamps.size());
+    std::iota(order.begin(), order.end(), u64{0});
+    std::stable_sort(order.begin(), order.end(), [&](u64 a, u64 b) { return mTimestamps[a] < mTimestamps[b]; });
+    std::vector<u64> rank(order.size());
+    std::vector<double> sorted(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        rank[order[i]] = i;
+        sorted[i] = mTimestamps[order[i]];
+    }
+    for (u64& key : mKeyframes) key = rank[key];
+    std::sort(mKeyframes.begin(), mKeyframes.end());
+    mTimestamps = std::move(sorted);
+}
+
+u64 MediaIndex::KeyframeBefore(u64 frame) const noexcept {
+    const auto it = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), frame);
+    return it == mKeyframes.begin() ? 0 : *std::prev(it);
+}
+
+u64 MediaIndex::FrameAt(double seconds) const noexcept {
+    if (mTimestamps.empty()) return 0;
+    const auto it = std::lower_bound(mTimestamps.begin(), mTimestamps.end(), seconds);
+    if (it == mTimestamps.begin()) return 0;
+    if (it == mTimestamps.end()) return mTimestamps.size() - 1;
+    const auto before = std::prev(it);
+    const auto nearest = (*it - seconds) < (seconds - *before) ? it : before;
+    return static_cast<u64>(nearest - mTimestamps.begin());
+}
+
+std::filesystem::path MediaIndex::SidecarPath(const std::filesystem::path& media) {
+    std::filesystem::path sidecar = media;
+    sidecar += ".ctindex";
+    return sidecar;
+}
+
+result<MediaIndex> MediaIndex::Load(const std::filesystem::path& media) {
+    auto stamp = StampOf(media);
+    if (!stamp) return err(stamp.error());
+
+    const auto sidecar = SidecarPath(media);
+    std::ifstream in(sidecar, std::ios::binary);
+    if (!in) return err(ErrorCode::FILE_NOT_FOUND, "no media index: " + sidecar.string());
+
+    std::array<char, 8> magic{};
+    u32 version = 0;
+    Stamp recorded;
+    u64 frames = 0;
+    u64 keyframes = 0;
+    if (!Read(in, magic) || magic != kMagic || !Read(in, version) || version != kVersion) {
+        return err(ErrorCode::PARSE_INVALID_FORMAT, "not a media index: " + sidecar.string());
+    }
+    if (!Read(in, recorded.size) || !Read(in, recorded.modified) || !Read(in, frames) || !Read(in, keyframes)) {
+        return err(ErrorCode::PARSE_INVALID_FORMAT, "truncated media index: " + sidecar.string());
+    }
+    if (recorded.size != stamp->size || recorded.modified != stamp->modified) {
+        return err(ErrorCode::PARSE_INVALID_FORMAT, "stale media index: " + sidecar.string());
+    }
+
+    //NOTE: Check the counts against the file before trusting them with an allocation
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(sidecar, ec);
+    const u64 header = sizeof(kMagic) + sizeof(version) + sizeof(Stamp) + 2 * sizeof(u64);
+    if (ec || keyframes > frames || frames > (bytes - header) / sizeof(double) ||
+        bytes != header + frames * sizeof(double) + keyframes * sizeof(u64)) {
+        return err(ErrorCode::PARSE_INVALID_FORMAT, "corrupt media index: " + sidecar.string());
+    }
+
+    MediaIndex index;
+    index.mTimestamps.resize(frames);
+    index.mKeyframes.resize(keyframes);
+    in.read(reinterpret_cast<char*>(index.mTimestamps.data()), static_cast<std::streamsize>(frames * sizeof(double)));
+    in.read(reinterpret_cast<char*>(index.mKeyframes.data()), static_cast<std::streamsize>(keyframes * sizeof(u64)));
+    if (!in || !std::is_sorted(index.mKeyframes.begin(), index.mKeyframes.end()) ||
+        (keyframes > 0 && index.mKeyframes.back() >= frames)) {
+        return err(ErrorCode::PARSE_INVALID_FORMAT, "corrupt media index: " + sidecar.string());
+    }
+    return index;
+}
+
+result<void> MediaIndex::Save(const std::filesystem::path& media) const {
+    auto stamp = StampOf(media);
+    if (!stamp) return err(stamp.error());
+
+    //NOTE: Written beside the sidecar and renamed over it, so a reader never sees half a file
+    const auto sidecar = SidecarPath(media);
+    auto partial = sidecar;
+    partial += ".partial";
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (!out) return err(ErrorCode::FILE_WRITE_ERROR, "could not write media index: " + partial.string());
+        Write(out, kMagic);
+        Write(out, kVersion);
+        Write(out, stamp->size);
+        Write(out, stamp->modified);
+        Write(out, static_cast<u64>(mTimestamps.size()));
+        Write(out, static_cast<u64>(mKeyframes.size()));
+        out.write(reinterpret_cast<const char*>(mTimestamps.data()),
+                  static_cast<std::streamsize>(mTimestamps.size() * sizeof(double)));
+        out.write(reinterpret_cast<const char*>(mKeyframes.data()),
+                  static_cast<std::streamsize>(mKeyframes.size() * sizeof(u64)));
+        if (!out.flush()) {
+            return err(ErrorCode::FILE_WRITE_ERROR, "could not write media index: " + partial.string());
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(partial, sidecar, ec);
+    if (ec) {
+        std::filesystem::remove(partial, ec);
+        return err(ErrorCode::FILE_WRITE_ERROR, "could not write media index: " + sidecar.string());
+    }
+    return {};
+}
+
+} // namespace ct::vision
@@ -0,0 +1,92 @@
+#include "media/reorder_buffer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ct::vision {
+
+ReorderBuffer::ReorderBuffer(std::size_t window, u64 count)
+    : mSlots(std::max<std::size_t>(window, 1)), mCount(count) {}
+
+std::optional<ReorderBuffer::Ticket> ReorderBuffer::Claim() {
+    std::unique_lock lock(mMutex);
+    mClaimable.wait(lock, [&] { return mClosed || (mClaimed < mCount && mClaimed < mNext + mSlots.size()); });
+    if (mClosed) return std::nullopt;
+    return Ticket{mClaimed++, mGeneration};
+}
+
+void ReorderBuffer::Put(const Ticket& ticket, result<Frame> frame) {
+    bool next = false;
+    {
+        std::lock_guard lock(mMutex);
+        if (ticket.generation != mGeneration || mClosed) return;
+        mSlots[ticket.index % mSlots.size()] = std::move(frame);
+        next = ticket.index == mNext;
+    }
+    if (next) mReady.notify_one();
+}
+
+void ReorderBuffer::Reset(u64 next) {
+    {
+        std::lock_guard lock(mMutex);
+        for (auto& slot : mSlots) slot.reset();
+        mNext = next;
+        mClaimed = next;
+        ++mGeneration;
+        mEnd.reset();
+    }
+    mClaimable.notify_all();
+}
+
+void ReorderBuffer::Close() {
+    {
+        std::lock_guard lock(mMutex);
+        mClosed = true;
+    }
+    mClaimable.notify_all();
+    mReady.notify_all();
+}
+
+result<Frame> ReorderBuffer::Take() {
+    auto& slot = mSlots[mNext % mSlots.size()];
+    result<Frame> frame = std::move(*slot);
+    slot.reset();
+    if (!frame) {
+        //NOTE: Later frames may have decoded fine, but the stream stops at the first failure
+        mEnd = frame.error();
+        return frame;
+    }
+    ++mNext;
+    return frame;
+}
+
+result<Frame> ReorderBuffer::Pop() {
+    result<Frame> frame;
+    {
+        std::unique_lock lock(mMutex);
+        mReady.wait(lock, [&] { return mClosed || mEnd || mNext >= mCount || Ready(); });
+        if (mEnd) return err(*mEnd);
+        if (mClosed) return err(ErrorCode::VALIDATION_INVALID_STATE, "media is closed");
+        if (mNext >= mCount) return err(ErrorCode::FILE_EOF, "end of sequence");
+        frame = Take();
+    }
+    mClaimable.notify_one();
+    return frame;
+}
+
+result<std::optional<Frame>> ReorderBuffer::TryPop() {
+    result<Frame> frame;
+    {
+        std::lock_guard lock(mMutex);
+        if (mEnd) return err(*mEnd);
+        if (mClosed) return err(ErrorCode::VALIDATION_INVALID_STATE, "media is closed");
+        if (mNext >= mCount) return err(ErrorCode::FILE_EOF, "end of sequence");
+        if (!Ready()) return std::optional<Frame>();
+        frame = Take();
+    }
+    mClaimable.notify_one();
+    if (!frame) return err(frame.error());
+    return std::optional<Frame>(std::move(*frame));
+}
+
+} // namespace ct::vision
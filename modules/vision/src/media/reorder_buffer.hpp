@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ct/base/errors/result.hpp"
+#include "ct/vision/media/frame.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace ct::vision {
+
+// Hands frame numbers of a stream of known length to several decoders and delivers the
+// results in order. Decoders claim at most `window` frames ahead of the consumer, so the
+// window bounds both the look-ahead and the frames held; frame i lives in slot i % window.
+class ReorderBuffer {
+public:
+    struct Ticket {
+        u64 index{0};
+        u64 generation{0};
+    };
+
+    ReorderBuffer(std::size_t window, u64 count);
+
+    // Next frame to decode; blocks while the window is full or every frame is claimed,
+    // std::nullopt once the buffer is closed
+    [[nodiscard]] std::optional<Ticket> Claim();
+
+    // Hands in a claimed frame or the error decoding it; tickets from before a Reset are dropped
+    void Put(const Ticket& ticket, result<Frame> frame);
+
+    // Restarts delivery at frame `next`, discarding buffered and in-flight frames
+    void Reset(u64 next);
+
+    // Wakes decoders and consumer for shutdown
+    void Close();
+
+    // After the last frame every call returns ErrorCode::FILE_EOF; a decode error is
+    // returned in place of its frame and from then on
+    [[nodiscard]] result<Frame> Pop();
+    [[nodiscard]] result<std::optional<Frame>> TryPop();
+
+private:
+    [[nodiscard]] bool Ready() const noexcept { return mSlots[mNext % mSlots.size()].has_value(); }
+    [[nodiscard]] result<Frame> Take();
+
+    std::mutex mMutex;
+    std::condition_variable mClaimable;
+    std::condition_variable mReady;
+    std::vector<std::optional<result<Frame>>> mSlots;
+    u64 mCount;
+    u64 mNext{0};    // Frame the consumer gets next
+    u64 mClaimed{0}; // Frame the decoders claim next
+    u64 mGeneration{0};
+    std::optional<Error> mEnd;
+    bool mClosed{false};
+};
+
+} // namespace ct::vision
@@ -0,0 +1,198 @@
+#include "media/video_media.hpp"
+
+#include "ct/base/logger/logger.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/version.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace ct::vision {
+
+namespace {
+
+bool IsKeyframe([[maybe_unused]] cv::VideoCapture& scan, [[maybe_unused]] bool raw, u64 frame) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+    if (raw) return scan.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0;
+#endif
+    //NOTE: Without packet flags only the first frame is known to be decodable on its own;
+    //      seeks then decode from the start, slowly but exactly
+    return frame == 0;
+}
+
+result<ref<const MediaIndex>> BuildIndex(const std::filesystem::path& path, const std::atomic<bool>& cancel) {
+    //NOTE: A live stream never ends, so scanning it would hold a second connection forever
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return err(ErrorCode::VALIDATION_INVALID_STATE, "only media files can be indexed: " + path.string());
+    }
+    if (auto cached = MediaIndex::Load(path)) return createRef<const MediaIndex>(std::move(*cached));
+
+    //NOTE: Raw mode hands out compressed packets, so the scan costs I/O rather than
+    //      decoding; backends without it fall back to a decoding scan
+    cv::VideoCapture scan;
+    bool raw = true;
+    MediaIndex index;
+    try {
+        scan.open(path.string(), cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1});
+        if (!scan.isOpened()) {
+            raw = false;
+            scan.open(path.string());
+        }
+        if (!scan.isOpened()) return err(ErrorCode::FILE_READ_ERROR, "could not scan media: " + path.string());
+        while (!cancel.load(std::memory_order_relaxed) && scan.grab()) {
+            index.Add(scan.get(cv::CAP_PROP_POS_MSEC) / 1000.0, IsKeyframe(scan, raw, index.FrameCount()));
+        }
+    } catch (const cv::Exception& e) {
+        return err(ErrorCode::FILE_READ_ERROR, e.what());
+    }
+    if (cancel.load(std::memory_order_relaxed)) return err(ErrorCode::VALIDATION_INVALID_STATE, "media is closed");
+    if (index.FrameCount() == 0) return err(ErrorCode::PARSE_INVALID_FORMAT, "no frames to index: " + path.string());
+    index.Finalize();
+
+    //NOTE: A read-only location only costs the next open a re-scan
+    if (auto saved = index.Save(path); !saved) log::Warn("media index not cached: {}", saved.error().Message());
+    return createRef<const MediaIndex>(std::move(index));
+}
+
+} // namespace
+
+VideoMedia::VideoMedia(std::filesystem::path path, cv::VideoCapture capture, const MediaSettings& settings)
+    : Media(std::move(path)), mCapture(std::move(capture)), mQueue(settings.prefetch) {
+    mInfo.width = static_cast<u32>(mCapture.get(cv::CAP_PROP_FRAME_WIDTH));
+    mInfo.height = static_cast<u32>(mCapture.get(cv::CAP_PROP_FRAME_HEIGHT));
+    mInfo.fps = mCapture.get(cv::CAP_PROP_FPS);
+    const double count = mCapture.get(cv::CAP_PROP_FRAME_COUNT);
+    mInfo.frameCount = count > 0.0 ? static_cast<u64>(count) : 0;
+    //NOTE: One more buffer than ring + consumer for the frame being decoded
+    const std::size_t bytes = AlignedRowBytes(std::size_t{mInfo.width} * 3) * mInfo.height;
+    mPool = FramePool::Create(bytes, settings.prefetch + settings.inFlight + 1);
+    mIndex = std::async(settings.index ? std::launch::async : std::launch::deferred,
+                        [path = Path(), this] { return BuildIndex(path, mCancelIndex); })
+                 .share();
+    StartDecoder(0, false);
+}
+
+VideoMedia::~VideoMedia() {
+    StopDecoder();
+    //NOTE: The future of an async scan blocks until it returns, so stop it first
+    mCancelIndex.store(true, std::memory_order_relaxed);
+    mIndex = {};
+}
+
+void VideoMedia::StartDecoder(u64 first, bool grabbed) {
+    mWorker = std::thread([this, first, grabbed] { Decode(first, grabbed); });
+}
+
+void VideoMedia::StopDecoder() {
+    mQueue.Close();
+    if (mWorker.joinable()) mWorker.join();
+}
+
+result<void> VideoMedia::Seek(u64 frame) {
+    auto index = Index();
+    if (!index) return err(index.error());
+    if (frame >= (*index)->FrameCount()) {
+        return err(ErrorCode::VALIDATION_OUT_OF_RANGE,
+                   "frame " + std::to_string(frame) + " is past the end of " + Path().string());
+    }
+
+    StopDecoder();
+    mQueue.Reset();
+    auto at = Position(**index, frame);
+    if (!at) {
+        mQueue.Finish(at.error());
+        return err(at.error());
+    }
+    StartDecoder(*at, true);
+    return {};
+}
+
+result<u64> VideoMedia::Position(const MediaIndex& index, u64 frame) {
+    const auto timestamps = index.Timestamps();
+    const auto current = [&] { return index.FrameAt(mCapture.get(cv::CAP_PROP_POS_MSEC) / 1000.0); };
+    //NOTE: A container seek lands on a keyframe near the requested time, but which one is
+    //      only known after a grab; step back a keyframe at a time while it overshoots
+    try {
+        for (u64 key = index.KeyframeBefore(frame);; key = index.KeyframeBefore(key - 1)) {
+            if (key == 0) {
+                mCapture.set(cv::CAP_PROP_POS_FRAMES, 0.0);
+            } else {
+                mCapture.set(cv::CAP_PROP_POS_MSEC, timestamps[key] * 1000.0);
+            }
+            if (!mCapture.grab()) return err(ErrorCode::FILE_READ_ERROR, "could not seek " + Path().string());
+
+            u64 at = current();
+            if (at > frame && key > 0) continue;
+            //NOTE: grab() decodes without the colour conversion read() adds
+            while (at < frame) {
+                if (!mCapture.grab()) return err(ErrorCode::FILE_EOF, "end of stream");
+                at = std::max(at + 1, current());
+            }
+            return at;
+        }
+    } catch (const cv::Exception& e) {
+        return err(ErrorCode::FILE_READ_ERROR, e.what());
+    }
+}
+
+void VideoMedia::Decode(u64 first, bool grabbed) {
+    // Geometry of the last frame; the decoder writes into a header over a pooled buffer
+    // as long as it stays the same, and allocates its own image (copied over) when not
+    u32 width = mInfo.width;
+    u32 height = mInfo.height;
+    u32 channels = 3;
+    for (u64 index = first;; ++index) {
+        std::size_t stride = AlignedRowBytes(std::size_t{width} * channels);
+        FrameBuffer buffer = mPool->Acquire(stride * height);
+        cv::Mat decoded;
+        if (width > 0 && height > 0) {
+            decoded = cv::Mat(static_cast<int>(height), static_cast<int>(width),
+                              CV_8UC(static_cast<int>(channels)), buffer.Data(), stride);
+        }
+        try {
+            const bool got = grabbed ? mCapture.retrieve(decoded) : mCapture.read(decoded);
+            grabbed = false;
+            if (!got || decoded.empty()) {
+                mQueue.Finish(Error(ErrorCode::FILE_EOF, "end of stream"));
+                return;
+            }
+        } catch (const cv::Exception& e) {
+            mQueue.Finish(Error(ErrorCode::FILE_READ_ERROR, e.what()));
+            return;
+        }
+        if (decoded.depth() != CV_8U) {
+            mQueue.Finish(Error(ErrorCode::FILE_READ_ERROR, "decoder returned a non 8-bit frame"));
+            return;
+        }
+
+        if (decoded.data != buffer.Data()) {
+            width = static_cast<u32>(decoded.cols);
+            height = static_cast<u32>(decoded.rows);
+            channels = static_cast<u32>(decoded.channels());
+            stride = AlignedRowBytes(std::size_t{width} * channels);
+            buffer.Reset();
+            buffer = mPool->Acquire(stride * height);
+            const std::size_t row = std::size_t{width} * channels;
+            for (u32 y = 0; y < height; ++y) {
+                std::memcpy(buffer.Data() + y * stride, decoded.ptr<u8>(static_cast<int>(y)), row);
+            }
+        }
+
+        Frame frame;
+        frame.pixels = std::move(buffer);
+        frame.width = width;
+        frame.height = height;
+        frame.channels = channels;
+        frame.stride = stride;
+        frame.index = index;
+        frame.timestamp = mCapture.get(cv::CAP_PROP_POS_MSEC) / 1000.0;
+        if (!mQueue.Push(std::move(frame))) return;
+    }
+}
+
+} // namespace ct::vision
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ct/vision/media/media.hpp"
+#include "media/frame_queue.hpp"
+
+#include <opencv2/videoio.hpp>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace ct::vision {
+
+// Video files and streams through cv::VideoCapture, decoded on one background thread.
+// The seek index is built by a second capture in raw packet mode, next to the decoder.
+class VideoMedia final : public Media {
+public:
+    VideoMedia(std::filesystem::path path, cv::VideoCapture capture, const MediaSettings& settings);
+    ~VideoMedia() override;
+
+    [[nodiscard]] result<Frame> Next() override { return mQueue.Pop(); }
+    [[nodiscard]] result<std::optional<Frame>> TryNext() override { return mQueue.TryPop(); }
+    [[nodiscard]] result<void> Seek(u64 frame) override;
+    [[nodiscard]] result<ref<const MediaIndex>> Index() override { return mIndex.get(); }
+    [[nodiscard]] const MediaInfo& Info() const noexcept override { return mInfo; }
+
+private:
+    // `grabbed`: the capture already holds `first`, grabbed but not yet retrieved
+    void StartDecoder(u64 first, bool grabbed);
+    void StopDecoder();
+    void Decode(u64 first, bool grabbed);
+
+    // Leaves the capture holding the frame at or just after `frame`; returns its number
+    [[nodiscard]] result<u64> Position(const MediaIndex& index, u64 frame);
+
+    cv::VideoCapture mCapture;
+    MediaInfo mInfo;
+    FrameQueue mQueue;
+    ref<FramePool> mPool;
+    std::thread mWorker;
+    std::atomic<bool> mCancelIndex{false};
+    std::shared_future<result<ref<const MediaIndex>>> mIndex;
+};
+
+} // namespace ct::vision
@@ -0,0 +1,249 @@
+#include "ct/vision/remap/remap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace ct::vision {
+
+namespace {
+
+constexpr std::size_t kLanes = simd_lanes<i32>;
+using Lanes = pack<i32, kLanes>;
+
+constexpr i32 kRemapScale = 1 << kRemapBits;
+constexpr i32 kRemapMask = kRemapScale - 1;
+constexpr u32 kWeightBits = 2 * kRemapBits;
+
+//NOTE: Output rows per thread-pool task at minimum
+constexpr std::size_t kRowGrain = 8;
+
+// Every parameter a table depends on; the extrinsics do not enter
+struct RemapKey {
+    std::array<float, 9 + 5 + 9 + 9> values{};
+    u32 width{0};
+    u32 height{0};
+
+    [[nodiscard]] bool operator==(const RemapKey&) const = default;
+
+    [[nodiscard]] u64 Hash() const noexcept {
+        // FNV-1a over the raw bytes
+        u64 h = 0xcbf2'9ce4'8422'2325ull;
+        const auto mix = [&](const void* p, std::size_t n) {
+            const auto* b = static_cast<const unsigned char*>(p);
+            for (std::size_t i = 0; i < n; ++i) h = (h ^ b[i]) * 0x100'0000'01b3ull;
+        };
+        mix(values.data(), sizeof(values));
+        mix(&width, sizeof(width));
+        mix(&height, sizeof(height));
+        return h;
+    }
+};
+
+RemapKey MakeKey(const Camera& camera, const mat3f& rotation, const mat3f& newIntrinsics, u32 width, u32 height) {
+    RemapKey key;
+    std::size_t at = 0;
+    for (const mat3f* m : {&camera.intrinsics, &rotation, &newIntrinsics}) {
+        for (std::size_t r = 0; r < 3; ++r) {
+            for (std::size_t c = 0; c < 3; ++c) key.values[at++] = (*m)(r, c);
+        }
+    }
+    for (std::size_t i = 0; i < 5; ++i) key.values[at++] = camera.distortion[i];
+    key.width = width;
+    key.height = height;
+    return key;
+}
+
+struct CacheEntry {
+    u64 hash;
+    RemapKey key;
+    ref<const RemapTable> table;
+};
+
+std::mutex gCacheMutex;
+std::vector<CacheEntry> gCache;
+
+// Source position in 1 / kRemapScale pixels, saturated to the int16 range of the table;
+// NaN (rays behind the camera) lands far outside the image
+i32 Quantize(float v) noexcept {
+    constexpr float lo = -32768.0f * kRemapScale;
+    constexpr float hi = 32767.0f * kRemapScale;
+    const float s = v * static_cast<float>(kRemapScale);
+    if (!(s > lo)) return static_cast<i32>(lo);
+    if (s >= hi) return static_cast<i32>(hi);
+    return static_cast<i32>(std::lrintf(s));
+}
+
+// One output row, a block of kLanes pixels at a time: the four taps of every pixel are
+// gathered into lanes, then the weights and both bilinear steps run in SIMD
+template<u32 C>
+void RemapRow(const ImageView<const u8>& src, u8* out, const i16* xy, const u16* frac, u32 width) noexcept {
+    const i32 sw = static_cast<i32>(src.width);
+    const i32 sh = static_cast<i32>(src.height);
+    const std::size_t stride = src.stride;
+    alignas(64) i32 fx[kLanes];
+    alignas(64) i32 fy[kLanes];
+    alignas(64) i32 taps[C][4][kLanes];
+    alignas(64) i32 result[C][kLanes];
+
+    for (u32 x = 0; x < width; x += kLanes) {
+        const std::size_t count = std::min<std::size_t>(kLanes, width - x);
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            const i32 sx = l < count ? xy[2 * (x + l)] : -2;
+            const i32 sy = l < count ? xy[2 * (x + l) + 1] : -2;
+            const u16 f = l < count ? frac[x + l] : 0;
+            fx[l] = f & kRemapMask;
+            fy[l] = f >> kRemapBits;
+            //NOTE: Footprints fully inside the image, the common case, skip the clamping
+            if (static_cast<u32>(sx) < src.width - 1 && static_cast<u32>(sy) < src.height - 1) {
+                const u8* p = src.data + static_cast<std::size_t>(sy) * stride + static_cast<std::size_t>(sx) * C;
+                for (u32 c = 0; c < C; ++c) {
+                    taps[c][0][l] = p[c];
+                    taps[c][1][l] = p[C + c];
+                    taps[c][2][l] = p[stride + c];
+                    taps[c][3][l] = p[stride + C + c];
+                }
+                continue;
+            }
+            if (sx < -1 || sx >= sw || sy < -1 || sy >= sh) {
+                for (u32 c = 0; c < C; ++c) {
+                    for (auto& t : taps[c]) t[l] = 0;
+                }
+                continue;
+            }
+            const auto x0 = static_cast<std::size_t>(std::clamp(sx, 0, sw - 1)) * C;
+            const auto x1 = static_cast<std::size_t>(std::clamp(sx + 1, 0, sw - 1)) * C;
+            const u8* r0 = src.data + static_cast<std::size_t>(std::clamp(sy, 0, sh - 1)) * stride;
+            const u8* r1 = src.data + static_cast<std::size_t>(std::clamp(sy + 1, 0, sh - 1)) * stride;
+            for (u32 c = 0; c < C; ++c) {
+                taps[c][0][l] = r0[x0 + c];
+                taps[c][1][l] = r0[x1 + c];
+                taps[c][2][l] = r1[x0 + c];
+                taps[c][3][l] = r1[x1 + c];
+            }
+        }
+
+        const Lanes ax = Lanes::load(fx);
+        const Lanes ay = Lanes::load(fy);
+        const Lanes bx = kRemapScale - ax;
+        const Lanes by = kRemapScale - ay;
+        for (u32 c = 0; c < C; ++c) {
+            const Lanes top = Lanes::load(taps[c][0]) * bx + Lanes::load(taps[c][1]) * ax;
+            const Lanes bottom = Lanes::load(taps[c][2]) * bx + Lanes::load(taps[c][3]) * ax;
+            const Lanes sum = top * by + bottom * ay;
+            ((sum + (1 << (kWeightBits - 1))) >> static_cast<int>(kWeightBits)).store(result[c]);
+        }
+        u8* o = out + std::size_t{x} * C;
+        for (std::size_t l = 0; l < count; ++l) {
+            for (u32 c = 0; c < C; ++c) o[l * C + c] = static_cast<u8>(result[c][l]);
+        }
+    }
+}
+
+template<u32 C>
+void RemapRows(const ImageView<const u8>& src, const ImageView<u8>& dst, const RemapTable& table) {
+    const auto xy = table.Coordinates();
+    const auto frac = table.Fractions();
+    const std::size_t rows = dst.height;
+    parallel_for(0, rows, parallel_grain(rows, kRowGrain), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t y = begin; y < end; ++y) {
+            const std::size_t at = y * dst.width;
+            RemapRow<C>(src, dst.Row(static_cast<u32>(y)), xy.data() + 2 * at, frac.data() + at, dst.width);
+        }
+    });
+}
+
+} // namespace
+
+RemapTable::RemapTable(u32 width, u32 height)
+    : mWidth(width), mHeight(height),
+      mCoordinates(2 * std::size_t{width} * height), mFractions(std::size_t{width} * height) {}
+
+ref<const RemapTable> RemapTable::Build(const Camera& camera, const mat3f& rotation, const mat3f& newIntrinsics,
+                                        u32 width, u32 height) {
+    ref<RemapTable> table(new RemapTable(width, height));
+    // Output pixel -> ray in the camera frame
+    const mat3f back = transpose(rotation) * inverse(newIntrinsics);
+    const mat3f& k = camera.intrinsics;
+
+    parallel_for(0, height, parallel_grain(height, kRowGrain), [&](std::size_t begin, std::size_t end) {
+        std::vector<vec2f> normalized(width);
+        std::vector<vec2f> distorted(width);
+        for (std::size_t y = begin; y < end; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                const vec3f ray = back * vec3f(static_cast<float>(x), static_cast<float>(y), 1.0f);
+                const float nan = std::numeric_limits<float>::quiet_NaN();
+                normalized[x] = ray.z > 0.0f ? vec2f(ray.x / ray.z, ray.y / ray.z) : vec2f(nan, nan);
+            }
+            camera.Distort(normalized, distorted);
+
+            i16* xy = table->mCoordinates.data() + 2 * y * width;
+            u16* frac = table->mFractions.data() + y * width;
+            for (u32 x = 0; x < width; ++x) {
+                const vec2f d = distorted[x];
+                const i32 u = Quantize(k(0, 0) * d.x + k(0, 1) * d.y + k(0, 2));
+                const i32 v = Quantize(k(1, 1) * d.y + k(1, 2));
+                xy[2 * x] = static_cast<i16>(u >> kRemapBits);
+                xy[2 * x + 1] = static_cast<i16>(v >> kRemapBits);
+                frac[x] = static_cast<u16>(((v & kRemapMask) << kRemapBits) | (u & kRemapMask));
+            }
+        }
+    });
+    return table;
+}
+
+ref<const RemapTable> RemapTable::Rectify(const Camera& camera, const mat3f& rotation, const mat3f& newIntrinsics,
+                                          u32 width, u32 height) {
+    const RemapKey key = MakeKey(camera, rotation, newIntrinsics, width, height);
+    const u64 hash = key.Hash();
+    {
+        std::lock_guard lock(gCacheMutex);
+        const auto it = std::find_if(gCache.begin(), gCache.end(), [&](const CacheEntry& e) {
+            return e.hash == hash && e.key == key;
+        });
+        if (it != gCache.end()) {
+            std::rotate(it, it + 1, gCache.end());
+            return gCache.back().table;
+        }
+    }
+
+    //NOTE: Built unlocked; two threads missing on the same key both build, and the first insert wins
+    ref<const RemapTable> built = Build(camera, rotation, newIntrinsics, width, height);
+    std::lock_guard lock(gCacheMutex);
+    const auto it = std::find_if(gCache.begin(), gCache.end(), [&](const CacheEntry& e) {
+        return e.hash == hash && e.key == key;
+    });
+    if (it != gCache.end()) return it->table;
+    if (gCache.size() >= kRemapCacheSize) gCache.erase(gCache.begin());
+    gCache.push_back({hash, key, built});
+    return built;
+}
+
+ref<const RemapTable> RemapTable::Undistort(const Camera& camera, u32 width, u32 height) {
+    return Rectify(camera, mat3f::identity(), camera.intrinsics, width, height);
+}
+
+void RemapTable::ClearCache() {
+    std::lock_guard lock(gCacheMutex);
+    gCache.clear();
+}
+
+void Remap(ImageView<const u8> src, ImageView<u8> dst, const RemapTable& table) {
+    assert(dst.width == table.Width() && dst.height == table.Height());
+    assert(dst.channels == src.channels);
+    if (dst.Empty() || src.Empty()) return;
+    switch (src.channels) {
+        case 1: RemapRows<1>(src, dst, table); break;
+        case 2: RemapRows<2>(src, dst, table); break;
+        case 3: RemapRows<3>(src, dst, table); break;
+        case 4: RemapRows<4>(src, dst, table); break;
+        default: assert(false && "Remap supports 1 to 4 channels"); break;
+    }
+}
+
+} // namespace ct::vision
@@ -9,27 +9,31 @@
 #include <opencv2/features2d.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
-#include <opencv2/videoio.hpp>
 
 using namespace ct;
 
 constexpr int kFrameWidth = 1080;
 constexpr int kFrameHeight = 720;
 
-cv::Mat process_frame(const cv::Mat& frame_bgr) {
+// Per-frame scratch images, kept across frames so cv::resize / cvtColor write into the
+// same buffers instead of allocating new ones every frame
+struct FrameWorkspace {
     cv::Mat resized;
-    cv::resize(frame_bgr, resized, cv::Size(kFrameWidth, kFrameHeight), 0.0, 0.0, cv::INTER_AREA);
     cv::Mat gray;
-    cv::cvtColor(resized, gray, cv::COLOR_BGR2GRAY);
-
     std::vector<cv::Point2f> corners;
-    cv::goodFeaturesToTrack(gray, corners, 1000, 0.01, 10);
+};
+
+const cv::Mat& process_frame(const cv::Mat& frame_bgr, FrameWorkspace& ws) {
+    cv::resize(frame_bgr, ws.resized, cv::Size(kFrameWidth, kFrameHeight), 0.0, 0.0, cv::INTER_AREA);
+    cv::cvtColor(ws.resized, ws.gray, cv::COLOR_BGR2GRAY);
+
+    cv::goodFeaturesToTrack(ws.gray, ws.corners, 1000, 0.01, 10);
 
-    for (size_t i = 0; i < corners.size(); i++) {
-        cv::circle(resized, corners[i], 3, cv::Scalar(0, 255, 0), -1);
+    for (size_t i = 0; i < ws.corners.size(); i++) {
+        cv::circle(ws.resized, ws.corners[i], 3, cv::Scalar(0, 255, 0), -1);
     }
 
-    return resized;
+    return ws.resized;
 }
 
 int main(int /*argc*/, char* /*argv*/[]) {
@@ -37,20 +41,29 @@ int main(int /*argc*/, char* /*argv*/[]) {
 
     const std::filesystem::path videoPath = "/home/toor/dev/toolbox/dataset/video.mp4";
 
-    cv::VideoCapture cap(videoPath.string());
-    if (!cap.isOpened()) {
-        log::Error("Error: Could not open video: {}", videoPath.string());
+    auto media = vision::Media::Open(videoPath);
+    if (!media) {
+        log::Error("Error: Could not open video: {} ({})", videoPath.string(), media.error().Message());
         return EXIT_FAILURE;
     }
 
-    cv::Mat frame;
+    // Frames are decoded ahead on the media thread while this one processes
+    FrameWorkspace workspace;
     while (true) {
-        if (!cap.read(frame) || frame.empty()) {
-            log::Info("End of video or failed to read frame.");
+        auto frame = (*media)->Next();
+        if (!frame) {
+            if (frame.error().Code() == ErrorCode::FILE_EOF) {
+                log::Info("End of video.");
+            } else {
+                log::Error("Failed to read frame: {}", frame.error().Message());
+            }
             break;
         }
 
-        cv::Mat vis = process_frame(frame);
+        // Header over the pooled buffer; the frame returns to the pool at the end of the iteration
+        const cv::Mat view(static_cast<int>(frame->height), static_cast<int>(frame->width),
+                           CV_8UC(static_cast<int>(frame->channels)), frame->pixels.Data(), frame->stride);
+        const cv::Mat& vis = process_frame(view, workspace);
         cv::imshow("Camera Feed", vis);
 
         const int k = cv::waitKey(30);